@@ -41,6 +41,16 @@ enum CoreSettings : uint32_t
     GaplessPlayback     = 10 | Type::Bool,
     Language            = 11 | Type::String,
     BufferLength        = 12 | Type::Int,
+    ReadAheadSize       = 13 | Type::Int,
+    MemoryCacheLimit    = 14 | Type::Int,
+    ReplayGainMode      = 15 | Type::Int,
+    ReplayGainPreamp    = 16 | Type::Double,
+    DspChain            = 17 | Type::StringList,
+    OutputSampleRate    = 18 | Type::Int,
+    CrossfadeLength     = 19 | Type::Int,
+    EngineStatistics    = 20 | Type::Bool,
+    OutputLatency       = 21 | Type::Int,
+    ExclusiveOutput     = 22 | Type::Bool,
 };
 Q_ENUM_NS(CoreSettings)
 } // namespace Fooyin::Settings::Core
@@ -0,0 +1,108 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QObject>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Fooyin {
+class AudioAnalysisBus;
+
+/** The analysis of one block of rendered audio. */
+struct AnalysisResult
+{
+    // When the block is heard
+    std::chrono::steady_clock::time_point playTime;
+    int sampleRate{0};
+    // Per channel, as a linear gain where 1.0 is full scale
+    std::vector<float> peak;
+    std::vector<float> rms;
+    // Magnitude of each frequency bin of all channels mixed down, from DC up to half the sample rate.
+    // A full scale sine wave peaks at 1.0.
+    std::vector<float> spectrum;
+
+    [[nodiscard]] bool isValid() const
+    {
+        return sampleRate > 0;
+    }
+
+    /** Returns the centre frequency of spectrum bin @p bin in Hz. */
+    [[nodiscard]] double binFrequency(int bin) const
+    {
+        if(spectrum.size() < 2) {
+            return 0.0;
+        }
+        return static_cast<double>(bin) * sampleRate / (2.0 * static_cast<double>(spectrum.size() - 1));
+    }
+};
+
+/*!
+ * Analyses rendered audio for visualisations, so however many are shown each block is only analysed once.
+ * Blocks are read from the renderer as they're published, and each is released through @fn current once
+ * it's actually heard.
+ *
+ * Nothing is published or analysed unless at least one visualisation has subscribed.
+ */
+class FYCORE_EXPORT AudioAnalyser : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Samples in each spectrum, giving a resolution of around 11Hz at 44.1kHz
+    static constexpr int FftSize = 4096;
+
+    explicit AudioAnalyser(std::shared_ptr<AudioAnalysisBus> bus, QObject* parent = nullptr);
+    ~AudioAnalyser() override;
+
+    /*!
+     * Starts analysing on behalf of @p subscriber, until it unsubscribes or is destroyed.
+     * Visualisations should only be subscribed while visible.
+     */
+    void subscribe(QObject* subscriber);
+    void unsubscribe(QObject* subscriber);
+
+    /** Sets how many times a second to check for newly heard audio, which should match the display. */
+    void setRefreshRate(double rate);
+
+    /*!
+     * Returns the analysis of the audio being heard now, or an invalid result if nothing is playing.
+     * The reference remains valid until the next @fn updated signal.
+     */
+    [[nodiscard]] const AnalysisResult& current() const;
+    /*!
+     * Returns every result heard since the previous @fn updated signal, oldest first, for visualisations
+     * which draw each block such as a spectrogram. The last is the same as @fn current.
+     */
+    [[nodiscard]] const std::vector<AnalysisResult>& released() const;
+
+signals:
+    /** Emitted at most once per refresh, when the audio being heard has moved on. */
+    void updated();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
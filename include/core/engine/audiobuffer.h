@@ -28,13 +28,36 @@
 #include <span>
 
 namespace Fooyin {
+struct AudioBufferPoolStats
+{
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t cachedBytes{0};
+};
+
+/*!
+ * A block of interleaved PCM audio.
+ * Storage is taken from a shared pool and returned once the last copy is destroyed,
+ * so buffers can be created and discarded on the audio path without touching the heap.
+ */
 class FYCORE_EXPORT AudioBuffer
 {
 public:
+    /** Releases externally owned data wrapped by a buffer. */
+    using ReleaseFunc = void (*)(void* opaque);
+
     AudioBuffer();
     AudioBuffer(AudioFormat format, uint64_t startTime);
     AudioBuffer(std::span<const std::byte> data, AudioFormat format, uint64_t startTime);
     AudioBuffer(const uint8_t* data, size_t size, AudioFormat format, uint64_t startTime);
+    /*!
+     * Wraps @p size bytes of externally owned @p data without copying it.
+     * @p release is called with @p opaque once the data is no longer referenced.
+     * @note the data is treated as read-only; it's copied into the buffer's own storage
+     * the first time the buffer is modified or non-const access to it is requested.
+     */
+    AudioBuffer(const std::byte* data, size_t size, AudioFormat format, uint64_t startTime, ReleaseFunc release,
+                void* opaque);
     ~AudioBuffer();
 
     AudioBuffer(const AudioBuffer& other);
@@ -45,6 +68,7 @@ public:
     void resize(size_t size);
     void append(std::span<const std::byte> data);
     void append(const std::byte* data, size_t size);
+    /** Removes @p size bytes from the front of the buffer. This doesn't move the remaining data. */
     void erase(size_t size);
     void clear();
     void reset();
@@ -67,6 +91,9 @@ public:
     void fillRemainingWithSilence();
     void adjustVolumeOfSamples(double volume);
 
+    /** Returns the counters of the storage pool shared by all buffers. */
+    static AudioBufferPoolStats poolStats();
+
 private:
     struct Private;
     QExplicitlySharedDataPointer<Private> p;
@@ -21,6 +21,8 @@
 
 #include "fycore_export.h"
 
+#include <core/engine/dspnode.h>
+#include <core/engine/enginestats.h>
 #include <core/engine/outputplugin.h>
 
 namespace Fooyin {
@@ -55,13 +57,20 @@ public:
     virtual void seek(uint64_t pos) = 0;
 
     virtual void changeTrack(const Track& track) = 0;
-    virtual void setState(PlaybackState state)   = 0;
+    /*!
+     * Opens @p track in the background so it can follow on from the current track without a gap.
+     * Changing to any other track is unaffected.
+     */
+    virtual void prepareNextTrack(const Track& track) = 0;
+    virtual void setState(PlaybackState state)        = 0;
 
     virtual void play()  = 0;
     virtual void pause() = 0;
     virtual void stop()  = 0;
 
     virtual void setVolume(double volume) = 0;
+    /** Replaces the DSP chain with a stage from each of @p dsps, applied in order. */
+    virtual void setDsps(const std::vector<DspCreator>& dsps) = 0;
 
     virtual void setAudioOutput(const OutputCreator& output) = 0;
     virtual void setOutputDevice(const QString& device)      = 0;
@@ -71,5 +80,9 @@ signals:
     void trackStatusChanged(TrackStatus status);
     void positionChanged(uint64_t ms);
     void trackAboutToFinish();
+    /** Emitted periodically while Settings::Core::EngineStatistics is enabled. */
+    void statsChanged(const EngineStats& stats);
+    /** Emitted when the path from decoder to device starts or stops being bit-perfect. */
+    void bitPerfectChanged(bool bitPerfect);
 };
 } // namespace Fooyin
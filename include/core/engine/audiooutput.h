@@ -24,6 +24,8 @@
 
 #include <QString>
 
+#include <functional>
+
 namespace Fooyin {
 struct OutputState
 {
@@ -40,6 +42,16 @@ struct OutputDevice
 
 using OutputDevices = std::vector<OutputDevice>;
 
+/*!
+ * Used by outputs running in pull mode to request audio from the renderer.
+ * Writes up to @p frames frames into @p data, in the format passed to @fn AudioOutput::init.
+ * @p delay is the time in seconds until the first frame written will be heard, as best the output can tell;
+ * it's used to keep the playback position in step with what's actually audible.
+ * @returns the number of frames written. The output is responsible for filling the rest with silence.
+ * @note this is intended to be called from the output's real-time thread, so it never blocks.
+ */
+using AudioPullCallback = std::function<int(std::byte* data, int frames, double delay)>;
+
 /*!
  * An abstract interface for an audio output driver.
  */
@@ -105,6 +117,22 @@ public:
     virtual int write(const AudioBuffer& buffer) = 0;
     virtual void setPaused(bool pause)           = 0;
 
+    /*!
+     * Returns @c true if the driver can request audio itself from its device callback or thread.
+     * In pull mode, @fn write won't be called; audio is instead requested using the callback
+     * passed to @fn setPullCallback once @fn start has been called.
+     */
+    virtual bool supportsPullMode() const
+    {
+        return false;
+    }
+
+    /*!
+     * Sets the callback used to request audio in pull mode.
+     * @note this will only be called if @fn supportsPullMode returns @c true, and always before @fn init.
+     */
+    virtual void setPullCallback(AudioPullCallback /*callback*/) { }
+
     /*!
      * Set's the volume of the audio driver.
      * @note this will only be called if @fn canHandleVolume returns @c true.
@@ -112,6 +140,38 @@ public:
      */
     virtual void setVolume(double /*volume*/){};
 
+    /*!
+     * Requests that the device buffer hold around @p latency ms of audio, or the driver's default if 0.
+     * Drivers pick the nearest size their device supports; @fn bufferSize returns what was actually used.
+     * @note this is only applied by the next call to @fn init.
+     */
+    virtual void setLatency(int /*latency*/) { }
+
+    /*!
+     * Requests exclusive access to the device, bypassing any mixing, resampling or format conversion
+     * done by the driver or sound server.
+     * @note this is only applied by the next call to @fn init.
+     */
+    virtual void setExclusive(bool /*exclusive*/) { }
+
+    /*!
+     * Returns the format closest to @p format which the device can play without converting it.
+     * The channel count is never changed. May be called whether or not the output is initialised.
+     */
+    virtual AudioFormat negotiateFormat(const AudioFormat& format)
+    {
+        return format;
+    }
+
+    /*!
+     * Returns @c true if samples written are played exactly as given, with no conversion or gain applied
+     * by the driver, sound server or device. Only meaningful while initialised.
+     */
+    [[nodiscard]] virtual bool isBitPerfect() const
+    {
+        return false;
+    }
+
     /*!
      * Set's the device for this driver.
      * @note this may be called regardless of the current initialised state.
@@ -0,0 +1,70 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audioformat.h>
+
+#include <QString>
+
+#include <functional>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * An abstract interface for a single stage of DSP applied between the decoder and the output.
+ * Audio is always passed as interleaved 32bit float samples, whatever format the decoder produces.
+ */
+class DspNode
+{
+public:
+    virtual ~DspNode() = default;
+
+    /** Returns the name shown to the user for this stage. */
+    [[nodiscard]] virtual QString name() const = 0;
+
+    /*!
+     * Prepares the stage for audio at the sample rate and channel count of @p format,
+     * passed in blocks of at most @p maxFrames frames.
+     * Any scratch buffers or filter state should be allocated here.
+     * @note this is never called from the decode thread, and may be called again if the format changes.
+     * @returns @c false if the format isn't supported, in which case the stage is bypassed.
+     */
+    virtual bool prepare(const AudioFormat& format, int maxFrames) = 0;
+
+    /*!
+     * Processes @p frames interleaved frames of @p data in place.
+     * @note this is called from the decode thread, so must not allocate, lock or block.
+     */
+    virtual void process(float* data, int frames) = 0;
+
+    /** Returns the delay introduced by this stage in frames. */
+    [[nodiscard]] virtual int latency() const
+    {
+        return 0;
+    }
+
+    /*!
+     * Clears any filter history or delay lines, such as after a seek.
+     * @note like @fn process, this must not allocate.
+     */
+    virtual void reset() { }
+};
+using DspCreator = std::function<std::unique_ptr<DspNode>()>;
+} // namespace Fooyin
@@ -23,14 +23,18 @@
 
 #include <core/engine/audioengine.h>
 #include <core/engine/audiooutput.h>
+#include <core/engine/readaheadoptions.h>
 
 #include <QObject>
 
 namespace Fooyin {
 struct AudioOutputBuilder;
+struct DspNodeBuilder;
+class AudioAnalyser;
 class AudioDecoder;
 
 using OutputNames = std::vector<QString>;
+using DspNames    = std::vector<QString>;
 
 class FYCORE_EXPORT EngineController : public QObject
 {
@@ -53,12 +57,46 @@ public:
      */
     virtual void addOutput(const AudioOutputBuilder& output) = 0;
 
+    /** Returns a list of all DSP names. */
+    [[nodiscard]] virtual DspNames getAllDsps() const = 0;
+
+    /*!
+     * Adds a DSP stage, which can then be enabled using Settings::Core::DspChain.
+     * @note dsp.name must be unique.
+     */
+    virtual void addDsp(const DspNodeBuilder& dsp) = 0;
+
     virtual std::unique_ptr<AudioDecoder> createDecoder() = 0;
 
+    /*!
+     * Returns the decoder best suited to @p source, which reads local files ahead as set by @p options.
+     * Pass ScanReadAhead where a file is read through once, or where many decoders are in use at once.
+     * @note the decoder still needs to be initialised with @p source.
+     */
+    virtual std::unique_ptr<AudioDecoder> createDecoder(const QString& source, const ReadAheadOptions& options) = 0;
+
+    /*!
+     * Returns the most recent statistics from the playback pipeline.
+     * @note these are only collected while Settings::Core::EngineStatistics is enabled.
+     */
+    [[nodiscard]] virtual EngineStats engineStats() const = 0;
+
+    /*!
+     * Returns @c true if the current track reaches the output device exactly as decoded, with no resampling,
+     * DSP or gain applied anywhere along the way, including by the driver or sound server.
+     * @see Settings::Core::ExclusiveOutput
+     */
+    [[nodiscard]] virtual bool isBitPerfect() const = 0;
+
+    /** Returns the shared analysis of rendered audio, for visualisations to subscribe to. */
+    [[nodiscard]] virtual AudioAnalyser* analyser() const = 0;
+
 signals:
     void outputChanged(const QString& output);
     void deviceChanged(const QString& device);
     void trackStatusChanged(TrackStatus status);
     void trackAboutToFinish();
+    void engineStatsChanged(const EngineStats& stats);
+    void bitPerfectChanged(bool bitPerfect);
 };
 } // namespace Fooyin
@@ -0,0 +1,75 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiobuffer.h>
+
+#include <QString>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace Fooyin {
+struct DspStageStats
+{
+    QString name;
+    int latency{0};
+    uint64_t frames{0};
+    std::chrono::nanoseconds processTime{0};
+};
+
+/*!
+ * A snapshot of the playback pipeline, for tracking down glitches.
+ * Counters accumulate from when collection was enabled; levels are as of the snapshot.
+ */
+struct EngineStats
+{
+    // Bucket i counts buffers which took under 2^i µs to decode, with the last bucket holding the rest
+    static constexpr size_t DecodeTimeBuckets = 16;
+
+    // Times the output asked for audio and the ring buffer couldn't supply it all
+    uint64_t underruns{0};
+    // Frames of silence played as a result
+    uint64_t underrunFrames{0};
+
+    uint64_t decodedBuffers{0};
+    std::chrono::microseconds decodeTime{0};
+    std::chrono::microseconds maxDecodeTime{0};
+    std::array<uint64_t, DecodeTimeBuckets> decodeTimeHistogram{};
+
+    // Buffers resampled or converted to the output format
+    uint64_t conversions{0};
+
+    // Fill level of the ring buffer between the decode thread and the output
+    int bufferedFrames{0};
+    int bufferCapacity{0};
+    // Lowest fill level seen while playing
+    int minBufferedFrames{0};
+    // Time in seconds from audio leaving the ring buffer to it being heard
+    double outputDelay{0.0};
+
+    uint64_t readAheadStalls{0};
+    std::chrono::nanoseconds readAheadStallTime{0};
+
+    AudioBufferPoolStats bufferPool;
+    std::vector<DspStageStats> dspStages;
+};
+} // namespace Fooyin
@@ -0,0 +1,37 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Fooyin {
+/** How a decoder reads local files ahead of decoding. */
+struct ReadAheadOptions
+{
+    // Amount of the file to keep buffered ahead of the read position
+    size_t windowSize{4 * 1024 * 1024};
+    // Files up to this size are read into memory in full; 0 disables caching
+    uint64_t cacheLimit{64 * 1024 * 1024};
+};
+
+// For files read once from start to end, such as when scanning, where a decoder may run on every core
+constexpr ReadAheadOptions ScanReadAhead{.windowSize = 1024 * 1024, .cacheLimit = 0};
+} // namespace Fooyin
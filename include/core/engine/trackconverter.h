@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+#include <utils/worker.h>
+
+#include <QString>
+
+namespace Fooyin {
+struct ConversionOptions
+{
+    enum Codec : uint8_t
+    {
+        Flac = 0,
+        Opus,
+        Mp3,
+        Aac,
+    };
+
+    Codec codec{Flac};
+    // Target bitrate of the lossy codecs, in kbps
+    int bitrate{192};
+    // FLAC compression level, from 0 to 12
+    int compressionLevel{5};
+    // Resample to this rate, or 0 to keep each track's own rate where the codec allows it
+    int sampleRate{0};
+    // Files are written here, keeping their layout relative to the directory common to all tracks
+    QString outputDirectory;
+    bool overwrite{false};
+
+    /** Returns the file extension used for @p codec, without the dot. */
+    [[nodiscard]] static QString extension(Codec codec);
+};
+
+/*!
+ * Converts tracks to another format, copying their metadata across.
+ * Tracks are decoded, resampled if needed and encoded in parallel, one per core, with idle threads
+ * taking the next track from a shared queue so a few long tracks don't hold up the rest.
+ * Stopping the thread cancels the conversion, and files which are partly written are removed.
+ */
+class FYCORE_EXPORT TrackConverter : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit TrackConverter(QObject* parent = nullptr);
+    ~TrackConverter() override;
+
+    /** Converts @p tracks using @p options, blocking until all are done or stopThread is called. */
+    void convertTracks(const TrackList& tracks, const ConversionOptions& options);
+
+signals:
+    /** Overall progress, weighted by track duration. */
+    void progressChanged(int percent);
+    void trackConverted(const Track& track, const QString& outputPath);
+    void trackFailed(const Track& track, const QString& error);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
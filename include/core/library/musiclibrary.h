@@ -29,9 +29,10 @@ namespace Fooyin {
 struct LibraryInfo;
 
 /*!
- * There are two types of scan request:
+ * There are three types of scan request:
  * - Tracks: Scans a TrackList; emits tracksScanned when finished.
  * - Library: Scans an entire library; emits tracksAdded, tracksUpdated, tracksDeleted.
+ * - ReplayGain: Measures the loudness of a TrackList; emits tracksUpdated as albums are finished.
  * In-progress requests can be cancelled early using cancel().
  */
 struct ScanRequest
@@ -40,6 +41,7 @@ struct ScanRequest
     {
         Tracks = 0,
         Library,
+        ReplayGain,
     };
 
     Type type;
@@ -83,6 +85,13 @@ public:
      */
     virtual ScanRequest scanTracks(const TrackList& tracks) = 0;
 
+    /*!
+     * Calculates the ReplayGain values of @p tracks, writing them to the files and database.
+     * Tracks are grouped by album (and directory) for the album gain.
+     * @returns a ScanRequest representing a queued scan operation.
+     */
+    virtual ScanRequest scanReplayGain(const TrackList& tracks) = 0;
+
     /** Returns all tracks for all libraries */
     [[nodiscard]] virtual TrackList tracks() const = 0;
 
@@ -47,7 +47,10 @@ public:
     /** Returns the current playlist mode (shuffle and repeat flags). */
     [[nodiscard]] Playlist::PlayModes playMode() const;
 
-    /** Returns the current playback position in ms. */
+    /*!
+     * Returns the current playback position in ms.
+     * While playing, this is extrapolated from the last position reported by the engine.
+     */
     [[nodiscard]] uint64_t currentPosition() const;
 
     /*!
@@ -112,6 +115,11 @@ signals:
     void nextTrack();
     void previousTrack();
 
+    /*!
+     * Emitted when the engine reports a position that doesn't follow on from the last one,
+     * such as after seeking or changing track, or to correct drift. It isn't emitted
+     * continuously during playback; poll currentPosition() (or use a PositionTicker) instead.
+     */
     void positionChanged(uint64_t ms);
     void positionMoved(uint64_t ms);
 
@@ -89,6 +89,13 @@ public:
      * the index +- delta is out of range.
      */
     Track nextTrack(int delta, PlayModes mode);
+    /*!
+     * Returns the track @fn nextTrackChange would change to, without changing any state,
+     * so the scheduled track and shuffle position are left as they are.
+     * @note metadata isn't read, and this will return an invalid track under shuffle before
+     * the shuffle order has been created.
+     */
+    [[nodiscard]] Track peekNextTrack(int delta, PlayModes mode) const;
     /*!
      * Changes to and returns the next track to be played based on the @p delta from the current
      * index and the @p mode.
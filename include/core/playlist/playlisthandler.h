@@ -115,6 +115,8 @@ signals:
     void playlistRemoved(Playlist* playlist);
     void playlistRenamed(Playlist* playlist);
     void activePlaylistChanged(Playlist* playlist);
+    /** Emitted in response to @fn trackAboutToFinish with the track expected to be played next. */
+    void upcomingTrack(const Track& track);
 
 public slots:
     void populatePlaylists(const TrackList& tracks);
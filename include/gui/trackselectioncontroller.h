@@ -81,6 +81,8 @@ signals:
     void actionExecuted(TrackAction action);
     void selectionChanged();
     void requestPropertiesDialog();
+    void requestReplayGainScan(const TrackList& tracks);
+    void requestConversion(const TrackList& tracks);
 
 private:
     struct Private;
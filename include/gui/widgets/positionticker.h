@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fygui_export.h"
+
+#include <QObject>
+#include <QTimer>
+
+class QWidget;
+
+namespace Fooyin {
+class PlayerController;
+
+/*!
+ * Polls the playback position on behalf of a widget, at a rate suited to what it shows.
+ * While playing, it ticks at most once per display refresh when the widget is on screen,
+ * and once a second when it's hidden or its window is minimised. Jumps in position, such
+ * as from seeking or changing track, are passed on straight away.
+ */
+class FYGUI_EXPORT PositionTicker : public QObject
+{
+    Q_OBJECT
+
+public:
+    PositionTicker(PlayerController* playerController, QWidget* widget);
+
+    /*!
+     * Sets the smallest change in position worth updating the widget for,
+     * such as the length of track covered by one pixel.
+     */
+    void setResolution(uint64_t ms);
+
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+signals:
+    void positionChanged(uint64_t ms);
+
+private:
+    void sendPosition();
+    void updateInterval();
+
+    PlayerController* m_playerController;
+    QWidget* m_widget;
+    QTimer m_timer;
+    uint64_t m_resolution;
+    bool m_exposed;
+};
+} // namespace Fooyin
@@ -0,0 +1,247 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A fixed-capacity, lock-free ring buffer for a single producer and a single consumer.
+ * Only one thread may call the producer functions (@fn write, @fn waitForSpace) and only
+ * one thread may call the consumer functions (@fn read, @fn peek, @fn skip, @fn clear).
+ * @note @fn resize and @fn reset are not thread-safe and require both sides to be idle.
+ */
+template <typename T>
+class LockFreeRingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "LockFreeRingBuffer requires a trivially copyable type");
+
+public:
+    explicit LockFreeRingBuffer(size_t capacity = 0);
+
+    void resize(size_t capacity);
+    void reset();
+
+    [[nodiscard]] size_t capacity() const;
+    [[nodiscard]] size_t readAvailable() const;
+    [[nodiscard]] size_t writeAvailable() const;
+
+    [[nodiscard]] uint64_t readPosition() const;
+    [[nodiscard]] uint64_t writePosition() const;
+
+    size_t write(const T* data, size_t count);
+    /*!
+     * Blocks the producer until at least @p count items can be written, or until @fn interrupt is called.
+     * @returns @c true if the requested space is available.
+     */
+    bool waitForSpace(size_t count);
+    /** Wakes up a producer blocked in @fn waitForSpace. Safe to call from any thread. */
+    void interrupt();
+
+    size_t read(T* data, size_t count);
+    size_t peek(T* data, size_t count) const;
+    size_t skip(size_t count);
+    /** Discards all readable items. Must only be called by the consumer. */
+    void clear();
+
+private:
+    void copyOut(T* data, uint64_t pos, size_t count) const;
+    void advanceRead(size_t count);
+
+    std::vector<T> m_buffer;
+
+    alignas(64) std::atomic<uint64_t> m_writePos;
+    alignas(64) std::atomic<uint64_t> m_readPos;
+    alignas(64) std::atomic<uint32_t> m_readSignal;
+};
+
+template <typename T>
+LockFreeRingBuffer<T>::LockFreeRingBuffer(size_t capacity)
+    : m_buffer(capacity)
+    , m_writePos{0}
+    , m_readPos{0}
+    , m_readSignal{0}
+{ }
+
+template <typename T>
+void LockFreeRingBuffer<T>::resize(size_t capacity)
+{
+    if(m_buffer.size() != capacity) {
+        m_buffer.assign(capacity, T{});
+    }
+    reset();
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::reset()
+{
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::capacity() const
+{
+    return m_buffer.size();
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::readAvailable() const
+{
+    const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+    const uint64_t readPos  = m_readPos.load(std::memory_order_acquire);
+    return static_cast<size_t>(writePos - readPos);
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::writeAvailable() const
+{
+    return m_buffer.size() - readAvailable();
+}
+
+template <typename T>
+uint64_t LockFreeRingBuffer<T>::readPosition() const
+{
+    return m_readPos.load(std::memory_order_acquire);
+}
+
+template <typename T>
+uint64_t LockFreeRingBuffer<T>::writePosition() const
+{
+    return m_writePos.load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::write(const T* data, size_t count)
+{
+    const size_t capacity = m_buffer.size();
+    if(capacity == 0) {
+        return 0;
+    }
+
+    const uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+    const uint64_t readPos  = m_readPos.load(std::memory_order_acquire);
+
+    count = std::min(count, capacity - static_cast<size_t>(writePos - readPos));
+    if(count == 0) {
+        return 0;
+    }
+
+    const auto index   = static_cast<size_t>(writePos % capacity);
+    const size_t first = std::min(count, capacity - index);
+
+    std::memcpy(m_buffer.data() + index, data, first * sizeof(T));
+    if(first < count) {
+        std::memcpy(m_buffer.data(), data + first, (count - first) * sizeof(T));
+    }
+
+    m_writePos.store(writePos + count, std::memory_order_release);
+
+    return count;
+}
+
+template <typename T>
+bool LockFreeRingBuffer<T>::waitForSpace(size_t count)
+{
+    count = std::min(count, m_buffer.size());
+
+    // Load the signal before checking to avoid missing a wakeup between the check and the wait
+    const uint32_t signal = m_readSignal.load(std::memory_order_acquire);
+    if(writeAvailable() >= count) {
+        return true;
+    }
+
+    m_readSignal.wait(signal, std::memory_order_acquire);
+
+    return writeAvailable() >= count;
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::interrupt()
+{
+    m_readSignal.fetch_add(1, std::memory_order_release);
+    m_readSignal.notify_all();
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::read(T* data, size_t count)
+{
+    count = peek(data, count);
+    advanceRead(count);
+    return count;
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::peek(T* data, size_t count) const
+{
+    count = std::min(count, readAvailable());
+    if(count == 0) {
+        return 0;
+    }
+
+    copyOut(data, m_readPos.load(std::memory_order_relaxed), count);
+
+    return count;
+}
+
+template <typename T>
+size_t LockFreeRingBuffer<T>::skip(size_t count)
+{
+    count = std::min(count, readAvailable());
+    advanceRead(count);
+    return count;
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::clear()
+{
+    m_readPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_release);
+    interrupt();
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::copyOut(T* data, uint64_t pos, size_t count) const
+{
+    const size_t capacity = m_buffer.size();
+    const auto index      = static_cast<size_t>(pos % capacity);
+    const size_t first    = std::min(count, capacity - index);
+
+    std::memcpy(data, m_buffer.data() + index, first * sizeof(T));
+    if(first < count) {
+        std::memcpy(data + first, m_buffer.data(), (count - first) * sizeof(T));
+    }
+}
+
+template <typename T>
+void LockFreeRingBuffer<T>::advanceRead(size_t count)
+{
+    if(count == 0) {
+        return;
+    }
+
+    m_readPos.fetch_add(count, std::memory_order_release);
+    interrupt();
+}
+} // namespace Fooyin
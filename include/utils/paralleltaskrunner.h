@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Fooyin {
+class Worker;
+
+/*!
+ * Processes a number of items on a dedicated thread pool, one worker per core, with idle workers taking the
+ * next item from a shared queue so a few long items don't hold up the rest.
+ * No more items are handed out once the owning Worker is stopped or closing.
+ */
+class FYUTILS_EXPORT ParallelTaskRunner
+{
+public:
+    struct Tasks
+    {
+        // Called on each worker before it takes any items; returning false leaves them to the other workers
+        std::function<bool(int worker)> start{};
+        // Processes the item at @p index
+        std::function<void(size_t index, int worker)> process{};
+        // Called on each started worker once there are no items left
+        std::function<void(int worker)> finish{};
+    };
+
+    explicit ParallelTaskRunner(const Worker* owner, int updateInterval = 250);
+
+    /** Returns the number of workers used to process @p count items. */
+    [[nodiscard]] static int workerCount(size_t count);
+
+    /*!
+     * Processes @p count items, blocking until all are done or the owner is stopped.
+     * @p update is called on the calling thread every update interval (in ms) while waiting.
+     */
+    void run(size_t count, const Tasks& tasks, const std::function<void()>& update = {}) const;
+
+private:
+    const Worker* m_owner;
+    int m_updateInterval;
+};
+
+/*!
+ * Collects results from the workers of a ParallelTaskRunner, to be taken in batches on the calling thread.
+ */
+template <typename T>
+class ParallelResults
+{
+public:
+    void add(T result)
+    {
+        const std::scoped_lock lock{m_guard};
+        m_results.push_back(std::move(result));
+    }
+
+    void add(const std::vector<T>& results)
+    {
+        const std::scoped_lock lock{m_guard};
+        m_results.insert(m_results.end(), results.cbegin(), results.cend());
+    }
+
+    /** Returns the results added since the last call. */
+    [[nodiscard]] std::vector<T> take()
+    {
+        std::vector<T> results;
+        const std::scoped_lock lock{m_guard};
+        results.swap(m_results);
+        return results;
+    }
+
+private:
+    std::mutex m_guard;
+    std::vector<T> m_results;
+};
+} // namespace Fooyin
@@ -28,6 +28,7 @@
 #include "plugins/pluginmanager.h"
 #include "translations.h"
 
+#include <core/engine/dspplugin.h>
 #include <core/engine/outputplugin.h>
 #include <core/player/playercontroller.h>
 #include <core/playlist/playlisthandler.h>
@@ -62,7 +63,7 @@ struct Application::Private
         , translations{settingsManager}
         , database{new Database(parent)}
         , playerController{new PlayerController(settingsManager, parent)}
-        , engine{playerController, settingsManager}
+        , engine{playerController, settingsManager, database->connectionPool()}
         , libraryManager{new LibraryManager(database->connectionPool(), settingsManager, parent)}
         , library{new UnifiedMusicLibrary(libraryManager, database->connectionPool(), settingsManager, parent)}
         , playlistHandler{new PlaylistHandler(database->connectionPool(), playerController, settingsManager, parent)}
@@ -99,6 +100,11 @@ struct Application::Private
             const AudioOutputBuilder builder = plugin->registerOutput();
             engine.addOutput(builder);
         });
+
+        pluginManager.initialisePlugins<DspPlugin>([this](DspPlugin* plugin) {
+            const DspNodeBuilder builder = plugin->registerDsp();
+            engine.addDsp(builder);
+        });
     }
 
     void savePlaybackState() const
@@ -155,6 +161,8 @@ Application::Application(QObject* parent)
                      [this](const TrackList& tracks) { p->playlistHandler->tracksUpdated(tracks); });
     QObject::connect(&p->engine, &EngineHandler::trackAboutToFinish, p->playlistHandler,
                      &PlaylistHandler::trackAboutToFinish);
+    QObject::connect(p->playlistHandler, &PlaylistHandler::upcomingTrack, &p->engine,
+                     &EngineHandler::prepareNextTrack);
 
     p->library->loadAllTracks();
     p->engine.setup();
@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "seektabledatabase.h"
+
+#include <core/track.h>
+#include <utils/database/dbquery.h>
+
+namespace Fooyin {
+SeekTable SeekTableDatabase::seekTable(const Track& track) const
+{
+    const auto statement = QStringLiteral("SELECT FileSize, ModifiedDate, Data FROM SeekTables WHERE FilePath = :path");
+
+    DbQuery query{db(), statement};
+
+    query.bindValue(QStringLiteral(":path"), track.filepath());
+
+    if(!query.exec() || !query.next()) {
+        return SeekTable{};
+    }
+
+    if(query.value(0).toULongLong() != track.fileSize() || query.value(1).toULongLong() != track.modifiedTime()) {
+        return SeekTable{};
+    }
+
+    const QByteArray data = query.value(2).toByteArray();
+
+    return SeekTable::deserialise(reinterpret_cast<const std::byte*>(data.constData()),
+                                  static_cast<size_t>(data.size()));
+}
+
+bool SeekTableDatabase::storeSeekTable(const Track& track, const SeekTable& table) const
+{
+    const auto statement = QStringLiteral("INSERT OR REPLACE INTO SeekTables (FilePath, FileSize, ModifiedDate, Data) "
+                                          "VALUES (:path, :fileSize, :modifiedDate, :data)");
+
+    DbQuery query{db(), statement};
+
+    const auto data = table.serialise();
+
+    query.bindValue(QStringLiteral(":path"), track.filepath());
+    query.bindValue(QStringLiteral(":fileSize"), QVariant::fromValue(track.fileSize()));
+    query.bindValue(QStringLiteral(":modifiedDate"), QVariant::fromValue(track.modifiedTime()));
+    query.bindValue(QStringLiteral(":data"),
+                    QByteArray{reinterpret_cast<const char*>(data.data()), static_cast<qsizetype>(data.size())});
+
+    return query.exec();
+}
+} // namespace Fooyin
@@ -0,0 +1,39 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "engine/seektable.h"
+
+#include <core/trackfwd.h>
+#include <utils/database/dbmodule.h>
+
+namespace Fooyin {
+/*!
+ * Stores the seek tables built while playing tracks.
+ * Tables are discarded once the file's size or modified time no longer match,
+ * and deleted along with unused tracks in @ref TrackDatabase::cleanupTracks.
+ */
+class SeekTableDatabase : public DbModule
+{
+public:
+    [[nodiscard]] SeekTable seekTable(const Track& track) const;
+    bool storeSeekTable(const Track& track, const SeekTable& table) const;
+};
+} // namespace Fooyin
@@ -399,6 +399,7 @@ void TrackDatabase::cleanupTracks()
     removeUnmanagedTracks();
     markUnusedStatsForDelete();
     deleteExpiredStats();
+    deleteUnusedSeekTables();
 }
 
 void TrackDatabase::dropViews(const QSqlDatabase& db)
@@ -660,4 +661,16 @@ void TrackDatabase::deleteExpiredStats() const
 
     query.exec();
 }
+
+void TrackDatabase::deleteUnusedSeekTables() const
+{
+    // Tables for files which have since changed can never be used again either
+    const auto statement = QStringLiteral(
+        "DELETE FROM SeekTables WHERE NOT EXISTS (SELECT 1 FROM Tracks WHERE Tracks.FilePath = SeekTables.FilePath "
+        "AND Tracks.FileSize = SeekTables.FileSize AND Tracks.ModifiedDate = SeekTables.ModifiedDate);");
+
+    DbQuery query{db(), statement};
+
+    query.exec();
+}
 } // namespace Fooyin
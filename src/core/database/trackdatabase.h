@@ -54,5 +54,6 @@ private:
     void removeUnmanagedTracks() const;
     void markUnusedStatsForDelete() const;
     void deleteExpiredStats() const;
+    void deleteUnusedSeekTables() const;
 };
 } // namespace Fooyin
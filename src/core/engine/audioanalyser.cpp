@@ -0,0 +1,256 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/engine/audioanalyser.h>
+
+#include "audioanalysisbus.h"
+#include "fft.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <numbers>
+
+using namespace std::chrono_literals;
+
+// Results are dropped once they're this far behind, so visualisations settle when playback stops
+constexpr auto StaleTime = 250ms;
+// Results not yet heard are capped in case play times jump ahead, such as after the device stalls
+constexpr size_t MaxPendingResults = 256;
+constexpr double DefaultRefreshRate = 60.0;
+
+namespace Fooyin {
+struct AudioAnalyser::Private
+{
+    AudioAnalyser* self;
+
+    std::shared_ptr<AudioAnalysisBus> bus;
+    std::vector<QObject*> subscribers;
+    QTimer* refreshTimer;
+
+    uint64_t cursor{0};
+    // Read into here, rather than on the stack, as blocks are large
+    std::unique_ptr<AudioAnalysisBus::Block> block;
+
+    Audio::Fft fft{FftSize};
+    std::vector<float> window;
+    float windowScale{1.0F};
+    // The most recent FftSize samples, mixed down to mono
+    std::vector<float> history;
+    std::vector<float> windowed;
+    int sampleRate{0};
+    int channels{0};
+
+    std::deque<AnalysisResult> pending;
+    std::vector<AnalysisResult> released;
+    AnalysisResult current;
+
+    Private(AudioAnalyser* self_, std::shared_ptr<AudioAnalysisBus> bus_)
+        : self{self_}
+        , bus{std::move(bus_)}
+        , refreshTimer{new QTimer(self)}
+        , block{std::make_unique<AudioAnalysisBus::Block>()}
+        , window(FftSize)
+        , history(FftSize)
+        , windowed(FftSize)
+    {
+        // Hann window, scaled so a full scale sine wave peaks at 1.0
+        double sum{0.0};
+        for(int i{0}; i < FftSize; ++i) {
+            window.at(i) = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * std::numbers::pi * i / (FftSize - 1))));
+            sum += window.at(i);
+        }
+        windowScale = static_cast<float>(2.0 / sum);
+
+        refreshTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(refreshTimer, &QTimer::timeout, self, [this]() { refresh(); });
+        setRefreshRate(DefaultRefreshRate);
+    }
+
+    void setRefreshRate(double rate) const
+    {
+        refreshTimer->setInterval(static_cast<int>(std::max(1000.0 / std::max(rate, 1.0), 1.0)));
+    }
+
+    void start()
+    {
+        resetAnalysis();
+        cursor = bus->nextSequence();
+        bus->setEnabled(true);
+        refreshTimer->start();
+    }
+
+    void stop()
+    {
+        bus->setEnabled(false);
+        refreshTimer->stop();
+        resetAnalysis();
+        emit self->updated();
+    }
+
+    void resetAnalysis()
+    {
+        std::ranges::fill(history, 0.0F);
+        pending.clear();
+        released.clear();
+        current = {};
+    }
+
+    void refresh()
+    {
+        while(bus->read(cursor, *block)) {
+            analyseBlock(*block);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        bool changed{false};
+
+        released.clear();
+        while(!pending.empty() && pending.front().playTime <= now) {
+            released.push_back(std::move(pending.front()));
+            pending.pop_front();
+        }
+
+        if(!released.empty()) {
+            current = released.back();
+            changed = true;
+        }
+
+        if(!changed && current.isValid() && now - current.playTime > StaleTime) {
+            current = {};
+            changed = true;
+        }
+
+        if(changed) {
+            emit self->updated();
+        }
+    }
+
+    void analyseBlock(const AudioAnalysisBus::Block& audio)
+    {
+        if(audio.discontinuity || audio.sampleRate != sampleRate || audio.channels != channels) {
+            // Anything not yet heard has been discarded by the renderer
+            std::ranges::fill(history, 0.0F);
+            pending.clear();
+            sampleRate = audio.sampleRate;
+            channels   = audio.channels;
+        }
+
+        AnalysisResult result;
+        result.playTime   = audio.playTime;
+        result.sampleRate = audio.sampleRate;
+        result.peak.assign(static_cast<size_t>(channels), 0.0F);
+        result.rms.assign(static_cast<size_t>(channels), 0.0F);
+
+        // Shift the history along to make room for the new block, mixed down to mono
+        const int frames = std::min(audio.frames, FftSize);
+        std::shift_left(history.begin(), history.end(), frames);
+        float* mixed = history.data() + (FftSize - frames);
+
+        for(int frame{0}; frame < frames; ++frame) {
+            const float* samples = audio.samples.data() + static_cast<ptrdiff_t>(frame * channels);
+            float sum{0.0F};
+            for(int ch{0}; ch < channels; ++ch) {
+                const float sample = samples[ch];
+                result.peak[ch]    = std::max(result.peak[ch], std::abs(sample));
+                result.rms[ch] += sample * sample;
+                sum += sample;
+            }
+            mixed[frame] = sum / static_cast<float>(channels);
+        }
+
+        for(float& rms : result.rms) {
+            rms = std::sqrt(rms / static_cast<float>(std::max(frames, 1)));
+        }
+
+        for(int i{0}; i < FftSize; ++i) {
+            windowed[i] = history[i] * window[i];
+        }
+
+        result.spectrum.resize(fft.binCount());
+        fft.magnitudes(windowed.data(), result.spectrum.data());
+        for(float& magnitude : result.spectrum) {
+            magnitude *= windowScale;
+        }
+
+        pending.push_back(std::move(result));
+        if(pending.size() > MaxPendingResults) {
+            pending.pop_front();
+        }
+    }
+};
+
+AudioAnalyser::AudioAnalyser(std::shared_ptr<AudioAnalysisBus> bus, QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this, std::move(bus))}
+{ }
+
+AudioAnalyser::~AudioAnalyser()
+{
+    p->bus->setEnabled(false);
+}
+
+void AudioAnalyser::subscribe(QObject* subscriber)
+{
+    if(!subscriber || std::ranges::find(p->subscribers, subscriber) != p->subscribers.cend()) {
+        return;
+    }
+
+    p->subscribers.push_back(subscriber);
+    QObject::connect(subscriber, &QObject::destroyed, this, [this, subscriber]() { unsubscribe(subscriber); });
+
+    if(p->subscribers.size() == 1) {
+        p->start();
+    }
+}
+
+void AudioAnalyser::unsubscribe(QObject* subscriber)
+{
+    const auto it = std::ranges::find(p->subscribers, subscriber);
+    if(it == p->subscribers.cend()) {
+        return;
+    }
+
+    p->subscribers.erase(it);
+    QObject::disconnect(subscriber, nullptr, this, nullptr);
+
+    if(p->subscribers.empty()) {
+        p->stop();
+    }
+}
+
+void AudioAnalyser::setRefreshRate(double rate)
+{
+    p->setRefreshRate(rate);
+}
+
+const AnalysisResult& AudioAnalyser::current() const
+{
+    return p->current;
+}
+
+const std::vector<AnalysisResult>& AudioAnalyser::released() const
+{
+    return p->released;
+}
+} // namespace Fooyin
+
+#include "core/engine/moc_audioanalyser.cpp"
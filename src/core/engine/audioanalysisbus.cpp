@@ -0,0 +1,129 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audioanalysisbus.h"
+
+#include "audiokernels.h"
+
+#include <algorithm>
+
+namespace Fooyin {
+AudioAnalysisBus::AudioAnalysisBus()
+    : m_enabled{false}
+    , m_discontinuity{false}
+    , m_lastSequence{0}
+    , m_slots(BlockCount)
+{ }
+
+bool AudioAnalysisBus::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+void AudioAnalysisBus::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void AudioAnalysisBus::publish(const AudioFormat& format, const std::byte* data, int frames,
+                               Clock::time_point playTime)
+{
+    const int channels = format.channelCount();
+    if(channels <= 0 || channels > MaxChannels || frames <= 0) {
+        return;
+    }
+
+    const auto convert = Audio::convertKernel(format.sampleFormat(), SampleFormat::Float);
+    if(!convert) {
+        return;
+    }
+
+    int offset{0};
+    while(offset < frames) {
+        const int count       = std::min(BlockFrames, frames - offset);
+        const uint64_t number = m_lastSequence.load(std::memory_order_relaxed) + 1;
+        Slot& slot            = m_slots[number % BlockCount];
+
+        // Readers copying the slot now will see the sequence change and discard what they read
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const std::chrono::duration<double> offsetTime{static_cast<double>(offset) / format.sampleRate()};
+
+        Block& block        = slot.block;
+        block.sequence      = number;
+        block.playTime      = playTime + std::chrono::duration_cast<Clock::duration>(offsetTime);
+        block.sampleRate    = format.sampleRate();
+        block.channels      = channels;
+        block.frames        = count;
+        block.discontinuity = m_discontinuity.exchange(false, std::memory_order_relaxed);
+        convert(data + format.bytesForFrames(offset), reinterpret_cast<std::byte*>(block.samples.data()),
+                count * channels);
+
+        slot.sequence.store(number, std::memory_order_release);
+        m_lastSequence.store(number, std::memory_order_release);
+
+        offset += count;
+    }
+}
+
+void AudioAnalysisBus::markDiscontinuity()
+{
+    m_discontinuity.store(true, std::memory_order_relaxed);
+}
+
+uint64_t AudioAnalysisBus::nextSequence() const
+{
+    return m_lastSequence.load(std::memory_order_acquire) + 1;
+}
+
+bool AudioAnalysisBus::read(uint64_t& cursor, Block& block) const
+{
+    while(true) {
+        const uint64_t last = m_lastSequence.load(std::memory_order_acquire);
+        if(cursor > last) {
+            return false;
+        }
+
+        // Lapped by the producer; jump to the oldest block still held
+        if(last - cursor >= BlockCount) {
+            cursor = last - BlockCount + 1;
+        }
+
+        const Slot& slot = m_slots[cursor % BlockCount];
+        if(slot.sequence.load(std::memory_order_acquire) != cursor) {
+            // Being overwritten as we speak
+            ++cursor;
+            continue;
+        }
+
+        block = slot.block;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.sequence.load(std::memory_order_relaxed) != cursor) {
+            // Overwritten while copying, so the copy may be torn
+            ++cursor;
+            continue;
+        }
+
+        ++cursor;
+        return true;
+    }
+}
+} // namespace Fooyin
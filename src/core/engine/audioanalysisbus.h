@@ -0,0 +1,102 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audioformat.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Broadcasts rendered audio to visualisations without the render thread ever blocking.
+ * Audio is converted to float and published in fixed-size blocks into a ring which the renderer overwrites
+ * as it goes; each reader keeps its own cursor, and skips ahead if it falls so far behind it's lapped.
+ *
+ * The renderer is the only producer. Publishing never allocates, so is safe from a real-time callback.
+ */
+class FYCORE_EXPORT AudioAnalysisBus
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int BlockFrames = 1024;
+    // Audio with more channels than this isn't published
+    static constexpr int MaxChannels = 8;
+    static constexpr int BlockCount  = 32;
+
+    struct Block
+    {
+        uint64_t sequence{0};
+        // When the first frame of the block is expected to be heard
+        Clock::time_point playTime;
+        int sampleRate{0};
+        int channels{0};
+        int frames{0};
+        // Set on the first block after playback was stopped or seeked, so readers can drop anything older
+        bool discontinuity{false};
+        // Interleaved, with only the first frames * channels samples in use
+        std::array<float, static_cast<size_t>(BlockFrames) * MaxChannels> samples{};
+    };
+
+    AudioAnalysisBus();
+
+    /** Returns @c true if anything is reading from the bus; the renderer doesn't publish otherwise. */
+    [[nodiscard]] bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    // Producer
+    /*!
+     * Publishes @p frames frames of @p data, split into as many blocks as needed.
+     * @p playTime is when the first frame is expected to be heard.
+     */
+    void publish(const AudioFormat& format, const std::byte* data, int frames, Clock::time_point playTime);
+    /** Marks the next block published as a discontinuity. Called whenever buffered audio is discarded. */
+    void markDiscontinuity();
+
+    // Consumers
+    /** Returns the sequence the next block published will have, for a new reader to start from. */
+    [[nodiscard]] uint64_t nextSequence() const;
+    /*!
+     * Copies the block with sequence @p cursor into @p block, and advances the cursor past it.
+     * If that block has already been overwritten, the oldest one still available is read instead.
+     * @returns @c false if there's nothing new to read.
+     */
+    bool read(uint64_t& cursor, Block& block) const;
+
+private:
+    struct Slot
+    {
+        // Sequence of the block held, or 0 while it's being written
+        std::atomic<uint64_t> sequence{0};
+        Block block;
+    };
+
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_discontinuity;
+    std::atomic<uint64_t> m_lastSequence;
+    std::vector<Slot> m_slots;
+};
+} // namespace Fooyin
@@ -19,65 +19,202 @@
 
 #include <core/engine/audiobuffer.h>
 
-#include <QDebug>
+#include "audiobufferpool.h"
+#include "audiogain.h"
 
-#include <ranges>
-#include <utility>
+#include <cstring>
 
 namespace Fooyin {
 struct AudioBuffer::Private : QSharedData
 {
-    std::vector<std::byte> buffer;
+    std::byte* storage{nullptr};
+    size_t capacity{0};
+    size_t offset{0};
+    size_t size{0};
     AudioFormat format;
     uint64_t startTime;
 
-    Private(std::span<const std::byte> data_, AudioFormat format_, uint64_t startTime_)
+    // Externally owned, read-only data
+    const std::byte* external{nullptr};
+    ReleaseFunc releaseExternal{nullptr};
+    void* opaque{nullptr};
+
+    Private(const std::byte* data_, size_t size_, AudioFormat format_, uint64_t startTime_)
         : format{format_}
         , startTime{startTime_}
     {
-        buffer.assign(data_.begin(), data_.end());
+        assign(data_, size_);
     }
 
-    Private(const uint8_t* data_, size_t size, AudioFormat format_, uint64_t startTime_)
-        : format{format_}
+    Private(const std::byte* data_, size_t size_, AudioFormat format_, uint64_t startTime_, ReleaseFunc release_,
+            void* opaque_)
+        : size{size_}
+        , format{format_}
         , startTime{startTime_}
+        , external{data_}
+        , releaseExternal{release_}
+        , opaque{opaque_}
+    { }
+
+    Private(const Private& other)
+        : QSharedData{other}
+        , format{other.format}
+        , startTime{other.startTime}
     {
-        buffer.resize(size);
-        std::memmove(buffer.data(), data_, size);
+        assign(other.constData(), other.size);
     }
 
-    void fillSilence()
+    ~Private()
     {
-        const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
-        std::ranges::fill(buffer, unsignedFormat ? std::byte{0x80} : std::byte{0});
+        dropExternal();
+        AudioBufferPool::instance().release(storage, capacity);
     }
 
-    void fillRemainingWithSilence()
+    Private& operator=(const Private&) = delete;
+
+    static void* operator new(size_t size)
+    {
+        return AudioBufferPool::instance().acquire(size);
+    }
+
+    static void operator delete(void* ptr, size_t size)
+    {
+        AudioBufferPool::instance().release(static_cast<std::byte*>(ptr), size);
+    }
+
+    [[nodiscard]] const std::byte* constData() const
+    {
+        if(external) {
+            return external + offset;
+        }
+        return storage ? storage + offset : nullptr;
+    }
+
+    std::byte* data()
+    {
+        makeOwned();
+        return storage ? storage + offset : nullptr;
+    }
+
+    void dropExternal()
     {
+        if(external && releaseExternal) {
+            releaseExternal(opaque);
+        }
+        external        = nullptr;
+        releaseExternal = nullptr;
+        opaque          = nullptr;
+    }
+
+    void makeOwned()
+    {
+        if(!external) {
+            return;
+        }
+
+        // Copy-on-write: the wrapped data is never modified
+        const std::byte* source = external + offset;
+
+        offset = 0;
+        if(size > 0) {
+            capacity = AudioBufferPool::capacityFor(size);
+            storage  = AudioBufferPool::instance().acquire(capacity);
+            std::memcpy(storage, source, size);
+        }
+
+        dropExternal();
+    }
+
+    void assign(const std::byte* data_, size_t size_)
+    {
+        if(size_ > 0) {
+            reserve(size_);
+            std::memcpy(data(), data_, size_);
+        }
+        size = size_;
+    }
+
+    void reserve(size_t size_)
+    {
+        makeOwned();
+
+        if(offset + size_ <= capacity) {
+            return;
+        }
+
+        if(size_ <= capacity) {
+            // Reclaim the space freed by erase
+            std::memmove(storage, storage + offset, size);
+            offset = 0;
+            return;
+        }
+
+        auto& pool = AudioBufferPool::instance();
+
+        const size_t newCapacity = AudioBufferPool::capacityFor(size_);
+        std::byte* newStorage    = pool.acquire(newCapacity);
+
+        if(size > 0) {
+            std::memcpy(newStorage, storage + offset, size);
+        }
+        pool.release(storage, capacity);
+
+        storage  = newStorage;
+        capacity = newCapacity;
+        offset   = 0;
+    }
+
+    void resize(size_t size_)
+    {
+        reserve(size_);
+
+        if(size_ > size) {
+            std::memset(data() + size, 0, size_ - size);
+        }
+        size = size_;
+    }
+
+    void erase(size_t size_)
+    {
+        size_ = std::min(size_, size);
+
+        offset += size_;
+        size -= size_;
+
+        if(size == 0) {
+            offset = 0;
+        }
+    }
+
+    void fillSilence()
+    {
+        makeOwned();
+
+        if(!storage) {
+            return;
+        }
+
         const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
-        std::fill(buffer.begin() + buffer.size(), buffer.begin() + buffer.capacity(),
-                  unsignedFormat ? std::byte{0x80} : std::byte{0});
+        std::memset(data(), unsignedFormat ? 0x80 : 0, size);
     }
 
-    template <typename T>
-    void adjustVolume(const double volume)
+    void fillRemainingWithSilence()
     {
-        const auto bytes = static_cast<int>(buffer.size());
-        const int bps    = format.bytesPerSample();
-
-        for(int i{0}; i < bytes; i += bps) {
-            T sample;
-            std::memcpy(&sample, buffer.data() + i, bps);
-            sample *= volume;
-            std::memcpy(buffer.data() + i, &sample, bps);
+        makeOwned();
+
+        if(!storage) {
+            return;
         }
+
+        const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
+        std::memset(data() + size, unsignedFormat ? 0x80 : 0, capacity - offset - size);
     }
 };
 
 AudioBuffer::AudioBuffer() = default;
 
 AudioBuffer::AudioBuffer(std::span<const std::byte> data, AudioFormat format, uint64_t startTime)
-    : p{new Private(data, format, startTime)}
+    : p{new Private(data.data(), data.size(), format, startTime)}
 { }
 
 AudioBuffer::AudioBuffer(AudioFormat format, uint64_t startTime)
@@ -85,7 +222,12 @@ AudioBuffer::AudioBuffer(AudioFormat format, uint64_t startTime)
 { }
 
 AudioBuffer::AudioBuffer(const uint8_t* data, size_t size, AudioFormat format, uint64_t startTime)
-    : p{new Private(data, size, format, startTime)}
+    : p{new Private(reinterpret_cast<const std::byte*>(data), size, format, startTime)}
+{ }
+
+AudioBuffer::AudioBuffer(const std::byte* data, size_t size, AudioFormat format, uint64_t startTime,
+                         ReleaseFunc release, void* opaque)
+    : p{new Private(data, size, format, startTime, release, opaque)}
 { }
 
 AudioBuffer::~AudioBuffer() = default;
@@ -97,14 +239,14 @@ AudioBuffer::AudioBuffer(AudioBuffer&& other) noexcept        = default;
 void AudioBuffer::reserve(size_t size)
 {
     if(isValid()) {
-        p->buffer.reserve(size);
+        p->reserve(size);
     }
 }
 
 void AudioBuffer::resize(size_t size)
 {
     if(isValid()) {
-        p->buffer.resize(size);
+        p->resize(size);
     }
 }
 
@@ -118,23 +260,25 @@ void AudioBuffer::append(std::span<const std::byte> data)
 void AudioBuffer::append(const std::byte* data, size_t size)
 {
     if(isValid()) {
-        const size_t index = p->buffer.size();
-        p->buffer.resize(index + size);
-        std::memcpy(p->buffer.data() + index, data, size);
+        const size_t index = p->size;
+        p->reserve(index + size);
+        std::memcpy(p->data() + index, data, size);
+        p->size = index + size;
     }
 }
 
 void AudioBuffer::erase(size_t size)
 {
     if(isValid()) {
-        p->buffer.erase(p->buffer.begin(), p->buffer.begin() + size);
+        p->erase(size);
     }
 }
 
 void AudioBuffer::clear()
 {
     if(isValid()) {
-        p->buffer.clear();
+        p->size   = 0;
+        p->offset = 0;
     }
 }
 
@@ -177,7 +321,7 @@ int AudioBuffer::sampleCount() const
 
 int AudioBuffer::byteCount() const
 {
-    return isValid() ? static_cast<int>(p->buffer.size()) : 0;
+    return isValid() ? static_cast<int>(p->size) : 0;
 }
 
 uint64_t AudioBuffer::startTime() const
@@ -193,7 +337,7 @@ uint64_t AudioBuffer::duration() const
 std::span<const std::byte> AudioBuffer::constData() const
 {
     if(isValid()) {
-        return p->buffer;
+        return {p->constData(), p->size};
     }
     return {};
 }
@@ -201,7 +345,7 @@ std::span<const std::byte> AudioBuffer::constData() const
 const std::byte* AudioBuffer::data() const
 {
     if(isValid()) {
-        return p->buffer.data();
+        return p->constData();
     }
     return {};
 }
@@ -209,7 +353,7 @@ const std::byte* AudioBuffer::data() const
 std::byte* AudioBuffer::data()
 {
     if(isValid()) {
-        return p->buffer.data();
+        return p->data();
     }
     return {};
 }
@@ -234,28 +378,11 @@ void AudioBuffer::adjustVolumeOfSamples(double volume)
         return;
     }
 
-    if(volume == 0.0) {
-        fillSilence();
-        return;
-    }
+    Audio::applyGain(p->format, p->data(), sampleCount(), volume);
+}
 
-    switch(format().sampleFormat()) {
-        case(SampleFormat::U8):
-            p->adjustVolume<uint8_t>(volume);
-            break;
-        case(SampleFormat::S16):
-            p->adjustVolume<int16_t>(volume);
-            break;
-        case(SampleFormat::S24):
-        case(SampleFormat::S32):
-            p->adjustVolume<int32_t>(volume);
-            break;
-        case(SampleFormat::Float):
-            p->adjustVolume<float>(volume);
-            break;
-        case(SampleFormat::Unknown):
-        default:
-            qDebug() << "Unable to adjust volume of unsupported format";
-    }
+AudioBufferPoolStats AudioBuffer::poolStats()
+{
+    return AudioBufferPool::instance().stats();
 }
 } // namespace Fooyin
@@ -0,0 +1,120 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiobufferpool.h"
+
+#include <bit>
+
+// Smallest size class (64 bytes)
+constexpr auto MinClassShift = 6;
+// Maximum number of free blocks kept per size class
+constexpr auto MaxFreeBlocks = 32;
+
+namespace Fooyin {
+AudioBufferPool::AudioBufferPool()
+    : m_hits{0}
+    , m_misses{0}
+    , m_cachedBytes{0}
+{
+    for(auto& sizeClass : m_classes) {
+        sizeClass.freeBlocks.reserve(MaxFreeBlocks);
+    }
+}
+
+AudioBufferPool::~AudioBufferPool()
+{
+    for(auto& sizeClass : m_classes) {
+        for(std::byte* block : sizeClass.freeBlocks) {
+            ::operator delete(block);
+        }
+    }
+}
+
+AudioBufferPool& AudioBufferPool::instance()
+{
+    static AudioBufferPool pool;
+    return pool;
+}
+
+size_t AudioBufferPool::capacityFor(size_t size)
+{
+    return std::bit_ceil(std::max(size, size_t{1} << MinClassShift));
+}
+
+std::byte* AudioBufferPool::acquire(size_t size)
+{
+    const size_t capacity = capacityFor(size);
+    const int index       = sizeClass(capacity);
+
+    if(index >= 0) {
+        auto& sizeClass = m_classes.at(index);
+
+        const std::scoped_lock lock{sizeClass.mutex};
+        if(!sizeClass.freeBlocks.empty()) {
+            std::byte* block = sizeClass.freeBlocks.back();
+            sizeClass.freeBlocks.pop_back();
+
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            m_cachedBytes.fetch_sub(capacity, std::memory_order_relaxed);
+
+            return block;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    return static_cast<std::byte*>(::operator new(capacity));
+}
+
+void AudioBufferPool::release(std::byte* block, size_t size)
+{
+    if(!block) {
+        return;
+    }
+
+    const size_t capacity = capacityFor(size);
+    const int index       = sizeClass(capacity);
+
+    if(index >= 0) {
+        auto& sizeClass = m_classes.at(index);
+
+        const std::scoped_lock lock{sizeClass.mutex};
+        if(sizeClass.freeBlocks.size() < MaxFreeBlocks) {
+            sizeClass.freeBlocks.push_back(block);
+            m_cachedBytes.fetch_add(capacity, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+AudioBufferPoolStats AudioBufferPool::stats() const
+{
+    return {.hits        = m_hits.load(std::memory_order_relaxed),
+            .misses      = m_misses.load(std::memory_order_relaxed),
+            .cachedBytes = m_cachedBytes.load(std::memory_order_relaxed)};
+}
+
+int AudioBufferPool::sizeClass(size_t size)
+{
+    const int index = std::bit_width(size) - 1 - MinClassShift;
+    return index < static_cast<int>(std::tuple_size_v<decltype(m_classes)>) ? index : -1;
+}
+} // namespace Fooyin
@@ -0,0 +1,73 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiobuffer.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A process-wide pool of raw storage blocks used by AudioBuffer.
+ * Requests are rounded up to a power-of-two size class, and released blocks are kept
+ * for reuse, so once playback reaches a steady state no further heap allocations are made.
+ * Safe to use from any thread.
+ */
+class AudioBufferPool
+{
+public:
+    static AudioBufferPool& instance();
+
+    /** Returns the capacity of the block which would be returned for a request of @p size bytes. */
+    static size_t capacityFor(size_t size);
+
+    /*!
+     * Returns a block of at least @p size bytes (see @fn capacityFor).
+     * The contents of the block are undefined.
+     */
+    std::byte* acquire(size_t size);
+    /** Returns a block previously acquired with a request of @p size bytes to the pool. */
+    void release(std::byte* block, size_t size);
+
+    [[nodiscard]] AudioBufferPoolStats stats() const;
+
+private:
+    AudioBufferPool();
+    ~AudioBufferPool();
+
+    static int sizeClass(size_t size);
+
+    struct SizeClass
+    {
+        std::mutex mutex;
+        std::vector<std::byte*> freeBlocks;
+    };
+
+    std::array<SizeClass, 17> m_classes;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_cachedBytes;
+};
+} // namespace Fooyin
@@ -19,6 +19,8 @@
 
 #include "audioclock.h"
 
+#include <algorithm>
+
 namespace Fooyin {
 AudioClock::AudioClock()
     : m_paused{true}
@@ -59,7 +61,8 @@ uint64_t AudioClock::positionFromTime(TimePoint tp, bool ignorePause) const
 {
     tp                  = m_paused && !ignorePause ? m_timePoint : tp;
     const TrackTime pos = m_position + toTrackTime(tp - m_timePoint);
-    return pos.count();
+    // Synced to a buffer which hasn't been heard yet
+    return static_cast<uint64_t>(std::max<TrackTime::rep>(pos.count(), 0));
 }
 
 AudioClock::TimePoint AudioClock::timeFromPosition(uint64_t position, bool ignorePause) const
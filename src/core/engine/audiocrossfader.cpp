@@ -0,0 +1,173 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiocrossfader.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// Number of frames mixed at once
+constexpr auto BlockFrames = 1024;
+
+namespace Fooyin {
+AudioCrossfader::AudioCrossfader()
+    : m_length{0}
+    , m_position{0}
+    , m_toFloat{nullptr}
+    , m_fromFloat{nullptr}
+    , m_mix{Audio::mixKernel()}
+{ }
+
+void AudioCrossfader::prepare(const AudioFormat& format)
+{
+    if(format == m_format) {
+        return;
+    }
+
+    m_format = format;
+    stop();
+
+    if(!format.isValid()) {
+        return;
+    }
+
+    const SampleFormat sampleFormat = format.sampleFormat();
+    m_toFloat   = Audio::convertKernel(sampleFormat, SampleFormat::Float);
+    m_fromFloat = Audio::convertKernel(SampleFormat::Float, sampleFormat);
+    if(!m_toFloat || !m_fromFloat) {
+        qDebug() << "Unable to crossfade unsupported format";
+        m_format = {};
+        return;
+    }
+
+    const auto samples = static_cast<size_t>(BlockFrames) * format.channelCount();
+    m_outgoingGains.assign(samples, 0.0F);
+    m_incomingGains.assign(samples, 0.0F);
+    m_outgoing.assign(samples, 0.0F);
+    m_incoming.assign(samples, 0.0F);
+}
+
+void AudioCrossfader::start(int frames)
+{
+    m_length   = m_format.isValid() ? std::max(0, frames) : 0;
+    m_position = 0;
+}
+
+void AudioCrossfader::stop()
+{
+    m_length   = 0;
+    m_position = 0;
+}
+
+bool AudioCrossfader::isActive() const
+{
+    return m_position < m_length;
+}
+
+int AudioCrossfader::remainingFrames() const
+{
+    return m_length - m_position;
+}
+
+void AudioCrossfader::mix(std::byte* outgoing, const std::byte* incoming, int frames)
+{
+    for(int frame{0}; frame < frames; frame += BlockFrames) {
+        const auto offset = m_format.bytesForFrames(frame);
+        mixBlock(outgoing + offset, outgoing + offset, incoming + offset, std::min(BlockFrames, frames - frame));
+    }
+}
+
+void AudioCrossfader::fadeIn(std::byte* incoming, int frames)
+{
+    for(int frame{0}; frame < frames; frame += BlockFrames) {
+        const auto offset = m_format.bytesForFrames(frame);
+        mixBlock(incoming + offset, nullptr, incoming + offset, std::min(BlockFrames, frames - frame));
+    }
+}
+
+void AudioCrossfader::fadeOut(std::byte* outgoing, int frames)
+{
+    for(int frame{0}; frame < frames; frame += BlockFrames) {
+        const auto offset = m_format.bytesForFrames(frame);
+        mixBlock(outgoing + offset, outgoing + offset, nullptr, std::min(BlockFrames, frames - frame));
+    }
+}
+
+void AudioCrossfader::fillGains(int frames)
+{
+    const int channels = m_format.channelCount();
+
+    for(int frame{0}; frame < frames; ++frame) {
+        // Equal-power: the gains trace a quarter circle, so the combined power stays constant
+        const double progress = static_cast<double>(m_position + frame) / m_length;
+        const double angle    = progress * std::numbers::pi / 2.0;
+        const auto outGain    = progress < 1.0 ? static_cast<float>(std::cos(angle)) : 0.0F;
+        const auto inGain     = progress < 1.0 ? static_cast<float>(std::sin(angle)) : 1.0F;
+
+        const auto index = static_cast<size_t>(frame) * channels;
+        std::fill_n(m_outgoingGains.begin() + static_cast<ptrdiff_t>(index), channels, outGain);
+        std::fill_n(m_incomingGains.begin() + static_cast<ptrdiff_t>(index), channels, inGain);
+    }
+}
+
+void AudioCrossfader::mixBlock(std::byte* output, const std::byte* outgoing, const std::byte* incoming, int frames)
+{
+    if(!m_format.isValid()) {
+        return;
+    }
+
+    const int sampleCount = frames * m_format.channelCount();
+
+    // A missing stream is treated as silence
+    const auto toFloat = [this, sampleCount](const std::byte* input, std::vector<float>& output) {
+        if(input) {
+            m_toFloat(input, reinterpret_cast<std::byte*>(output.data()), sampleCount);
+        }
+        else {
+            std::fill_n(output.begin(), sampleCount, 0.0F);
+        }
+    };
+
+    if(!isActive()) {
+        // Once the fade is over, only the incoming stream is heard
+        if(incoming && output != incoming) {
+            std::copy_n(incoming, m_format.bytesForFrames(frames), output);
+        }
+        else if(!incoming) {
+            toFloat(nullptr, m_incoming);
+            m_fromFloat(reinterpret_cast<const std::byte*>(m_incoming.data()), output, sampleCount);
+        }
+        return;
+    }
+
+    fillGains(frames);
+
+    toFloat(outgoing, m_outgoing);
+    toFloat(incoming, m_incoming);
+
+    m_mix(m_outgoing.data(), m_incoming.data(), m_outgoingGains.data(), m_incomingGains.data(), sampleCount);
+
+    m_fromFloat(reinterpret_cast<const std::byte*>(m_outgoing.data()), output, sampleCount);
+
+    m_position = std::min(m_length, m_position + frames);
+}
+} // namespace Fooyin
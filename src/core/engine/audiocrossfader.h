@@ -0,0 +1,79 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "audiokernels.h"
+
+#include <core/engine/audioformat.h>
+
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Mixes the end of one stream into the start of another using an equal-power fade.
+ * Samples are mixed as floats in blocks using scratch space allocated by @fn prepare, so
+ * mixing never allocates. Not thread-safe; owned by whichever thread processes the audio.
+ */
+class FYCORE_EXPORT AudioCrossfader
+{
+public:
+    AudioCrossfader();
+
+    /** Allocates scratch space for mixing buffers in @p format. */
+    void prepare(const AudioFormat& format);
+
+    /** Starts a fade lasting @p frames frames, abandoning any fade in progress. */
+    void start(int frames);
+    void stop();
+
+    [[nodiscard]] bool isActive() const;
+    /** Returns the number of frames until the outgoing stream is silent. */
+    [[nodiscard]] int remainingFrames() const;
+
+    /*!
+     * Fades out @p frames frames of @p outgoing while fading in @p incoming, writing the result to @p outgoing.
+     * Both must be in the prepared format. Frames past the end of the fade are taken from @p incoming alone.
+     */
+    void mix(std::byte* outgoing, const std::byte* incoming, int frames);
+    /** Carries on fading in @p frames frames of @p incoming in place, after the outgoing stream has ended early. */
+    void fadeIn(std::byte* incoming, int frames);
+    /** Carries on fading out @p frames frames of @p outgoing in place, after the incoming stream has ended early. */
+    void fadeOut(std::byte* outgoing, int frames);
+
+private:
+    void fillGains(int frames);
+    void mixBlock(std::byte* output, const std::byte* outgoing, const std::byte* incoming, int frames);
+
+    AudioFormat m_format;
+    int m_length;
+    int m_position;
+
+    std::vector<float> m_outgoingGains;
+    std::vector<float> m_incomingGains;
+    std::vector<float> m_outgoing;
+    std::vector<float> m_incoming;
+
+    Audio::ConvertKernel m_toFloat;
+    Audio::ConvertKernel m_fromFloat;
+    Audio::MixKernel m_mix;
+};
+} // namespace Fooyin
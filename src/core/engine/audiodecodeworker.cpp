@@ -0,0 +1,479 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiodecodeworker.h"
+
+#include "audioringbuffer.h"
+#include "dspchain.h"
+#include "enginemetrics.h"
+
+#include <core/engine/audiodecoder.h>
+
+#include <QDebug>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+namespace Fooyin {
+AudioDecodeWorker::AudioDecodeWorker(AudioDecoder* decoder, AudioRingBuffer* buffer, DspChain* dsp,
+                                     EngineMetrics* metrics, QObject* parent)
+    : Worker{parent}
+    , m_decoder{decoder}
+    , m_buffer{buffer}
+    , m_dsp{dsp}
+    , m_metrics{metrics}
+    , m_pendingOffset{0}
+    , m_markerWritten{false}
+    , m_trackStart{false}
+    , m_decoderFinished{false}
+    , m_finished{false}
+    , m_prerollIndex{0}
+    , m_nextDecoder{nullptr}
+    , m_nextStarted{false}
+    , m_fadingIn{false}
+    , m_incomingDecoder{nullptr}
+    , m_incomingPrerollIndex{0}
+    , m_incomingOffset{0}
+    , m_incomingFinished{false}
+{ }
+
+void AudioDecodeWorker::startDecoding()
+{
+    if(state() == Running) {
+        return;
+    }
+
+    setState(Running);
+    QMetaObject::invokeMethod(this, &AudioDecodeWorker::decode);
+}
+
+void AudioDecodeWorker::stopDecoding()
+{
+    setState(Idle);
+
+    // The decode loop may be about to block on the ring buffer, so keep waking it until it has exited
+    while(!m_decodeGuard.try_lock_for(1ms)) {
+        m_buffer->interrupt();
+    }
+    m_decodeGuard.unlock();
+}
+
+void AudioDecodeWorker::reset()
+{
+    const std::scoped_lock lock{m_decodeGuard};
+
+    m_pending         = {};
+    m_pendingOffset   = 0;
+    m_markerWritten   = false;
+    m_trackStart      = false;
+    m_decoderFinished = false;
+    m_finished        = false;
+    m_preroll.clear();
+    m_prerollIndex = 0;
+
+    m_resampler.reset();
+    m_dsp->reset();
+
+    m_crossfader.stop();
+    clearIncoming();
+
+    // A crossfade in progress is abandoned; the engine goes back to the current track
+    const std::scoped_lock nextLock{m_nextGuard};
+    if(std::exchange(m_nextStarted, false)) {
+        m_nextDecoder = nullptr;
+        m_nextPreroll.clear();
+    }
+}
+
+void AudioDecodeWorker::setOutputFormat(const AudioFormat& format)
+{
+    const std::scoped_lock lock{m_decodeGuard};
+
+    m_outputFormat = format;
+    m_crossfader.prepare(format);
+
+    // Set up for the current decoder here, so the decode thread only needs to when the format changes mid-stream
+    const AudioFormat inputFormat = m_decoder.load()->format();
+    if(inputFormat != format && inputFormat.isValid()) {
+        if(inputFormat != m_resampler.inputFormat() || format != m_resampler.outputFormat()) {
+            m_resampler.init(inputFormat, format);
+        }
+    }
+}
+
+AudioDecoder* AudioDecodeWorker::decoder() const
+{
+    return m_decoder.load();
+}
+
+void AudioDecodeWorker::setDecoder(AudioDecoder* decoder, std::vector<AudioBuffer> preroll)
+{
+    const std::scoped_lock lock{m_decodeGuard};
+
+    m_decoder      = decoder;
+    m_preroll      = std::move(preroll);
+    m_prerollIndex = 0;
+}
+
+void AudioDecodeWorker::setNextDecoder(AudioDecoder* decoder, std::vector<AudioBuffer> preroll, Crossfade crossfade)
+{
+    const std::scoped_lock lock{m_nextGuard};
+
+    m_nextDecoder   = decoder;
+    m_nextPreroll   = std::move(preroll);
+    m_nextCrossfade = crossfade;
+
+    // Set up here rather than on the decode thread, as the next track may be read alongside the current one
+    const AudioFormat inputFormat = decoder->format();
+    if(inputFormat != m_outputFormat && m_outputFormat.isValid()) {
+        m_nextResampler.init(inputFormat, m_outputFormat);
+    }
+}
+
+bool AudioDecodeWorker::takeNextDecoder(std::vector<AudioBuffer>& preroll)
+{
+    const std::scoped_lock lock{m_nextGuard};
+
+    if(!m_nextDecoder || m_nextStarted) {
+        return false;
+    }
+
+    m_nextDecoder = nullptr;
+    preroll       = std::exchange(m_nextPreroll, {});
+
+    return true;
+}
+
+void AudioDecodeWorker::closeThread()
+{
+    Worker::closeThread();
+    m_buffer->interrupt();
+}
+
+void AudioDecodeWorker::decode()
+{
+    const std::scoped_lock lock{m_decodeGuard};
+
+    while(mayRun() && !m_finished) {
+        if(m_pending.isValid()) {
+            if(!writePending()) {
+                m_buffer->waitForSpace(m_pending.frameCount() - m_pendingOffset, !m_markerWritten);
+            }
+            continue;
+        }
+
+        if(m_decoderFinished) {
+            if(drainResampler() || startNextDecoder()) {
+                continue;
+            }
+            if(m_buffer->writeEndOfTrack()) {
+                m_finished = true;
+                setState(Idle);
+                emit endOfInput();
+                return;
+            }
+            m_buffer->waitForSpace(0, true);
+            continue;
+        }
+
+        m_pending         = readBuffer();
+        m_pendingOffset   = 0;
+        m_decoderFinished = !m_pending.isValid();
+
+        if(!m_decoderFinished) {
+            if(!convertBuffer(m_pending, m_resampler)) {
+                // Nothing more of the track can be played, so end it here rather than dropping every buffer
+                m_pending         = {};
+                m_decoderFinished = true;
+                continue;
+            }
+            if(!m_pending.isValid()) {
+                // Nothing came out of the resampler yet
+                continue;
+            }
+            crossfade(m_pending);
+        }
+
+        m_dsp->process(m_pending);
+    }
+}
+
+AudioBuffer AudioDecodeWorker::readBuffer()
+{
+    if(m_prerollIndex < m_preroll.size()) {
+        auto buffer = std::move(m_preroll.at(m_prerollIndex++));
+        if(m_prerollIndex == m_preroll.size()) {
+            m_preroll.clear();
+            m_prerollIndex = 0;
+        }
+        return buffer;
+    }
+
+    return decodeBuffer(m_decoder.load());
+}
+
+AudioBuffer AudioDecodeWorker::decodeBuffer(AudioDecoder* decoder)
+{
+    if(!m_metrics->isEnabled()) {
+        return decoder->readBuffer();
+    }
+
+    const auto start = EngineMetrics::Clock::now();
+    AudioBuffer buffer{decoder->readBuffer()};
+    if(buffer.isValid()) {
+        m_metrics->recordDecode(EngineMetrics::Clock::now() - start);
+    }
+
+    return buffer;
+}
+
+bool AudioDecodeWorker::convertBuffer(AudioBuffer& buffer, FFmpegResampler& resampler)
+{
+    if(!m_outputFormat.isValid() || buffer.format() == m_outputFormat) {
+        return true;
+    }
+
+    if(buffer.format() != resampler.inputFormat() || m_outputFormat != resampler.outputFormat()) {
+        if(!resampler.init(buffer.format(), m_outputFormat)) {
+            qWarning() << "Unable to convert decoded audio to the output format";
+            buffer = {};
+            return false;
+        }
+    }
+
+    m_metrics->recordConversion();
+
+    buffer = resampler.process(buffer);
+    return true;
+}
+
+bool AudioDecodeWorker::drainResampler()
+{
+    // The tail of a track being faded out is already inaudible
+    if(!m_resampler.isInitialised() || m_fadingIn) {
+        return false;
+    }
+
+    {
+        // The stream carries on seamlessly into a following track in the same format
+        const std::scoped_lock lock{m_nextGuard};
+        if(m_nextDecoder && m_nextDecoder->format() == m_resampler.inputFormat()) {
+            return false;
+        }
+    }
+
+    m_pending       = m_resampler.flush();
+    m_pendingOffset = 0;
+
+    if(!m_pending.isValid()) {
+        return false;
+    }
+
+    m_dsp->process(m_pending);
+    return true;
+}
+
+bool AudioDecodeWorker::startNextDecoder()
+{
+    const std::scoped_lock lock{m_nextGuard};
+
+    if(!m_nextDecoder) {
+        return false;
+    }
+
+    AudioDecoder* decoder = std::exchange(m_nextDecoder, nullptr);
+
+    if(std::exchange(m_fadingIn, false)) {
+        // Carry on from wherever the crossfade had read up to
+        m_preroll.clear();
+        if(m_incoming.isValid() && m_incomingOffset < m_incoming.frameCount()) {
+            const AudioFormat format = m_incoming.format();
+            const auto remaining     = m_incoming.constData().subspan(format.bytesForFrames(m_incomingOffset));
+            m_preroll.emplace_back(remaining, format,
+                                   m_incoming.startTime() + format.durationForFrames(m_incomingOffset));
+        }
+        std::move(m_incomingPreroll.begin() + static_cast<ptrdiff_t>(m_incomingPrerollIndex),
+                  m_incomingPreroll.end(), std::back_inserter(m_preroll));
+
+        std::swap(m_resampler, m_nextResampler);
+        m_nextStarted = false;
+        clearIncoming();
+    }
+    else {
+        m_preroll = std::exchange(m_nextPreroll, {});
+
+        // A track in the same format carries on through the same resampler without a break
+        const AudioFormat inputFormat = decoder->format();
+        if(inputFormat != m_resampler.inputFormat() && inputFormat == m_nextResampler.inputFormat()
+           && m_outputFormat == m_nextResampler.outputFormat()) {
+            std::swap(m_resampler, m_nextResampler);
+        }
+    }
+
+    m_decoder         = decoder;
+    m_prerollIndex    = 0;
+    m_trackStart      = true;
+    m_decoderFinished = false;
+
+    return true;
+}
+
+void AudioDecodeWorker::crossfade(AudioBuffer& buffer)
+{
+    if(!m_fadingIn && !m_crossfader.isActive() && !startCrossfade(buffer)) {
+        return;
+    }
+
+    if(!m_fadingIn) {
+        // The outgoing track ended before the fade did, so this is already the incoming one
+        m_crossfader.fadeIn(buffer.data(), buffer.frameCount());
+        return;
+    }
+
+    mixIncoming(buffer);
+
+    if(!m_crossfader.isActive()) {
+        // Nothing more of the outgoing track will be heard
+        m_decoderFinished = true;
+    }
+}
+
+bool AudioDecodeWorker::startCrossfade(const AudioBuffer& buffer)
+{
+    const std::scoped_lock lock{m_nextGuard};
+
+    if(!m_nextDecoder || m_nextCrossfade.length == 0
+       || buffer.startTime() + buffer.duration() <= m_nextCrossfade.position) {
+        return false;
+    }
+
+    clearIncoming();
+
+    m_nextStarted     = true;
+    m_fadingIn        = true;
+    m_incomingDecoder = m_nextDecoder;
+    m_incomingPreroll = std::exchange(m_nextPreroll, {});
+
+    m_crossfader.start(m_outputFormat.framesForDuration(m_nextCrossfade.length));
+
+    return true;
+}
+
+void AudioDecodeWorker::mixIncoming(AudioBuffer& buffer)
+{
+    const AudioFormat format = buffer.format();
+    const int frameCount     = buffer.frameCount();
+    std::byte* data          = buffer.data();
+
+    int framesMixed{0};
+    while(framesMixed < frameCount) {
+        if(!m_incoming.isValid() || m_incomingOffset >= m_incoming.frameCount()) {
+            m_incoming       = readIncoming();
+            m_incomingOffset = 0;
+
+            if(!m_incoming.isValid()) {
+                // The incoming track is shorter than the fade, so fade out over silence
+                m_crossfader.fadeOut(data + format.bytesForFrames(framesMixed), frameCount - framesMixed);
+                return;
+            }
+        }
+
+        const int count = std::min(frameCount - framesMixed, m_incoming.frameCount() - m_incomingOffset);
+        m_crossfader.mix(data + format.bytesForFrames(framesMixed),
+                         m_incoming.constData().data() + format.bytesForFrames(m_incomingOffset), count);
+
+        framesMixed += count;
+        m_incomingOffset += count;
+    }
+}
+
+AudioBuffer AudioDecodeWorker::readIncoming()
+{
+    while(!m_incomingFinished) {
+        AudioBuffer buffer;
+        if(m_incomingPrerollIndex < m_incomingPreroll.size()) {
+            buffer = std::move(m_incomingPreroll.at(m_incomingPrerollIndex++));
+        }
+        else {
+            buffer = decodeBuffer(m_incomingDecoder);
+        }
+
+        if(!buffer.isValid()) {
+            m_incomingFinished = true;
+            break;
+        }
+
+        if(!convertBuffer(buffer, m_nextResampler)) {
+            // Fade out over silence, as with a short track; it then ends as soon as it's switched to
+            m_incomingFinished = true;
+            break;
+        }
+        if(buffer.isValid()) {
+            return buffer;
+        }
+    }
+
+    return {};
+}
+
+void AudioDecodeWorker::clearIncoming()
+{
+    m_fadingIn        = false;
+    m_incomingDecoder = nullptr;
+    m_incomingPreroll.clear();
+    m_incomingPrerollIndex = 0;
+    m_incoming             = {};
+    m_incomingOffset       = 0;
+    m_incomingFinished     = false;
+}
+
+bool AudioDecodeWorker::writePending()
+{
+    if(!m_markerWritten) {
+        // Audio leaves the DSP chain later than it went in, so the position is held back to match
+        const uint64_t latency   = m_dsp->latency();
+        const uint64_t startTime = m_pending.startTime() > latency ? m_pending.startTime() - latency : 0;
+        if(!(m_trackStart ? m_buffer->writeTrackStart(startTime) : m_buffer->writeMarker(startTime))) {
+            return false;
+        }
+        m_markerWritten = true;
+        m_trackStart    = false;
+    }
+
+    const int frameCount = m_pending.frameCount();
+    const auto* data     = m_pending.constData().data() + m_pending.format().bytesForFrames(m_pendingOffset);
+
+    m_pendingOffset += m_buffer->writeFrames(data, frameCount - m_pendingOffset);
+
+    if(m_pendingOffset < frameCount) {
+        return false;
+    }
+
+    m_pending       = {};
+    m_pendingOffset = 0;
+    m_markerWritten = false;
+
+    return true;
+}
+} // namespace Fooyin
+
+#include "moc_audiodecodeworker.cpp"
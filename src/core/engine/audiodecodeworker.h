@@ -0,0 +1,157 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "audiocrossfader.h"
+#include "engine/ffmpeg/ffmpegresampler.h"
+
+#include <core/engine/audiobuffer.h>
+#include <utils/worker.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Fooyin {
+class AudioDecoder;
+class AudioRingBuffer;
+class DspChain;
+class EngineMetrics;
+
+/** Where to start mixing a queued decoder into the end of the current one. */
+struct Crossfade
+{
+    // Position in the current track, in ms
+    uint64_t position{0};
+    // Length of the overlap in ms; no crossfade if 0
+    uint64_t length{0};
+};
+
+/*!
+ * Runs the decoder on a dedicated thread, filling the ring buffer until it's full.
+ * Each buffer is converted to the output format if needed, then passed through the DSP chain before being written.
+ * The decoder and DSP chain must only be accessed from other threads while decoding is stopped.
+ */
+class AudioDecodeWorker : public Worker
+{
+    Q_OBJECT
+
+public:
+    AudioDecodeWorker(AudioDecoder* decoder, AudioRingBuffer* buffer, DspChain* dsp, EngineMetrics* metrics,
+                      QObject* parent = nullptr);
+
+    /** Starts filling the ring buffer. Safe to call from any thread. */
+    void startDecoding();
+    /*!
+     * Stops decoding and blocks until the decode loop has exited.
+     * Safe to call from any thread other than the worker's.
+     */
+    void stopDecoding();
+    /*!
+     * Discards any partially written or pre-decoded buffers, and clears the state of the DSP chain.
+     * Must only be called while decoding is stopped.
+     */
+    void reset();
+
+    /*!
+     * Sets the format written to the ring buffer. Buffers from the decoder in any other format are resampled,
+     * so tracks of differing formats can follow on from each other. Must only be called while decoding is stopped.
+     */
+    void setOutputFormat(const AudioFormat& format);
+
+    /** Returns the decoder currently being read from. Safe to call from any thread. */
+    [[nodiscard]] AudioDecoder* decoder() const;
+    /*!
+     * Replaces the decoder, reading the already decoded @p preroll buffers before anything else.
+     * Must only be called while decoding is stopped.
+     */
+    void setDecoder(AudioDecoder* decoder, std::vector<AudioBuffer> preroll = {});
+
+    /*!
+     * Queues @p decoder to carry on from once the current decoder runs out, instead of ending the track.
+     * Its first buffer is marked as the start of a new track. Safe to call from any thread.
+     * If @p crossfade is set, both decoders are read from during the overlap and mixed together, and the
+     * switch happens once the current one has faded out.
+     */
+    void setNextDecoder(AudioDecoder* decoder, std::vector<AudioBuffer> preroll, Crossfade crossfade = {});
+    /*!
+     * Removes the queued decoder, unless it has already been switched to or is being crossfaded into.
+     * @returns @c true if it was removed, with its unread buffers moved into @p preroll.
+     */
+    bool takeNextDecoder(std::vector<AudioBuffer>& preroll);
+
+    void closeThread() override;
+
+signals:
+    /** Emitted once the end of the track has been written to the ring buffer. */
+    void endOfInput();
+
+private:
+    void decode();
+    AudioBuffer readBuffer();
+    AudioBuffer decodeBuffer(AudioDecoder* decoder);
+    // Converts in place, leaving the buffer empty if nothing has come out of the resampler yet
+    bool convertBuffer(AudioBuffer& buffer, FFmpegResampler& resampler);
+    bool drainResampler();
+    bool startNextDecoder();
+    void crossfade(AudioBuffer& buffer);
+    bool startCrossfade(const AudioBuffer& buffer);
+    void mixIncoming(AudioBuffer& buffer);
+    AudioBuffer readIncoming();
+    void clearIncoming();
+    bool writePending();
+
+    std::atomic<AudioDecoder*> m_decoder;
+    AudioRingBuffer* m_buffer;
+    DspChain* m_dsp;
+    EngineMetrics* m_metrics;
+    AudioFormat m_outputFormat;
+    FFmpegResampler m_resampler;
+
+    std::timed_mutex m_decodeGuard;
+    AudioBuffer m_pending;
+    int m_pendingOffset;
+    bool m_markerWritten;
+    bool m_trackStart;
+    bool m_decoderFinished;
+    bool m_finished;
+
+    std::vector<AudioBuffer> m_preroll;
+    size_t m_prerollIndex;
+
+    std::mutex m_nextGuard;
+    AudioDecoder* m_nextDecoder;
+    std::vector<AudioBuffer> m_nextPreroll;
+    Crossfade m_nextCrossfade;
+    FFmpegResampler m_nextResampler;
+    // Set once the queued decoder is being read from for a crossfade
+    bool m_nextStarted;
+
+    // The track being faded in, only touched by the decode thread
+    AudioCrossfader m_crossfader;
+    bool m_fadingIn;
+    AudioDecoder* m_incomingDecoder;
+    std::vector<AudioBuffer> m_incomingPreroll;
+    size_t m_incomingPrerollIndex;
+    AudioBuffer m_incoming;
+    int m_incomingOffset;
+    bool m_incomingFinished;
+};
+} // namespace Fooyin
@@ -0,0 +1,168 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiogain.h"
+
+#include "audiokernels.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Number of samples of ramp gains calculated at once
+constexpr auto RampBlockSize = 1024;
+// Logarithmic ramps can never reach silence, so they run to -60dB and jump the rest of the way
+constexpr auto MinRampGain = 0.001;
+
+namespace Fooyin::Audio {
+void applyGain(const AudioFormat& format, std::byte* data, int sampleCount, double gain)
+{
+    if(!data || sampleCount <= 0 || gain == 1.0) {
+        return;
+    }
+
+    if(gain == 0.0) {
+        const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
+        std::fill_n(data, sampleCount * format.bytesPerSample(), unsignedFormat ? std::byte{0x80} : std::byte{0});
+        return;
+    }
+
+    if(auto kernel = gainKernel(format.sampleFormat())) {
+        kernel(data, sampleCount, gain);
+    }
+    else {
+        qDebug() << "Unable to adjust volume of unsupported format";
+    }
+}
+
+GainRamp::GainRamp(double gain)
+    : m_start{gain}
+    , m_gain{gain}
+    , m_target{gain}
+    , m_step{0.0}
+    , m_position{0}
+    , m_length{0}
+    , m_shape{RampShape::Linear}
+{ }
+
+double GainRamp::gain() const
+{
+    return m_gain;
+}
+
+double GainRamp::target() const
+{
+    return m_target;
+}
+
+bool GainRamp::isRamping() const
+{
+    return m_position < m_length;
+}
+
+int GainRamp::remainingFrames() const
+{
+    return m_length - m_position;
+}
+
+void GainRamp::rampTo(double gain, int frames, RampShape shape)
+{
+    if(frames <= 0 || gain == m_gain) {
+        setGain(gain);
+        return;
+    }
+
+    m_start    = m_gain;
+    m_target   = gain;
+    m_position = 0;
+    m_length   = frames;
+    m_shape    = shape;
+
+    if(shape == RampShape::Linear) {
+        m_step = (m_target - m_start) / m_length;
+    }
+    else {
+        m_step = std::log(std::max(m_target, MinRampGain) / std::max(m_start, MinRampGain)) / m_length;
+    }
+}
+
+void GainRamp::setGain(double gain)
+{
+    m_start    = gain;
+    m_gain     = gain;
+    m_target   = gain;
+    m_position = 0;
+    m_length   = 0;
+}
+
+void GainRamp::process(const AudioFormat& format, std::byte* data, int frames)
+{
+    if(!data || frames <= 0) {
+        return;
+    }
+
+    const int channels = format.channelCount();
+    int offset{0};
+
+    if(isRamping()) {
+        const auto kernel      = gainRampKernel(format.sampleFormat());
+        const int blockFrames  = RampBlockSize / std::max(channels, 1);
+        const int rampedFrames = std::min(frames, remainingFrames());
+
+        if(!kernel || blockFrames == 0) {
+            setGain(m_target);
+        }
+        else {
+            std::array<float, RampBlockSize> gains;
+
+            while(offset < rampedFrames) {
+                const int count = std::min(blockFrames, rampedFrames - offset);
+
+                // Every sample in a frame shares a gain, and the ramp's last frame lands exactly on the target
+                for(int i{0}; i < count; ++i) {
+                    m_gain = gainAt(++m_position);
+                    std::fill_n(gains.begin() + (i * channels), channels, static_cast<float>(m_gain));
+                }
+
+                kernel(data + format.bytesForFrames(offset), gains.data(), count * channels);
+                offset += count;
+            }
+        }
+    }
+
+    if(offset < frames) {
+        applyGain(format, data + format.bytesForFrames(offset), (frames - offset) * channels, m_gain);
+    }
+}
+
+double GainRamp::gainAt(int position) const
+{
+    if(position >= m_length) {
+        return m_target;
+    }
+
+    if(m_shape == RampShape::Linear) {
+        return m_start + (m_step * position);
+    }
+
+    return std::max(m_start, MinRampGain) * std::exp(m_step * position);
+}
+} // namespace Fooyin::Audio
@@ -0,0 +1,84 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audioformat.h>
+
+#include <cstddef>
+
+namespace Fooyin::Audio {
+enum class RampShape : uint8_t
+{
+    // Moves the gain in equal steps; suited to small changes such as volume adjustments
+    Linear = 0,
+    // Moves the gain in equal steps of dB, so fades sound even to the ear
+    Logarithmic,
+};
+
+/*!
+ * Scales @p sampleCount interleaved samples in @p data by @p gain in place.
+ * Integer formats are saturated rather than wrapped.
+ * Doesn't allocate, so is safe to use from a real-time thread.
+ */
+FYCORE_EXPORT void applyGain(const AudioFormat& format, std::byte* data, int sampleCount, double gain);
+
+/*!
+ * Applies a gain to a stream, moving towards a new target gradually so changes don't click.
+ * Ramps are sample-accurate and may span any number of calls to @fn process.
+ * Not thread-safe; owned by whichever thread processes the audio. Never allocates.
+ */
+class FYCORE_EXPORT GainRamp
+{
+public:
+    explicit GainRamp(double gain = 1.0);
+
+    /** Returns the gain applied to the last processed frame. */
+    [[nodiscard]] double gain() const;
+    /** Returns the gain being ramped towards, or the current gain if not ramping. */
+    [[nodiscard]] double target() const;
+    [[nodiscard]] bool isRamping() const;
+    /** Returns the number of frames until the ramp reaches its target. */
+    [[nodiscard]] int remainingFrames() const;
+
+    /*!
+     * Ramps from the current gain to @p gain over @p frames frames.
+     * A ramp already in progress is restarted from wherever it had reached.
+     */
+    void rampTo(double gain, int frames, RampShape shape);
+    /** Jumps straight to @p gain, abandoning any ramp in progress. */
+    void setGain(double gain);
+
+    /** Applies the gain to @p frames interleaved frames of @p data in place, advancing any ramp. */
+    void process(const AudioFormat& format, std::byte* data, int frames);
+
+private:
+    [[nodiscard]] double gainAt(int position) const;
+
+    double m_start;
+    double m_gain;
+    double m_target;
+    double m_step;
+    int m_position;
+    int m_length;
+    RampShape m_shape;
+};
+} // namespace Fooyin::Audio
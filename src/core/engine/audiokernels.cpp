@@ -0,0 +1,1544 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiokernels.h"
+
+#include <utils/math.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FY_X86_KERNELS
+#include <immintrin.h>
+#define FY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+using Fooyin::Audio::ConvertKernel;
+using Fooyin::Audio::GainKernel;
+using Fooyin::Audio::GainRampKernel;
+using Fooyin::Audio::InterleaveKernel;
+using Fooyin::Audio::KernelIsa;
+using Fooyin::Audio::MixKernel;
+using Fooyin::Audio::RemapKernel;
+
+// Integer samples are scaled by powers of two, so full-scale values round-trip exactly
+constexpr float ScaleU8  = 128.0F;
+constexpr float ScaleS16 = 32768.0F;
+constexpr float ScaleS32 = 2147483648.0F;
+
+int16_t u8ToS16(uint8_t sample)
+{
+    return static_cast<int16_t>((sample ^ 0x80) << 8);
+}
+
+int32_t u8ToS32(uint8_t sample)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(sample ^ 0x80) << 24);
+}
+
+float u8ToFloat(uint8_t sample)
+{
+    return static_cast<float>(static_cast<int8_t>(sample ^ 0x80)) / ScaleU8;
+}
+
+uint8_t s16ToU8(int16_t sample)
+{
+    return static_cast<uint8_t>((sample >> 8) ^ 0x80);
+}
+
+int32_t s16ToS32(int16_t sample)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(sample) << 16);
+}
+
+float s16ToFloat(int16_t sample)
+{
+    return static_cast<float>(sample) / ScaleS16;
+}
+
+uint8_t s32ToU8(int32_t sample)
+{
+    return static_cast<uint8_t>((sample >> 24) ^ 0x80);
+}
+
+int16_t s32ToS16(int32_t sample)
+{
+    return static_cast<int16_t>(sample >> 16);
+}
+
+float s32ToFloat(int32_t sample)
+{
+    return static_cast<float>(sample) / ScaleS32;
+}
+
+uint8_t floatToU8(float sample)
+{
+    const float scaled = std::clamp(sample * ScaleU8, -ScaleU8, ScaleU8 - 1.0F);
+    return static_cast<uint8_t>(Fooyin::Math::fltToInt(scaled) ^ 0x80);
+}
+
+int16_t floatToS16(float sample)
+{
+    const float scaled = std::clamp(sample * ScaleS16, -ScaleS16, ScaleS16 - 1.0F);
+    return static_cast<int16_t>(Fooyin::Math::fltToInt(scaled));
+}
+
+int32_t floatToS32(float sample)
+{
+    // 2^31 - 1 isn't representable as a float, so clip positive overflow separately
+    const float scaled = sample * ScaleS32;
+    if(scaled >= ScaleS32) {
+        return std::numeric_limits<int32_t>::max();
+    }
+    return Fooyin::Math::fltToInt(std::max(scaled, -ScaleS32));
+}
+
+template <typename In, typename Out, Out (*Func)(In)>
+void convertScalar(const std::byte* input, std::byte* output, int count)
+{
+    for(int i{0}; i < count; ++i) {
+        In in;
+        std::memcpy(&in, input + (i * sizeof(In)), sizeof(In));
+        const Out out = Func(in);
+        std::memcpy(output + (i * sizeof(Out)), &out, sizeof(Out));
+    }
+}
+
+template <size_t Size>
+void copySamples(const std::byte* input, std::byte* output, int count)
+{
+    std::memcpy(output, input, static_cast<size_t>(count) * Size);
+}
+
+// Converts the samples left over once a vector loop has finished
+template <typename In, typename Out, Out (*Func)(In)>
+void convertTail(const std::byte* input, std::byte* output, int offset, int count)
+{
+    convertScalar<In, Out, Func>(input + (offset * sizeof(In)), output + (offset * sizeof(Out)), count - offset);
+}
+
+template <typename T>
+void interleaveScalar(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    for(int ch{0}; ch < channels; ++ch) {
+        const uint8_t* in = planes[ch];
+        std::byte* out    = output + (ch * sizeof(T));
+        for(int i{0}; i < frames; ++i) {
+            std::memcpy(out + (i * channels * sizeof(T)), in + (i * sizeof(T)), sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+void interleaveMono(const uint8_t* const* planes, int /*channels*/, std::byte* output, int frames)
+{
+    std::memcpy(output, planes[0], static_cast<size_t>(frames) * sizeof(T));
+}
+
+// Interleaves the frames left over once a vector loop has finished
+template <typename T>
+void interleaveTail(const uint8_t* const* planes, int channels, std::byte* output, int offset, int frames)
+{
+    std::array<const uint8_t*, 8> tailPlanes;
+    for(int ch{0}; ch < channels; ++ch) {
+        tailPlanes.at(ch) = planes[ch] + (offset * sizeof(T));
+    }
+    interleaveScalar<T>(tailPlanes.data(), channels, output + (offset * channels * sizeof(T)), frames - offset);
+}
+
+uint8_t scaleU8(uint8_t sample, double gain)
+{
+    const float scaled = static_cast<float>(sample - 128) * static_cast<float>(gain);
+    return static_cast<uint8_t>(std::clamp<long>(std::lrint(scaled), -128, 127) + 128);
+}
+
+int16_t scaleS16(int16_t sample, double gain)
+{
+    const float scaled = static_cast<float>(sample) * static_cast<float>(gain);
+    return static_cast<int16_t>(std::clamp<long>(std::lrint(scaled), std::numeric_limits<int16_t>::min(),
+                                                 std::numeric_limits<int16_t>::max()));
+}
+
+int32_t scaleS32(int32_t sample, double gain)
+{
+    // Use doubles, as a float can't hold every 32bit sample
+    const double scaled = std::clamp(static_cast<double>(sample) * gain, -2147483648.0, 2147483647.0);
+    return static_cast<int32_t>(std::lrint(scaled));
+}
+
+float scaleFloat(float sample, double gain)
+{
+    return sample * static_cast<float>(gain);
+}
+
+struct ConstantGain
+{
+    double gain;
+
+    [[nodiscard]] double at(int /*index*/) const
+    {
+        return gain;
+    }
+};
+
+struct RampGain
+{
+    const float* gains;
+
+    [[nodiscard]] double at(int index) const
+    {
+        return gains[index];
+    }
+};
+
+// Scales the samples from offset onwards; also used for the samples left over once a vector loop has finished
+template <typename T, T (*Scale)(T, double), typename Gain>
+void gainScalar(std::byte* data, int offset, int count, const Gain& gain)
+{
+    for(int i{offset}; i < count; ++i) {
+        T sample;
+        std::memcpy(&sample, data + (i * sizeof(T)), sizeof(T));
+        sample = Scale(sample, gain.at(i));
+        std::memcpy(data + (i * sizeof(T)), &sample, sizeof(T));
+    }
+}
+
+template <typename T, T (*Scale)(T, double)>
+void gainScalar(std::byte* data, int count, const ConstantGain& gain)
+{
+    gainScalar<T, Scale>(data, 0, count, gain);
+}
+
+template <typename T, T (*Scale)(T, double)>
+void gainScalar(std::byte* data, int count, const RampGain& gain)
+{
+    gainScalar<T, Scale>(data, 0, count, gain);
+}
+
+// Adapt the implementations, which are shared between constant gains and ramps, to the kernel signatures
+template <void (*Impl)(std::byte*, int, const ConstantGain&)>
+void constantGain(std::byte* data, int count, double gain)
+{
+    Impl(data, count, ConstantGain{gain});
+}
+
+template <void (*Impl)(std::byte*, int, const RampGain&)>
+void rampGain(std::byte* data, const float* gains, int count)
+{
+    Impl(data, count, RampGain{gains});
+}
+
+#ifdef FY_X86_KERNELS
+__m128i loadSse(const std::byte* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+void storeSse(std::byte* data, __m128i vec)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), vec);
+}
+
+void storeSse(std::byte* data, __m128 vec)
+{
+    _mm_storeu_ps(reinterpret_cast<float*>(data), vec);
+}
+
+__m128 loadSsePs(const std::byte* data)
+{
+    return _mm_loadu_ps(reinterpret_cast<const float*>(data));
+}
+
+__m128i floatToS32Sse(__m128 samples)
+{
+    const __m128 scaled = _mm_mul_ps(samples, _mm_set1_ps(ScaleS32));
+    // Overflow converts to INT_MIN; flip it to INT_MAX for positive values
+    const __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(scaled, _mm_set1_ps(ScaleS32)));
+    return _mm_xor_si128(_mm_cvtps_epi32(scaled), overflow);
+}
+
+__m128i floatToIntSse(__m128 samples, float scale)
+{
+    const __m128 scaled  = _mm_mul_ps(samples, _mm_set1_ps(scale));
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(scaled, _mm_set1_ps(-scale)), _mm_set1_ps(scale - 1.0F));
+    return _mm_cvtps_epi32(clamped);
+}
+
+__m128 intToFloatSse(__m128i samples, float scale)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(samples), _mm_set1_ps(1.0F / scale));
+}
+
+void u8ToS16Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m128i in = _mm_xor_si128(loadSse(input + i), sign);
+        storeSse(output + (i * 2), _mm_unpacklo_epi8(zero, in));
+        storeSse(output + (i * 2) + 16, _mm_unpackhi_epi8(zero, in));
+    }
+    convertTail<uint8_t, int16_t, u8ToS16>(input, output, i, count);
+}
+
+void u8ToS32Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m128i in = _mm_xor_si128(loadSse(input + i), sign);
+        const __m128i lo = _mm_unpacklo_epi8(zero, in);
+        const __m128i hi = _mm_unpackhi_epi8(zero, in);
+        std::byte* out   = output + (i * 4);
+        storeSse(out, _mm_unpacklo_epi16(zero, lo));
+        storeSse(out + 16, _mm_unpackhi_epi16(zero, lo));
+        storeSse(out + 32, _mm_unpacklo_epi16(zero, hi));
+        storeSse(out + 48, _mm_unpackhi_epi16(zero, hi));
+    }
+    convertTail<uint8_t, int32_t, u8ToS32>(input, output, i, count);
+}
+
+void u8ToFloatSse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m128i in = _mm_xor_si128(loadSse(input + i), sign);
+        // Sign extend to 16 and then 32 bits
+        const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(in, in), 8);
+        const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(in, in), 8);
+        std::byte* out   = output + (i * 4);
+        storeSse(out, intToFloatSse(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), ScaleU8));
+        storeSse(out + 16, intToFloatSse(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), ScaleU8));
+        storeSse(out + 32, intToFloatSse(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), ScaleU8));
+        storeSse(out + 48, intToFloatSse(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), ScaleU8));
+    }
+    convertTail<uint8_t, float, u8ToFloat>(input, output, i, count);
+}
+
+void s16ToU8Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m128i lo = _mm_srai_epi16(loadSse(input + (i * 2)), 8);
+        const __m128i hi = _mm_srai_epi16(loadSse(input + (i * 2) + 16), 8);
+        storeSse(output + i, _mm_xor_si128(_mm_packs_epi16(lo, hi), sign));
+    }
+    convertTail<int16_t, uint8_t, s16ToU8>(input, output, i, count);
+}
+
+void s16ToS32Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i in = loadSse(input + (i * 2));
+        storeSse(output + (i * 4), _mm_unpacklo_epi16(zero, in));
+        storeSse(output + (i * 4) + 16, _mm_unpackhi_epi16(zero, in));
+    }
+    convertTail<int16_t, int32_t, s16ToS32>(input, output, i, count);
+}
+
+void s16ToFloatSse2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i in = loadSse(input + (i * 2));
+        storeSse(output + (i * 4), intToFloatSse(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16), ScaleS16));
+        storeSse(output + (i * 4) + 16, intToFloatSse(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16), ScaleS16));
+    }
+    convertTail<int16_t, float, s16ToFloat>(input, output, i, count);
+}
+
+void s32ToU8Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const std::byte* in = input + (i * 4);
+        const __m128i a     = _mm_srai_epi32(loadSse(in), 24);
+        const __m128i b     = _mm_srai_epi32(loadSse(in + 16), 24);
+        const __m128i c     = _mm_srai_epi32(loadSse(in + 32), 24);
+        const __m128i d     = _mm_srai_epi32(loadSse(in + 48), 24);
+        const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        storeSse(output + i, _mm_xor_si128(packed, sign));
+    }
+    convertTail<int32_t, uint8_t, s32ToU8>(input, output, i, count);
+}
+
+void s32ToS16Sse2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i lo = _mm_srai_epi32(loadSse(input + (i * 4)), 16);
+        const __m128i hi = _mm_srai_epi32(loadSse(input + (i * 4) + 16), 16);
+        storeSse(output + (i * 2), _mm_packs_epi32(lo, hi));
+    }
+    convertTail<int32_t, int16_t, s32ToS16>(input, output, i, count);
+}
+
+void s32ToFloatSse2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 4 <= count; i += 4) {
+        storeSse(output + (i * 4), intToFloatSse(loadSse(input + (i * 4)), ScaleS32));
+    }
+    convertTail<int32_t, float, s32ToFloat>(input, output, i, count);
+}
+
+void floatToU8Sse2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const std::byte* in = input + (i * 4);
+        const __m128i a     = floatToIntSse(loadSsePs(in), ScaleU8);
+        const __m128i b     = floatToIntSse(loadSsePs(in + 16), ScaleU8);
+        const __m128i c     = floatToIntSse(loadSsePs(in + 32), ScaleU8);
+        const __m128i d     = floatToIntSse(loadSsePs(in + 48), ScaleU8);
+        const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        storeSse(output + i, _mm_xor_si128(packed, sign));
+    }
+    convertTail<float, uint8_t, floatToU8>(input, output, i, count);
+}
+
+void floatToS16Sse2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i lo = floatToIntSse(loadSsePs(input + (i * 4)), ScaleS16);
+        const __m128i hi = floatToIntSse(loadSsePs(input + (i * 4) + 16), ScaleS16);
+        storeSse(output + (i * 2), _mm_packs_epi32(lo, hi));
+    }
+    convertTail<float, int16_t, floatToS16>(input, output, i, count);
+}
+
+void floatToS32Sse2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 4 <= count; i += 4) {
+        storeSse(output + (i * 4), floatToS32Sse(loadSsePs(input + (i * 4))));
+    }
+    convertTail<float, int32_t, floatToS32>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 void u8ToFloatAvx2(const std::byte* input, std::byte* output, int count)
+{
+    const __m128i sign  = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m256 scale = _mm256_set1_ps(1.0F / ScaleU8);
+
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i)), sign);
+        const __m256 out = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(in)), scale);
+        _mm256_storeu_ps(reinterpret_cast<float*>(output + (i * 4)), out);
+    }
+    convertTail<uint8_t, float, u8ToFloat>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 void s16ToS32Avx2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256i in = _mm256_cvtepi16_epi32(loadSse(input + (i * 2)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i * 4)), _mm256_slli_epi32(in, 16));
+    }
+    convertTail<int16_t, int32_t, s16ToS32>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 void s16ToFloatAvx2(const std::byte* input, std::byte* output, int count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0F / ScaleS16);
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m256i lo = _mm256_cvtepi16_epi32(loadSse(input + (i * 2)));
+        const __m256i hi = _mm256_cvtepi16_epi32(loadSse(input + (i * 2) + 16));
+        auto* out        = reinterpret_cast<float*>(output + (i * 4));
+        _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(out + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    convertTail<int16_t, float, s16ToFloat>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 void s32ToFloatAvx2(const std::byte* input, std::byte* output, int count)
+{
+    const __m256 scale = _mm256_set1_ps(1.0F / ScaleS32);
+
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + (i * 4)));
+        _mm256_storeu_ps(reinterpret_cast<float*>(output + (i * 4)), _mm256_mul_ps(_mm256_cvtepi32_ps(in), scale));
+    }
+    convertTail<int32_t, float, s32ToFloat>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 __m256i floatToIntAvx2(__m256 samples, float scale)
+{
+    const __m256 scaled  = _mm256_mul_ps(samples, _mm256_set1_ps(scale));
+    const __m256 clamped = _mm256_min_ps(_mm256_max_ps(scaled, _mm256_set1_ps(-scale)), _mm256_set1_ps(scale - 1.0F));
+    return _mm256_cvtps_epi32(clamped);
+}
+
+FY_TARGET_AVX2 void floatToS16Avx2(const std::byte* input, std::byte* output, int count)
+{
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const auto* in   = reinterpret_cast<const float*>(input + (i * 4));
+        const __m256i lo = floatToIntAvx2(_mm256_loadu_ps(in), ScaleS16);
+        const __m256i hi = floatToIntAvx2(_mm256_loadu_ps(in + 8), ScaleS16);
+        // packs works within 128bit lanes, so restore the sample order afterwards
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i * 2)), packed);
+    }
+    convertTail<float, int16_t, floatToS16>(input, output, i, count);
+}
+
+FY_TARGET_AVX2 void floatToS32Avx2(const std::byte* input, std::byte* output, int count)
+{
+    const __m256 limit = _mm256_set1_ps(ScaleS32);
+
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(reinterpret_cast<const float*>(input + (i * 4))), limit);
+        const __m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(scaled, limit, _CMP_GE_OQ));
+        const __m256i out      = _mm256_xor_si256(_mm256_cvtps_epi32(scaled), overflow);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i * 4)), out);
+    }
+    convertTail<float, int32_t, floatToS32>(input, output, i, count);
+}
+__m128i loadPlane(const uint8_t* plane, int offset)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(plane + offset));
+}
+
+void interleaveStereo16Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        const __m128i left  = loadPlane(planes[0], i * 2);
+        const __m128i right = loadPlane(planes[1], i * 2);
+        storeSse(output + (i * 4), _mm_unpacklo_epi16(left, right));
+        storeSse(output + (i * 4) + 16, _mm_unpackhi_epi16(left, right));
+    }
+    interleaveTail<int16_t>(planes, channels, output, i, frames);
+}
+
+void interleaveStereo32Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        const __m128i left  = loadPlane(planes[0], i * 4);
+        const __m128i right = loadPlane(planes[1], i * 4);
+        storeSse(output + (i * 8), _mm_unpacklo_epi32(left, right));
+        storeSse(output + (i * 8) + 16, _mm_unpackhi_epi32(left, right));
+    }
+    interleaveTail<int32_t>(planes, channels, output, i, frames);
+}
+
+// Transposes 4 channels of 4 frames, so each row holds one frame
+void transpose4x4(__m128i& row0, __m128i& row1, __m128i& row2, __m128i& row3)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(row0, row1);
+    const __m128i t1 = _mm_unpacklo_epi32(row2, row3);
+    const __m128i t2 = _mm_unpackhi_epi32(row0, row1);
+    const __m128i t3 = _mm_unpackhi_epi32(row2, row3);
+
+    row0 = _mm_unpacklo_epi64(t0, t1);
+    row1 = _mm_unpackhi_epi64(t0, t1);
+    row2 = _mm_unpacklo_epi64(t2, t3);
+    row3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+void interleave6Ch32Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        const int offset = i * 4;
+
+        __m128i ch0 = loadPlane(planes[0], offset);
+        __m128i ch1 = loadPlane(planes[1], offset);
+        __m128i ch2 = loadPlane(planes[2], offset);
+        __m128i ch3 = loadPlane(planes[3], offset);
+        transpose4x4(ch0, ch1, ch2, ch3);
+
+        const __m128i ch4 = loadPlane(planes[4], offset);
+        const __m128i ch5 = loadPlane(planes[5], offset);
+        const __m128i lo  = _mm_unpacklo_epi32(ch4, ch5);
+        const __m128i hi  = _mm_unpackhi_epi32(ch4, ch5);
+
+        std::byte* out = output + (i * 24);
+        storeSse(out, ch0);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), lo);
+        storeSse(out + 24, ch1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 40), _mm_unpackhi_epi64(lo, lo));
+        storeSse(out + 48, ch2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 64), hi);
+        storeSse(out + 72, ch3);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 88), _mm_unpackhi_epi64(hi, hi));
+    }
+    interleaveTail<int32_t>(planes, channels, output, i, frames);
+}
+
+void interleave8Ch32Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        const int offset = i * 4;
+
+        __m128i ch0 = loadPlane(planes[0], offset);
+        __m128i ch1 = loadPlane(planes[1], offset);
+        __m128i ch2 = loadPlane(planes[2], offset);
+        __m128i ch3 = loadPlane(planes[3], offset);
+        transpose4x4(ch0, ch1, ch2, ch3);
+
+        __m128i ch4 = loadPlane(planes[4], offset);
+        __m128i ch5 = loadPlane(planes[5], offset);
+        __m128i ch6 = loadPlane(planes[6], offset);
+        __m128i ch7 = loadPlane(planes[7], offset);
+        transpose4x4(ch4, ch5, ch6, ch7);
+
+        std::byte* out = output + (i * 32);
+        storeSse(out, ch0);
+        storeSse(out + 16, ch4);
+        storeSse(out + 32, ch1);
+        storeSse(out + 48, ch5);
+        storeSse(out + 64, ch2);
+        storeSse(out + 80, ch6);
+        storeSse(out + 96, ch3);
+        storeSse(out + 112, ch7);
+    }
+    interleaveTail<int32_t>(planes, channels, output, i, frames);
+}
+
+// Transposes 8 channels of 8 16bit frames, so each row holds one frame
+void transpose8x8(__m128i* rows)
+{
+    const __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]);
+    const __m128i a1 = _mm_unpacklo_epi16(rows[2], rows[3]);
+    const __m128i a2 = _mm_unpacklo_epi16(rows[4], rows[5]);
+    const __m128i a3 = _mm_unpacklo_epi16(rows[6], rows[7]);
+    const __m128i a4 = _mm_unpackhi_epi16(rows[0], rows[1]);
+    const __m128i a5 = _mm_unpackhi_epi16(rows[2], rows[3]);
+    const __m128i a6 = _mm_unpackhi_epi16(rows[4], rows[5]);
+    const __m128i a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+
+    const __m128i b0 = _mm_unpacklo_epi32(a0, a1);
+    const __m128i b1 = _mm_unpacklo_epi32(a2, a3);
+    const __m128i b2 = _mm_unpackhi_epi32(a0, a1);
+    const __m128i b3 = _mm_unpackhi_epi32(a2, a3);
+    const __m128i b4 = _mm_unpacklo_epi32(a4, a5);
+    const __m128i b5 = _mm_unpacklo_epi32(a6, a7);
+    const __m128i b6 = _mm_unpackhi_epi32(a4, a5);
+    const __m128i b7 = _mm_unpackhi_epi32(a6, a7);
+
+    rows[0] = _mm_unpacklo_epi64(b0, b1);
+    rows[1] = _mm_unpackhi_epi64(b0, b1);
+    rows[2] = _mm_unpacklo_epi64(b2, b3);
+    rows[3] = _mm_unpackhi_epi64(b2, b3);
+    rows[4] = _mm_unpacklo_epi64(b4, b5);
+    rows[5] = _mm_unpackhi_epi64(b4, b5);
+    rows[6] = _mm_unpacklo_epi64(b6, b7);
+    rows[7] = _mm_unpackhi_epi64(b6, b7);
+}
+
+void interleave6Ch16Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        __m128i rows[8]{}; // NOLINT
+        for(int ch{0}; ch < 6; ++ch) {
+            rows[ch] = loadPlane(planes[ch], i * 2);
+        }
+        transpose8x8(rows);
+
+        // Each frame is 12 bytes, so only store the first 6 samples of every row
+        std::byte* out = output + (i * 12);
+        for(int frame{0}; frame < 8; ++frame) {
+            const __m128i row = rows[frame];
+            const int tail    = _mm_cvtsi128_si32(_mm_srli_si128(row, 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + (frame * 12)), row);
+            std::memcpy(out + (frame * 12) + 8, &tail, sizeof(tail));
+        }
+    }
+    interleaveTail<int16_t>(planes, channels, output, i, frames);
+}
+
+void interleave8Ch16Sse2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        __m128i rows[8]{}; // NOLINT
+        for(int ch{0}; ch < 8; ++ch) {
+            rows[ch] = loadPlane(planes[ch], i * 2);
+        }
+        transpose8x8(rows);
+
+        std::byte* out = output + (i * 16);
+        for(int frame{0}; frame < 8; ++frame) {
+            storeSse(out + (frame * 16), rows[frame]);
+        }
+    }
+    interleaveTail<int16_t>(planes, channels, output, i, frames);
+}
+
+FY_TARGET_AVX2 void interleaveStereo16Avx2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 16 <= frames; i += 16) {
+        const __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[0] + (i * 2)));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[1] + (i * 2)));
+        const __m256i lo    = _mm256_unpacklo_epi16(left, right);
+        const __m256i hi    = _mm256_unpackhi_epi16(left, right);
+        // Unpacking works within 128bit lanes, so swap the middle halves back into order
+        auto* out = reinterpret_cast<__m256i*>(output + (i * 4));
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleaveTail<int16_t>(planes, channels, output, i, frames);
+}
+
+FY_TARGET_AVX2 void interleaveStereo32Avx2(const uint8_t* const* planes, int channels, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        const __m256i left  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[0] + (i * 4)));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[1] + (i * 4)));
+        const __m256i lo    = _mm256_unpacklo_epi32(left, right);
+        const __m256i hi    = _mm256_unpackhi_epi32(left, right);
+        auto* out           = reinterpret_cast<__m256i*>(output + (i * 8));
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleaveTail<int32_t>(planes, channels, output, i, frames);
+}
+
+__m128 gainPs(const ConstantGain& gain, int /*index*/)
+{
+    return _mm_set1_ps(static_cast<float>(gain.gain));
+}
+
+__m128 gainPs(const RampGain& gain, int index)
+{
+    return _mm_loadu_ps(gain.gains + index);
+}
+
+__m128d gainPd(const ConstantGain& gain, int /*index*/)
+{
+    return _mm_set1_pd(gain.gain);
+}
+
+__m128d gainPd(const RampGain& gain, int index)
+{
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(gain.gains + index))));
+}
+
+__m128i scaleIntSse(__m128i samples, __m128 gain)
+{
+    return _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(samples), gain));
+}
+
+__m128i scaleS32Sse(__m128d samples, __m128d gain)
+{
+    const __m128d scaled = _mm_mul_pd(samples, gain);
+    return _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(scaled, _mm_set1_pd(-2147483648.0)), _mm_set1_pd(2147483647.0)));
+}
+
+template <typename Gain>
+void gainU8Sse2(std::byte* data, int count, const Gain& gain)
+{
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m128i in = _mm_xor_si128(loadSse(data + i), sign);
+        // Sign extend to 16 and then 32 bits
+        const __m128i lo   = _mm_srai_epi16(_mm_unpacklo_epi8(in, in), 8);
+        const __m128i hi   = _mm_srai_epi16(_mm_unpackhi_epi8(in, in), 8);
+        const __m128i out0 = scaleIntSse(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), gainPs(gain, i));
+        const __m128i out1 = scaleIntSse(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), gainPs(gain, i + 4));
+        const __m128i out2 = scaleIntSse(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), gainPs(gain, i + 8));
+        const __m128i out3 = scaleIntSse(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), gainPs(gain, i + 12));
+        const __m128i out  = _mm_packs_epi16(_mm_packs_epi32(out0, out1), _mm_packs_epi32(out2, out3));
+        storeSse(data + i, _mm_xor_si128(out, sign));
+    }
+    gainScalar<uint8_t, scaleU8>(data, i, count, gain);
+}
+
+template <typename Gain>
+void gainS16Sse2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i in = loadSse(data + (i * 2));
+        const __m128i lo = scaleIntSse(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16), gainPs(gain, i));
+        const __m128i hi = scaleIntSse(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16), gainPs(gain, i + 4));
+        storeSse(data + (i * 2), _mm_packs_epi32(lo, hi));
+    }
+    gainScalar<int16_t, scaleS16>(data, i, count, gain);
+}
+
+template <typename Gain>
+void gainS32Sse2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 4 <= count; i += 4) {
+        const __m128i in = loadSse(data + (i * 4));
+        const __m128i lo = scaleS32Sse(_mm_cvtepi32_pd(in), gainPd(gain, i));
+        const __m128i hi = scaleS32Sse(_mm_cvtepi32_pd(_mm_shuffle_epi32(in, 0xEE)), gainPd(gain, i + 2));
+        storeSse(data + (i * 4), _mm_unpacklo_epi64(lo, hi));
+    }
+    gainScalar<int32_t, scaleS32>(data, i, count, gain);
+}
+
+template <typename Gain>
+void gainFloatSse2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 4 <= count; i += 4) {
+        storeSse(data + (i * 4), _mm_mul_ps(loadSsePs(data + (i * 4)), gainPs(gain, i)));
+    }
+    gainScalar<float, scaleFloat>(data, i, count, gain);
+}
+
+FY_TARGET_AVX2 __m256 gainPsAvx2(const ConstantGain& gain, int /*index*/)
+{
+    return _mm256_set1_ps(static_cast<float>(gain.gain));
+}
+
+FY_TARGET_AVX2 __m256 gainPsAvx2(const RampGain& gain, int index)
+{
+    return _mm256_loadu_ps(gain.gains + index);
+}
+
+FY_TARGET_AVX2 __m256d gainPdAvx2(const ConstantGain& gain, int /*index*/)
+{
+    return _mm256_set1_pd(gain.gain);
+}
+
+FY_TARGET_AVX2 __m256d gainPdAvx2(const RampGain& gain, int index)
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(gain.gains + index));
+}
+
+FY_TARGET_AVX2 __m128i scaleS32Avx2(__m128i samples, __m256d gain)
+{
+    const __m256d scaled  = _mm256_mul_pd(_mm256_cvtepi32_pd(samples), gain);
+    const __m256d clamped = _mm256_min_pd(_mm256_max_pd(scaled, _mm256_set1_pd(-2147483648.0)),
+                                          _mm256_set1_pd(2147483647.0));
+    return _mm256_cvtpd_epi32(clamped);
+}
+
+template <typename Gain>
+FY_TARGET_AVX2 void gainS16Avx2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m256i lo = _mm256_cvtepi16_epi32(loadSse(data + (i * 2)));
+        const __m256i hi = _mm256_cvtepi16_epi32(loadSse(data + (i * 2) + 16));
+        const __m256i scaledLo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), gainPsAvx2(gain, i)));
+        const __m256i scaledHi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), gainPsAvx2(gain, i + 8)));
+        // packs works within 128bit lanes, so restore the sample order afterwards
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(scaledLo, scaledHi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + (i * 2)), packed);
+    }
+    gainScalar<int16_t, scaleS16>(data, i, count, gain);
+}
+
+template <typename Gain>
+FY_TARGET_AVX2 void gainS32Avx2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i lo = scaleS32Avx2(loadSse(data + (i * 4)), gainPdAvx2(gain, i));
+        const __m128i hi = scaleS32Avx2(loadSse(data + (i * 4) + 16), gainPdAvx2(gain, i + 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + (i * 4)),
+                            _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+    }
+    gainScalar<int32_t, scaleS32>(data, i, count, gain);
+}
+
+template <typename Gain>
+FY_TARGET_AVX2 void gainFloatAvx2(std::byte* data, int count, const Gain& gain)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* samples = reinterpret_cast<float*>(data + (i * 4));
+        _mm256_storeu_ps(samples, _mm256_mul_ps(_mm256_loadu_ps(samples), gainPsAvx2(gain, i)));
+    }
+    gainScalar<float, scaleFloat>(data, i, count, gain);
+}
+#endif
+
+void mixScalar(float* output, const float* input, const float* outputGains, const float* inputGains, int count)
+{
+    for(int i{0}; i < count; ++i) {
+        output[i] = (output[i] * outputGains[i]) + (input[i] * inputGains[i]);
+    }
+}
+
+#ifdef FY_X86_KERNELS
+void mixSse2(float* output, const float* input, const float* outputGains, const float* inputGains, int count)
+{
+    int i{0};
+    for(; i + 4 <= count; i += 4) {
+        const __m128 out = _mm_mul_ps(_mm_loadu_ps(output + i), _mm_loadu_ps(outputGains + i));
+        const __m128 in  = _mm_mul_ps(_mm_loadu_ps(input + i), _mm_loadu_ps(inputGains + i));
+        _mm_storeu_ps(output + i, _mm_add_ps(out, in));
+    }
+    mixScalar(output + i, input + i, outputGains + i, inputGains + i, count - i);
+}
+
+FY_TARGET_AVX2 void mixAvx2(float* output, const float* input, const float* outputGains, const float* inputGains,
+                            int count)
+{
+    int i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256 out = _mm256_mul_ps(_mm256_loadu_ps(output + i), _mm256_loadu_ps(outputGains + i));
+        const __m256 in  = _mm256_mul_ps(_mm256_loadu_ps(input + i), _mm256_loadu_ps(inputGains + i));
+        _mm256_storeu_ps(output + i, _mm256_add_ps(out, in));
+    }
+    mixScalar(output + i, input + i, outputGains + i, inputGains + i, count - i);
+}
+#endif
+
+template <typename T>
+void monoToStereoScalar(const std::byte* input, std::byte* output, int frames)
+{
+    for(int i{0}; i < frames; ++i) {
+        std::memcpy(output + (i * 2 * sizeof(T)), input + (i * sizeof(T)), sizeof(T));
+        std::memcpy(output + (((i * 2) + 1) * sizeof(T)), input + (i * sizeof(T)), sizeof(T));
+    }
+}
+
+// Integer averages round halves up, matching _mm_avg_epu8
+uint8_t averageU8(uint8_t left, uint8_t right)
+{
+    return static_cast<uint8_t>((left + right + 1) >> 1);
+}
+
+int16_t averageS16(int16_t left, int16_t right)
+{
+    return static_cast<int16_t>((left + right + 1) >> 1);
+}
+
+int32_t averageS32(int32_t left, int32_t right)
+{
+    return static_cast<int32_t>((int64_t{left} + right + 1) >> 1);
+}
+
+float averageFloat(float left, float right)
+{
+    return (left + right) * 0.5F;
+}
+
+template <typename T, T (*Average)(T, T)>
+void stereoToMonoScalar(const std::byte* input, std::byte* output, int frames)
+{
+    for(int i{0}; i < frames; ++i) {
+        std::array<T, 2> frame;
+        std::memcpy(frame.data(), input + (i * sizeof(frame)), sizeof(frame));
+        const T out = Average(frame[0], frame[1]);
+        std::memcpy(output + (i * sizeof(T)), &out, sizeof(T));
+    }
+}
+
+#ifdef FY_X86_KERNELS
+void monoToStereo8Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 16 <= frames; i += 16) {
+        const __m128i in = loadSse(input + i);
+        storeSse(output + (i * 2), _mm_unpacklo_epi8(in, in));
+        storeSse(output + (i * 2) + 16, _mm_unpackhi_epi8(in, in));
+    }
+    monoToStereoScalar<uint8_t>(input + i, output + (i * 2), frames - i);
+}
+
+void monoToStereo16Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        const __m128i in = loadSse(input + (i * 2));
+        storeSse(output + (i * 4), _mm_unpacklo_epi16(in, in));
+        storeSse(output + (i * 4) + 16, _mm_unpackhi_epi16(in, in));
+    }
+    monoToStereoScalar<int16_t>(input + (i * 2), output + (i * 4), frames - i);
+}
+
+void monoToStereo32Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        const __m128i in = loadSse(input + (i * 4));
+        storeSse(output + (i * 8), _mm_unpacklo_epi32(in, in));
+        storeSse(output + (i * 8) + 16, _mm_unpackhi_epi32(in, in));
+    }
+    monoToStereoScalar<int32_t>(input + (i * 4), output + (i * 8), frames - i);
+}
+
+void stereoToMonoU8Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0xFF);
+
+    int i{0};
+    for(; i + 16 <= frames; i += 16) {
+        const __m128i first  = loadSse(input + (i * 2));
+        const __m128i second = loadSse(input + (i * 2) + 16);
+        // Average each left sample with the right one above it, leaving the result in the low byte
+        const __m128i lo = _mm_and_si128(_mm_avg_epu8(first, _mm_srli_epi16(first, 8)), lowBytes);
+        const __m128i hi = _mm_and_si128(_mm_avg_epu8(second, _mm_srli_epi16(second, 8)), lowBytes);
+        storeSse(output + i, _mm_packus_epi16(lo, hi));
+    }
+    stereoToMonoScalar<uint8_t, averageU8>(input + (i * 2), output + i, frames - i);
+}
+
+void stereoToMonoS16Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i half = _mm_set1_epi32(1);
+
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        // Summing each pair in 32bits can't overflow, and halving brings it back into range
+        const __m128i lo = _mm_madd_epi16(loadSse(input + (i * 4)), ones);
+        const __m128i hi = _mm_madd_epi16(loadSse(input + (i * 4) + 16), ones);
+        storeSse(output + (i * 2), _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(lo, half), 1),
+                                                   _mm_srai_epi32(_mm_add_epi32(hi, half), 1)));
+    }
+    stereoToMonoScalar<int16_t, averageS16>(input + (i * 4), output + (i * 2), frames - i);
+}
+
+// Splits 4 interleaved stereo frames into their left and right samples
+void deinterleaveSse2(const std::byte* input, __m128& left, __m128& right)
+{
+    const __m128 first  = loadSsePs(input);
+    const __m128 second = loadSsePs(input + 16);
+    left                = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+    right               = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+// Averages without widening as (l >> 1) + (r >> 1) + ((l | r) & 1), which equals (l + r + 1) >> 1
+__m128i averageS32Sse2(__m128i left, __m128i right)
+{
+    const __m128i halves = _mm_add_epi32(_mm_srai_epi32(left, 1), _mm_srai_epi32(right, 1));
+    return _mm_add_epi32(halves, _mm_and_si128(_mm_or_si128(left, right), _mm_set1_epi32(1)));
+}
+
+void stereoToMonoS32Sse2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        __m128 left;
+        __m128 right;
+        deinterleaveSse2(input + (i * 8), left, right);
+        storeSse(output + (i * 4), averageS32Sse2(_mm_castps_si128(left), _mm_castps_si128(right)));
+    }
+    stereoToMonoScalar<int32_t, averageS32>(input + (i * 8), output + (i * 4), frames - i);
+}
+
+void stereoToMonoFloatSse2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 4 <= frames; i += 4) {
+        __m128 left;
+        __m128 right;
+        deinterleaveSse2(input + (i * 8), left, right);
+        storeSse(output + (i * 4), _mm_mul_ps(_mm_add_ps(left, right), _mm_set1_ps(0.5F)));
+    }
+    stereoToMonoScalar<float, averageFloat>(input + (i * 8), output + (i * 4), frames - i);
+}
+
+FY_TARGET_AVX2 void monoToStereo16Avx2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 16 <= frames; i += 16) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + (i * 2)));
+        const __m256i lo = _mm256_unpacklo_epi16(in, in);
+        const __m256i hi = _mm256_unpackhi_epi16(in, in);
+        auto* out        = reinterpret_cast<__m256i*>(output + (i * 4));
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    monoToStereoScalar<int16_t>(input + (i * 2), output + (i * 4), frames - i);
+}
+
+FY_TARGET_AVX2 void monoToStereo32Avx2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + (i * 4)));
+        const __m256i lo = _mm256_unpacklo_epi32(in, in);
+        const __m256i hi = _mm256_unpackhi_epi32(in, in);
+        auto* out        = reinterpret_cast<__m256i*>(output + (i * 8));
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    monoToStereoScalar<int32_t>(input + (i * 4), output + (i * 8), frames - i);
+}
+
+FY_TARGET_AVX2 void stereoToMonoS16Avx2(const std::byte* input, std::byte* output, int frames)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i half = _mm256_set1_epi32(1);
+
+    int i{0};
+    for(; i + 16 <= frames; i += 16) {
+        const __m256i lo = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + (i * 4))),
+                                             ones);
+        const __m256i hi
+            = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + (i * 4) + 32)), ones);
+        const __m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(lo, half), 1),
+                                                  _mm256_srai_epi32(_mm256_add_epi32(hi, half), 1));
+        // Packing works within 128bit lanes, so swap the middle quarters back into order
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i * 2)),
+                            _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    stereoToMonoScalar<int16_t, averageS16>(input + (i * 4), output + (i * 2), frames - i);
+}
+
+// Splits 8 interleaved stereo frames into their left and right samples, with the middle quarters swapped
+FY_TARGET_AVX2 void deinterleaveAvx2(const std::byte* input, __m256& left, __m256& right)
+{
+    const __m256 first  = _mm256_loadu_ps(reinterpret_cast<const float*>(input));
+    const __m256 second = _mm256_loadu_ps(reinterpret_cast<const float*>(input + 32));
+    left                = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+    right               = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+FY_TARGET_AVX2 void stereoToMonoS32Avx2(const std::byte* input, std::byte* output, int frames)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        __m256 leftPs;
+        __m256 rightPs;
+        deinterleaveAvx2(input + (i * 8), leftPs, rightPs);
+        const __m256i left   = _mm256_castps_si256(leftPs);
+        const __m256i right  = _mm256_castps_si256(rightPs);
+        const __m256i halves = _mm256_add_epi32(_mm256_srai_epi32(left, 1), _mm256_srai_epi32(right, 1));
+        const __m256i mono   = _mm256_add_epi32(halves, _mm256_and_si256(_mm256_or_si256(left, right), one));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i * 4)),
+                            _mm256_permute4x64_epi64(mono, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    stereoToMonoScalar<int32_t, averageS32>(input + (i * 8), output + (i * 4), frames - i);
+}
+
+FY_TARGET_AVX2 void stereoToMonoFloatAvx2(const std::byte* input, std::byte* output, int frames)
+{
+    int i{0};
+    for(; i + 8 <= frames; i += 8) {
+        __m256 left;
+        __m256 right;
+        deinterleaveAvx2(input + (i * 8), left, right);
+        const __m256d mono = _mm256_castps_pd(_mm256_mul_ps(_mm256_add_ps(left, right), _mm256_set1_ps(0.5F)));
+        _mm256_storeu_pd(reinterpret_cast<double*>(output + (i * 4)),
+                         _mm256_permute4x64_pd(mono, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    stereoToMonoScalar<float, averageFloat>(input + (i * 8), output + (i * 4), frames - i);
+}
+#endif
+
+// Indexed by U8, S16, S32 and Float
+using KernelTable = std::array<std::array<ConvertKernel, 4>, 4>;
+
+int tableIndex(Fooyin::SampleFormat format)
+{
+    switch(format) {
+        case(Fooyin::SampleFormat::U8):
+            return 0;
+        case(Fooyin::SampleFormat::S16):
+            return 1;
+        case(Fooyin::SampleFormat::S24):
+        case(Fooyin::SampleFormat::S32):
+            return 2;
+        case(Fooyin::SampleFormat::Float):
+            return 3;
+        case(Fooyin::SampleFormat::Unknown):
+        default:
+            return -1;
+    }
+}
+
+KernelTable scalarKernels()
+{
+    return {{
+        {copySamples<1>, convertScalar<uint8_t, int16_t, u8ToS16>, convertScalar<uint8_t, int32_t, u8ToS32>,
+         convertScalar<uint8_t, float, u8ToFloat>},
+        {convertScalar<int16_t, uint8_t, s16ToU8>, copySamples<2>, convertScalar<int16_t, int32_t, s16ToS32>,
+         convertScalar<int16_t, float, s16ToFloat>},
+        {convertScalar<int32_t, uint8_t, s32ToU8>, convertScalar<int32_t, int16_t, s32ToS16>, copySamples<4>,
+         convertScalar<int32_t, float, s32ToFloat>},
+        {convertScalar<float, uint8_t, floatToU8>, convertScalar<float, int16_t, floatToS16>,
+         convertScalar<float, int32_t, floatToS32>, copySamples<4>},
+    }};
+}
+
+#ifdef FY_X86_KERNELS
+KernelTable sse2Kernels()
+{
+    return {{
+        {copySamples<1>, u8ToS16Sse2, u8ToS32Sse2, u8ToFloatSse2},
+        {s16ToU8Sse2, copySamples<2>, s16ToS32Sse2, s16ToFloatSse2},
+        {s32ToU8Sse2, s32ToS16Sse2, copySamples<4>, s32ToFloatSse2},
+        {floatToU8Sse2, floatToS16Sse2, floatToS32Sse2, copySamples<4>},
+    }};
+}
+
+KernelTable avx2Kernels()
+{
+    // Paths which need cross-lane packing to narrow to bytes gain little over SSE2
+    KernelTable kernels = sse2Kernels();
+    kernels[0][3]       = u8ToFloatAvx2;
+    kernels[1][2]       = s16ToS32Avx2;
+    kernels[1][3]       = s16ToFloatAvx2;
+    kernels[2][3]       = s32ToFloatAvx2;
+    kernels[3][1]       = floatToS16Avx2;
+    kernels[3][2]       = floatToS32Avx2;
+    return kernels;
+}
+#endif
+
+const KernelTable& kernelTable([[maybe_unused]] KernelIsa isa)
+{
+    static const KernelTable scalar = scalarKernels();
+#ifdef FY_X86_KERNELS
+    static const KernelTable sse2 = sse2Kernels();
+    static const KernelTable avx2 = avx2Kernels();
+
+    switch(std::min(isa, Fooyin::Audio::detectedIsa())) {
+        case(KernelIsa::AVX2):
+            return avx2;
+        case(KernelIsa::SSE2):
+            return sse2;
+        case(KernelIsa::Scalar):
+        default:
+            return scalar;
+    }
+#else
+    return scalar;
+#endif
+}
+
+InterleaveKernel scalarInterleave(int sampleSize, int channels)
+{
+    switch(sampleSize) {
+        case(1):
+            return channels == 1 ? interleaveMono<uint8_t> : interleaveScalar<uint8_t>;
+        case(2):
+            return channels == 1 ? interleaveMono<int16_t> : interleaveScalar<int16_t>;
+        case(4):
+            return channels == 1 ? interleaveMono<int32_t> : interleaveScalar<int32_t>;
+        case(8):
+            return channels == 1 ? interleaveMono<int64_t> : interleaveScalar<int64_t>;
+        default:
+            return nullptr;
+    }
+}
+
+#ifdef FY_X86_KERNELS
+InterleaveKernel vectorInterleave(int sampleSize, int channels, KernelIsa isa)
+{
+    const bool avx2 = isa == KernelIsa::AVX2;
+
+    if(sampleSize == 2) {
+        switch(channels) {
+            case(2):
+                return avx2 ? interleaveStereo16Avx2 : interleaveStereo16Sse2;
+            case(6):
+                return interleave6Ch16Sse2;
+            case(8):
+                return interleave8Ch16Sse2;
+            default:
+                break;
+        }
+    }
+    else if(sampleSize == 4) {
+        switch(channels) {
+            case(2):
+                return avx2 ? interleaveStereo32Avx2 : interleaveStereo32Sse2;
+            case(6):
+                return interleave6Ch32Sse2;
+            case(8):
+                return interleave8Ch32Sse2;
+            default:
+                break;
+        }
+    }
+
+    return nullptr;
+}
+#endif
+
+// Indexed by U8, S16, S32 and Float, as with the conversion tables
+struct GainKernels
+{
+    std::array<GainKernel, 4> constant;
+    std::array<GainRampKernel, 4> ramp;
+};
+
+GainKernels scalarGainKernels()
+{
+    return {
+        .constant = {constantGain<gainScalar<uint8_t, scaleU8>>, constantGain<gainScalar<int16_t, scaleS16>>,
+                     constantGain<gainScalar<int32_t, scaleS32>>, constantGain<gainScalar<float, scaleFloat>>},
+        .ramp     = {rampGain<gainScalar<uint8_t, scaleU8>>, rampGain<gainScalar<int16_t, scaleS16>>,
+                     rampGain<gainScalar<int32_t, scaleS32>>, rampGain<gainScalar<float, scaleFloat>>},
+    };
+}
+
+#ifdef FY_X86_KERNELS
+GainKernels sse2GainKernels()
+{
+    return {
+        .constant = {constantGain<gainU8Sse2>, constantGain<gainS16Sse2>, constantGain<gainS32Sse2>,
+                     constantGain<gainFloatSse2>},
+        .ramp     = {rampGain<gainU8Sse2>, rampGain<gainS16Sse2>, rampGain<gainS32Sse2>, rampGain<gainFloatSse2>},
+    };
+}
+
+GainKernels avx2GainKernels()
+{
+    // 8bit output is rare enough that the SSE2 kernel will do
+    return {
+        .constant = {constantGain<gainU8Sse2>, constantGain<gainS16Avx2>, constantGain<gainS32Avx2>,
+                     constantGain<gainFloatAvx2>},
+        .ramp     = {rampGain<gainU8Sse2>, rampGain<gainS16Avx2>, rampGain<gainS32Avx2>, rampGain<gainFloatAvx2>},
+    };
+}
+#endif
+
+const GainKernels& gainKernels([[maybe_unused]] KernelIsa isa)
+{
+    static const GainKernels scalar = scalarGainKernels();
+#ifdef FY_X86_KERNELS
+    static const GainKernels sse2 = sse2GainKernels();
+    static const GainKernels avx2 = avx2GainKernels();
+
+    switch(std::min(isa, Fooyin::Audio::detectedIsa())) {
+        case(KernelIsa::AVX2):
+            return avx2;
+        case(KernelIsa::SSE2):
+            return sse2;
+        case(KernelIsa::Scalar):
+        default:
+            return scalar;
+    }
+#else
+    return scalar;
+#endif
+}
+// Indexed by U8, S16, S32 and Float, as with the conversion tables
+struct RemapKernels
+{
+    std::array<RemapKernel, 4> monoToStereo;
+    std::array<RemapKernel, 4> stereoToMono;
+};
+
+RemapKernels scalarRemapKernels()
+{
+    return {
+        .monoToStereo = {monoToStereoScalar<uint8_t>, monoToStereoScalar<int16_t>, monoToStereoScalar<int32_t>,
+                         monoToStereoScalar<float>},
+        .stereoToMono = {stereoToMonoScalar<uint8_t, averageU8>, stereoToMonoScalar<int16_t, averageS16>,
+                         stereoToMonoScalar<int32_t, averageS32>, stereoToMonoScalar<float, averageFloat>},
+    };
+}
+
+#ifdef FY_X86_KERNELS
+RemapKernels sse2RemapKernels()
+{
+    return {
+        .monoToStereo = {monoToStereo8Sse2, monoToStereo16Sse2, monoToStereo32Sse2, monoToStereo32Sse2},
+        .stereoToMono = {stereoToMonoU8Sse2, stereoToMonoS16Sse2, stereoToMonoS32Sse2, stereoToMonoFloatSse2},
+    };
+}
+
+RemapKernels avx2RemapKernels()
+{
+    // As with gain, 8bit output is rare enough that the SSE2 kernels will do
+    return {
+        .monoToStereo = {monoToStereo8Sse2, monoToStereo16Avx2, monoToStereo32Avx2, monoToStereo32Avx2},
+        .stereoToMono = {stereoToMonoU8Sse2, stereoToMonoS16Avx2, stereoToMonoS32Avx2, stereoToMonoFloatAvx2},
+    };
+}
+#endif
+
+const RemapKernels& remapKernels([[maybe_unused]] KernelIsa isa)
+{
+    static const RemapKernels scalar = scalarRemapKernels();
+#ifdef FY_X86_KERNELS
+    static const RemapKernels sse2 = sse2RemapKernels();
+    static const RemapKernels avx2 = avx2RemapKernels();
+    switch(std::min(isa, Fooyin::Audio::detectedIsa())) {
+        case(KernelIsa::AVX2):
+            return avx2;
+        case(KernelIsa::SSE2):
+            return sse2;
+        case(KernelIsa::Scalar):
+        default:
+            return scalar;
+    }
+#else
+    return scalar;
+#endif
+}
+} // namespace
+
+namespace Fooyin::Audio {
+KernelIsa detectedIsa()
+{
+    static const KernelIsa isa = []() {
+#ifdef FY_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return KernelIsa::AVX2;
+        }
+        if(__builtin_cpu_supports("sse2")) {
+            return KernelIsa::SSE2;
+        }
+#endif
+        return KernelIsa::Scalar;
+    }();
+    return isa;
+}
+
+ConvertKernel convertKernel(SampleFormat input, SampleFormat output)
+{
+    return convertKernel(input, output, detectedIsa());
+}
+
+ConvertKernel convertKernel(SampleFormat input, SampleFormat output, KernelIsa isa)
+{
+    const int inIndex  = tableIndex(input);
+    const int outIndex = tableIndex(output);
+
+    if(inIndex < 0 || outIndex < 0) {
+        return nullptr;
+    }
+
+    return kernelTable(isa).at(inIndex).at(outIndex);
+}
+
+InterleaveKernel interleaveKernel(int sampleSize, int channels)
+{
+    return interleaveKernel(sampleSize, channels, detectedIsa());
+}
+
+InterleaveKernel interleaveKernel(int sampleSize, int channels, KernelIsa isa)
+{
+    if(channels <= 0) {
+        return nullptr;
+    }
+
+#ifdef FY_X86_KERNELS
+    isa = std::min(isa, detectedIsa());
+    if(isa != KernelIsa::Scalar) {
+        if(auto kernel = vectorInterleave(sampleSize, channels, isa)) {
+            return kernel;
+        }
+    }
+#else
+    static_cast<void>(isa);
+#endif
+
+    return scalarInterleave(sampleSize, channels);
+}
+
+GainKernel gainKernel(SampleFormat format)
+{
+    return gainKernel(format, detectedIsa());
+}
+
+GainKernel gainKernel(SampleFormat format, KernelIsa isa)
+{
+    const int index = tableIndex(format);
+    return index >= 0 ? gainKernels(isa).constant.at(index) : nullptr;
+}
+
+GainRampKernel gainRampKernel(SampleFormat format)
+{
+    return gainRampKernel(format, detectedIsa());
+}
+
+GainRampKernel gainRampKernel(SampleFormat format, KernelIsa isa)
+{
+    const int index = tableIndex(format);
+    return index >= 0 ? gainKernels(isa).ramp.at(index) : nullptr;
+}
+
+MixKernel mixKernel()
+{
+    return mixKernel(detectedIsa());
+}
+
+MixKernel mixKernel([[maybe_unused]] KernelIsa isa)
+{
+#ifdef FY_X86_KERNELS
+    switch(std::min(isa, detectedIsa())) {
+        case(KernelIsa::AVX2):
+            return mixAvx2;
+        case(KernelIsa::SSE2):
+            return mixSse2;
+        case(KernelIsa::Scalar):
+        default:
+            return mixScalar;
+    }
+#else
+    return mixScalar;
+#endif
+}
+RemapKernel remapKernel(SampleFormat format, int inChannels, int outChannels)
+{
+    return remapKernel(format, inChannels, outChannels, detectedIsa());
+}
+
+RemapKernel remapKernel(SampleFormat format, int inChannels, int outChannels, KernelIsa isa)
+{
+    const int index = tableIndex(format);
+    if(index < 0) {
+        return nullptr;
+    }
+
+    if(inChannels == 1 && outChannels == 2) {
+        return remapKernels(isa).monoToStereo.at(index);
+    }
+    if(inChannels == 2 && outChannels == 1) {
+        return remapKernels(isa).stereoToMono.at(index);
+    }
+
+    return nullptr;
+}
+} // namespace Fooyin::Audio
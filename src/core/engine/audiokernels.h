@@ -0,0 +1,126 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audioformat.h>
+
+#include <cstddef>
+
+namespace Fooyin::Audio {
+enum class KernelIsa : uint8_t
+{
+    Scalar = 0,
+    SSE2,
+    AVX2,
+};
+
+/*!
+ * Converts @p count packed samples from one sample format to another.
+ * Neither buffer needs to be aligned.
+ */
+using ConvertKernel = void (*)(const std::byte* input, std::byte* output, int count);
+
+/*!
+ * Interleaves @p frames frames from @p channels planes, one per channel, into @p output.
+ * Neither the planes nor the output need to be aligned.
+ */
+using InterleaveKernel = void (*)(const uint8_t* const* planes, int channels, std::byte* output, int frames);
+
+/*!
+ * Scales @p count samples in @p data by @p gain in place.
+ * Integer formats are rounded and saturated, floating point samples are left unclipped.
+ */
+using GainKernel = void (*)(std::byte* data, int count, double gain);
+
+/*!
+ * Scales each of the @p count samples in @p data by the matching entry of @p gains in place.
+ * Used to apply ramps; rounding and saturation match @ref GainKernel.
+ */
+using GainRampKernel = void (*)(std::byte* data, const float* gains, int count);
+
+/*!
+ * Mixes @p count float samples of @p input into @p output in place, scaling each by the matching entry of
+ * @p outputGains and @p inputGains respectively. Used to crossfade between two streams.
+ */
+using MixKernel = void (*)(float* output, const float* input, const float* outputGains, const float* inputGains,
+                           int count);
+
+/*!
+ * Remaps @p frames interleaved frames from one channel count to another.
+ * Mono is copied to both stereo channels, while stereo is downmixed to the average of the two.
+ */
+using RemapKernel = void (*)(const std::byte* input, std::byte* output, int frames);
+
+/** Returns the widest instruction set supported by the current CPU. Detected once. */
+FYCORE_EXPORT KernelIsa detectedIsa();
+
+/*!
+ * Returns the kernel converting @p input samples to @p output, selected for the current CPU.
+ * S24 is treated as S32, as it's stored in a 32bit int.
+ * @returns @c nullptr if either format is unknown.
+ */
+FYCORE_EXPORT ConvertKernel convertKernel(SampleFormat input, SampleFormat output);
+/*!
+ * Returns the kernel for a specific instruction set, falling back to the widest one
+ * below @p isa which is supported. Intended for testing and benchmarking.
+ */
+FYCORE_EXPORT ConvertKernel convertKernel(SampleFormat input, SampleFormat output, KernelIsa isa);
+
+/*!
+ * Returns the kernel interleaving @p channels planes of @p sampleSize byte samples, selected for the current CPU.
+ * Specialised kernels are used for 1, 2, 6 and 8 channels of 16 and 32bit samples.
+ * @returns @c nullptr if @p sampleSize isn't 1, 2, 4 or 8.
+ */
+FYCORE_EXPORT InterleaveKernel interleaveKernel(int sampleSize, int channels);
+/** Returns the interleave kernel for a specific instruction set. Intended for testing and benchmarking. */
+FYCORE_EXPORT InterleaveKernel interleaveKernel(int sampleSize, int channels, KernelIsa isa);
+
+/*!
+ * Returns the gain kernel for samples of @p format, selected for the current CPU.
+ * @returns @c nullptr if the format is unknown.
+ */
+FYCORE_EXPORT GainKernel gainKernel(SampleFormat format);
+/** Returns the gain kernel for a specific instruction set. Intended for testing and benchmarking. */
+FYCORE_EXPORT GainKernel gainKernel(SampleFormat format, KernelIsa isa);
+
+/*!
+ * Returns the gain ramp kernel for samples of @p format, selected for the current CPU.
+ * @returns @c nullptr if the format is unknown.
+ */
+FYCORE_EXPORT GainRampKernel gainRampKernel(SampleFormat format);
+/** Returns the gain ramp kernel for a specific instruction set. Intended for testing and benchmarking. */
+FYCORE_EXPORT GainRampKernel gainRampKernel(SampleFormat format, KernelIsa isa);
+
+/*!
+ * Returns the kernel remapping samples of @p format from @p inChannels to @p outChannels, selected for the current CPU.
+ * Only mono to stereo and stereo to mono have kernels.
+ * @returns @c nullptr for other layouts, or if the format is unknown.
+ */
+FYCORE_EXPORT RemapKernel remapKernel(SampleFormat format, int inChannels, int outChannels);
+/** Returns the remap kernel for a specific instruction set. Intended for testing and benchmarking. */
+FYCORE_EXPORT RemapKernel remapKernel(SampleFormat format, int inChannels, int outChannels, KernelIsa isa);
+
+/** Returns the float mix kernel, selected for the current CPU. */
+FYCORE_EXPORT MixKernel mixKernel();
+/** Returns the mix kernel for a specific instruction set. Intended for testing and benchmarking. */
+FYCORE_EXPORT MixKernel mixKernel(KernelIsa isa);
+} // namespace Fooyin::Audio
@@ -20,19 +20,45 @@
 #include "audioplaybackengine.h"
 
 #include "audioclock.h"
+#include "audiodecodeworker.h"
+#include "audiopreloader.h"
 #include "audiorenderer.h"
+#include "audioringbuffer.h"
+#include "database/seektabledatabase.h"
+#include "decoderfactory.h"
+#include "dspchain.h"
 #include "engine/ffmpeg/ffmpegdecoder.h"
+#include "enginemetrics.h"
+#include "replaygain.h"
 
 #include <core/coresettings.h>
 #include <core/engine/audiobuffer.h>
 #include <core/engine/audiodecoder.h>
 #include <core/engine/audiooutput.h>
 #include <core/track.h>
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbconnectionprovider.h>
 #include <utils/settings/settingsmanager.h>
 
+#include <QThread>
 #include <QTimer>
 
-using namespace std::chrono_literals;
+#include <algorithm>
+
+// Time allowed for the next track to be opened before the decoder reaches the end of the current one
+constexpr auto PreloadWindow = 5000;
+// Listeners carry the position on themselves, so it's only sent again once it has drifted by this much
+constexpr auto PositionTolerance = 20;
+// How often statistics are sent while they're being collected
+constexpr auto StatsInterval = 1000;
+
+namespace {
+// Only FFmpeg needs a seek table; the PCM decoder can seek straight to any sample
+Fooyin::FFmpegDecoder* seekTableDecoder(Fooyin::AudioDecoder* decoder)
+{
+    return dynamic_cast<Fooyin::FFmpegDecoder*>(decoder);
+}
+} // namespace
 
 namespace Fooyin {
 struct AudioPlaybackEngine::Private
@@ -41,74 +67,225 @@ struct AudioPlaybackEngine::Private
 
     SettingsManager* settings;
 
+    DbConnectionPoolPtr dbPool;
+    std::unique_ptr<DbConnectionHandler> dbHandler;
+    SeekTableDatabase seekTableDb;
+
     AudioClock clock;
-    QTimer* positionUpdateTimer{nullptr};
+    QTimer* aboutToFinishTimer{nullptr};
+    QTimer* statsTimer{nullptr};
+    EngineMetrics metrics;
+    std::shared_ptr<AudioAnalysisBus> analysisBus;
 
     TrackStatus status{NoTrack};
     PlaybackState state{StoppedState};
+    // The last position sent, and when
     uint64_t lastPosition{0};
+    AudioClock::TimePoint lastPositionTime;
 
-    uint64_t totalBufferTime{0};
     uint64_t bufferLength{0};
 
     uint64_t duration{0};
     double volume{1.0};
+    bool aboutToFinishSent{false};
+    bool bitPerfect{false};
 
     AudioFormat format;
 
+    Track track;
     std::unique_ptr<AudioDecoder> decoder;
+    AudioRingBuffer ringBuffer;
+    DspChain dspChain;
     AudioRenderer* renderer;
 
-    QTimer* bufferTimer;
+    QThread decodeThread;
+    AudioDecodeWorker decodeWorker;
+
+    QThread preloadThread;
+    AudioPreloader preloader;
+    PreloadedTrack nextTrack;
+    // Set once the next track has been handed to the decode worker to follow on from the current one
+    bool spliceQueued{false};
+    Track splicedTrack;
 
-    explicit Private(AudioEngine* self_, SettingsManager* settings_)
+    Private(AudioEngine* self_, SettingsManager* settings_, DbConnectionPoolPtr dbPool_,
+            std::shared_ptr<AudioAnalysisBus> analysisBus_)
         : self{self_}
         , settings{settings_}
+        , dbPool{std::move(dbPool_)}
+        , analysisBus{std::move(analysisBus_)}
         , bufferLength{static_cast<uint64_t>(settings->value<Settings::Core::BufferLength>())}
-        , decoder{std::make_unique<FFmpegDecoder>()}
-        , renderer{new AudioRenderer(self)}
-        , bufferTimer{new QTimer(self)}
+        , decoder{std::make_unique<FFmpegDecoder>(readAheadOptions())}
+        , renderer{new AudioRenderer(&ringBuffer, &metrics, analysisBus.get(), self)}
+        , decodeWorker{decoder.get(), &ringBuffer, &dspChain, &metrics}
     {
-        bufferTimer->setInterval(10ms);
+        decodeWorker.moveToThread(&decodeThread);
+        decodeThread.setObjectName(QStringLiteral("Decoder"));
+        decodeThread.start();
 
-        settings->subscribe<Settings::Core::BufferLength>(self, [this](int length) { bufferLength = length; });
+        preloader.moveToThread(&preloadThread);
+        preloadThread.setObjectName(QStringLiteral("Preloader"));
+        preloadThread.start();
 
-        QObject::connect(renderer, &AudioRenderer::bufferProcessed, self, [this](const AudioBuffer& buffer) {
-            totalBufferTime -= buffer.duration();
-            clock.sync(buffer.startTime());
+        settings->subscribe<Settings::Core::BufferLength>(self, [this](int length) { bufferLength = length; });
+        settings->subscribe<Settings::Core::ReplayGainMode>(self, [this]() { updateReplayGain(); });
+        settings->subscribe<Settings::Core::ReplayGainPreamp>(self, [this]() { updateReplayGain(); });
+        settings->subscribe<Settings::Core::EngineStatistics>(self, [this](bool enabled) { collectStats(enabled); });
+        settings->subscribe<Settings::Core::OutputLatency>(self, [this](int latency) {
+            reopenOutput([this, latency]() { renderer->updateLatency(latency); });
+        });
+        settings->subscribe<Settings::Core::ExclusiveOutput>(self, [this](bool exclusive) {
+            reopenOutput([this, exclusive]() { renderer->updateExclusive(exclusive); });
         });
+
+        renderer->updateLatency(settings->value<Settings::Core::OutputLatency>());
+        renderer->updateExclusive(settings->value<Settings::Core::ExclusiveOutput>());
+
+        // Timers have to be created on the engine thread, which we haven't been moved to yet
+        QMetaObject::invokeMethod(
+            self, [this]() { collectStats(settings->value<Settings::Core::EngineStatistics>()); },
+            Qt::QueuedConnection);
+
+        QObject::connect(renderer, &AudioRenderer::bufferStarted, self,
+                         [this](uint64_t startTime, AudioClock::TimePoint playTime) {
+                             clock.sync(playTime, startTime);
+                             updatePosition();
+                             // Sound servers may only switch to our format once the stream is running
+                             updateBitPerfect();
+                         });
+        QObject::connect(renderer, &AudioRenderer::trackStarted, self, [this]() { onTrackStarted(); });
         QObject::connect(renderer, &AudioRenderer::finished, self, [this]() { onRendererFinished(); });
+        QObject::connect(&decodeWorker, &AudioDecodeWorker::endOfInput, self, [this]() { notifyAboutToFinish(); });
+        QObject::connect(&preloader, &AudioPreloader::trackLoaded, self,
+                         [this](const Track& track) { onTrackLoaded(track); });
+    }
 
-        QObject::connect(bufferTimer, &QTimer::timeout, self, [this]() { readNextBuffer(); });
+    [[nodiscard]] ReadAheadOptions readAheadOptions() const
+    {
+        constexpr uint64_t MiB = 1024 * 1024;
+
+        return {.windowSize = static_cast<size_t>(settings->value<Settings::Core::ReadAheadSize>()) * MiB,
+                .cacheLimit = static_cast<uint64_t>(settings->value<Settings::Core::MemoryCacheLimit>()) * MiB};
+    }
+
+    void updateReplayGain()
+    {
+        const auto mode   = static_cast<ReplayGain::Mode>(settings->value<Settings::Core::ReplayGainMode>());
+        const auto preamp = settings->value<Settings::Core::ReplayGainPreamp>();
+
+        renderer->updateReplayGain(ReplayGain::linearGain(ReplayGain::values(track), mode, preamp));
+        updateBitPerfect();
     }
 
-    QTimer* positionTimer()
+    SeekTableDatabase& seekTables()
     {
-        if(!positionUpdateTimer) {
-            positionUpdateTimer = new QTimer(self);
-            positionUpdateTimer->setInterval(50ms);
-            positionUpdateTimer->setTimerType(Qt::PreciseTimer);
-            QObject::connect(positionUpdateTimer, &QTimer::timeout, self, [this]() { updatePosition(); });
+        // Connections are per thread, so this can't be done until we're running on the engine thread
+        if(!dbHandler) {
+            dbHandler = std::make_unique<DbConnectionHandler>(dbPool);
+            seekTableDb.initialise(DbConnectionProvider{dbPool});
         }
-        return positionUpdateTimer;
+        return seekTableDb;
     }
 
-    void readNextBuffer()
+    // Must only be called while decoding is stopped, or once the decode worker has moved on from the decoder
+    void storeSeekTable()
     {
-        if(totalBufferTime >= bufferLength) {
+        auto* ffmpegDecoder = seekTableDecoder(decoder.get());
+        if(!ffmpegDecoder || !track.isValid() || !ffmpegDecoder->seekTable().isModified()) {
             return;
         }
 
-        const auto buffer = decoder->readBuffer();
-        if(buffer.isValid()) {
-            totalBufferTime += buffer.duration();
-            renderer->queueBuffer(buffer);
+        seekTables().storeSeekTable(track, ffmpegDecoder->seekTable());
+    }
+
+    void loadSeekTable(AudioDecoder* trackDecoder, const Track& seekTrack)
+    {
+        if(auto* ffmpegDecoder = seekTableDecoder(trackDecoder)) {
+            ffmpegDecoder->setSeekTable(seekTables().seekTable(seekTrack));
         }
-        else {
-            bufferTimer->stop();
-            renderer->queueBuffer({});
-            QMetaObject::invokeMethod(self, &AudioEngine::trackAboutToFinish);
+    }
+
+    QTimer* finishTimer()
+    {
+        if(!aboutToFinishTimer) {
+            aboutToFinishTimer = new QTimer(self);
+            aboutToFinishTimer->setSingleShot(true);
+            QObject::connect(aboutToFinishTimer, &QTimer::timeout, self, [this]() { updatePosition(); });
+        }
+        return aboutToFinishTimer;
+    }
+
+    // Applies a change to the output which only takes effect once it's reopened, resuming playback afterwards.
+    // The output is reopened in the same format; a newly negotiated one is picked up from the next track.
+    template <typename Func>
+    void reopenOutput(Func&& change)
+    {
+        const bool playing = state == PlayingState || state == PausedState;
+
+        clock.setPaused(playing);
+        renderer->pause(playing);
+
+        if(playing) {
+            decodeWorker.stopDecoding();
+        }
+
+        change();
+
+        if(playing) {
+            if(!renderer->init(format)) {
+                changeTrackStatus(NoTrack);
+                return;
+            }
+            clock.setPaused(false);
+            startPlayback();
+        }
+
+        updateBitPerfect();
+    }
+
+    void updateBitPerfect()
+    {
+        // Any resampling, DSP or gain on the way means the device isn't getting the decoded samples untouched
+        const bool isBitPerfect = state != StoppedState && decoder && format == decoder->format()
+                               && dspChain.isEmpty() && renderer->isBitPerfect();
+
+        if(std::exchange(bitPerfect, isBitPerfect) != isBitPerfect) {
+            emit self->bitPerfectChanged(isBitPerfect);
+        }
+    }
+
+    void collectStats(bool enabled)
+    {
+        metrics.setEnabled(enabled);
+
+        if(!enabled) {
+            if(statsTimer) {
+                statsTimer->stop();
+            }
+            return;
+        }
+
+        if(!statsTimer) {
+            statsTimer = new QTimer(self);
+            QObject::connect(statsTimer, &QTimer::timeout, self, [this]() { sendStats(); });
         }
+        statsTimer->start(StatsInterval);
+    }
+
+    void sendStats()
+    {
+        EngineStats stats    = metrics.snapshot();
+        stats.bufferCapacity = ringBuffer.capacity();
+        stats.bufferPool     = AudioBuffer::poolStats();
+        stats.dspStages      = dspChain.stats();
+
+        if(const auto* ffmpegDecoder = dynamic_cast<const FFmpegDecoder*>(decoder.get())) {
+            const auto readAhead     = ffmpegDecoder->readAheadStats();
+            stats.readAheadStalls    = readAhead.stalls;
+            stats.readAheadStallTime = readAhead.stallTime;
+        }
+
+        emit self->statsChanged(stats);
     }
 
     PlaybackState changeState(PlaybackState newState)
@@ -129,18 +306,188 @@ struct AudioPlaybackEngine::Private
         return prevStatus;
     }
 
-    void updatePosition()
+    void sendPosition(uint64_t position)
+    {
+        lastPosition     = position;
+        lastPositionTime = AudioClock::Clock::now();
+        emit self->positionChanged(position);
+    }
+
+    // Sends the position if it's moved away from where listeners will have carried it on to
+    void updatePosition(bool force = false)
     {
-        if(std::exchange(lastPosition, clock.currentPosition()) != lastPosition) {
-            emit self->positionChanged(lastPosition);
+        const uint64_t position = clock.currentPosition();
+        const auto now          = AudioClock::Clock::now();
+
+        uint64_t expected = lastPosition;
+        if(state == PlayingState) {
+            expected += std::chrono::duration_cast<std::chrono::milliseconds>(now - lastPositionTime).count();
+        }
+
+        const uint64_t drift = position > expected ? position - expected : expected - position;
+        if(force || drift >= PositionTolerance) {
+            sendPosition(position);
         }
+
+        scheduleAboutToFinish(position);
     }
 
-    bool updateFormat(const AudioFormat& nextFormat)
+    // The decoder runs a buffer length ahead of playback, and starts on the next track early to crossfade
+    void scheduleAboutToFinish(uint64_t position)
     {
-        const auto prevFormat = std::exchange(format, nextFormat);
+        if(aboutToFinishSent || duration == 0) {
+            return;
+        }
 
-        if(settings->value<Settings::Core::GaplessPlayback>() && prevFormat == format
+        const uint64_t lead = bufferLength + PreloadWindow + crossfadeLength();
+        if(position + lead >= duration) {
+            finishTimer()->stop();
+            notifyAboutToFinish();
+        }
+        else if(state == PlayingState) {
+            finishTimer()->start(static_cast<int>(duration - lead - position));
+        }
+        else {
+            finishTimer()->stop();
+        }
+    }
+
+    void notifyAboutToFinish()
+    {
+        if(!std::exchange(aboutToFinishSent, true)) {
+            emit self->trackAboutToFinish();
+        }
+    }
+
+    [[nodiscard]] uint64_t crossfadeLength() const
+    {
+        return static_cast<uint64_t>(std::max(0, settings->value<Settings::Core::CrossfadeLength>()));
+    }
+
+    // Returns where to start fading into the next track, if there's room to
+    [[nodiscard]] Crossfade crossfade() const
+    {
+        const uint64_t length = crossfadeLength();
+        if(length == 0 || duration < length * 2 || nextTrack.track.duration() < length * 2) {
+            return {};
+        }
+
+        return {.position = duration - length, .length = length};
+    }
+
+    void onTrackLoaded(const Track& track)
+    {
+        auto loaded = preloader.take();
+        if(!loaded.decoder || !(loaded.track == track) || !(nextTrack.track == track)) {
+            return;
+        }
+
+        nextTrack = std::move(loaded);
+        loadSeekTable(nextTrack.decoder.get(), track);
+
+        // Only a track with the same output format can follow on without reinitialising the output
+        const bool gapless = settings->value<Settings::Core::GaplessPlayback>() || crossfadeLength() > 0;
+        if(gapless && status != NoTrack && status != InvalidTrack
+           && outputFormat(nextTrack.decoder->format()) == format) {
+            decodeWorker.setNextDecoder(nextTrack.decoder.get(), std::move(nextTrack.preroll), crossfade());
+            spliceQueued = true;
+        }
+    }
+
+    void onTrackStarted()
+    {
+        if(!spliceQueued || decodeWorker.decoder() != nextTrack.decoder.get()) {
+            return;
+        }
+
+        // The previous decoder is no longer in use by the decode worker
+        storeSeekTable();
+
+        track             = nextTrack.track;
+        decoder           = std::move(nextTrack.decoder);
+        duration          = nextTrack.track.duration();
+        splicedTrack      = std::exchange(nextTrack, {}).track;
+        spliceQueued      = false;
+        aboutToFinishSent = false;
+
+        updateReplayGain();
+
+        sendPosition(0);
+        scheduleAboutToFinish(0);
+        changeTrackStatus(EndOfTrack);
+    }
+
+    // Must only be called while decoding is stopped
+    void cancelSplice()
+    {
+        if(!std::exchange(spliceQueued, false)) {
+            return;
+        }
+
+        std::vector<AudioBuffer> preroll;
+        if(decodeWorker.takeNextDecoder(preroll)) {
+            nextTrack.preroll = std::move(preroll);
+            return;
+        }
+
+        // Already switched to, so go back to the current track and rewind the next in case it's changed to
+        decodeWorker.setDecoder(decoder.get());
+        if(nextTrack.decoder->isSeekable()) {
+            nextTrack.decoder->stop();
+        }
+        else {
+            nextTrack = {};
+        }
+    }
+
+    bool loadTrack(const Track& track)
+    {
+        auto next = std::exchange(nextTrack, {});
+
+        if(next.decoder && next.track == track) {
+            decoder = std::move(next.decoder);
+            decodeWorker.setDecoder(decoder.get(), std::move(next.preroll));
+            return true;
+        }
+
+        preloader.clear();
+
+        // Use a new decoder so any change in the read-ahead settings is picked up
+        decoder = Audio::createDecoder(track.filepath(), readAheadOptions());
+        decodeWorker.setDecoder(decoder.get());
+
+        if(!decoder->init(track.filepath())) {
+            return false;
+        }
+
+        loadSeekTable(decoder.get(), track);
+
+        return true;
+    }
+
+    // Returns the format the output is opened in for a track decoded in @p trackFormat
+    [[nodiscard]] AudioFormat outputFormat(const AudioFormat& trackFormat) const
+    {
+        const int sampleRate = settings->value<Settings::Core::OutputSampleRate>();
+        if(sampleRate <= 0 || !trackFormat.isValid()) {
+            // Anything the device can't take natively is converted by the decode worker, so it's never hidden
+            return renderer->negotiateFormat(trackFormat);
+        }
+
+        // Always use the same sample format too, so only a change in channel count reopens the device
+        return renderer->negotiateFormat({SampleFormat::S32, sampleRate, trackFormat.channelCount()});
+    }
+
+    bool updateFormat(const AudioFormat& trackFormat)
+    {
+        const auto prevFormat = std::exchange(format, outputFormat(trackFormat));
+
+        ringBuffer.init(format, bufferLength);
+        decodeWorker.setOutputFormat(format);
+        dspChain.prepare(format);
+
+        const bool fixedFormat = settings->value<Settings::Core::OutputSampleRate>() > 0;
+        if((fixedFormat || settings->value<Settings::Core::GaplessPlayback>()) && prevFormat == format
            && state != PlaybackState::PausedState) {
             return true;
         }
@@ -150,13 +497,17 @@ struct AudioPlaybackEngine::Private
             return false;
         }
 
+        updateBitPerfect();
+
         return true;
     }
 
-    void startPlayback() const
+    void startPlayback()
     {
-        decoder->start();
-        bufferTimer->start();
+        if(decodeWorker.state() != Worker::Running) {
+            decoder->start();
+            decodeWorker.startDecoding();
+        }
         renderer->start();
     }
 
@@ -170,46 +521,58 @@ struct AudioPlaybackEngine::Private
 
     void pauseOutput(bool pause) const
     {
-        if(pause) {
-            bufferTimer->stop();
-        }
-        else {
-            bufferTimer->start();
-        }
+        // The decode thread keeps running until the ring buffer is full
+        renderer->pause(pause, true);
+    }
 
-        renderer->pause(pause);
+    void stopDecoding()
+    {
+        decodeWorker.stopDecoding();
+        cancelSplice();
+        decodeWorker.reset();
     }
 
     void resetWorkers()
     {
-        bufferTimer->stop();
+        stopDecoding();
         clock.setPaused(true);
         renderer->reset();
-        totalBufferTime = 0;
     }
 
     void stopWorkers()
     {
-        bufferTimer->stop();
+        stopDecoding();
         clock.setPaused(true);
         clock.sync();
         renderer->stop();
         decoder->stop();
-        totalBufferTime = 0;
     }
 };
 
-AudioPlaybackEngine::AudioPlaybackEngine(SettingsManager* settings, QObject* parent)
+AudioPlaybackEngine::AudioPlaybackEngine(SettingsManager* settings, DbConnectionPoolPtr dbPool,
+                                         std::shared_ptr<AudioAnalysisBus> analysisBus, QObject* parent)
     : AudioEngine{parent}
-    , p{std::make_unique<Private>(this, settings)}
+    , p{std::make_unique<Private>(this, settings, std::move(dbPool), std::move(analysisBus))}
 { }
 
 AudioPlaybackEngine::~AudioPlaybackEngine()
 {
     p->stopWorkers();
+    p->storeSeekTable();
+
+    p->decodeWorker.closeThread();
+    p->decodeThread.quit();
+    p->decodeThread.wait();
+
+    p->preloader.closeThread();
+    p->preloadThread.quit();
+    p->preloadThread.wait();
 
-    if(p->positionUpdateTimer) {
-        p->positionUpdateTimer->deleteLater();
+    if(p->aboutToFinishTimer) {
+        p->aboutToFinishTimer->deleteLater();
+    }
+    if(p->statsTimer) {
+        p->statsTimer->deleteLater();
     }
 }
 
@@ -226,23 +589,35 @@ void AudioPlaybackEngine::seek(uint64_t pos)
 
     if(p->state == PlayingState) {
         p->clock.setPaused(false);
-        p->bufferTimer->start();
+        p->decodeWorker.startDecoding();
         p->renderer->start();
     }
-    else {
-        p->updatePosition();
-    }
+
+    p->updatePosition(true);
 }
 
 void AudioPlaybackEngine::changeTrack(const Track& track)
 {
+    // Already playing, having been spliced onto the end of the previous track
+    if(p->splicedTrack.isValid() && std::exchange(p->splicedTrack, {}) == track) {
+        p->changeTrackStatus(LoadedTrack);
+        return;
+    }
+
     p->stopWorkers();
+    p->storeSeekTable();
 
-    emit positionChanged(0);
+    p->sendPosition(0);
 
     p->clock.setPaused(true);
     p->clock.sync();
 
+    p->track             = track;
+    p->duration          = track.duration();
+    p->aboutToFinishSent = false;
+
+    p->updateReplayGain();
+
     if(!track.isValid()) {
         p->changeTrackStatus(InvalidTrack);
         return;
@@ -250,7 +625,7 @@ void AudioPlaybackEngine::changeTrack(const Track& track)
 
     p->changeTrackStatus(LoadingTrack);
 
-    if(!p->decoder->init(track.filepath())) {
+    if(!p->loadTrack(track)) {
         p->changeTrackStatus(InvalidTrack);
         return;
     }
@@ -267,6 +642,25 @@ void AudioPlaybackEngine::changeTrack(const Track& track)
     }
 }
 
+void AudioPlaybackEngine::prepareNextTrack(const Track& track)
+{
+    if(!track.isValid() || p->nextTrack.track == track) {
+        return;
+    }
+
+    if(p->spliceQueued) {
+        std::vector<AudioBuffer> preroll;
+        if(!p->decodeWorker.takeNextDecoder(preroll)) {
+            // Already being decoded, so it's too late to change
+            return;
+        }
+        p->spliceQueued = false;
+    }
+
+    p->nextTrack = {.track = track};
+    p->preloader.load(track, p->readAheadOptions());
+}
+
 void AudioPlaybackEngine::setState(PlaybackState state)
 {
     const auto prevState = p->changeState(state);
@@ -285,6 +679,8 @@ void AudioPlaybackEngine::setState(PlaybackState state)
     else if(state == PausedState) {
         p->pauseOutput(true);
     }
+
+    p->updateBitPerfect();
 }
 
 void AudioPlaybackEngine::play()
@@ -295,12 +691,11 @@ void AudioPlaybackEngine::play()
 
     if(p->status == EndOfTrack && p->state == StoppedState) {
         seek(0);
-        emit positionChanged(0);
     }
 
     setState(PlayingState);
     p->changeTrackStatus(BufferedTrack);
-    p->positionTimer()->start();
+    p->updatePosition(true);
 }
 
 void AudioPlaybackEngine::pause()
@@ -311,26 +706,51 @@ void AudioPlaybackEngine::pause()
 
     if(p->status == EndOfTrack && p->state == StoppedState) {
         seek(0);
-        emit positionChanged(0);
     }
 
     setState(PausedState);
-    p->positionTimer()->stop();
+    p->updatePosition(true);
     p->changeTrackStatus(BufferedTrack);
 }
 
 void AudioPlaybackEngine::stop()
 {
     setState(StoppedState);
-    p->positionTimer()->stop();
-    p->lastPosition = 0;
-    emit positionChanged(0);
+    if(p->aboutToFinishTimer) {
+        p->aboutToFinishTimer->stop();
+    }
+    p->sendPosition(0);
 }
 
 void AudioPlaybackEngine::setVolume(double volume)
 {
     p->volume = volume;
     p->renderer->updateVolume(volume);
+    p->updateBitPerfect();
+}
+
+void AudioPlaybackEngine::setDsps(const std::vector<DspCreator>& dsps)
+{
+    // Stages are created and prepared here so nothing is allocated on the decode thread
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    for(const auto& creator : dsps) {
+        if(auto node = creator()) {
+            nodes.push_back(std::move(node));
+        }
+    }
+
+    const bool decoding = p->decodeWorker.state() == Worker::Running;
+    if(decoding) {
+        p->decodeWorker.stopDecoding();
+    }
+
+    p->dspChain.setNodes(std::move(nodes));
+
+    if(decoding) {
+        p->decodeWorker.startDecoding();
+    }
+
+    p->updateBitPerfect();
 }
 
 void AudioPlaybackEngine::setAudioOutput(const OutputCreator& output)
@@ -341,7 +761,7 @@ void AudioPlaybackEngine::setAudioOutput(const OutputCreator& output)
     p->renderer->pause(playing);
 
     if(playing) {
-        p->bufferTimer->stop();
+        p->decodeWorker.stopDecoding();
     }
 
     p->renderer->updateOutput(output);
@@ -368,7 +788,7 @@ void AudioPlaybackEngine::setOutputDevice(const QString& device)
     p->renderer->pause(playing);
 
     if(playing) {
-        p->bufferTimer->stop();
+        p->decodeWorker.stopDecoding();
     }
 
     p->renderer->updateDevice(device);
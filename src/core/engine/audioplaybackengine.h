@@ -20,8 +20,10 @@
 #pragma once
 
 #include <core/engine/audioengine.h>
+#include <utils/database/dbconnectionpool.h>
 
 namespace Fooyin {
+class AudioAnalysisBus;
 class SettingsManager;
 
 class AudioPlaybackEngine : public AudioEngine
@@ -29,13 +31,15 @@ class AudioPlaybackEngine : public AudioEngine
     Q_OBJECT
 
 public:
-    explicit AudioPlaybackEngine(SettingsManager* settings, QObject* parent = nullptr);
+    AudioPlaybackEngine(SettingsManager* settings, DbConnectionPoolPtr dbPool,
+                        std::shared_ptr<AudioAnalysisBus> analysisBus, QObject* parent = nullptr);
     ~AudioPlaybackEngine() override;
 
 public slots:
     void seek(uint64_t pos) override;
 
     void changeTrack(const Track& track) override;
+    void prepareNextTrack(const Track& track) override;
     void setState(PlaybackState state) override;
 
     void play() override;
@@ -43,6 +47,7 @@ public slots:
     void stop() override;
 
     void setVolume(double volume) override;
+    void setDsps(const std::vector<DspCreator>& dsps) override;
 
     void setAudioOutput(const OutputCreator& output) override;
     void setOutputDevice(const QString& device) override;
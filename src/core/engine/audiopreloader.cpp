@@ -0,0 +1,111 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiopreloader.h"
+
+#include "decoderfactory.h"
+
+#include <QDebug>
+
+// Enough to cover the gap while the decode thread switches over
+constexpr auto PrerollLength = 500;
+
+namespace Fooyin {
+AudioPreloader::AudioPreloader(QObject* parent)
+    : Worker{parent}
+    , m_generation{0}
+{ }
+
+void AudioPreloader::load(const Track& track, const ReadAheadOptions& options)
+{
+    uint64_t generation{0};
+    {
+        const std::scoped_lock lock{m_guard};
+        generation = ++m_generation;
+        m_loaded   = {};
+        setState(Running);
+    }
+
+    QMetaObject::invokeMethod(this, [this, track, options, generation]() { loadTrack(track, options, generation); });
+}
+
+PreloadedTrack AudioPreloader::take()
+{
+    const std::scoped_lock lock{m_guard};
+    return std::exchange(m_loaded, {});
+}
+
+void AudioPreloader::clear()
+{
+    const std::scoped_lock lock{m_guard};
+    ++m_generation;
+    m_loaded = {};
+    setState(Idle);
+}
+
+void AudioPreloader::loadTrack(const Track& track, const ReadAheadOptions& options, uint64_t generation)
+{
+    if(!isCurrent(generation)) {
+        return;
+    }
+
+    auto decoder = Audio::createDecoder(track.filepath(), options);
+    if(!decoder->init(track.filepath())) {
+        qDebug() << "Unable to preload" << track.filepath();
+        const std::scoped_lock lock{m_guard};
+        if(m_generation.load() == generation) {
+            setState(Idle);
+        }
+        return;
+    }
+
+    decoder->start();
+
+    std::vector<AudioBuffer> preroll;
+    uint64_t prerollDuration{0};
+
+    while(isCurrent(generation) && prerollDuration < PrerollLength) {
+        auto buffer = decoder->readBuffer();
+        if(!buffer.isValid()) {
+            break;
+        }
+        prerollDuration += buffer.duration();
+        preroll.push_back(std::move(buffer));
+    }
+
+    {
+        // Checked under the lock, as the track may have been cleared or superseded while loading
+        const std::scoped_lock lock{m_guard};
+        if(closing() || m_generation.load() != generation) {
+            return;
+        }
+        m_loaded = {.track = track, .decoder = std::move(decoder), .preroll = std::move(preroll)};
+        setState(Idle);
+    }
+
+    emit trackLoaded(track);
+}
+
+bool AudioPreloader::isCurrent(uint64_t generation) const
+{
+    return !closing() && m_generation.load(std::memory_order_acquire) == generation;
+}
+} // namespace Fooyin
+
+#include "moc_audiopreloader.cpp"
@@ -0,0 +1,76 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "engine/readaheadfile.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/audiodecoder.h>
+#include <core/track.h>
+#include <utils/worker.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Fooyin {
+struct PreloadedTrack
+{
+    Track track;
+    std::unique_ptr<AudioDecoder> decoder;
+    // Buffers already read from the decoder
+    std::vector<AudioBuffer> preroll;
+};
+
+/*!
+ * Opens, probes and pre-decodes the start of a track on its own thread, so the engine can
+ * move on to it without waiting on the filesystem.
+ */
+class AudioPreloader : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit AudioPreloader(QObject* parent = nullptr);
+
+    /*!
+     * Starts loading @p track, replacing any previously loaded track. The file is read ahead as set by @p options.
+     * Safe to call from any thread.
+     */
+    void load(const Track& track, const ReadAheadOptions& options);
+    /** Takes the loaded track, if any. Safe to call from any thread. */
+    PreloadedTrack take();
+    /** Abandons any load in progress and discards the loaded track. Safe to call from any thread. */
+    void clear();
+
+signals:
+    /** Emitted once @p track has been opened and its first buffers decoded. */
+    void trackLoaded(const Track& track);
+
+private:
+    void loadTrack(const Track& track, const ReadAheadOptions& options, uint64_t generation);
+    [[nodiscard]] bool isCurrent(uint64_t generation) const;
+
+    std::mutex m_guard;
+    PreloadedTrack m_loaded;
+    // Bumped by every load and clear, so a load which has been superseded never stores its result
+    std::atomic<uint64_t> m_generation;
+};
+} // namespace Fooyin
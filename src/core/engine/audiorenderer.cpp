@@ -19,44 +19,152 @@
 
 #include "audiorenderer.h"
 
+#include "audioanalysisbus.h"
+#include "audiogain.h"
+#include "audioringbuffer.h"
+#include "enginemetrics.h"
+
 #include <core/engine/audiobuffer.h>
 #include <core/engine/audiooutput.h>
-#include <utils/threadqueue.h>
+#include <utils/lockfreeringbuffer.h>
 
 #include <QDebug>
 #include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
 #include <utility>
 
+using namespace std::chrono_literals;
+
+// Length of the ramp used when the volume changes
+constexpr auto VolumeRampLength = 20;
+// Length of the fade used when pausing or stopping
+constexpr auto FadeLength = 30;
+// Extra time allowed for a fade to be rendered before giving up on it, such as if the device stops requesting audio
+constexpr auto FadeTimeout = 100;
+// The clock only drifts slowly, so it's resynced this often rather than on every buffer
+constexpr auto ClockSyncInterval = 500ms;
+// Events waiting to be sent from the engine thread; they're rare, so this is never close to filling
+constexpr auto MaxPendingEvents = 64;
+
+namespace {
+Fooyin::AudioClock::Clock::duration toClockDuration(double seconds)
+{
+    return std::chrono::duration_cast<Fooyin::AudioClock::Clock::duration>(std::chrono::duration<double>{seconds});
+}
+} // namespace
+
 namespace Fooyin {
+/** Something seen while rendering, passed on as a signal from the engine thread. */
+struct RenderEvent
+{
+    enum Type : uint8_t
+    {
+        BufferStarted,
+        TrackStarted,
+        Finished,
+        // A fade out has been rendered; playTime is when its end will be heard
+        FadeFinished
+    };
+
+    Type type{BufferStarted};
+    uint64_t startTime{0};
+    AudioClock::TimePoint playTime;
+    // The fade a FadeFinished event belongs to, so one which has since been cancelled is ignored
+    uint32_t fade{0};
+};
+
 struct AudioRenderer::Private
 {
     AudioRenderer* self;
 
+    AudioRingBuffer* ringBuffer;
+    EngineMetrics* metrics;
+    AudioAnalysisBus* analysisBus;
     std::unique_ptr<AudioOutput> audioOutput;
     AudioFormat format;
-    double volume{0.0};
+    std::atomic<double> volume{0.0};
+    std::atomic<double> replayGain{1.0};
+    int latency{0};
+    bool exclusive{false};
     int bufferSize{0};
 
     bool bufferPrefilled{false};
 
-    ThreadQueue<AudioBuffer> bufferQueue{false};
     AudioBuffer tempBuffer;
     int totalSamplesWritten{0};
-    int currentBufferOffset{0};
 
     bool isRunning{false};
 
+    bool pullMode{false};
+    std::atomic<bool> pullEnabled{false};
+    std::atomic<bool> inCallback{false};
+
+    // What to do once the fade out has finished
+    enum class FadeAction : uint8_t
+    {
+        None,
+        Pause,
+        Stop
+    };
+    FadeAction fadeAction{FadeAction::None};
+    std::atomic<uint32_t> fadeId{0};
+    // When stopping in pull mode, the fade out is taken from the ring buffer up front and played from here,
+    // so the ring buffer can be reused as soon as the renderer has stopped
+    AudioBuffer fadeTail;
+    int fadeTailPos{0};
+    std::atomic<bool> playingTail{false};
+
+    // Only touched by whichever thread renders the audio, or while rendering is stopped
+    Audio::GainRamp gain;
+    std::atomic<bool> fadingOut{false};
+    std::atomic<bool> fadeFinished{false};
+    AudioClock::TimePoint lastSync;
+    bool syncPending{true};
+    // Set when the last read ran out of audio before reaching the end of the track
+    bool starved{false};
+    // Running out isn't an underrun before any audio has arrived, as after a seek, or once the track has ended
+    bool audioRead{false};
+    bool trackEnded{false};
+
+    // Written by whichever thread renders the audio, so the device's thread never has to allocate a queued event
+    LockFreeRingBuffer<RenderEvent> events{MaxPendingEvents};
+
     QTimer* writeTimer;
+    QTimer* fadeTimer;
+    QTimer* eventTimer;
 
-    explicit Private(AudioRenderer* self_)
+    Private(AudioRenderer* self_, AudioRingBuffer* ringBuffer_, EngineMetrics* metrics_,
+            AudioAnalysisBus* analysisBus_)
         : self{self_}
+        , ringBuffer{ringBuffer_}
+        , metrics{metrics_}
+        , analysisBus{analysisBus_}
         , writeTimer{new QTimer(self)}
+        , fadeTimer{new QTimer(self)}
+        , eventTimer{new QTimer(self)}
     {
         QObject::connect(writeTimer, &QTimer::timeout, self, [this]() { writeNext(); });
+        QObject::connect(eventTimer, &QTimer::timeout, self, [this]() { sendEvents(); });
+
+        fadeTimer->setSingleShot(true);
+        QObject::connect(fadeTimer, &QTimer::timeout, self, [this]() { completeFade(); });
     }
 
     bool initOutput()
     {
+        pullMode = audioOutput->supportsPullMode();
+        if(pullMode) {
+            audioOutput->setPullCallback(
+                [this](std::byte* data, int frames, double delay) { return pullAudio(data, frames, delay); });
+        }
+
+        audioOutput->setLatency(latency);
+        audioOutput->setExclusive(exclusive);
+
         if(!audioOutput->init(format)) {
             return false;
         }
@@ -65,6 +173,11 @@ struct AudioRenderer::Private
         bufferSize = audioOutput->bufferSize();
         updateInterval();
 
+        tempBuffer = {format, 0};
+        tempBuffer.reserve(static_cast<size_t>(format.bytesForFrames(bufferSize)));
+        fadeTail = {format, 0};
+        fadeTail.reserve(static_cast<size_t>(format.bytesForFrames(format.framesForDuration(FadeLength))));
+
         return true;
     }
 
@@ -72,17 +185,62 @@ struct AudioRenderer::Private
     {
         const auto interval = static_cast<int>(static_cast<double>(bufferSize) / format.sampleRate() * 1000 * 0.25);
         writeTimer->setInterval(interval);
+        eventTimer->setInterval(interval);
+    }
+
+    void postEvent(RenderEvent::Type type, uint64_t startTime = 0, AudioClock::TimePoint playTime = {})
+    {
+        const RenderEvent event{.type = type, .startTime = startTime, .playTime = playTime};
+        events.write(&event, 1);
+    }
+
+    void sendEvents()
+    {
+        RenderEvent event;
+        while(events.read(&event, 1) == 1) {
+            switch(event.type) {
+                case(RenderEvent::BufferStarted):
+                    emit self->bufferStarted(event.startTime, event.playTime);
+                    break;
+                case(RenderEvent::TrackStarted):
+                    emit self->trackStarted();
+                    break;
+                case(RenderEvent::Finished):
+                    emit self->finished();
+                    break;
+                case(RenderEvent::FadeFinished):
+                    if(event.fade == fadeId.load()) {
+                        fadeRendered(event.playTime);
+                    }
+                    break;
+            }
+        }
+
+        // Keep going after stopping until anything rendered beforehand has been sent, and any fade has finished
+        if(!isRunning && fadeAction == FadeAction::None) {
+            eventTimer->stop();
+        }
     }
 
     void writeNext()
     {
-        if(!isRunning || bufferQueue.empty() || !audioOutput->initialised()) {
+        if(!isRunning || !audioOutput->initialised()) {
             return;
         }
 
-        const int samples = audioOutput->currentState().freeSamples;
+        const OutputState state = audioOutput->currentState();
+        const int samples       = state.freeSamples;
+
+        const int rendered = samples > 0 ? renderAudio(samples, state.delay) : 0;
+        // Already on the engine thread, so there's no need to wait for the event timer
+        sendEvents();
+
+        // Only counts once the output has played everything it was given
+        if(bufferPrefilled && starved && state.queuedSamples == 0) {
+            metrics->recordUnderrun(samples - rendered);
+        }
 
-        if((samples == 0 && totalSamplesWritten > 0) || (samples > 0 && renderAudio(samples) == samples)) {
+        if((samples == 0 && totalSamplesWritten > 0) || (samples > 0 && rendered == samples)) {
             if(!bufferPrefilled) {
                 bufferPrefilled = true;
                 audioOutput->start();
@@ -90,69 +248,272 @@ struct AudioRenderer::Private
         }
     }
 
-    int writeAudioSamples(int samples)
+    // @p delay is the time in seconds until the first frame read will be heard
+    int readFromRing(std::byte* data, int frames, double delay)
     {
-        tempBuffer.clear();
-
-        int samplesBuffered{0};
+        const auto now = AudioClock::Clock::now();
+        int framesRead{0};
+        starved = false;
 
-        const int sstride = format.bytesPerFrame();
+        if(metrics->isEnabled()) {
+            metrics->recordBufferLevel(ringBuffer->framesAvailable());
+            metrics->recordOutputDelay(delay);
+        }
 
-        while(isRunning && !bufferQueue.empty() && samplesBuffered < samples) {
-            const AudioBuffer& buffer = bufferQueue.front();
+        while(framesRead < frames) {
+            AudioRingBuffer::Marker marker;
+            if(ringBuffer->takeMarker(marker)) {
+                if(marker.endOfTrack) {
+                    trackEnded = true;
+                    postEvent(RenderEvent::Finished);
+                    break;
+                }
+                if(marker.trackStart) {
+                    postEvent(RenderEvent::TrackStarted);
+                }
+                if(marker.trackStart || std::exchange(syncPending, false) || now - lastSync >= ClockSyncInterval) {
+                    lastSync = now;
+                    // Everything read before the marker plays first
+                    const double playDelay = delay + (static_cast<double>(framesRead) / format.sampleRate());
+                    postEvent(RenderEvent::BufferStarted, marker.startTime, now + toClockDuration(playDelay));
+                }
+                continue;
+            }
 
-            if(!buffer.isValid()) {
-                // End of file
-                currentBufferOffset = 0;
-                bufferQueue.dequeue();
-                QMetaObject::invokeMethod(self, &AudioRenderer::finished);
-                return samplesBuffered;
+            const int count = ringBuffer->readFrames(data + format.bytesForFrames(framesRead), frames - framesRead);
+            if(count == 0) {
+                starved = audioRead && !trackEnded;
+                break;
             }
 
-            const int bytesLeft = buffer.byteCount() - currentBufferOffset;
+            audioRead  = true;
+            trackEnded = false;
+            framesRead += count;
+        }
 
-            if(bytesLeft <= 0) {
-                currentBufferOffset = 0;
-                emit self->bufferProcessed(buffer);
-                bufferQueue.dequeue();
-                continue;
-            }
+        return framesRead;
+    }
 
-            const int sampleCount = std::min(bytesLeft / sstride, samples - samplesBuffered);
-            const int bytes       = sampleCount * sstride;
-            const auto fdata      = buffer.constData().subspan(currentBufferOffset, static_cast<size_t>(bytes));
+    [[nodiscard]] double targetGain() const
+    {
+        if(fadingOut) {
+            return 0.0;
+        }
+        return (audioOutput->canHandleVolume() ? 1.0 : volume.load()) * replayGain.load();
+    }
 
-            if(!tempBuffer.isValid()) {
-                tempBuffer = {fdata, buffer.format(), buffer.startTime()};
+    int renderFrames(std::byte* data, int frames, double delay)
+    {
+        const double target = targetGain();
+        if(target != gain.target()) {
+            if(fadingOut) {
+                gain.rampTo(target, format.framesForDuration(FadeLength), Audio::RampShape::Logarithmic);
             }
             else {
-                tempBuffer.append(fdata);
+                const bool fadingIn = gain.gain() == 0.0;
+                gain.rampTo(target, format.framesForDuration(fadingIn ? FadeLength : VolumeRampLength),
+                            fadingIn ? Audio::RampShape::Logarithmic : Audio::RampShape::Linear);
             }
+        }
 
-            samplesBuffered += sampleCount;
-            currentBufferOffset += bytes;
+        if(fadingOut) {
+            // Hold back the remaining audio once faded out, so it's still there to resume from
+            frames = std::min(frames, gain.remainingFrames());
+            if(frames == 0) {
+                finishFade(delay);
+                return 0;
+            }
         }
 
-        tempBuffer.fillRemainingWithSilence();
+        const int framesRead = readFromRing(data, frames, delay);
 
-        if(!tempBuffer.isValid()) {
-            return 0;
+        // Visualisations are fed before the gain, so they don't follow the volume or fades
+        if(framesRead > 0 && analysisBus->isEnabled()) {
+            analysisBus->publish(format, data, framesRead, AudioClock::Clock::now() + toClockDuration(delay));
         }
 
-        return samplesBuffered;
+        gain.process(format, data, framesRead);
+
+        if(fadingOut && (framesRead < frames || !gain.isRamping())) {
+            finishFade(delay + (static_cast<double>(framesRead) / format.sampleRate()));
+        }
+
+        return framesRead;
     }
 
-    int renderAudio(int samples)
+    // @p delay is the time in seconds until the end of the fade will be heard
+    void finishFade(double delay)
     {
-        if(writeAudioSamples(samples) == 0) {
-            return 0;
+        if(!fadeFinished.exchange(true)) {
+            const RenderEvent event{.type     = RenderEvent::FadeFinished,
+                                    .playTime = AudioClock::Clock::now() + toClockDuration(delay),
+                                    .fade     = fadeId.load()};
+            events.write(&event, 1);
         }
+    }
 
-        if(!audioOutput->canHandleVolume()) {
-            tempBuffer.adjustVolumeOfSamples(volume);
+    // Closes the output so it's reopened with any new settings by the next init
+    void closeOutput()
+    {
+        settleFade();
+        bufferPrefilled = false;
+        disablePull();
+
+        if(audioOutput->initialised()) {
+            audioOutput->uninit();
         }
+    }
+
+    void resetGain()
+    {
+        fadingOut.store(false);
+        gain.setGain((audioOutput && !audioOutput->canHandleVolume() ? volume.load() : 1.0) * replayGain.load());
+    }
+
+    void setOutputPaused(bool paused)
+    {
+        if(audioOutput && audioOutput->initialised()) {
+            audioOutput->setPaused(paused);
+        }
+
+        isRunning = !paused;
+
+        if(pullMode) {
+            pullEnabled.store(!paused);
+        }
+        if(isRunning) {
+            eventTimer->start();
+        }
+    }
+
+    /*!
+     * Carries out @p action once the fade out about to be started has been rendered (for a stop) or heard (for a
+     * pause), or after @p timeout ms if it never is.
+     */
+    void awaitFade(FadeAction action, int timeout)
+    {
+        ++fadeId;
+        fadeFinished.store(false);
+        fadeAction = action;
+        fadeTimer->start(timeout);
+    }
+
+    // Called on the engine thread once the fade out has been rendered, and will be heard at @p playTime
+    void fadeRendered(AudioClock::TimePoint playTime)
+    {
+        if(fadeAction == FadeAction::Stop) {
+            completeFade();
+        }
+        else if(fadeAction == FadeAction::Pause) {
+            // Leave time for the fade to make it through the output's buffer
+            const auto remaining
+                = std::chrono::duration_cast<std::chrono::milliseconds>(playTime - AudioClock::Clock::now());
+            fadeTimer->start(static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+        }
+    }
+
+    void completeFade()
+    {
+        fadeTimer->stop();
+
+        switch(std::exchange(fadeAction, FadeAction::None)) {
+            case(FadeAction::Pause):
+                setOutputPaused(true);
+                break;
+            case(FadeAction::Stop):
+                disablePull();
+                playingTail.store(false);
+                break;
+            case(FadeAction::None):
+                break;
+        }
+    }
+
+    // Finishes a stop still waiting on its fade, or abandons a pending pause, before anything else is changed
+    void settleFade()
+    {
+        if(fadeAction == FadeAction::Stop) {
+            completeFade();
+        }
+
+        fadeAction = FadeAction::None;
+        fadeTimer->stop();
+    }
+
+    void fadeOutNow()
+    {
+        fadeFinished.store(false);
+        fadingOut.store(true);
+
+        // Fit the fade into whatever space the output has left
+        const OutputState state = audioOutput->currentState();
+        const int frames        = std::min(state.freeSamples, format.framesForDuration(FadeLength));
+        gain.rampTo(0.0, frames, Audio::RampShape::Logarithmic);
+        renderAudio(frames, state.delay);
+    }
+
+    // Stops with the fade out still to be requested by the device
+    void fadeOutTail()
+    {
+        disablePull();
+
+        const int frames = format.framesForDuration(FadeLength);
+        fadeTail.resize(static_cast<size_t>(format.bytesForFrames(frames)));
+        gain.rampTo(0.0, frames, Audio::RampShape::Logarithmic);
+
+        const int framesRead = readFromRing(fadeTail.data(), frames, 0.0);
+        gain.process(format, fadeTail.data(), framesRead);
+        fadeTail.resize(static_cast<size_t>(format.bytesForFrames(framesRead)));
+        fadeTailPos = 0;
+
+        finishStop();
 
-        if(!tempBuffer.isValid()) {
+        awaitFade(FadeAction::Stop, FadeLength + FadeTimeout);
+        playingTail.store(true);
+        pullEnabled.store(true);
+    }
+
+    // Called from the device's thread while stopping; nothing more is played once the fade out has been
+    int playTail(std::byte* data, int frames, double delay)
+    {
+        const auto tail = fadeTail.constData().subspan(static_cast<size_t>(fadeTailPos));
+        const int count = std::min(frames, format.framesForBytes(static_cast<int>(tail.size())));
+        const int bytes = format.bytesForFrames(count);
+
+        std::memcpy(data, tail.data(), static_cast<size_t>(bytes));
+        fadeTailPos += bytes;
+
+        if(fadeTailPos >= fadeTail.byteCount()) {
+            finishFade(delay + (static_cast<double>(count) / format.sampleRate()));
+        }
+
+        return count;
+    }
+
+    void finishStop()
+    {
+        isRunning = false;
+        writeTimer->stop();
+        disablePull();
+        resetGain();
+
+        clearBuffers();
+    }
+
+    int writeAudioSamples(int samples, double delay)
+    {
+        tempBuffer.resize(static_cast<size_t>(format.bytesForFrames(samples)));
+
+        const int samplesBuffered = renderFrames(tempBuffer.data(), samples, delay);
+
+        tempBuffer.resize(static_cast<size_t>(format.bytesForFrames(samplesBuffered)));
+
+        return samplesBuffered;
+    }
+
+    int renderAudio(int samples, double delay)
+    {
+        if(writeAudioSamples(samples, delay) == 0) {
             return 0;
         }
 
@@ -161,17 +522,80 @@ struct AudioRenderer::Private
 
         return samplesWritten;
     }
+
+    int pullAudio(std::byte* data, int frames, double delay)
+    {
+        // Paired with disablePull: once the flag is cleared, no new callback will touch the ring buffer
+        inCallback.store(true);
+        if(!pullEnabled.load()) {
+            inCallback.store(false);
+            return 0;
+        }
+
+        int framesRead{0};
+        if(playingTail.load()) {
+            framesRead = playTail(data, frames, delay);
+        }
+        else {
+            framesRead = renderFrames(data, frames, delay);
+            if(starved && !fadingOut) {
+                metrics->recordUnderrun(frames - framesRead);
+            }
+        }
+
+        inCallback.store(false);
+
+        return framesRead;
+    }
+
+    void disablePull()
+    {
+        pullEnabled.store(false);
+        while(inCallback.load()) {
+            std::this_thread::yield();
+        }
+    }
+
+    void startPull()
+    {
+        if(!audioOutput || !audioOutput->initialised()) {
+            return;
+        }
+
+        pullEnabled.store(true);
+
+        // The device will request audio itself, so there's nothing to prefill
+        if(!std::exchange(bufferPrefilled, true)) {
+            audioOutput->start();
+        }
+    }
+
+    void clearBuffers()
+    {
+        bufferPrefilled     = false;
+        totalSamplesWritten = 0;
+        syncPending         = true;
+        starved             = false;
+        audioRead           = false;
+        trackEnded          = false;
+        ringBuffer->clear();
+        tempBuffer.clear();
+        analysisBus->markDiscontinuity();
+    }
 };
 
-AudioRenderer::AudioRenderer(QObject* parent)
+AudioRenderer::AudioRenderer(AudioRingBuffer* buffer, EngineMetrics* metrics, AudioAnalysisBus* analysisBus,
+                             QObject* parent)
     : QObject{parent}
-    , p{std::make_unique<Private>(this)}
+    , p{std::make_unique<Private>(this, buffer, metrics, analysisBus)}
 {
     setObjectName(QStringLiteral("Renderer"));
 }
 
 AudioRenderer::~AudioRenderer()
 {
+    p->disablePull();
+
     if(p->audioOutput && p->audioOutput->initialised()) {
         p->audioOutput->uninit();
     }
@@ -185,6 +609,10 @@ bool AudioRenderer::init(const AudioFormat& format)
         return false;
     }
 
+    p->settleFade();
+    p->disablePull();
+    p->resetGain();
+
     if(p->audioOutput->initialised()) {
         p->audioOutput->uninit();
     }
@@ -194,50 +622,72 @@ bool AudioRenderer::init(const AudioFormat& format)
 
 void AudioRenderer::start()
 {
-    if(std::exchange(p->isRunning, true)) {
-        return;
+    // Only a pending stop needs finishing first; a pending pause is cancelled by resuming with pause()
+    if(p->fadeAction == Private::FadeAction::Stop) {
+        p->settleFade();
     }
 
-    p->writeTimer->start();
+    const bool wasRunning = std::exchange(p->isRunning, true);
+    p->eventTimer->start();
+
+    if(p->pullMode) {
+        p->startPull();
+    }
+    else if(!wasRunning) {
+        p->writeTimer->start();
+    }
 }
 
 void AudioRenderer::stop()
 {
-    p->isRunning = false;
-    p->writeTimer->stop();
-
-    p->bufferPrefilled     = false;
-    p->totalSamplesWritten = 0;
-    p->currentBufferOffset = 0;
-    p->bufferQueue.clear();
-    p->tempBuffer.reset();
+    p->settleFade();
+
+    if(p->isRunning && p->bufferPrefilled && p->audioOutput && p->audioOutput->initialised()) {
+        if(p->pullMode) {
+            p->fadeOutTail();
+            return;
+        }
+        p->fadeOutNow();
+    }
+
+    p->finishStop();
 }
 
 void AudioRenderer::reset()
 {
+    p->settleFade();
+    p->disablePull();
+    p->resetGain();
+
     if(p->audioOutput && p->audioOutput->initialised()) {
         p->audioOutput->reset();
     }
 
-    p->bufferPrefilled     = false;
-    p->totalSamplesWritten = 0;
-    p->currentBufferOffset = 0;
-    p->bufferQueue.clear();
-    p->tempBuffer.reset();
+    p->clearBuffers();
 }
 
-void AudioRenderer::pause(bool paused)
+void AudioRenderer::pause(bool paused, bool fade)
 {
-    if(p->audioOutput && p->audioOutput->initialised()) {
-        p->audioOutput->setPaused(paused);
+    const bool fadePending = p->fadeAction == Private::FadeAction::Pause;
+    p->settleFade();
+
+    if(!paused) {
+        // The output is only paused once the fade has finished; until then, just ramp back up
+        p->fadingOut.store(false);
+        if(!fadePending) {
+            p->setOutputPaused(false);
+        }
+        return;
     }
 
-    p->isRunning = !paused;
-}
+    if(fade && p->isRunning && p->audioOutput && p->audioOutput->initialised()) {
+        const auto delay = static_cast<int>(p->audioOutput->currentState().delay * 1000);
+        p->awaitFade(Private::FadeAction::Pause, FadeLength + delay + FadeTimeout);
+        p->fadingOut.store(true);
+        return;
+    }
 
-void AudioRenderer::queueBuffer(const AudioBuffer& buffer)
-{
-    p->bufferQueue.enqueue(buffer);
+    p->setOutputPaused(true);
 }
 
 void AudioRenderer::updateOutput(const OutputCreator& output)
@@ -247,6 +697,9 @@ void AudioRenderer::updateOutput(const OutputCreator& output)
         return;
     }
 
+    p->settleFade();
+    p->disablePull();
+
     if(p->audioOutput && p->audioOutput->initialised()) {
         p->audioOutput->uninit();
     }
@@ -261,7 +714,9 @@ void AudioRenderer::updateDevice(const QString& device)
         return;
     }
 
+    p->settleFade();
     p->bufferPrefilled = false;
+    p->disablePull();
 
     if(p->audioOutput->initialised()) {
         p->audioOutput->uninit();
@@ -272,6 +727,41 @@ void AudioRenderer::updateDevice(const QString& device)
     }
 }
 
+void AudioRenderer::updateLatency(int latency)
+{
+    if(std::exchange(p->latency, latency) != latency && p->audioOutput) {
+        p->closeOutput();
+    }
+}
+
+void AudioRenderer::updateExclusive(bool exclusive)
+{
+    if(std::exchange(p->exclusive, exclusive) != exclusive && p->audioOutput) {
+        p->closeOutput();
+    }
+}
+
+AudioFormat AudioRenderer::negotiateFormat(const AudioFormat& format) const
+{
+    if(!p->audioOutput || !format.isValid()) {
+        return format;
+    }
+
+    // Outputs only know about the exclusive flag once they've been initialised with it
+    p->audioOutput->setExclusive(p->exclusive);
+    return p->audioOutput->negotiateFormat(format);
+}
+
+bool AudioRenderer::isBitPerfect() const
+{
+    if(!p->audioOutput || !p->audioOutput->initialised() || !p->audioOutput->isBitPerfect()) {
+        return false;
+    }
+
+    // Volume and ReplayGain are both applied here unless the output handles volume itself
+    return p->targetGain() == 1.0;
+}
+
 void AudioRenderer::updateVolume(double volume)
 {
     p->volume = volume;
@@ -280,6 +770,12 @@ void AudioRenderer::updateVolume(double volume)
         p->audioOutput->setVolume(volume);
     }
 }
+
+void AudioRenderer::updateReplayGain(double gain)
+{
+    // Picked up by the next render, which ramps to it
+    p->replayGain = gain;
+}
 } // namespace Fooyin
 
 #include "moc_audiorenderer.cpp"
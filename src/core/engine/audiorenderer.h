@@ -19,36 +19,60 @@
 
 #pragma once
 
+#include "audioclock.h"
+
 #include <core/engine/audiooutput.h>
 
 #include <QObject>
 
 namespace Fooyin {
-class AudioBuffer;
+class AudioAnalysisBus;
 class AudioFormat;
+class AudioRingBuffer;
+class EngineMetrics;
 
 class AudioRenderer : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit AudioRenderer(QObject* parent = nullptr);
+    AudioRenderer(AudioRingBuffer* buffer, EngineMetrics* metrics, AudioAnalysisBus* analysisBus,
+                  QObject* parent = nullptr);
     ~AudioRenderer() override;
 
     bool init(const AudioFormat& format);
     void start();
     void stop();
     void reset();
-    void pause(bool paused);
-
-    void queueBuffer(const AudioBuffer& buffer);
+    /*!
+     * Pauses or resumes the output. If @p fade is set, the audio is faded out first
+     * and the output is only paused once the fade has been heard.
+     */
+    void pause(bool paused, bool fade = false);
 
     void updateOutput(const OutputCreator& output);
     void updateDevice(const QString& device);
+    /** Sets the requested output latency in ms, which is applied when the output is next initialised. */
+    void updateLatency(int latency);
+    /** Sets whether the output should open its device exclusively, which is applied when it's next initialised. */
+    void updateExclusive(bool exclusive);
+
+    /** Returns the format closest to @p format the output can play without converting it. */
+    [[nodiscard]] AudioFormat negotiateFormat(const AudioFormat& format) const;
+    /** Returns @c true if rendered audio reaches the device unaltered, i.e. with unity gain and no conversion. */
+    [[nodiscard]] bool isBitPerfect() const;
     void updateVolume(double volume);
+    /** Sets a linear gain to apply on top of the volume, such as the current track's ReplayGain. */
+    void updateReplayGain(double gain);
 
 signals:
-    void bufferProcessed(const AudioBuffer& buffer);
+    /*!
+     * Emitted when the buffer starting at @p startTime in the track is read from the ring buffer.
+     * @p playTime is when the output expects it to be heard.
+     */
+    void bufferStarted(uint64_t startTime, AudioClock::TimePoint playTime);
+    /** Emitted when playback reaches a track which was spliced onto the end of the previous one. */
+    void trackStarted();
     void finished();
 
 private:
@@ -0,0 +1,157 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audioringbuffer.h"
+
+// Enough for several seconds of even the smallest codec frames
+constexpr auto MarkerCapacity = 1024;
+// Always hold at least a few device periods, regardless of the configured buffer length
+constexpr auto MinimumDuration = 200;
+
+namespace Fooyin {
+AudioRingBuffer::AudioRingBuffer()
+    : m_bytesPerFrame{0}
+    , m_markers{MarkerCapacity}
+{ }
+
+void AudioRingBuffer::init(const AudioFormat& format, uint64_t duration)
+{
+    m_format        = format;
+    m_bytesPerFrame = format.bytesPerFrame();
+
+    duration = std::max<uint64_t>(duration, MinimumDuration);
+
+    m_data.resize(static_cast<size_t>(format.bytesForDuration(duration)));
+    m_markers.reset();
+}
+
+AudioFormat AudioRingBuffer::format() const
+{
+    return m_format;
+}
+
+int AudioRingBuffer::capacity() const
+{
+    return m_bytesPerFrame > 0 ? static_cast<int>(m_data.capacity()) / m_bytesPerFrame : 0;
+}
+
+int AudioRingBuffer::framesAvailable() const
+{
+    return m_bytesPerFrame > 0 ? static_cast<int>(m_data.readAvailable()) / m_bytesPerFrame : 0;
+}
+
+uint64_t AudioRingBuffer::bufferedDuration() const
+{
+    return m_format.durationForFrames(framesAvailable());
+}
+
+bool AudioRingBuffer::writeMarker(uint64_t startTime)
+{
+    return pushMarker({.offset = m_data.writePosition(), .startTime = startTime, .endOfTrack = false});
+}
+
+bool AudioRingBuffer::writeTrackStart(uint64_t startTime)
+{
+    return pushMarker(
+        {.offset = m_data.writePosition(), .startTime = startTime, .endOfTrack = false, .trackStart = true});
+}
+
+bool AudioRingBuffer::writeEndOfTrack()
+{
+    return pushMarker({.offset = m_data.writePosition(), .startTime = 0, .endOfTrack = true});
+}
+
+int AudioRingBuffer::writeFrames(const std::byte* data, int frames)
+{
+    if(m_bytesPerFrame <= 0 || frames <= 0) {
+        return 0;
+    }
+
+    // Only ever write whole frames
+    const int writableFrames = static_cast<int>(m_data.writeAvailable()) / m_bytesPerFrame;
+    const int count          = std::min(frames, writableFrames);
+
+    m_data.write(data, static_cast<size_t>(count * m_bytesPerFrame));
+
+    return count;
+}
+
+bool AudioRingBuffer::waitForSpace(int frames, bool marker)
+{
+    if(marker && m_markers.writeAvailable() == 0) {
+        return m_markers.waitForSpace(1);
+    }
+
+    return m_data.waitForSpace(static_cast<size_t>(frames * m_bytesPerFrame));
+}
+
+void AudioRingBuffer::interrupt()
+{
+    m_data.interrupt();
+    m_markers.interrupt();
+}
+
+bool AudioRingBuffer::takeMarker(Marker& marker)
+{
+    Marker nextMarker;
+    if(m_markers.peek(&nextMarker, 1) == 0) {
+        return false;
+    }
+
+    if(nextMarker.offset > m_data.readPosition()) {
+        return false;
+    }
+
+    m_markers.skip(1);
+    marker = nextMarker;
+
+    return true;
+}
+
+int AudioRingBuffer::readFrames(std::byte* data, int frames)
+{
+    if(m_bytesPerFrame <= 0 || frames <= 0) {
+        return 0;
+    }
+
+    auto bytes = static_cast<size_t>(frames * m_bytesPerFrame);
+
+    Marker nextMarker;
+    if(m_markers.peek(&nextMarker, 1) > 0) {
+        const uint64_t readPos = m_data.readPosition();
+        if(nextMarker.offset <= readPos) {
+            return 0;
+        }
+        bytes = std::min(bytes, static_cast<size_t>(nextMarker.offset - readPos));
+    }
+
+    return static_cast<int>(m_data.read(data, bytes)) / m_bytesPerFrame;
+}
+
+void AudioRingBuffer::clear()
+{
+    m_markers.clear();
+    m_data.clear();
+}
+
+bool AudioRingBuffer::pushMarker(const Marker& marker)
+{
+    return m_markers.write(&marker, 1) == 1;
+}
+} // namespace Fooyin
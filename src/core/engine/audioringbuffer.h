@@ -0,0 +1,91 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audioformat.h>
+#include <utils/lockfreeringbuffer.h>
+
+namespace Fooyin {
+/*!
+ * A fixed-capacity PCM ring which hands decoded audio from the decode thread to the renderer.
+ * Buffer boundaries are tracked using markers, so the renderer can follow timestamps and the end
+ * of a track without a separate queue.
+ *
+ * The decode thread is the only producer and the renderer the only consumer.
+ */
+class AudioRingBuffer
+{
+public:
+    struct Marker
+    {
+        uint64_t offset{0};
+        uint64_t startTime{0};
+        bool endOfTrack{false};
+        // Set on the first buffer of a track which follows on from the previous one without a gap
+        bool trackStart{false};
+    };
+
+    AudioRingBuffer();
+
+    /*!
+     * Allocates enough space to hold @p duration ms of audio in @p format.
+     * @note not thread-safe; both the producer and the consumer must be idle.
+     */
+    void init(const AudioFormat& format, uint64_t duration);
+
+    [[nodiscard]] AudioFormat format() const;
+    [[nodiscard]] int capacity() const;
+    [[nodiscard]] int framesAvailable() const;
+    [[nodiscard]] uint64_t bufferedDuration() const;
+
+    // Producer
+    bool writeMarker(uint64_t startTime);
+    bool writeTrackStart(uint64_t startTime);
+    bool writeEndOfTrack();
+    int writeFrames(const std::byte* data, int frames);
+    /*!
+     * Blocks until @p frames frames (and a marker if @p marker is @c true) can be written,
+     * or until @fn interrupt is called.
+     */
+    bool waitForSpace(int frames, bool marker = false);
+    void interrupt();
+
+    // Consumer
+    /*!
+     * Removes the marker at the current read position, if any.
+     * @returns @c true if a marker was taken.
+     */
+    bool takeMarker(Marker& marker);
+    /*!
+     * Reads up to @p frames frames into @p data, stopping at the next marker.
+     * @returns the number of frames read.
+     */
+    int readFrames(std::byte* data, int frames);
+    void clear();
+
+private:
+    bool pushMarker(const Marker& marker);
+
+    AudioFormat m_format;
+    int m_bytesPerFrame;
+    LockFreeRingBuffer<std::byte> m_data;
+    LockFreeRingBuffer<Marker> m_markers;
+};
+} // namespace Fooyin
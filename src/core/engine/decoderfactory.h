@@ -0,0 +1,34 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "engine/readaheadfile.h"
+#include "fycore_export.h"
+
+#include <core/engine/audiodecoder.h>
+
+namespace Fooyin::Audio {
+/*!
+ * Creates a decoder for @p source. Uncompressed files the native PCM decoder can read are handled by it,
+ * and everything else by FFmpeg, which reads local files ahead as set by @p options.
+ * The decoder still needs to be initialised with @p source.
+ */
+FYCORE_EXPORT std::unique_ptr<AudioDecoder> createDecoder(const QString& source, const ReadAheadOptions& options = {});
+} // namespace Fooyin::Audio
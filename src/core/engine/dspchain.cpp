@@ -0,0 +1,189 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dspchain.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace Fooyin {
+DspChain::DspChain(int maxFrames)
+    : m_maxFrames{std::max(1, maxFrames)}
+    , m_active{false}
+    , m_toFloat{nullptr}
+    , m_fromFloat{nullptr}
+{ }
+
+void DspChain::setNodes(std::vector<std::unique_ptr<DspNode>> nodes)
+{
+    {
+        const std::scoped_lock lock{m_stageGuard};
+
+        m_stages.clear();
+        for(auto& node : nodes) {
+            if(node) {
+                m_stages.emplace_back().node = std::move(node);
+            }
+        }
+    }
+
+    prepareStages();
+}
+
+void DspChain::prepare(const AudioFormat& format)
+{
+    if(format == m_format) {
+        return;
+    }
+
+    m_format = format;
+    prepareStages();
+}
+
+void DspChain::reset()
+{
+    for(auto& stage : m_stages) {
+        if(stage.active) {
+            stage.node->reset();
+        }
+    }
+}
+
+bool DspChain::isEmpty() const
+{
+    return !m_active;
+}
+
+AudioFormat DspChain::format() const
+{
+    return m_format;
+}
+
+int DspChain::latencyFrames() const
+{
+    int latency{0};
+    for(const auto& stage : m_stages) {
+        if(stage.active) {
+            latency += stage.node->latency();
+        }
+    }
+    return latency;
+}
+
+uint64_t DspChain::latency() const
+{
+    if(!m_format.isValid()) {
+        return 0;
+    }
+    return m_format.durationForFrames(latencyFrames());
+}
+
+void DspChain::process(AudioBuffer& buffer)
+{
+    if(!m_active || !buffer.isValid() || buffer.format() != m_format) {
+        return;
+    }
+
+    const int frameCount = buffer.frameCount();
+    std::byte* data      = buffer.data();
+
+    for(int frame{0}; frame < frameCount; frame += m_maxFrames) {
+        processBlock(data + m_format.bytesForFrames(frame), std::min(m_maxFrames, frameCount - frame));
+    }
+}
+
+std::vector<DspStageStats> DspChain::stats() const
+{
+    const std::scoped_lock lock{m_stageGuard};
+
+    std::vector<DspStageStats> stats;
+    stats.reserve(m_stages.size());
+
+    for(const auto& stage : m_stages) {
+        stats.push_back({.name        = stage.node->name(),
+                         .latency     = stage.active ? stage.node->latency() : 0,
+                         .frames      = stage.frames.load(std::memory_order_relaxed),
+                         .processTime = std::chrono::nanoseconds{stage.processTime.load(std::memory_order_relaxed)}});
+    }
+
+    return stats;
+}
+
+void DspChain::prepareStages()
+{
+    m_active = false;
+
+    if(!m_format.isValid()) {
+        return;
+    }
+
+    const SampleFormat sampleFormat = m_format.sampleFormat();
+    if(sampleFormat == SampleFormat::Float) {
+        m_toFloat   = nullptr;
+        m_fromFloat = nullptr;
+        m_scratch   = {};
+    }
+    else {
+        m_toFloat   = Audio::convertKernel(sampleFormat, SampleFormat::Float);
+        m_fromFloat = Audio::convertKernel(SampleFormat::Float, sampleFormat);
+        if(!m_toFloat || !m_fromFloat) {
+            qDebug() << "Unable to apply DSP to unsupported format";
+            return;
+        }
+        m_scratch.assign(static_cast<size_t>(m_maxFrames) * m_format.channelCount(), 0.0F);
+    }
+
+    for(auto& stage : m_stages) {
+        stage.active = stage.node->prepare(m_format, m_maxFrames);
+        if(!stage.active) {
+            qWarning() << "DSP" << stage.node->name() << "doesn't support the current format and will be bypassed";
+        }
+        m_active = m_active || stage.active;
+    }
+}
+
+void DspChain::processBlock(std::byte* data, int frames)
+{
+    const int sampleCount = frames * m_format.channelCount();
+
+    float* samples = m_toFloat ? m_scratch.data() : reinterpret_cast<float*>(data);
+    if(m_toFloat) {
+        m_toFloat(data, reinterpret_cast<std::byte*>(samples), sampleCount);
+    }
+
+    for(auto& stage : m_stages) {
+        if(!stage.active) {
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        stage.node->process(samples, frames);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        stage.frames.fetch_add(frames, std::memory_order_relaxed);
+        stage.processTime.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                    std::memory_order_relaxed);
+    }
+
+    if(m_fromFloat) {
+        m_fromFloat(reinterpret_cast<const std::byte*>(samples), data, sampleCount);
+    }
+}
+} // namespace Fooyin
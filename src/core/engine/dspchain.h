@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "audiokernels.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/dspnode.h>
+#include <core/engine/enginestats.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Runs decoded audio through a series of DspNodes in place.
+ * Integer formats are converted to float in a scratch buffer allocated up front, and large buffers
+ * are processed in blocks, so @fn process never allocates.
+ * Stages can only be changed while nothing is being processed; @fn stats is safe to call from any thread.
+ */
+class FYCORE_EXPORT DspChain
+{
+public:
+    explicit DspChain(int maxFrames = 4096);
+
+    /** Replaces all stages, preparing them for the current format. */
+    void setNodes(std::vector<std::unique_ptr<DspNode>> nodes);
+    /*!
+     * Prepares every stage for buffers in @p format. Does nothing if the format is unchanged,
+     * so state carries over between tracks played gaplessly.
+     */
+    void prepare(const AudioFormat& format);
+    /** Clears the state of every stage. */
+    void reset();
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] AudioFormat format() const;
+    /** Returns the total delay introduced by all stages in frames. */
+    [[nodiscard]] int latencyFrames() const;
+    /** Returns the total delay introduced by all stages in ms. */
+    [[nodiscard]] uint64_t latency() const;
+
+    /*!
+     * Processes @p buffer in place.
+     * Buffers which don't match the prepared format are left untouched.
+     */
+    void process(AudioBuffer& buffer);
+
+    /** Returns the time spent in each stage, and the number of frames it has processed. */
+    [[nodiscard]] std::vector<DspStageStats> stats() const;
+
+private:
+    struct Stage
+    {
+        std::unique_ptr<DspNode> node;
+        bool active{false};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<int64_t> processTime{0};
+    };
+
+    void prepareStages();
+    void processBlock(std::byte* data, int frames);
+
+    int m_maxFrames;
+    AudioFormat m_format;
+    bool m_active;
+
+    // Only guards changes to the stages against reads of the stats
+    mutable std::mutex m_stageGuard;
+    std::deque<Stage> m_stages;
+
+    std::vector<float> m_scratch;
+    Audio::ConvertKernel m_toFloat;
+    Audio::ConvertKernel m_fromFloat;
+};
+} // namespace Fooyin
@@ -19,11 +19,15 @@
 
 #include "enginehandler.h"
 
+#include "audioanalysisbus.h"
 #include "audioplaybackengine.h"
+#include "decoderfactory.h"
 #include "engine/ffmpeg/ffmpegdecoder.h"
 
 #include <core/coresettings.h>
+#include <core/engine/audioanalyser.h>
 #include <core/engine/audioengine.h>
+#include <core/engine/dspplugin.h>
 #include <core/engine/outputplugin.h>
 #include <core/track.h>
 
@@ -47,16 +51,26 @@ struct EngineHandler::Private
     SettingsManager* settings;
 
     QThread engineThread;
+    std::shared_ptr<AudioAnalysisBus> analysisBus;
+    AudioAnalyser* analyser;
     AudioEngine* engine;
 
     std::map<QString, OutputCreator> outputs;
     CurrentOutput currentOutput;
 
-    Private(EngineHandler* self_, PlayerController* playerController_, SettingsManager* settings_)
+    std::map<QString, DspCreator> dsps;
+
+    EngineStats stats;
+    bool bitPerfect{false};
+
+    Private(EngineHandler* self_, PlayerController* playerController_, SettingsManager* settings_,
+            DbConnectionPoolPtr dbPool)
         : self{self_}
         , playerController{playerController_}
         , settings{settings_}
-        , engine{new AudioPlaybackEngine(settings)}
+        , analysisBus{std::make_shared<AudioAnalysisBus>()}
+        , analyser{new AudioAnalyser(analysisBus, self)}
+        , engine{new AudioPlaybackEngine(settings, std::move(dbPool), analysisBus)}
     {
         engine->moveToThread(&engineThread);
         engineThread.start();
@@ -69,6 +83,14 @@ struct EngineHandler::Private
                          &PlayerController::setCurrentPosition);
         QObject::connect(engine, &AudioEngine::trackStatusChanged, self,
                          [this](TrackStatus status) { handleTrackStatus(status); });
+        QObject::connect(engine, &AudioEngine::statsChanged, self, [this](const EngineStats& engineStats) {
+            stats = engineStats;
+            emit self->engineStatsChanged(stats);
+        });
+        QObject::connect(engine, &AudioEngine::bitPerfectChanged, self, [this](bool isBitPerfect) {
+            bitPerfect = isBitPerfect;
+            emit self->bitPerfectChanged(bitPerfect);
+        });
 
         updateVolume(settings->value<Settings::Core::OutputVolume>());
     }
@@ -148,6 +170,22 @@ struct EngineHandler::Private
         }
     }
 
+    void changeDsps(const QStringList& names)
+    {
+        std::vector<DspCreator> creators;
+
+        for(const QString& name : names) {
+            if(!dsps.contains(name)) {
+                qWarning() << QStringLiteral("DSP (%1) hasn't been registered").arg(name);
+                continue;
+            }
+            creators.push_back(dsps.at(name));
+        }
+
+        QMetaObject::invokeMethod(
+            engine, [this, creators]() { engine->setDsps(creators); }, Qt::QueuedConnection);
+    }
+
     void updateVolume(double volume)
     {
         QMetaObject::invokeMethod(
@@ -155,9 +193,10 @@ struct EngineHandler::Private
     }
 };
 
-EngineHandler::EngineHandler(PlayerController* playerController, SettingsManager* settings, QObject* parent)
+EngineHandler::EngineHandler(PlayerController* playerController, SettingsManager* settings,
+                             DbConnectionPoolPtr dbPool, QObject* parent)
     : EngineController{parent}
-    , p{std::make_unique<Private>(this, playerController, settings)}
+    , p{std::make_unique<Private>(this, playerController, settings, std::move(dbPool))}
 {
     QObject::connect(playerController, &PlayerController::playStateChanged, this,
                      [this](PlayState state) { p->playStateChanged(state); });
@@ -173,6 +212,7 @@ EngineHandler::EngineHandler(PlayerController* playerController, SettingsManager
     p->settings->subscribe<Settings::Core::AudioOutput>(this,
                                                         [this](const QString& output) { p->changeOutput(output); });
     p->settings->subscribe<Settings::Core::OutputVolume>(this, [this](double volume) { p->updateVolume(volume); });
+    p->settings->subscribe<Settings::Core::DspChain>(this, [this](const QStringList& dsps) { p->changeDsps(dsps); });
 }
 
 EngineHandler::~EngineHandler()
@@ -184,6 +224,7 @@ EngineHandler::~EngineHandler()
 void EngineHandler::setup()
 {
     p->changeOutput(p->settings->value<Settings::Core::AudioOutput>());
+    p->changeDsps(p->settings->value<Settings::Core::DspChain>());
 }
 
 OutputNames EngineHandler::getAllOutputs() const
@@ -220,10 +261,55 @@ void EngineHandler::addOutput(const AudioOutputBuilder& output)
     p->outputs.emplace(output.name, output.creator);
 }
 
+DspNames EngineHandler::getAllDsps() const
+{
+    DspNames dsps;
+
+    for(const auto& [name, dsp] : p->dsps) {
+        dsps.emplace_back(name);
+    }
+
+    return dsps;
+}
+
+void EngineHandler::addDsp(const DspNodeBuilder& dsp)
+{
+    if(p->dsps.contains(dsp.name)) {
+        qDebug() << QStringLiteral("DSP (%1) already registered").arg(dsp.name);
+        return;
+    }
+    p->dsps.emplace(dsp.name, dsp.creator);
+}
+
 std::unique_ptr<AudioDecoder> EngineHandler::createDecoder()
 {
     return std::make_unique<FFmpegDecoder>();
 }
+
+std::unique_ptr<AudioDecoder> EngineHandler::createDecoder(const QString& source, const ReadAheadOptions& options)
+{
+    return Audio::createDecoder(source, options);
+}
+
+EngineStats EngineHandler::engineStats() const
+{
+    return p->stats;
+}
+
+bool EngineHandler::isBitPerfect() const
+{
+    return p->bitPerfect;
+}
+
+AudioAnalyser* EngineHandler::analyser() const
+{
+    return p->analyser;
+}
+
+void EngineHandler::prepareNextTrack(const Track& track)
+{
+    QMetaObject::invokeMethod(p->engine, [this, track]() { p->engine->prepareNextTrack(track); });
+}
 } // namespace Fooyin
 
 #include "moc_enginehandler.cpp"
@@ -20,13 +20,16 @@
 #pragma once
 
 #include <core/engine/enginecontroller.h>
+#include <utils/database/dbconnectionpool.h>
 
 #include <QObject>
 
 namespace Fooyin {
 class SettingsManager;
 class PlayerController;
+class Track;
 struct AudioOutputBuilder;
+struct DspNodeBuilder;
 
 using OutputNames = std::vector<QString>;
 
@@ -35,7 +38,8 @@ class EngineHandler : public EngineController
     Q_OBJECT
 
 public:
-    explicit EngineHandler(PlayerController* playerController, SettingsManager* settings, QObject* parent = nullptr);
+    EngineHandler(PlayerController* playerController, SettingsManager* settings, DbConnectionPoolPtr dbPool,
+                  QObject* parent = nullptr);
     ~EngineHandler() override;
 
     void setup();
@@ -44,7 +48,18 @@ public:
     [[nodiscard]] OutputDevices getOutputDevices(const QString& output) const override;
     void addOutput(const AudioOutputBuilder& output) override;
 
+    [[nodiscard]] DspNames getAllDsps() const override;
+    void addDsp(const DspNodeBuilder& dsp) override;
+
     std::unique_ptr<AudioDecoder> createDecoder() override;
+    std::unique_ptr<AudioDecoder> createDecoder(const QString& source, const ReadAheadOptions& options) override;
+
+    [[nodiscard]] EngineStats engineStats() const override;
+    [[nodiscard]] bool isBitPerfect() const override;
+    [[nodiscard]] AudioAnalyser* analyser() const override;
+
+    /** Prepares @p track in the background, ready to follow on from the current track. */
+    void prepareNextTrack(const Track& track);
 
 private:
     struct Private;
@@ -0,0 +1,143 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "enginemetrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+constexpr auto Relaxed = std::memory_order_relaxed;
+
+namespace Fooyin {
+EngineMetrics::EngineMetrics()
+    : m_enabled{false}
+{
+    reset();
+}
+
+bool EngineMetrics::isEnabled() const
+{
+    return m_enabled.load(Relaxed);
+}
+
+void EngineMetrics::setEnabled(bool enabled)
+{
+    if(enabled && !m_enabled.load(Relaxed)) {
+        reset();
+    }
+    m_enabled.store(enabled, Relaxed);
+}
+
+void EngineMetrics::reset()
+{
+    m_underruns.store(0, Relaxed);
+    m_underrunFrames.store(0, Relaxed);
+    m_decodedBuffers.store(0, Relaxed);
+    m_decodeTime.store(0, Relaxed);
+    m_maxDecodeTime.store(0, Relaxed);
+    for(auto& bucket : m_decodeTimeHistogram) {
+        bucket.store(0, Relaxed);
+    }
+    m_conversions.store(0, Relaxed);
+    m_bufferedFrames.store(0, Relaxed);
+    m_minBufferedFrames.store(std::numeric_limits<int>::max(), Relaxed);
+    m_outputDelay.store(0.0, Relaxed);
+}
+
+void EngineMetrics::recordUnderrun(int frames)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    m_underruns.fetch_add(1, Relaxed);
+    m_underrunFrames.fetch_add(static_cast<uint64_t>(frames), Relaxed);
+}
+
+void EngineMetrics::recordDecode(Clock::duration time)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+
+    m_decodedBuffers.fetch_add(1, Relaxed);
+    m_decodeTime.fetch_add(us, Relaxed);
+
+    // Only the decode thread writes this, so there's no need for a compare-exchange loop
+    if(us > m_maxDecodeTime.load(Relaxed)) {
+        m_maxDecodeTime.store(us, Relaxed);
+    }
+
+    const auto bucket = std::min<size_t>(std::bit_width(static_cast<uint64_t>(std::max<int64_t>(us, 0))),
+                                         EngineStats::DecodeTimeBuckets - 1);
+    m_decodeTimeHistogram.at(bucket).fetch_add(1, Relaxed);
+}
+
+void EngineMetrics::recordConversion()
+{
+    if(isEnabled()) {
+        m_conversions.fetch_add(1, Relaxed);
+    }
+}
+
+void EngineMetrics::recordBufferLevel(int frames)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    m_bufferedFrames.store(frames, Relaxed);
+    // Only the render thread writes this
+    if(frames < m_minBufferedFrames.load(Relaxed)) {
+        m_minBufferedFrames.store(frames, Relaxed);
+    }
+}
+
+void EngineMetrics::recordOutputDelay(double seconds)
+{
+    if(isEnabled()) {
+        m_outputDelay.store(seconds, Relaxed);
+    }
+}
+
+EngineStats EngineMetrics::snapshot() const
+{
+    EngineStats stats;
+
+    stats.underruns      = m_underruns.load(Relaxed);
+    stats.underrunFrames = m_underrunFrames.load(Relaxed);
+    stats.decodedBuffers = m_decodedBuffers.load(Relaxed);
+    stats.decodeTime     = std::chrono::microseconds{m_decodeTime.load(Relaxed)};
+    stats.maxDecodeTime  = std::chrono::microseconds{m_maxDecodeTime.load(Relaxed)};
+    for(size_t i{0}; i < EngineStats::DecodeTimeBuckets; ++i) {
+        stats.decodeTimeHistogram.at(i) = m_decodeTimeHistogram.at(i).load(Relaxed);
+    }
+    stats.conversions    = m_conversions.load(Relaxed);
+    stats.bufferedFrames = m_bufferedFrames.load(Relaxed);
+
+    const int minBuffered   = m_minBufferedFrames.load(Relaxed);
+    stats.minBufferedFrames = minBuffered == std::numeric_limits<int>::max() ? 0 : minBuffered;
+    stats.outputDelay       = m_outputDelay.load(Relaxed);
+
+    return stats;
+}
+} // namespace Fooyin
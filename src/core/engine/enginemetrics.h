@@ -0,0 +1,76 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/enginestats.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace Fooyin {
+/*!
+ * Lock-free counters updated from the decode and render threads.
+ * Every record function returns straight away while collection is disabled, so callers only
+ * need to check @fn isEnabled themselves to avoid work such as reading the clock.
+ */
+class FYCORE_EXPORT EngineMetrics
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    EngineMetrics();
+
+    [[nodiscard]] bool isEnabled() const;
+    /** Enables or disables collection. Counters are reset when enabled. */
+    void setEnabled(bool enabled);
+    void reset();
+
+    void recordUnderrun(int frames);
+    void recordDecode(Clock::duration time);
+    void recordConversion();
+    void recordBufferLevel(int frames);
+    void recordOutputDelay(double seconds);
+
+    /*!
+     * Returns the counters collected so far.
+     * Fields which come from elsewhere in the engine, such as the buffer capacity, are left unset.
+     */
+    [[nodiscard]] EngineStats snapshot() const;
+
+private:
+    std::atomic<bool> m_enabled;
+
+    std::atomic<uint64_t> m_underruns;
+    std::atomic<uint64_t> m_underrunFrames;
+
+    std::atomic<uint64_t> m_decodedBuffers;
+    std::atomic<int64_t> m_decodeTime;
+    std::atomic<int64_t> m_maxDecodeTime;
+    std::array<std::atomic<uint64_t>, EngineStats::DecodeTimeBuckets> m_decodeTimeHistogram;
+
+    std::atomic<uint64_t> m_conversions;
+
+    std::atomic<int> m_bufferedFrames;
+    std::atomic<int> m_minBufferedFrames;
+    std::atomic<double> m_outputDelay;
+};
+} // namespace Fooyin
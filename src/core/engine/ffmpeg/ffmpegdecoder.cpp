@@ -25,10 +25,14 @@
 #include "ffmpegstream.h"
 #include "ffmpegutils.h"
 
+#include "engine/audiokernels.h"
+#include "engine/readaheadfile.h"
+
 #include <core/engine/audiobuffer.h>
 #include <utils/worker.h>
 
 #include <QDebug>
+#include <QFile>
 
 #if defined(__GNUG__)
 #pragma GCC diagnostic ignored "-Wold-style-cast"
@@ -38,33 +42,20 @@
 
 using namespace std::chrono_literals;
 
-namespace {
-void interleaveSamples(uint8_t** in, Fooyin::AudioBuffer& buffer)
-{
-    const auto format  = buffer.format();
-    const int channels = format.channelCount();
-    const int samples  = buffer.frameCount();
-    const int bps      = format.bytesPerSample();
-    auto* out          = buffer.data();
-
-    for(int i{0}; i < samples; ++i) {
-        for(int ch{0}; ch < channels; ++ch) {
-            const auto inOffset  = i * bps;
-            const auto outOffset = (i * channels + ch) * bps;
-            std::memmove(out + outOffset, in[ch] + inOffset, bps);
-        }
-    }
-}
+// Size of the buffer FFmpeg reads through from the read-ahead file
+constexpr int IoBufferSize = 32768;
+// Minimum distance between seek table points
+constexpr int64_t SeekPointSpacing = 1000;
+// Seeks start at least this far before the target, as some codecs (e.g. MP3) need the previous packets
+constexpr int64_t SeekPreroll = 100;
+// Beyond this, the demuxer is likely to get closer than decoding forward from the nearest seek point
+constexpr int64_t MaxSeekPointDistance = 10000;
 
-void interleave(uint8_t** in, Fooyin::AudioBuffer& buffer)
+namespace {
+void unrefAVBuffer(void* opaque)
 {
-    if(!buffer.isValid()) {
-        return;
-    }
-
-    if(buffer.format().sampleFormat() != Fooyin::SampleFormat::Unknown) {
-        interleaveSamples(in, buffer);
-    }
+    auto* ref = static_cast<AVBufferRef*>(opaque);
+    av_buffer_unref(&ref);
 }
 
 struct FormatContextDeleter
@@ -78,6 +69,61 @@ struct FormatContextDeleter
     }
 };
 using FormatContextPtr = std::unique_ptr<AVFormatContext, FormatContextDeleter>;
+
+struct IoContextDeleter
+{
+    void operator()(AVIOContext* context) const
+    {
+        if(context) {
+            av_freep(&context->buffer);
+            avio_context_free(&context);
+        }
+    }
+};
+using IoContextPtr = std::unique_ptr<AVIOContext, IoContextDeleter>;
+
+int readPacket(void* opaque, uint8_t* data, int size)
+{
+    auto* file          = static_cast<Fooyin::ReadAheadFile*>(opaque);
+    const int64_t count = file->read(reinterpret_cast<std::byte*>(data), static_cast<size_t>(size));
+
+    if(count == 0) {
+        return AVERROR_EOF;
+    }
+    if(count < 0) {
+        return AVERROR(EIO);
+    }
+    return static_cast<int>(count);
+}
+
+int64_t seekPacket(void* opaque, int64_t offset, int whence)
+{
+    auto* file         = static_cast<Fooyin::ReadAheadFile*>(opaque);
+    const auto size    = static_cast<int64_t>(file->size());
+    const int position = whence & ~AVSEEK_FORCE;
+
+    int64_t pos{0};
+    switch(position) {
+        case(AVSEEK_SIZE):
+            return size;
+        case(SEEK_SET):
+            pos = offset;
+            break;
+        case(SEEK_CUR):
+            pos = static_cast<int64_t>(file->pos()) + offset;
+            break;
+        case(SEEK_END):
+            pos = size + offset;
+            break;
+        default:
+            return -1;
+    }
+
+    if(pos < 0 || !file->seek(static_cast<uint64_t>(pos))) {
+        return -1;
+    }
+    return pos;
+}
 } // namespace
 
 namespace Fooyin {
@@ -85,10 +131,15 @@ struct FFmpegDecoder::Private
 {
     FFmpegDecoder* self;
 
+    ReadAheadOptions readAheadOptions;
+    std::unique_ptr<ReadAheadFile> file;
+    // Must outlive the format context reading from it
+    IoContextPtr ioContext;
     FormatContextPtr context;
     Stream stream;
     Codec codec;
     AudioFormat audioFormat;
+    Audio::InterleaveKernel interleaveKernel{nullptr};
 
     Error error{NoError};
     AVRational timeBase;
@@ -100,18 +151,40 @@ struct FFmpegDecoder::Private
     int bufferPos{0};
     uint64_t currentPts{0};
 
-    explicit Private(FFmpegDecoder* self_)
+    SeekTable seekTable;
+    bool byteSeekable{false};
+    // Points are only recorded while the demuxer's timestamps can be trusted, i.e. when reading on from the start
+    bool recordSeekPoints{false};
+    // Decoded output is trimmed up to this sample after a seek; -1 if not seeking
+    int64_t trimToSample{-1};
+    // Used in place of frame timestamps when the demuxer doesn't know them, as after seeking by byte
+    int64_t nextSample{0};
+    bool frameDropped{false};
+    std::vector<const uint8_t*> planes;
+
+    // Reused for every packet read and frame decoded, so decoding doesn't allocate for each one
+    PacketPtr packet;
+    FramePtr frame;
+
+    Private(FFmpegDecoder* self_, const ReadAheadOptions& readAheadOptions_)
         : self{self_}
+        , readAheadOptions{readAheadOptions_}
         , timeBase{0, 0}
+        , packet{av_packet_alloc()}
+        , frame{av_frame_alloc()}
     { }
 
     bool setup(const QString& source)
     {
         context.reset();
+        closeFile();
         stream = {};
         codec  = {};
         buffer = {};
 
+        av_packet_unref(packet.get());
+        av_frame_unref(frame.get());
+
         error = Error::NoError;
 
         if(!createAVFormatContext(source)) {
@@ -124,15 +197,77 @@ struct FFmpegDecoder::Private
             return false;
         }
 
-        audioFormat = Utils::audioFormatFromCodec(stream.avStream()->codecpar);
+        seekTable        = SeekTable{av_rescale_q(SeekPointSpacing, {1, 1000}, timeBase)};
+        byteSeekable     = isSeekable && context->pb && !(context->iformat->flags & AVFMT_NO_BYTE_SEEK);
+        recordSeekPoints = byteSeekable;
+        trimToSample     = -1;
+        nextSample       = 0;
+
+        audioFormat      = Utils::audioFormatFromCodec(stream.avStream()->codecpar);
+        interleaveKernel = Audio::interleaveKernel(audioFormat.bytesPerSample(), audioFormat.channelCount());
 
         return createCodec(stream.avStream());
     }
 
+    bool openFile(const QString& source)
+    {
+        // Leave anything which isn't a local file to FFmpeg's own protocols
+        if(source.contains(QStringLiteral("://"))) {
+            return false;
+        }
+
+        auto readAheadFile = std::make_unique<ReadAheadFile>();
+        if(!readAheadFile->open(QFile::encodeName(source).toStdString(), readAheadOptions)) {
+            return false;
+        }
+
+        auto* ioBuffer = static_cast<uint8_t*>(av_malloc(IoBufferSize));
+        if(!ioBuffer) {
+            return false;
+        }
+
+        ioContext.reset(
+            avio_alloc_context(ioBuffer, IoBufferSize, 0, readAheadFile.get(), readPacket, nullptr, seekPacket));
+        if(!ioContext) {
+            av_free(ioBuffer);
+            return false;
+        }
+
+        file = std::move(readAheadFile);
+
+        return true;
+    }
+
+    void closeFile()
+    {
+        if(file) {
+            const auto stats = file->stats();
+            if(stats.stalls > 0) {
+                qDebug() << "Read-ahead stalled" << stats.stalls << "times for"
+                         << std::chrono::duration_cast<std::chrono::milliseconds>(stats.stallTime).count() << "ms";
+            }
+        }
+
+        ioContext.reset();
+        file.reset();
+    }
+
     bool createAVFormatContext(const QString& source)
     {
         AVFormatContext* avContext{nullptr};
 
+        // Fall back to FFmpeg opening the file itself, which also reports why it couldn't be opened
+        if(openFile(source)) {
+            avContext = avformat_alloc_context();
+            if(!avContext) {
+                closeFile();
+                error = Error::ResourceError;
+                return false;
+            }
+            avContext->pb = ioContext.get();
+            avContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+
         const int ret = avformat_open_input(&avContext, source.toUtf8().constData(), nullptr, nullptr);
         if(ret < 0) {
             if(ret == AVERROR(EACCES)) {
@@ -143,12 +278,15 @@ struct FFmpegDecoder::Private
                 Utils::printError(QStringLiteral("Invalid format: ") + source);
                 error = Error::FormatError;
             }
+            // The context is freed on failure
+            closeFile();
             return false;
         }
 
         if(avformat_find_stream_info(avContext, nullptr) < 0) {
             Utils::printError(QStringLiteral("Could not find stream info"));
             avformat_close_input(&avContext);
+            closeFile();
             error = Error::ResourceError;
             return false;
         }
@@ -221,17 +359,18 @@ struct FFmpegDecoder::Private
         return true;
     }
 
-    void decodeAudio(const Packet& packet)
+    // A null packet drains the decoder
+    void decodeAudio(const AVPacket* avPacket)
     {
         if(!isDecoding) {
             return;
         }
 
-        int result = sendAVPacket(packet);
+        int result = sendAVPacket(avPacket);
 
         if(result == AVERROR(EAGAIN)) {
             receiveAVFrames();
-            result = sendAVPacket(packet);
+            result = sendAVPacket(avPacket);
 
             if(result != AVERROR(EAGAIN)) {
                 qWarning() << "Unexpected decoder behavior";
@@ -248,13 +387,13 @@ struct FFmpegDecoder::Private
         return error != Error::NoError;
     }
 
-    [[nodiscard]] int sendAVPacket(const Packet& packet) const
+    [[nodiscard]] int sendAVPacket(const AVPacket* avPacket) const
     {
         if(hasError() || !isDecoding) {
             return -1;
         }
 
-        return avcodec_send_packet(codec.context(), !packet.isValid() || draining ? nullptr : packet.avPacket());
+        return avcodec_send_packet(codec.context(), draining ? nullptr : avPacket);
     }
 
     void receiveAVFrames()
@@ -263,8 +402,10 @@ struct FFmpegDecoder::Private
             return;
         }
 
-        auto avFrame     = FramePtr(av_frame_alloc());
-        const int result = avcodec_receive_frame(codec.context(), avFrame.get());
+        AVFrame* avFrame = frame.get();
+        av_frame_unref(avFrame);
+
+        const int result = avcodec_receive_frame(codec.context(), avFrame);
 
         if(result == AVERROR_EOF) {
             return;
@@ -280,51 +421,133 @@ struct FFmpegDecoder::Private
             return;
         }
 
-        const Frame frame{std::move(avFrame), timeBase};
+        const int sampleRate   = audioFormat.sampleRate();
+        const int frameSamples = avFrame->nb_samples;
 
-        currentPts = frame.ptsMs();
+        const int64_t pts         = avFrame->pts;
+        const int64_t startSample = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, timeBase, {1, sampleRate}) : nextSample;
+        nextSample                = startSample + frameSamples;
 
-        const auto sampleCount = audioFormat.bytesPerFrame() * frame.sampleCount();
+        int skip{0};
+        if(trimToSample >= 0) {
+            if(nextSample <= trimToSample) {
+                // Entirely before the seek target
+                frameDropped = true;
+                return;
+            }
+            skip         = static_cast<int>(std::max<int64_t>(trimToSample - startSample, 0));
+            trimToSample = -1;
+        }
 
-        if(av_sample_fmt_is_planar(frame.format())) {
-            buffer = {audioFormat, frame.ptsMs()};
-            buffer.resize(static_cast<size_t>(sampleCount));
-            interleave(frame.avFrame()->data, buffer);
+        const int64_t firstSample = startSample + skip;
+        const uint64_t startTime  = firstSample > 0 ? av_rescale(firstSample, 1000, sampleRate) : 0;
+        const int frameCount      = frameSamples - skip;
+        const auto byteCount      = static_cast<size_t>(audioFormat.bytesForFrames(frameCount));
+        const auto skipBytes      = static_cast<size_t>(audioFormat.bytesForFrames(skip));
+
+        currentPts = startTime;
+
+        if(av_sample_fmt_is_planar(static_cast<AVSampleFormat>(avFrame->format))) {
+            buffer = {audioFormat, startTime};
+            buffer.resize(byteCount);
+            if(interleaveKernel && audioFormat.sampleFormat() != SampleFormat::Unknown) {
+                const int channels     = audioFormat.channelCount();
+                const size_t planeSkip = skipBytes / static_cast<size_t>(channels);
+                planes.resize(static_cast<size_t>(channels));
+                for(int ch{0}; ch < channels; ++ch) {
+                    planes[static_cast<size_t>(ch)] = avFrame->extended_data[ch] + planeSkip;
+                }
+                interleaveKernel(planes.data(), channels, buffer.data(), frameCount);
+            }
+        }
+        else if(avFrame->buf[0]) {
+            // Hand the decoded samples on without copying. The buffer's reference is taken from the frame rather
+            // than adding one, which would allocate, and goes back to the codec's pool when ours is released.
+            AVBufferRef* ref = std::exchange(avFrame->buf[0], nullptr);
+            buffer           = {reinterpret_cast<const std::byte*>(avFrame->data[0]) + skipBytes,
+                      byteCount,
+                      audioFormat,
+                      startTime,
+                      unrefAVBuffer,
+                      ref};
         }
         else {
-            buffer = {frame.avFrame()->data[0], static_cast<size_t>(sampleCount), audioFormat, frame.ptsMs()};
+            buffer = {avFrame->data[0] + skipBytes, byteCount, audioFormat, startTime};
         }
     }
 
+    // Decodes until a frame is ready, skipping any trimmed by a seek
+    void decodeNext()
+    {
+        do {
+            frameDropped = false;
+            readNext();
+        } while(!buffer.isValid() && frameDropped && isDecoding && !hasError());
+    }
+
     void readNext()
     {
         if(!isDecoding) {
             return;
         }
 
-        const Packet packet(PacketPtr{av_packet_alloc()});
-        const int readResult = av_read_frame(context.get(), packet.avPacket());
+        // Once sent, the decoder holds its own reference to the packet, so it's free to be read into again
+        AVPacket* avPacket = packet.get();
+        int readResult{0};
+        do {
+            av_packet_unref(avPacket);
+            readResult = av_read_frame(context.get(), avPacket);
+        } while(readResult >= 0 && avPacket->stream_index != codec.streamIndex());
+
         if(readResult < 0) {
             if(readResult != AVERROR_EOF) {
                 Utils::printError(readResult);
             }
             else if(!draining) {
                 draining = true;
-                decodeAudio(packet);
+                decodeAudio(nullptr);
                 return;
             }
             return;
         }
 
-        if(packet.avPacket()->stream_index != codec.streamIndex()) {
-            readNext();
+        recordSeekPoint(avPacket);
+
+        decodeAudio(avPacket);
+    }
+
+    void recordSeekPoint(const AVPacket* packet)
+    {
+        if(!recordSeekPoints || packet->pos < 0 || packet->pts == AV_NOPTS_VALUE
+           || !(packet->flags & AV_PKT_FLAG_KEY)) {
             return;
         }
 
-        decodeAudio(packet);
+        seekTable.insert({.timestamp = packet->pts, .offset = packet->pos});
+    }
+
+    bool seekToPoint(int64_t timestamp)
+    {
+        if(!byteSeekable) {
+            return false;
+        }
+
+        const int64_t preroll = av_rescale_q(SeekPreroll, {1, 1000}, timeBase);
+        const auto point      = seekTable.find(std::max<int64_t>(timestamp - preroll, 0));
+        if(!point || timestamp - point->timestamp > av_rescale_q(MaxSeekPointDistance, {1, 1000}, timeBase)) {
+            return false;
+        }
+
+        if(av_seek_frame(context.get(), stream.index(), point->offset, AVSEEK_FLAG_BYTE) < 0) {
+            return false;
+        }
+
+        nextSample = av_rescale_q(point->timestamp, timeBase, {1, audioFormat.sampleRate()});
+
+        return true;
     }
 
-    void seek(uint64_t pos) const
+    void seek(uint64_t pos)
     {
         if(!context || !isSeekable || hasError()) {
             return;
@@ -332,21 +555,57 @@ struct FFmpegDecoder::Private
 
         const int64_t timestamp = av_rescale_q(static_cast<int64_t>(pos), {1, 1000}, stream.avStream()->time_base);
 
-        const int flags = pos < currentPts ? AVSEEK_FLAG_BACKWARD : 0;
-        if(av_seek_frame(context.get(), stream.index(), timestamp, flags) < 0) {
-            qWarning() << "Could not seek to position: " << pos;
-            return;
+        // Jump straight to a known packet if we can, as the demuxer's own seeking may have to estimate
+        if(pos == 0 || !seekToPoint(timestamp)) {
+            if(av_seek_frame(context.get(), stream.index(), timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+                qWarning() << "Could not seek to position: " << pos;
+                return;
+            }
+            nextSample = av_rescale_q(timestamp, timeBase, {1, audioFormat.sampleRate()});
         }
 
         avcodec_flush_buffers(codec.context());
+
+        buffer     = {};
+        bufferPos  = 0;
+        draining   = false;
+        currentPts = pos;
+
+        // Both kinds of seek land before the target, so trim the decoded output up to it
+        trimToSample     = pos > 0 ? av_rescale(static_cast<int64_t>(pos), audioFormat.sampleRate(), 1000) : -1;
+        recordSeekPoints = byteSeekable && pos == 0;
     }
 };
 
-FFmpegDecoder::FFmpegDecoder()
-    : p{std::make_unique<Private>(this)}
+FFmpegDecoder::FFmpegDecoder(const ReadAheadOptions& options)
+    : p{std::make_unique<Private>(this, options)}
 { }
 
-FFmpegDecoder::~FFmpegDecoder() = default;
+FFmpegDecoder::~FFmpegDecoder()
+{
+    p->context.reset();
+    p->closeFile();
+}
+
+ReadAheadStats FFmpegDecoder::readAheadStats() const
+{
+    return p->file ? p->file->stats() : ReadAheadStats{};
+}
+
+const SeekTable& FFmpegDecoder::seekTable() const
+{
+    return p->seekTable;
+}
+
+void FFmpegDecoder::setSeekTable(SeekTable table)
+{
+    // Keep anything already recorded, such as while the track was preloaded
+    table.setSpacing(p->seekTable.spacing());
+    for(const auto& point : p->seekTable.points()) {
+        table.insert(point);
+    }
+    p->seekTable = std::move(table);
+}
 
 bool FFmpegDecoder::init(const QString& source)
 {
@@ -389,7 +648,7 @@ AudioBuffer FFmpegDecoder::readBuffer()
     }
 
     if(!p->buffer.isValid()) {
-        p->readNext();
+        p->decodeNext();
     }
 
     return std::exchange(p->buffer, {});
@@ -402,7 +661,7 @@ AudioBuffer FFmpegDecoder::readBuffer(size_t bytes)
     }
 
     if(!p->buffer.isValid()) {
-        p->readNext();
+        p->decodeNext();
     }
 
     AudioBuffer buffer;
@@ -413,18 +672,19 @@ AudioBuffer FFmpegDecoder::readBuffer(size_t bytes)
     while(p->buffer.isValid() && bytesWritten < bytesRequested) {
         if(!buffer.isValid()) {
             buffer = {p->buffer.format(), p->buffer.startTime()};
+            buffer.reserve(bytes);
         }
         const int remaining = bytesRequested - bytesWritten;
         const int count     = p->buffer.byteCount() - p->bufferPos;
         if(count <= remaining) {
-            buffer.append(p->buffer.data() + p->bufferPos, count);
+            buffer.append(p->buffer.constData().data() + p->bufferPos, count);
             bytesWritten += count;
             p->buffer    = {};
             p->bufferPos = 0;
-            p->readNext();
+            p->decodeNext();
         }
         else {
-            buffer.append(p->buffer.data() + p->bufferPos, remaining);
+            buffer.append(p->buffer.constData().data() + p->bufferPos, remaining);
             bytesWritten += remaining;
             p->bufferPos += remaining;
         }
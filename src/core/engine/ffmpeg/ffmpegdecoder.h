@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include "engine/readaheadfile.h"
+#include "engine/seektable.h"
+
 #include <core/engine/audiodecoder.h>
 
 namespace Fooyin {
@@ -28,9 +31,24 @@ class AudioBuffer;
 class FFmpegDecoder : public AudioDecoder
 {
 public:
-    FFmpegDecoder();
+    /** Local files are read ahead of the decoder as set by @p options. */
+    explicit FFmpegDecoder(const ReadAheadOptions& options = {});
     ~FFmpegDecoder() override;
 
+    /** Returns the read-ahead statistics for the current file. */
+    [[nodiscard]] ReadAheadStats readAheadStats() const;
+
+    /*!
+     * Returns the table of seek points recorded while decoding, for formats which can be seeked by byte.
+     * Must not be called while another thread is decoding.
+     */
+    [[nodiscard]] const SeekTable& seekTable() const;
+    /*!
+     * Seeks using the points in @p table, such as one recorded on a previous play of the same file.
+     * Points already recorded are kept. Must not be called while another thread is decoding.
+     */
+    void setSeekTable(SeekTable table);
+
     bool init(const QString& source) override;
 
     void start() override;
@@ -0,0 +1,518 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegencoder.h"
+
+#include "ffmpegcodec.h"
+#include "ffmpegframe.h"
+#include "ffmpegpacket.h"
+#include "ffmpegresampler.h"
+#include "ffmpegutils.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/opt.h>
+}
+
+#include <QFile>
+
+#include <algorithm>
+
+// Used for encoders which accept frames of any size
+constexpr auto DefaultFrameSize = 4096;
+
+#define SUPPORTED_CONFIG (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100))
+
+namespace {
+struct OutputContextDeleter
+{
+    void operator()(AVFormatContext* context) const
+    {
+        if(context) {
+            if(context->pb && !(context->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&context->pb);
+            }
+            avformat_free_context(context);
+        }
+    }
+};
+using OutputContextPtr = std::unique_ptr<AVFormatContext, OutputContextDeleter>;
+
+struct AudioFifoDeleter
+{
+    void operator()(AVAudioFifo* fifo) const
+    {
+        if(fifo) {
+            av_audio_fifo_free(fifo);
+        }
+    }
+};
+using AudioFifoPtr = std::unique_ptr<AVAudioFifo, AudioFifoDeleter>;
+
+struct CodecInfo
+{
+    // Preferred encoder, used over FFmpeg's own if available
+    const char* encoder;
+    AVCodecID id;
+    const char* muxer;
+};
+
+CodecInfo codecInfo(Fooyin::ConversionOptions::Codec codec)
+{
+    switch(codec) {
+        case(Fooyin::ConversionOptions::Opus):
+            return {"libopus", AV_CODEC_ID_OPUS, "opus"};
+        case(Fooyin::ConversionOptions::Mp3):
+            return {"libmp3lame", AV_CODEC_ID_MP3, "mp3"};
+        case(Fooyin::ConversionOptions::Aac):
+            return {nullptr, AV_CODEC_ID_AAC, "ipod"};
+        case(Fooyin::ConversionOptions::Flac):
+        default:
+            return {nullptr, AV_CODEC_ID_FLAC, "flac"};
+    }
+}
+
+const AVCodec* findEncoder(const CodecInfo& info)
+{
+    if(info.encoder) {
+        if(const AVCodec* codec = avcodec_find_encoder_by_name(info.encoder)) {
+            return codec;
+        }
+    }
+    return avcodec_find_encoder(info.id);
+}
+
+const AVSampleFormat* supportedFormats(const AVCodec* codec)
+{
+#if SUPPORTED_CONFIG
+    const void* formats{nullptr};
+    avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, &formats, nullptr);
+    return static_cast<const AVSampleFormat*>(formats);
+#else
+    return codec->sample_fmts;
+#endif
+}
+
+const int* supportedRates(const AVCodec* codec)
+{
+#if SUPPORTED_CONFIG
+    const void* rates{nullptr};
+    avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_RATE, 0, &rates, nullptr);
+    return static_cast<const int*>(rates);
+#else
+    return codec->supported_samplerates;
+#endif
+}
+
+AVSampleFormat chooseSampleFormat(const AVCodec* codec, const Fooyin::AudioFormat& format)
+{
+    const AVSampleFormat* formats = supportedFormats(codec);
+    if(!formats) {
+        return Fooyin::Utils::avSampleFormat(format.sampleFormat());
+    }
+
+    // Lossless encoders keep the bit depth; the lossy ones all work in float internally
+    const bool lossless   = codec->id == AV_CODEC_ID_FLAC;
+    const int sampleBytes = format.bytesPerSample() <= 2 ? 2 : 4;
+
+    for(const AVSampleFormat* candidate = formats; *candidate != AV_SAMPLE_FMT_NONE; ++candidate) {
+        const AVSampleFormat packed = av_get_packed_sample_fmt(*candidate);
+        if(lossless ? av_get_bytes_per_sample(packed) == sampleBytes && packed != AV_SAMPLE_FMT_FLT
+                    : packed == AV_SAMPLE_FMT_FLT) {
+            return *candidate;
+        }
+    }
+
+    return formats[0];
+}
+
+int chooseSampleRate(const AVCodec* codec, int sampleRate)
+{
+    const int* rates = supportedRates(codec);
+    if(!rates) {
+        return sampleRate;
+    }
+
+    // The lowest supported rate above the one asked for, so nothing is lost, or failing that the highest
+    int best{0};
+    for(const int* rate = rates; *rate != 0; ++rate) {
+        if(*rate == sampleRate) {
+            return sampleRate;
+        }
+        if(*rate > sampleRate) {
+            if(best < sampleRate || *rate < best) {
+                best = *rate;
+            }
+        }
+        else if(best < sampleRate && *rate > best) {
+            best = *rate;
+        }
+    }
+
+    return best;
+}
+
+int channelCount(const AVCodecContext* context)
+{
+#if OLD_CHANNEL_LAYOUT
+    return context->channels;
+#else
+    return context->ch_layout.nb_channels;
+#endif
+}
+
+bool prepareFrame(AVFrame* frame, const AVCodecContext* context, int samples)
+{
+    frame->format      = context->sample_fmt;
+    frame->sample_rate = context->sample_rate;
+    frame->nb_samples  = samples;
+#if OLD_CHANNEL_LAYOUT
+    frame->channel_layout = context->channel_layout;
+    frame->channels       = context->channels;
+#else
+    if(av_channel_layout_copy(&frame->ch_layout, &context->ch_layout) < 0) {
+        return false;
+    }
+#endif
+    return av_frame_get_buffer(frame, 0) >= 0;
+}
+
+QString errorString(int error)
+{
+    char errStr[AV_ERROR_MAX_STRING_SIZE];
+    av_strerror(error, errStr, AV_ERROR_MAX_STRING_SIZE);
+    return QString::fromUtf8(errStr);
+}
+} // namespace
+
+namespace Fooyin {
+struct FFmpegEncoder::Private
+{
+    OutputContextPtr formatContext;
+    CodecContextPtr context;
+    AVStream* stream{nullptr};
+    SwrContextPtr swr;
+    AudioFifoPtr fifo;
+    FramePtr scratch;
+    PacketPtr packet;
+
+    AudioFormat format;
+    int frameSize{DefaultFrameSize};
+    bool smallLastFrame{false};
+    int64_t nextPts{0};
+
+    QString error;
+
+    bool fail(const QString& message, int ret = 0)
+    {
+        error = ret < 0 ? message + QStringLiteral(": ") + errorString(ret) : message;
+        return false;
+    }
+
+    bool openEncoder(const AVCodec* codec, const ConversionOptions& options)
+    {
+        context.reset(avcodec_alloc_context3(codec));
+        if(!context) {
+            return fail(QStringLiteral("Unable to allocate encoder"));
+        }
+
+        const int sampleRate = options.sampleRate > 0 ? options.sampleRate : format.sampleRate();
+
+        AVCodecContext* ctx = context.get();
+        ctx->sample_fmt     = chooseSampleFormat(codec, format);
+        ctx->sample_rate    = chooseSampleRate(codec, sampleRate);
+        ctx->time_base      = {1, ctx->sample_rate};
+#if OLD_CHANNEL_LAYOUT
+        ctx->channels       = format.channelCount();
+        ctx->channel_layout = av_get_default_channel_layout(format.channelCount());
+#else
+        av_channel_layout_default(&ctx->ch_layout, format.channelCount());
+#endif
+
+        if(codec->id == AV_CODEC_ID_FLAC) {
+            ctx->compression_level = options.compressionLevel;
+            if(format.sampleFormat() == SampleFormat::S24) {
+                ctx->bits_per_raw_sample = 24;
+            }
+        }
+        else {
+            ctx->bit_rate = static_cast<int64_t>(options.bitrate) * 1000;
+        }
+
+        // FFmpeg's own Opus encoder is still marked experimental
+        ctx->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+
+        if(formatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        if(const int ret = avcodec_open2(ctx, codec, nullptr); ret < 0) {
+            return fail(QStringLiteral("Unable to open encoder"), ret);
+        }
+
+        frameSize      = ctx->frame_size > 0 ? ctx->frame_size : DefaultFrameSize;
+        smallLastFrame = codec->capabilities & (AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE);
+
+        return true;
+    }
+
+    bool openResampler()
+    {
+        const AVCodecContext* ctx     = context.get();
+        const AVSampleFormat inFormat = Utils::avSampleFormat(format.sampleFormat());
+
+#if OLD_CHANNEL_LAYOUT
+        swr.reset(swr_alloc_set_opts(nullptr, ctx->channel_layout, ctx->sample_fmt, ctx->sample_rate,
+                                     ctx->channel_layout, inFormat, format.sampleRate(), 0, nullptr));
+#else
+        SwrContext* swrContext{nullptr};
+        if(const int ret = swr_alloc_set_opts2(&swrContext, &ctx->ch_layout, ctx->sample_fmt, ctx->sample_rate,
+                                               &ctx->ch_layout, inFormat, format.sampleRate(), 0, nullptr);
+           ret < 0) {
+            return fail(QStringLiteral("Unable to set up resampler"), ret);
+        }
+        swr.reset(swrContext);
+#endif
+        if(!swr) {
+            return fail(QStringLiteral("Unable to set up resampler"));
+        }
+
+        av_opt_set_int(swr.get(), "dither_method", SWR_DITHER_TRIANGULAR, 0);
+
+        if(const int ret = swr_init(swr.get()); ret < 0) {
+            return fail(QStringLiteral("Unable to set up resampler"), ret);
+        }
+
+        fifo.reset(av_audio_fifo_alloc(ctx->sample_fmt, channelCount(ctx), frameSize));
+        scratch.reset(av_frame_alloc());
+        packet.reset(av_packet_alloc());
+
+        if(!fifo || !scratch || !packet) {
+            return fail(QStringLiteral("Unable to allocate buffers"));
+        }
+
+        return true;
+    }
+
+    bool ensureScratch(int samples)
+    {
+        if(scratch->nb_samples >= samples) {
+            return true;
+        }
+
+        av_frame_unref(scratch.get());
+        return prepareFrame(scratch.get(), context.get(), samples) || fail(QStringLiteral("Unable to allocate frame"));
+    }
+
+    bool convert(const std::byte* data, int frames)
+    {
+        const int maxSamples = swr_get_out_samples(swr.get(), frames);
+        if(maxSamples <= 0) {
+            return true;
+        }
+        if(!ensureScratch(maxSamples)) {
+            return false;
+        }
+
+        const auto* in    = reinterpret_cast<const uint8_t*>(data);
+        const int samples = swr_convert(swr.get(), scratch->data, maxSamples, data ? &in : nullptr, frames);
+        if(samples < 0) {
+            return fail(QStringLiteral("Unable to convert samples"), samples);
+        }
+
+        if(av_audio_fifo_write(fifo.get(), reinterpret_cast<void**>(scratch->data), samples) < samples) {
+            return fail(QStringLiteral("Unable to buffer samples"));
+        }
+
+        return true;
+    }
+
+    bool encodeFrame(int samples)
+    {
+        const FramePtr frame{av_frame_alloc()};
+        // Encoders with a fixed frame size need the last frame padded out with silence
+        const int frameSamples = smallLastFrame ? samples : frameSize;
+
+        if(!frame || !prepareFrame(frame.get(), context.get(), frameSamples)) {
+            return fail(QStringLiteral("Unable to allocate frame"));
+        }
+
+        const int read = av_audio_fifo_read(fifo.get(), reinterpret_cast<void**>(frame->data), samples);
+        if(read < frameSamples) {
+            av_samples_set_silence(frame->data, std::max(read, 0), frameSamples - std::max(read, 0),
+                                   channelCount(context.get()), context->sample_fmt);
+        }
+
+        frame->pts = nextPts;
+        nextPts += frameSamples;
+
+        return sendFrame(frame.get());
+    }
+
+    // Sends @p frame to the encoder and writes out whatever it produces; a null frame flushes the encoder
+    bool sendFrame(const AVFrame* frame)
+    {
+        if(const int ret = avcodec_send_frame(context.get(), frame); ret < 0) {
+            return fail(QStringLiteral("Unable to encode audio"), ret);
+        }
+
+        while(true) {
+            const int ret = avcodec_receive_packet(context.get(), packet.get());
+            if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return true;
+            }
+            if(ret < 0) {
+                return fail(QStringLiteral("Unable to encode audio"), ret);
+            }
+
+            av_packet_rescale_ts(packet.get(), context->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+
+            if(const int writeRet = av_interleaved_write_frame(formatContext.get(), packet.get()); writeRet < 0) {
+                return fail(QStringLiteral("Unable to write to file"), writeRet);
+            }
+        }
+    }
+};
+
+FFmpegEncoder::FFmpegEncoder()
+    : p{std::make_unique<Private>()}
+{ }
+
+FFmpegEncoder::~FFmpegEncoder() = default;
+
+bool FFmpegEncoder::open(const QString& filepath, const AudioFormat& format, const ConversionOptions& options)
+{
+    close();
+    p->error.clear();
+    p->format  = format;
+    p->nextPts = 0;
+
+    if(Utils::avSampleFormat(format.sampleFormat()) == AV_SAMPLE_FMT_NONE) {
+        return p->fail(QStringLiteral("Unsupported sample format"));
+    }
+
+    const CodecInfo info = codecInfo(options.codec);
+    const AVCodec* codec = findEncoder(info);
+    if(!codec) {
+        return p->fail(QStringLiteral("Encoder not available"));
+    }
+
+    const QByteArray path = QFile::encodeName(filepath);
+
+    AVFormatContext* formatContext{nullptr};
+    if(const int ret = avformat_alloc_output_context2(&formatContext, nullptr, info.muxer, path.constData());
+       ret < 0) {
+        return p->fail(QStringLiteral("Unable to create output"), ret);
+    }
+    p->formatContext.reset(formatContext);
+
+    if(!p->openEncoder(codec, options)) {
+        return false;
+    }
+
+    p->stream = avformat_new_stream(formatContext, nullptr);
+    if(!p->stream) {
+        return p->fail(QStringLiteral("Unable to create stream"));
+    }
+
+    if(const int ret = avcodec_parameters_from_context(p->stream->codecpar, p->context.get()); ret < 0) {
+        return p->fail(QStringLiteral("Unable to create stream"), ret);
+    }
+    p->stream->time_base = p->context->time_base;
+
+    if(!(formatContext->oformat->flags & AVFMT_NOFILE)) {
+        if(const int ret = avio_open(&formatContext->pb, path.constData(), AVIO_FLAG_WRITE); ret < 0) {
+            return p->fail(QStringLiteral("Unable to open file"), ret);
+        }
+    }
+
+    if(const int ret = avformat_write_header(formatContext, nullptr); ret < 0) {
+        return p->fail(QStringLiteral("Unable to write header"), ret);
+    }
+
+    return p->openResampler();
+}
+
+bool FFmpegEncoder::write(const AudioBuffer& buffer)
+{
+    if(!p->swr || buffer.format() != p->format) {
+        return p->fail(QStringLiteral("Buffer doesn't match the encoder's format"));
+    }
+
+    if(!p->convert(buffer.constData().data(), buffer.frameCount())) {
+        return false;
+    }
+
+    while(av_audio_fifo_size(p->fifo.get()) >= p->frameSize) {
+        if(!p->encodeFrame(p->frameSize)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FFmpegEncoder::finish()
+{
+    if(!p->swr) {
+        return false;
+    }
+
+    // Drain whatever the resampler is holding back
+    if(!p->convert(nullptr, 0)) {
+        return false;
+    }
+
+    while(const int remaining = av_audio_fifo_size(p->fifo.get())) {
+        if(!p->encodeFrame(std::min(remaining, p->frameSize))) {
+            return false;
+        }
+    }
+
+    if(!p->sendFrame(nullptr)) {
+        return false;
+    }
+
+    if(const int ret = av_write_trailer(p->formatContext.get()); ret < 0) {
+        return p->fail(QStringLiteral("Unable to finish file"), ret);
+    }
+
+    close();
+    return true;
+}
+
+void FFmpegEncoder::close()
+{
+    p->swr.reset();
+    p->fifo.reset();
+    p->scratch.reset();
+    p->packet.reset();
+    p->context.reset();
+    p->stream = nullptr;
+    p->formatContext.reset();
+}
+
+QString FFmpegEncoder::error() const
+{
+    return p->error;
+}
+} // namespace Fooyin
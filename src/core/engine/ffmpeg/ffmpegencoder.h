@@ -0,0 +1,58 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/trackconverter.h>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Encodes a stream of buffers to a file using one of FFmpeg's encoders.
+ * Buffers are converted to the sample format and rate the encoder needs, and regrouped into
+ * frames of the size it expects.
+ * Not thread-safe; each encoder should only be used by a single thread at a time.
+ */
+class FFmpegEncoder
+{
+public:
+    FFmpegEncoder();
+    ~FFmpegEncoder();
+
+    /*!
+     * Creates @p filepath, ready to encode audio in @p format using @p options.
+     * @returns @c false if the encoder or file couldn't be opened; see @fn error.
+     */
+    bool open(const QString& filepath, const AudioFormat& format, const ConversionOptions& options);
+    /** Encodes @p buffer, which must be in the format passed to @fn open. */
+    bool write(const AudioBuffer& buffer);
+    /** Encodes anything still buffered and finishes writing the file. */
+    bool finish();
+    /** Closes the file without finishing it. */
+    void close();
+
+    [[nodiscard]] QString error() const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,187 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegresampler.h"
+
+#include "ffmpegutils.h"
+
+extern "C"
+{
+#include <libavutil/opt.h>
+}
+
+#include <QDebug>
+
+namespace {
+SwrContext* allocContext(const Fooyin::AudioFormat& input, const Fooyin::AudioFormat& output)
+{
+    const AVSampleFormat inFormat  = Fooyin::Utils::avSampleFormat(input.sampleFormat());
+    const AVSampleFormat outFormat = Fooyin::Utils::avSampleFormat(output.sampleFormat());
+
+#if OLD_CHANNEL_LAYOUT
+    const auto layout = av_get_default_channel_layout(input.channelCount());
+    return swr_alloc_set_opts(nullptr, layout, outFormat, output.sampleRate(), layout, inFormat, input.sampleRate(), 0,
+                              nullptr);
+#else
+    AVChannelLayout layout;
+    av_channel_layout_default(&layout, input.channelCount());
+
+    SwrContext* context{nullptr};
+    const int ret = swr_alloc_set_opts2(&context, &layout, outFormat, output.sampleRate(), &layout, inFormat,
+                                        input.sampleRate(), 0, nullptr);
+    av_channel_layout_uninit(&layout);
+
+    if(ret < 0) {
+        Fooyin::Utils::printError(ret);
+        return nullptr;
+    }
+    return context;
+#endif
+}
+} // namespace
+
+namespace Fooyin {
+FFmpegResampler::FFmpegResampler()
+    : m_position{0}
+{ }
+
+bool FFmpegResampler::init(const AudioFormat& input, const AudioFormat& output)
+{
+    m_context.reset();
+    m_inputFormat  = {};
+    m_outputFormat = {};
+    m_position     = 0;
+
+    if(!input.isValid() || !output.isValid() || input.channelCount() != output.channelCount()
+       || Utils::avSampleFormat(input.sampleFormat()) == AV_SAMPLE_FMT_NONE
+       || Utils::avSampleFormat(output.sampleFormat()) == AV_SAMPLE_FMT_NONE) {
+        qWarning() << "Unable to resample unsupported format";
+        return false;
+    }
+
+    SwrContextPtr context{allocContext(input, output)};
+    if(!context) {
+        return false;
+    }
+
+    // A longer, interpolated filter than the default, with dither when reducing bit depth
+    av_opt_set_int(context.get(), "filter_size", 64, 0);
+    av_opt_set_int(context.get(), "phase_shift", 10, 0);
+    av_opt_set_int(context.get(), "linear_interp", 1, 0);
+    av_opt_set_double(context.get(), "cutoff", 0.97, 0);
+    av_opt_set_int(context.get(), "dither_method", SWR_DITHER_TRIANGULAR, 0);
+
+    if(const int ret = swr_init(context.get()); ret < 0) {
+        Utils::printError(ret);
+        return false;
+    }
+
+    m_context      = std::move(context);
+    m_inputFormat  = input;
+    m_outputFormat = output;
+
+    return true;
+}
+
+void FFmpegResampler::reset()
+{
+    if(!m_context) {
+        return;
+    }
+
+    // Reinitialising the existing context drops the filter history without reallocating it
+    swr_close(m_context.get());
+    if(const int ret = swr_init(m_context.get()); ret < 0) {
+        Utils::printError(ret);
+        m_context.reset();
+    }
+    m_position = 0;
+}
+
+bool FFmpegResampler::isInitialised() const
+{
+    return !!m_context;
+}
+
+AudioFormat FFmpegResampler::inputFormat() const
+{
+    return m_inputFormat;
+}
+
+AudioFormat FFmpegResampler::outputFormat() const
+{
+    return m_outputFormat;
+}
+
+AudioBuffer FFmpegResampler::process(const AudioBuffer& buffer)
+{
+    if(!m_context || !buffer.isValid() || buffer.format() != m_inputFormat) {
+        return {};
+    }
+
+    // Output is timed from the input, less whatever the filter is holding back
+    const auto delay = static_cast<uint64_t>(swr_get_delay(m_context.get(), 1000));
+    m_position       = buffer.startTime() > delay ? buffer.startTime() - delay : 0;
+
+    return convert(buffer.constData().data(), buffer.frameCount(), m_position);
+}
+
+AudioBuffer FFmpegResampler::flush()
+{
+    if(!m_context) {
+        return {};
+    }
+
+    const uint64_t startTime = m_position;
+    auto buffer              = convert(nullptr, 0, startTime);
+
+    m_context.reset();
+    m_inputFormat  = {};
+    m_outputFormat = {};
+
+    return buffer;
+}
+
+AudioBuffer FFmpegResampler::convert(const std::byte* data, int frames, uint64_t startTime)
+{
+    const int maxFrames = swr_get_out_samples(m_context.get(), frames);
+    if(maxFrames <= 0) {
+        return {};
+    }
+
+    AudioBuffer output{m_outputFormat, startTime};
+    output.resize(static_cast<size_t>(m_outputFormat.bytesForFrames(maxFrames)));
+
+    auto* out      = reinterpret_cast<uint8_t*>(output.data());
+    const auto* in = reinterpret_cast<const uint8_t*>(data);
+
+    const int count = swr_convert(m_context.get(), &out, maxFrames, data ? &in : nullptr, frames);
+    if(count <= 0) {
+        if(count < 0) {
+            Utils::printError(count);
+        }
+        return {};
+    }
+
+    output.resize(static_cast<size_t>(m_outputFormat.bytesForFrames(count)));
+    m_position = startTime + m_outputFormat.durationForFrames(count);
+
+    return output;
+}
+} // namespace Fooyin
@@ -0,0 +1,89 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/audioformat.h>
+
+extern "C"
+{
+#include <libswresample/swresample.h>
+}
+
+#include <memory>
+
+namespace Fooyin {
+struct SwrContextDeleter
+{
+    void operator()(SwrContext* context) const
+    {
+        if(context != nullptr) {
+            swr_free(&context);
+        }
+    }
+};
+using SwrContextPtr = std::unique_ptr<SwrContext, SwrContextDeleter>;
+
+/*!
+ * Converts a stream of buffers to a different sample rate and sample format using libswresample.
+ * The channel count is left unchanged.
+ * Not thread-safe; owned by whichever thread processes the audio.
+ */
+class FYCORE_EXPORT FFmpegResampler
+{
+public:
+    FFmpegResampler();
+
+    /*!
+     * Sets up conversion of buffers in @p input to @p output, discarding anything still buffered.
+     * This allocates, so should be done before audio starts flowing where possible.
+     * @returns @c false if the conversion isn't supported.
+     */
+    bool init(const AudioFormat& input, const AudioFormat& output);
+    /** Drops any buffered audio, ready to convert from a new position in the stream. */
+    void reset();
+
+    [[nodiscard]] bool isInitialised() const;
+    [[nodiscard]] AudioFormat inputFormat() const;
+    [[nodiscard]] AudioFormat outputFormat() const;
+
+    /*!
+     * Converts @p buffer, which must be in the input format.
+     * The filter holds back a few frames, so the result is slightly shorter than the input
+     * and its start time is moved back to match.
+     */
+    AudioBuffer process(const AudioBuffer& buffer);
+    /*!
+     * Returns the frames held back by the filter at the end of the stream.
+     * The resampler needs to be initialised again before any further conversion.
+     */
+    AudioBuffer flush();
+
+private:
+    AudioBuffer convert(const std::byte* data, int frames, uint64_t startTime);
+
+    SwrContextPtr m_context;
+    AudioFormat m_inputFormat;
+    AudioFormat m_outputFormat;
+    uint64_t m_position;
+};
+} // namespace Fooyin
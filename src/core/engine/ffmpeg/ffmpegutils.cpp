@@ -79,4 +79,23 @@ AudioFormat audioFormatFromCodec(AVCodecParameters* codec)
 
     return format;
 }
+
+AVSampleFormat avSampleFormat(SampleFormat format)
+{
+    switch(format) {
+        case(SampleFormat::U8):
+            return AV_SAMPLE_FMT_U8;
+        case(SampleFormat::S16):
+            return AV_SAMPLE_FMT_S16;
+        // S24 is stored in the upper bits of a 32bit int
+        case(SampleFormat::S24):
+        case(SampleFormat::S32):
+            return AV_SAMPLE_FMT_S32;
+        case(SampleFormat::Float):
+            return AV_SAMPLE_FMT_FLT;
+        case(SampleFormat::Unknown):
+        default:
+            return AV_SAMPLE_FMT_NONE;
+    }
+}
 } // namespace Fooyin::Utils
@@ -36,4 +36,6 @@ namespace Fooyin::Utils {
 void printError(int error);
 void printError(const QString& error);
 AudioFormat audioFormatFromCodec(AVCodecParameters* codec);
+/** Returns the interleaved sample format matching @p format, or AV_SAMPLE_FMT_NONE if there isn't one. */
+AVSampleFormat avSampleFormat(SampleFormat format);
 } // namespace Fooyin::Utils
@@ -0,0 +1,239 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FY_X86_KERNELS
+#include <immintrin.h>
+#define FY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+using Fooyin::Audio::KernelIsa;
+
+// Runs one stage of radix-2 butterflies over split complex data, pairing each element with the one @p half after it
+using ButterflyStage = void (*)(float* re, float* im, const float* twRe, const float* twIm, int size, int half);
+
+void scalarStage(float* re, float* im, const float* twRe, const float* twIm, int size, int half)
+{
+    for(int start{0}; start < size; start += half * 2) {
+        float* aRe = re + start;
+        float* aIm = im + start;
+        float* bRe = aRe + half;
+        float* bIm = aIm + half;
+
+        for(int j{0}; j < half; ++j) {
+            const float tRe = (twRe[j] * bRe[j]) - (twIm[j] * bIm[j]);
+            const float tIm = (twRe[j] * bIm[j]) + (twIm[j] * bRe[j]);
+
+            bRe[j] = aRe[j] - tRe;
+            bIm[j] = aIm[j] - tIm;
+            aRe[j] += tRe;
+            aIm[j] += tIm;
+        }
+    }
+}
+
+#ifdef FY_X86_KERNELS
+void sse2Stage(float* re, float* im, const float* twRe, const float* twIm, int size, int half)
+{
+    for(int start{0}; start < size; start += half * 2) {
+        float* aRe = re + start;
+        float* aIm = im + start;
+        float* bRe = aRe + half;
+        float* bIm = aIm + half;
+
+        // Only used for stages where half is a multiple of 4
+        for(int j{0}; j < half; j += 4) {
+            const __m128 wRe = _mm_loadu_ps(twRe + j);
+            const __m128 wIm = _mm_loadu_ps(twIm + j);
+            const __m128 xRe = _mm_loadu_ps(bRe + j);
+            const __m128 xIm = _mm_loadu_ps(bIm + j);
+            const __m128 yRe = _mm_loadu_ps(aRe + j);
+            const __m128 yIm = _mm_loadu_ps(aIm + j);
+
+            const __m128 tRe = _mm_sub_ps(_mm_mul_ps(wRe, xRe), _mm_mul_ps(wIm, xIm));
+            const __m128 tIm = _mm_add_ps(_mm_mul_ps(wRe, xIm), _mm_mul_ps(wIm, xRe));
+
+            _mm_storeu_ps(bRe + j, _mm_sub_ps(yRe, tRe));
+            _mm_storeu_ps(bIm + j, _mm_sub_ps(yIm, tIm));
+            _mm_storeu_ps(aRe + j, _mm_add_ps(yRe, tRe));
+            _mm_storeu_ps(aIm + j, _mm_add_ps(yIm, tIm));
+        }
+    }
+}
+
+FY_TARGET_AVX2 void avx2Stage(float* re, float* im, const float* twRe, const float* twIm, int size, int half)
+{
+    for(int start{0}; start < size; start += half * 2) {
+        float* aRe = re + start;
+        float* aIm = im + start;
+        float* bRe = aRe + half;
+        float* bIm = aIm + half;
+
+        // Only used for stages where half is a multiple of 8
+        for(int j{0}; j < half; j += 8) {
+            const __m256 wRe = _mm256_loadu_ps(twRe + j);
+            const __m256 wIm = _mm256_loadu_ps(twIm + j);
+            const __m256 xRe = _mm256_loadu_ps(bRe + j);
+            const __m256 xIm = _mm256_loadu_ps(bIm + j);
+            const __m256 yRe = _mm256_loadu_ps(aRe + j);
+            const __m256 yIm = _mm256_loadu_ps(aIm + j);
+
+            const __m256 tRe = _mm256_sub_ps(_mm256_mul_ps(wRe, xRe), _mm256_mul_ps(wIm, xIm));
+            const __m256 tIm = _mm256_add_ps(_mm256_mul_ps(wRe, xIm), _mm256_mul_ps(wIm, xRe));
+
+            _mm256_storeu_ps(bRe + j, _mm256_sub_ps(yRe, tRe));
+            _mm256_storeu_ps(bIm + j, _mm256_sub_ps(yIm, tIm));
+            _mm256_storeu_ps(aRe + j, _mm256_add_ps(yRe, tRe));
+            _mm256_storeu_ps(aIm + j, _mm256_add_ps(yIm, tIm));
+        }
+    }
+}
+#endif
+
+// Early stages are too narrow to fill a vector, so fall back to narrower kernels for those
+ButterflyStage butterflyStage([[maybe_unused]] KernelIsa isa, [[maybe_unused]] int half)
+{
+#ifdef FY_X86_KERNELS
+    if(isa >= KernelIsa::AVX2 && half >= 8) {
+        return avx2Stage;
+    }
+    if(isa >= KernelIsa::SSE2 && half >= 4) {
+        return sse2Stage;
+    }
+#endif
+    return scalarStage;
+}
+} // namespace
+
+namespace Fooyin::Audio {
+Fft::Fft(int size)
+    : Fft{size, detectedIsa()}
+{ }
+
+Fft::Fft(int size, KernelIsa isa)
+    : m_size{size}
+    , m_isa{std::min(isa, detectedIsa())}
+{
+    // The real transform is computed with a complex one of half the size
+    const int half = size / 2;
+
+    int bits{0};
+    while((1 << bits) < half) {
+        ++bits;
+    }
+
+    m_bitReverse.resize(half);
+    for(int i{0}; i < half; ++i) {
+        int reversed{0};
+        for(int bit{0}; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_bitReverse.at(i) = reversed;
+    }
+
+    // Stage with butterflies of width h uses the h twiddles starting at h - 1
+    m_twiddleRe.reserve(half);
+    m_twiddleIm.reserve(half);
+    for(int h{1}; h < half; h *= 2) {
+        for(int j{0}; j < h; ++j) {
+            const double angle = -std::numbers::pi * j / h;
+            m_twiddleRe.push_back(static_cast<float>(std::cos(angle)));
+            m_twiddleIm.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    m_splitRe.resize(half + 1);
+    m_splitIm.resize(half + 1);
+    for(int k{0}; k <= half; ++k) {
+        const double angle = -2.0 * std::numbers::pi * k / size;
+        m_splitRe.at(k)    = static_cast<float>(std::cos(angle));
+        m_splitIm.at(k)    = static_cast<float>(std::sin(angle));
+    }
+
+    m_re.resize(half);
+    m_im.resize(half);
+    m_binRe.resize(half + 1);
+    m_binIm.resize(half + 1);
+}
+
+int Fft::size() const
+{
+    return m_size;
+}
+
+int Fft::binCount() const
+{
+    return (m_size / 2) + 1;
+}
+
+void Fft::forward(const float* input, float* real, float* imag)
+{
+    const int half = m_size / 2;
+
+    // Pack even samples into the real part and odd into the imaginary, already in bit-reversed order
+    for(int i{0}; i < half; ++i) {
+        const int index = m_bitReverse[i];
+        m_re[index]     = input[i * 2];
+        m_im[index]     = input[(i * 2) + 1];
+    }
+
+    transform();
+
+    // Separate the transforms of the even and odd samples, then combine them into the full-size one
+    for(int k{0}; k <= half; ++k) {
+        const int a = k % half;
+        const int b = (half - k) % half;
+
+        const float evenRe = 0.5F * (m_re[a] + m_re[b]);
+        const float evenIm = 0.5F * (m_im[a] - m_im[b]);
+        const float oddRe  = 0.5F * (m_im[a] + m_im[b]);
+        const float oddIm  = 0.5F * (m_re[b] - m_re[a]);
+
+        real[k] = evenRe + (m_splitRe[k] * oddRe) - (m_splitIm[k] * oddIm);
+        imag[k] = evenIm + (m_splitRe[k] * oddIm) + (m_splitIm[k] * oddRe);
+    }
+}
+
+void Fft::magnitudes(const float* input, float* output)
+{
+    forward(input, m_binRe.data(), m_binIm.data());
+
+    const int count = binCount();
+    for(int k{0}; k < count; ++k) {
+        output[k] = std::sqrt((m_binRe[k] * m_binRe[k]) + (m_binIm[k] * m_binIm[k]));
+    }
+}
+
+void Fft::transform()
+{
+    const int half = m_size / 2;
+
+    for(int h{1}; h < half; h *= 2) {
+        butterflyStage(m_isa, h)(m_re.data(), m_im.data(), m_twiddleRe.data() + h - 1, m_twiddleIm.data() + h - 1,
+                                 half, h);
+    }
+}
+} // namespace Fooyin::Audio
@@ -0,0 +1,68 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "audiokernels.h"
+
+#include <vector>
+
+namespace Fooyin::Audio {
+/*!
+ * A forward FFT of real input, with the butterflies vectorised for the current CPU.
+ * Tables are computed once on construction, and transforms never allocate.
+ * Not thread-safe; each thread should use its own instance.
+ */
+class FYCORE_EXPORT Fft
+{
+public:
+    /** Creates a transform of @p size samples, which must be a power of two of at least 4. */
+    explicit Fft(int size);
+    /** Creates a transform using a specific instruction set. Intended for testing and benchmarking. */
+    Fft(int size, KernelIsa isa);
+
+    [[nodiscard]] int size() const;
+    /** Returns the number of bins produced, from DC up to and including the Nyquist frequency. */
+    [[nodiscard]] int binCount() const;
+
+    /** Transforms @p size() samples of @p input, writing @p binCount() complex bins to @p real and @p imag. */
+    void forward(const float* input, float* real, float* imag);
+    /** Writes the magnitude of each of the @p binCount() bins of @p input to @p output. */
+    void magnitudes(const float* input, float* output);
+
+private:
+    void transform();
+
+    int m_size;
+    KernelIsa m_isa;
+    std::vector<int> m_bitReverse;
+    // Twiddles for each stage of the half-size complex transform, one stage after another
+    std::vector<float> m_twiddleRe;
+    std::vector<float> m_twiddleIm;
+    // Twiddles used to split the complex transform back into the real one
+    std::vector<float> m_splitRe;
+    std::vector<float> m_splitIm;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_binRe;
+    std::vector<float> m_binIm;
+};
+} // namespace Fooyin::Audio
@@ -0,0 +1,431 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "loudness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FY_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Loudness of a block below which it's ignored entirely, in LUFS
+constexpr double AbsoluteGate = -70.0;
+// Loudness relative to the ungated measurement below which a block is ignored, in LU
+constexpr double RelativeGate = -10.0;
+// Offset making a 997Hz full scale sine read -3.01 LUFS on a single channel
+constexpr double LoudnessOffset = -0.691;
+
+// Blocks are made up of four 100ms sub-blocks, overlapping each other by 75%
+constexpr int SubBlocksPerSecond = 10;
+constexpr int SubBlocksPerBlock  = 4;
+
+// Peaks are measured at 4x the sample rate below this
+constexpr int OversampleLimit = 96000;
+
+namespace {
+using Coefficients = std::array<std::array<double, 5>, 2>;
+
+constexpr int PeakTaps   = 12;
+constexpr int PeakPhases = 4;
+
+// The 48 tap interpolation filter from BS.1770-4 annex 2, split into its four phases.
+// Stored by tap so all phases can be computed at once from a single input sample.
+alignas(16) constexpr std::array<std::array<float, PeakPhases>, PeakTaps> PeakFilter{{
+    {0.0017089843750F, -0.0291748046875F, -0.0189208984375F, -0.0083007812500F},
+    {0.0109863281250F, 0.0292968750000F, 0.0330810546875F, 0.0148925781250F},
+    {-0.0196533203125F, -0.0517578125000F, -0.0582275390625F, -0.0266113281250F},
+    {0.0332031250000F, 0.0891113281250F, 0.1015625000000F, 0.0476074218750F},
+    {-0.0594482421875F, -0.1665039062500F, -0.2003173828125F, -0.1022949218750F},
+    {0.1373291015625F, 0.4650878906250F, 0.7797851562500F, 0.9721679687500F},
+    {0.9721679687500F, 0.7797851562500F, 0.4650878906250F, 0.1373291015625F},
+    {-0.1022949218750F, -0.2003173828125F, -0.1665039062500F, -0.0594482421875F},
+    {0.0476074218750F, 0.1015625000000F, 0.0891113281250F, 0.0332031250000F},
+    {-0.0266113281250F, -0.0582275390625F, -0.0517578125000F, -0.0196533203125F},
+    {0.0148925781250F, 0.0330810546875F, 0.0292968750000F, 0.0109863281250F},
+    {-0.0083007812500F, -0.0189208984375F, -0.0291748046875F, 0.0017089843750F},
+}};
+
+Coefficients kWeighting(int sampleRate)
+{
+    Coefficients coeffs{};
+    const double rate = sampleRate;
+
+    // High shelf modelling the acoustic effect of the head
+    {
+        constexpr double Freq = 1681.974450955533;
+        constexpr double Gain = 3.999843853973347;
+        constexpr double Q    = 0.7071752369554196;
+
+        const double k  = std::tan(std::numbers::pi * Freq / rate);
+        const double vh = std::pow(10.0, Gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / Q + k * k;
+
+        coeffs[0] = {(vh + vb * k / Q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / Q + k * k) / a0,
+                     2.0 * (k * k - 1.0) / a0, (1.0 - k / Q + k * k) / a0};
+    }
+
+    // RLB high-pass
+    {
+        constexpr double Freq = 38.13547087602444;
+        constexpr double Q    = 0.5003270373238773;
+
+        const double k  = std::tan(std::numbers::pi * Freq / rate);
+        const double a0 = 1.0 + k / Q + k * k;
+
+        coeffs[1] = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / Q + k * k) / a0};
+    }
+
+    return coeffs;
+}
+
+double channelWeight(int channel, int channels)
+{
+    // Assumes the usual WAVEFORMATEXTENSIBLE order for surround layouts
+    if(channels == 6 || channels == 8) {
+        if(channel == 3) {
+            return 0.0;
+        }
+        if(channel >= 4) {
+            return 1.41;
+        }
+    }
+    return 1.0;
+}
+
+double energyToLoudness(double energy)
+{
+    return LoudnessOffset + 10.0 * std::log10(energy);
+}
+
+double loudnessToEnergy(double loudness)
+{
+    return std::pow(10.0, (loudness - LoudnessOffset) / 10.0);
+}
+
+/*!
+ * Runs channels from @p firstChannel onwards through both K-weighting stages,
+ * adding the square of each output to the channel's entry in @p sums.
+ * @p state holds each stage's z1 and z2 in turn, each @p stride values long.
+ */
+void kWeightScalar(const Coefficients& coeffs, double* state, int stride, double* sums, const float* samples,
+                   int frames, int channels, int firstChannel)
+{
+    const auto& [b0, b1, b2, a1, a2]      = coeffs[0];
+    const auto& [hb0, hb1, hb2, ha1, ha2] = coeffs[1];
+
+    for(int ch{firstChannel}; ch < channels; ++ch) {
+        double z01 = state[ch];
+        double z02 = state[stride + ch];
+        double z11 = state[(2 * stride) + ch];
+        double z12 = state[(3 * stride) + ch];
+        double sum{0.0};
+
+        for(int frame{0}; frame < frames; ++frame) {
+            const double in = samples[(frame * channels) + ch];
+
+            const double shelved = (b0 * in) + z01;
+            z01                  = (b1 * in) - (a1 * shelved) + z02;
+            z02                  = (b2 * in) - (a2 * shelved);
+
+            const double out = (hb0 * shelved) + z11;
+            z11              = (hb1 * shelved) - (ha1 * out) + z12;
+            z12              = (hb2 * shelved) - (ha2 * out);
+
+            sum += out * out;
+        }
+
+        state[ch]                = z01;
+        state[stride + ch]       = z02;
+        state[(2 * stride) + ch] = z11;
+        state[(3 * stride) + ch] = z12;
+        sums[ch] += sum;
+    }
+}
+
+#ifdef FY_X86_KERNELS
+// As kWeightScalar, filtering two channels at a time; any odd channel left over is filtered by kWeightScalar
+void kWeightSse2(const Coefficients& coeffs, double* state, int stride, double* sums, const float* samples,
+                 int frames, int channels)
+{
+    const __m128d b0 = _mm_set1_pd(coeffs[0][0]);
+    const __m128d b1 = _mm_set1_pd(coeffs[0][1]);
+    const __m128d b2 = _mm_set1_pd(coeffs[0][2]);
+    const __m128d a1 = _mm_set1_pd(coeffs[0][3]);
+    const __m128d a2 = _mm_set1_pd(coeffs[0][4]);
+
+    const __m128d hb0 = _mm_set1_pd(coeffs[1][0]);
+    const __m128d hb1 = _mm_set1_pd(coeffs[1][1]);
+    const __m128d hb2 = _mm_set1_pd(coeffs[1][2]);
+    const __m128d ha1 = _mm_set1_pd(coeffs[1][3]);
+    const __m128d ha2 = _mm_set1_pd(coeffs[1][4]);
+
+    int ch{0};
+    for(; ch + 1 < channels; ch += 2) {
+        __m128d z01 = _mm_loadu_pd(state + ch);
+        __m128d z02 = _mm_loadu_pd(state + stride + ch);
+        __m128d z11 = _mm_loadu_pd(state + (2 * stride) + ch);
+        __m128d z12 = _mm_loadu_pd(state + (3 * stride) + ch);
+        __m128d sum = _mm_setzero_pd();
+
+        const float* input = samples + ch;
+        for(int frame{0}; frame < frames; ++frame, input += channels) {
+            const __m128d in
+                = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input))));
+
+            const __m128d shelved = _mm_add_pd(_mm_mul_pd(b0, in), z01);
+            z01 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, in), _mm_mul_pd(a1, shelved)), z02);
+            z02 = _mm_sub_pd(_mm_mul_pd(b2, in), _mm_mul_pd(a2, shelved));
+
+            const __m128d out = _mm_add_pd(_mm_mul_pd(hb0, shelved), z11);
+            z11 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hb1, shelved), _mm_mul_pd(ha1, out)), z12);
+            z12 = _mm_sub_pd(_mm_mul_pd(hb2, shelved), _mm_mul_pd(ha2, out));
+
+            sum = _mm_add_pd(sum, _mm_mul_pd(out, out));
+        }
+
+        _mm_storeu_pd(state + ch, z01);
+        _mm_storeu_pd(state + stride + ch, z02);
+        _mm_storeu_pd(state + (2 * stride) + ch, z11);
+        _mm_storeu_pd(state + (3 * stride) + ch, z12);
+        _mm_storeu_pd(sums + ch, _mm_add_pd(_mm_loadu_pd(sums + ch), sum));
+    }
+
+    kWeightScalar(coeffs, state, stride, sums, samples, frames, channels, ch);
+}
+
+float interpolatedPeakSse2(const float* history)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    __m128 acc = _mm_setzero_ps();
+    for(int tap{0}; tap < PeakTaps; ++tap) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(PeakFilter[tap].data()), _mm_set1_ps(history[tap])));
+    }
+    acc = _mm_and_ps(acc, absMask);
+
+    acc = _mm_max_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_max_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(acc);
+}
+#endif
+
+float interpolatedPeakScalar(const float* history)
+{
+    std::array<float, PeakPhases> acc{};
+    for(int tap{0}; tap < PeakTaps; ++tap) {
+        for(int phase{0}; phase < PeakPhases; ++phase) {
+            acc[phase] += PeakFilter[tap][phase] * history[tap];
+        }
+    }
+
+    float peak{0.0F};
+    for(const float sample : acc) {
+        peak = std::max(peak, std::abs(sample));
+    }
+    return peak;
+}
+} // namespace
+
+namespace Fooyin {
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels, [[maybe_unused]] Audio::KernelIsa isa)
+    : m_sampleRate{std::max(sampleRate, 1)}
+    , m_channels{std::max(channels, 1)}
+#ifdef FY_X86_KERNELS
+    , m_useSse2{std::min(isa, Audio::detectedIsa()) >= Audio::KernelIsa::SSE2}
+#else
+    , m_useSse2{false}
+#endif
+    , m_coeffs{kWeighting(m_sampleRate)}
+    , m_subBlockLength{std::max(m_sampleRate / SubBlocksPerSecond, 1)}
+    , m_subBlockFrames{0}
+    , m_subBlocks{}
+    , m_subBlockCount{0}
+    , m_oversample{m_sampleRate < OversampleLimit}
+    , m_peakPos{0}
+    , m_peak{0.0}
+{
+    m_weights.resize(m_channels);
+    for(int ch{0}; ch < m_channels; ++ch) {
+        m_weights[ch] = channelWeight(ch, m_channels);
+    }
+
+    reset();
+}
+
+int LoudnessMeter::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int LoudnessMeter::channels() const
+{
+    return m_channels;
+}
+
+void LoudnessMeter::process(const float* samples, int frames)
+{
+    while(frames > 0) {
+        const int count = std::min(frames, m_subBlockLength - m_subBlockFrames);
+
+#ifdef FY_X86_KERNELS
+        if(m_useSse2) {
+            kWeightSse2(m_coeffs, m_state.data(), m_channels, m_sums.data(), samples, count, m_channels);
+        }
+        else {
+            kWeightScalar(m_coeffs, m_state.data(), m_channels, m_sums.data(), samples, count, m_channels, 0);
+        }
+#else
+        kWeightScalar(m_coeffs, m_state.data(), m_channels, m_sums.data(), samples, count, m_channels, 0);
+#endif
+        findPeaks(samples, count);
+
+        m_subBlockFrames += count;
+        if(m_subBlockFrames == m_subBlockLength) {
+            finishSubBlock();
+        }
+
+        samples += static_cast<ptrdiff_t>(count) * m_channels;
+        frames -= count;
+    }
+}
+
+void LoudnessMeter::reset()
+{
+    m_state.assign(static_cast<size_t>(m_channels) * 4, 0.0);
+    m_sums.assign(m_channels, 0.0);
+    m_subBlockFrames = 0;
+    m_subBlockCount  = 0;
+    m_blocks.clear();
+
+    m_peakHistory.assign(static_cast<size_t>(m_channels) * PeakTaps * 2, 0.0F);
+    m_peakPos = 0;
+    m_peak    = 0.0;
+}
+
+double LoudnessMeter::integratedLoudness() const
+{
+    return integratedLoudness(m_blocks);
+}
+
+double LoudnessMeter::truePeak() const
+{
+    return m_peak;
+}
+
+const std::vector<double>& LoudnessMeter::blocks() const
+{
+    return m_blocks;
+}
+
+double LoudnessMeter::integratedLoudness(const std::vector<double>& blocks)
+{
+    const auto gatedMean = [&blocks](double threshold) {
+        double sum{0.0};
+        size_t count{0};
+        for(const double energy : blocks) {
+            if(energy > threshold) {
+                sum += energy;
+                ++count;
+            }
+        }
+        return count > 0 ? sum / static_cast<double>(count) : 0.0;
+    };
+
+    const double absoluteThreshold = loudnessToEnergy(AbsoluteGate);
+    const double ungated           = gatedMean(absoluteThreshold);
+    if(ungated <= 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    const double relativeThreshold = loudnessToEnergy(energyToLoudness(ungated) + RelativeGate);
+    const double gated             = gatedMean(std::max(absoluteThreshold, relativeThreshold));
+
+    return energyToLoudness(gated);
+}
+
+void LoudnessMeter::findPeaks(const float* samples, int frames)
+{
+    float peak = static_cast<float>(m_peak);
+
+    if(!m_oversample) {
+        const int count = frames * m_channels;
+        for(int i{0}; i < count; ++i) {
+            peak = std::max(peak, std::abs(samples[i]));
+        }
+        m_peak = peak;
+        return;
+    }
+
+    for(int frame{0}; frame < frames; ++frame) {
+        // Newest sample first, so each tap lines up with its coefficients
+        m_peakPos = (m_peakPos + PeakTaps - 1) % PeakTaps;
+
+        for(int ch{0}; ch < m_channels; ++ch) {
+            const float sample = samples[(frame * m_channels) + ch];
+            float* history     = m_peakHistory.data() + (static_cast<ptrdiff_t>(ch) * PeakTaps * 2);
+
+            history[m_peakPos]            = sample;
+            history[m_peakPos + PeakTaps] = sample;
+
+#ifdef FY_X86_KERNELS
+            const float interpolated = m_useSse2 ? interpolatedPeakSse2(history + m_peakPos)
+                                                 : interpolatedPeakScalar(history + m_peakPos);
+#else
+            const float interpolated = interpolatedPeakScalar(history + m_peakPos);
+#endif
+            peak = std::max({peak, std::abs(sample), interpolated});
+        }
+    }
+
+    m_peak = peak;
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    double energy{0.0};
+    for(int ch{0}; ch < m_channels; ++ch) {
+        energy += m_weights[ch] * m_sums[ch];
+    }
+    energy /= m_subBlockLength;
+
+    std::ranges::fill(m_sums, 0.0);
+    m_subBlockFrames = 0;
+
+    // Silence would otherwise leave the filters decaying through denormals
+    for(double& state : m_state) {
+        if(std::abs(state) < 1e-30) {
+            state = 0.0;
+        }
+    }
+
+    m_subBlocks[m_subBlockCount % SubBlocksPerBlock] = energy;
+    ++m_subBlockCount;
+
+    if(m_subBlockCount >= SubBlocksPerBlock) {
+        m_blocks.push_back(std::accumulate(m_subBlocks.cbegin(), m_subBlocks.cend(), 0.0) / SubBlocksPerBlock);
+    }
+}
+} // namespace Fooyin
@@ -0,0 +1,87 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "audiokernels.h"
+
+#include <array>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Measures loudness as described in ITU-R BS.1770-4 and EBU R128.
+ * Samples are K-weighted and gated over 400ms blocks, and the true peak is found by oversampling 4x.
+ * Channel pairs are filtered together where the CPU supports it.
+ */
+class FYCORE_EXPORT LoudnessMeter
+{
+public:
+    LoudnessMeter(int sampleRate, int channels, Audio::KernelIsa isa = Audio::detectedIsa());
+
+    [[nodiscard]] int sampleRate() const;
+    [[nodiscard]] int channels() const;
+
+    /** Feeds @p frames frames of interleaved float samples. */
+    void process(const float* samples, int frames);
+    void reset();
+
+    /** Returns the gated loudness in LUFS, or -infinity if nothing was loud enough to measure. */
+    [[nodiscard]] double integratedLoudness() const;
+    /** Returns the larger of the true peak and the sample peak, as a linear amplitude. */
+    [[nodiscard]] double truePeak() const;
+
+    /*!
+     * Returns the mean square energy of each 400ms block measured so far.
+     * Blocks from several tracks can be combined to measure an album as a whole.
+     */
+    [[nodiscard]] const std::vector<double>& blocks() const;
+    /** Returns the gated loudness in LUFS of @p blocks, or -infinity if nothing was loud enough to measure. */
+    static double integratedLoudness(const std::vector<double>& blocks);
+
+private:
+    void findPeaks(const float* samples, int frames);
+    void finishSubBlock();
+
+    int m_sampleRate;
+    int m_channels;
+    bool m_useSse2;
+
+    // Shelf then high-pass biquads, as {b0, b1, b2, a1, a2}
+    std::array<std::array<double, 5>, 2> m_coeffs;
+    // Filter state, as {z1, z2} for each stage, stored per channel so pairs of channels can be loaded together
+    std::vector<double> m_state;
+    std::vector<double> m_weights;
+    std::vector<double> m_sums;
+
+    int m_subBlockLength;
+    int m_subBlockFrames;
+    std::array<double, 4> m_subBlocks;
+    int m_subBlockCount;
+    std::vector<double> m_blocks;
+
+    bool m_oversample;
+    // The last few samples of each channel, stored twice over so they can always be read contiguously
+    std::vector<float> m_peakHistory;
+    int m_peakPos;
+    double m_peak;
+};
+} // namespace Fooyin
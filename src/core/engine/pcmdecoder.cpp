@@ -0,0 +1,617 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pcmdecoder.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Number of frames handed out by each call to readBuffer
+constexpr auto BufferFrames = 4096;
+// Bytes read to find the format and audio data, growing up to MaxHeaderSize if other chunks come first
+constexpr uint64_t HeaderReadSize = 64 * 1024;
+constexpr uint64_t MaxHeaderSize  = 32 * 1024 * 1024;
+
+namespace {
+constexpr bool NativeBigEndian = std::endian::native == std::endian::big;
+
+bool hasId(const std::byte* data, const char* id)
+{
+    return std::memcmp(data, id, 4) == 0;
+}
+
+uint16_t readU16(const std::byte* data, bool bigEndian)
+{
+    const auto b0 = std::to_integer<uint16_t>(data[0]);
+    const auto b1 = std::to_integer<uint16_t>(data[1]);
+    return bigEndian ? static_cast<uint16_t>((b0 << 8) | b1) : static_cast<uint16_t>((b1 << 8) | b0);
+}
+
+uint32_t readU32(const std::byte* data, bool bigEndian)
+{
+    const uint32_t high = readU16(data + (bigEndian ? 0 : 2), bigEndian);
+    const uint32_t low  = readU16(data + (bigEndian ? 2 : 0), bigEndian);
+    return (high << 16) | low;
+}
+
+uint64_t readU64(const std::byte* data, bool bigEndian)
+{
+    const uint64_t high = readU32(data + (bigEndian ? 0 : 4), bigEndian);
+    const uint64_t low  = readU32(data + (bigEndian ? 4 : 0), bigEndian);
+    return (high << 32) | low;
+}
+
+// AIFF stores its sample rate as an 80bit IEEE extended float
+double readExtended(const std::byte* data)
+{
+    const int exponent      = readU16(data, true) & 0x7FFF;
+    const uint64_t mantissa = readU64(data + 2, true);
+    if(exponent == 0 && mantissa == 0) {
+        return 0.0;
+    }
+
+    const double value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+    return (std::to_integer<int>(data[0]) & 0x80) ? -value : value;
+}
+
+using UnpackFunc = void (*)(const std::byte* input, std::byte* output, int samples);
+
+// AIFF's 8bit samples are signed, whereas U8 is offset binary
+void unpackS8(const std::byte* input, std::byte* output, int samples)
+{
+    for(int i{0}; i < samples; ++i) {
+        output[i] = input[i] ^ std::byte{0x80};
+    }
+}
+
+void swap16(const std::byte* input, std::byte* output, int samples)
+{
+    for(int i{0}; i < samples; ++i) {
+        output[(i * 2)]     = input[(i * 2) + 1];
+        output[(i * 2) + 1] = input[(i * 2)];
+    }
+}
+
+void swap32(const std::byte* input, std::byte* output, int samples)
+{
+    for(int i{0}; i < samples; ++i) {
+        uint32_t sample;
+        std::memcpy(&sample, input + static_cast<ptrdiff_t>(i * 4), 4);
+        sample = ((sample & 0xFF) << 24) | ((sample & 0xFF00) << 8) | ((sample >> 8) & 0xFF00) | (sample >> 24);
+        std::memcpy(output + static_cast<ptrdiff_t>(i * 4), &sample, 4);
+    }
+}
+
+// S24 is stored in the upper bits of a 32bit int
+template <bool BigEndian>
+void unpack24(const std::byte* input, std::byte* output, int samples)
+{
+    for(int i{0}; i < samples; ++i) {
+        const std::byte* bytes = input + static_cast<ptrdiff_t>(i * 3);
+
+        const auto high = std::to_integer<uint32_t>(bytes[BigEndian ? 0 : 2]);
+        const auto mid  = std::to_integer<uint32_t>(bytes[1]);
+        const auto low  = std::to_integer<uint32_t>(bytes[BigEndian ? 2 : 0]);
+
+        const uint32_t sample = (high << 24) | (mid << 16) | (low << 8);
+        std::memcpy(output + static_cast<ptrdiff_t>(i * 4), &sample, 4);
+    }
+}
+
+struct PcmLayout
+{
+    Fooyin::AudioFormat format;
+    // Size of a frame in the file, which differs from the format's for packed 24bit samples
+    int frameSize{0};
+    uint64_t dataOffset{0};
+    uint64_t frameCount{0};
+    // Converts samples to the format; not set if they can be used as they are
+    UnpackFunc unpack{nullptr};
+    // Set if the header carries on past the part of the file read so far
+    bool truncated{false};
+};
+
+bool setEncoding(PcmLayout& layout, int bits, bool isFloat, bool bigEndian, bool signed8, double sampleRate,
+                 int channels)
+{
+    if(channels <= 0 || sampleRate < 1.0 || sampleRate > 1536000.0 || (isFloat && bits != 32)) {
+        return false;
+    }
+
+    const bool swap = bigEndian != NativeBigEndian;
+
+    Fooyin::SampleFormat format;
+    switch(bits) {
+        case(8):
+            format        = Fooyin::SampleFormat::U8;
+            layout.unpack = signed8 ? unpackS8 : nullptr;
+            break;
+        case(16):
+            format        = Fooyin::SampleFormat::S16;
+            layout.unpack = swap ? swap16 : nullptr;
+            break;
+        case(24):
+            format        = Fooyin::SampleFormat::S24;
+            layout.unpack = bigEndian ? unpack24<true> : unpack24<false>;
+            break;
+        case(32):
+            format        = isFloat ? Fooyin::SampleFormat::Float : Fooyin::SampleFormat::S32;
+            layout.unpack = swap ? swap32 : nullptr;
+            break;
+        default:
+            return false;
+    }
+
+    layout.format    = {format, static_cast<int>(std::lround(sampleRate)), channels};
+    layout.frameSize = (bits / 8) * channels;
+
+    return true;
+}
+
+void setData(PcmLayout& layout, uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+    layout.dataOffset = std::min(offset, fileSize);
+    // Streamed files may not have had their sizes filled in, and others may be truncated
+    size              = std::min(size, fileSize - layout.dataOffset);
+    layout.frameCount = layout.frameSize > 0 ? size / static_cast<uint64_t>(layout.frameSize) : 0;
+}
+
+// Reads the body of a WAV or Wave64 format chunk
+bool parseWaveFormat(const std::byte* data, uint64_t size, PcmLayout& layout)
+{
+    if(size < 16) {
+        return false;
+    }
+
+    uint16_t tag            = readU16(data, false);
+    const uint16_t channels = readU16(data + 2, false);
+    const uint32_t rate     = readU32(data + 4, false);
+    const uint16_t align    = readU16(data + 12, false);
+    const uint16_t bits     = readU16(data + 14, false);
+
+    // WAVE_FORMAT_EXTENSIBLE: the actual format is at the start of the sub-format GUID
+    if(tag == 0xFFFE) {
+        if(size < 40) {
+            return false;
+        }
+        tag = readU16(data + 24, false);
+    }
+
+    // Only PCM and IEEE float
+    if((tag != 1 && tag != 3) || align != channels * (bits / 8)) {
+        return false;
+    }
+
+    return setEncoding(layout, bits, tag == 3, false, false, rate, channels);
+}
+
+// @p size is the number of bytes read from the start of the file, which may be less than @p fileSize
+bool parseWav(const std::byte* data, uint64_t size, uint64_t fileSize, PcmLayout& layout)
+{
+    if(size < 12 || !hasId(data, "RIFF") || !hasId(data + 8, "WAVE")) {
+        return false;
+    }
+
+    bool hasFormat{false};
+    uint64_t pos{12};
+
+    while(pos + 8 <= size) {
+        const std::byte* chunk    = data + pos;
+        const uint64_t chunkSize  = readU32(chunk + 4, false);
+        const uint64_t body       = pos + 8;
+        const uint64_t bodyLength = std::min(chunkSize, size - body);
+
+        if(hasId(chunk, "fmt ")) {
+            if(bodyLength < chunkSize && size < fileSize) {
+                layout.truncated = true;
+                return false;
+            }
+            if(!parseWaveFormat(data + body, bodyLength, layout)) {
+                return false;
+            }
+            hasFormat = true;
+        }
+        else if(hasId(chunk, "data")) {
+            if(!hasFormat) {
+                return false;
+            }
+            setData(layout, body, chunkSize, fileSize);
+            return layout.frameCount > 0;
+        }
+
+        // Chunks are padded to an even size
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+
+    // The rest of the header may still be to come
+    layout.truncated = size < fileSize;
+    return false;
+}
+
+bool parseWave64(const std::byte* data, uint64_t size, uint64_t fileSize, PcmLayout& layout)
+{
+    // Every chunk GUID other than the RIFF one shares these last 12 bytes
+    static constexpr std::array<uint8_t, 12> ChunkGuid{0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1,
+                                                        0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+    static constexpr std::array<uint8_t, 12> RiffGuid{0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6,
+                                                       0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+
+    const auto hasGuid = [](const std::byte* guid, const char* id, const std::array<uint8_t, 12>& tail) {
+        return hasId(guid, id) && std::memcmp(guid + 4, tail.data(), tail.size()) == 0;
+    };
+
+    if(size < 40 || !hasGuid(data, "riff", RiffGuid) || !hasGuid(data + 24, "wave", ChunkGuid)) {
+        return false;
+    }
+
+    bool hasFormat{false};
+    uint64_t pos{40};
+
+    while(pos + 24 <= size) {
+        const std::byte* chunk = data + pos;
+        // Sizes include the chunk's header
+        const uint64_t chunkSize = readU64(chunk + 16, false);
+        if(chunkSize < 24) {
+            return false;
+        }
+
+        const uint64_t body       = pos + 24;
+        const uint64_t bodyLength = std::min(chunkSize - 24, size - body);
+
+        if(hasGuid(chunk, "fmt ", ChunkGuid)) {
+            if(bodyLength < chunkSize - 24 && size < fileSize) {
+                layout.truncated = true;
+                return false;
+            }
+            if(!parseWaveFormat(data + body, bodyLength, layout)) {
+                return false;
+            }
+            hasFormat = true;
+        }
+        else if(hasGuid(chunk, "data", ChunkGuid)) {
+            if(!hasFormat) {
+                return false;
+            }
+            setData(layout, body, chunkSize - 24, fileSize);
+            return layout.frameCount > 0;
+        }
+
+        // Chunks are aligned to 8 bytes
+        pos += (chunkSize + 7) & ~uint64_t{7};
+    }
+
+    // The rest of the header may still be to come
+    layout.truncated = size < fileSize;
+    return false;
+}
+
+bool parseAiff(const std::byte* data, uint64_t size, uint64_t fileSize, PcmLayout& layout)
+{
+    if(size < 12 || !hasId(data, "FORM") || (!hasId(data + 8, "AIFF") && !hasId(data + 8, "AIFC"))) {
+        return false;
+    }
+
+    const bool compressed = hasId(data + 8, "AIFC");
+
+    bool hasFormat{false};
+    uint64_t pos{12};
+
+    while(pos + 8 <= size) {
+        const std::byte* chunk    = data + pos;
+        const uint64_t chunkSize  = readU32(chunk + 4, true);
+        const uint64_t body       = pos + 8;
+        const uint64_t bodyLength = std::min(chunkSize, size - body);
+
+        if(hasId(chunk, "COMM")) {
+            if(bodyLength < chunkSize && size < fileSize) {
+                layout.truncated = true;
+                return false;
+            }
+            if(bodyLength < (compressed ? 22U : 18U)) {
+                return false;
+            }
+
+            const int channels = readU16(data + body, true);
+            // Samples are left-aligned within whole bytes
+            const int bits     = ((readU16(data + body + 6, true) + 7) / 8) * 8;
+            const double rate  = readExtended(data + body + 8);
+
+            bool bigEndian{true};
+            bool isFloat{false};
+
+            if(compressed) {
+                const std::byte* type = data + body + 18;
+                if(hasId(type, "sowt")) {
+                    bigEndian = false;
+                }
+                else if(hasId(type, "fl32") || hasId(type, "FL32")) {
+                    isFloat = true;
+                }
+                else if(!hasId(type, "NONE") && !hasId(type, "twos")) {
+                    return false;
+                }
+            }
+
+            if(!setEncoding(layout, bits, isFloat, bigEndian, true, rate, channels)) {
+                return false;
+            }
+            hasFormat = true;
+        }
+        else if(hasId(chunk, "SSND")) {
+            if(hasFormat && bodyLength < 8 && size < fileSize) {
+                layout.truncated = true;
+                return false;
+            }
+            if(!hasFormat || bodyLength < 8) {
+                return false;
+            }
+            const uint64_t offset = readU32(data + body, true);
+            setData(layout, body + 8 + offset, chunkSize - std::min<uint64_t>(chunkSize, 8 + offset), fileSize);
+            return layout.frameCount > 0;
+        }
+
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+
+    // The rest of the header may still be to come
+    layout.truncated = size < fileSize;
+    return false;
+}
+
+bool parseHeader(const std::byte* data, uint64_t size, uint64_t fileSize, PcmLayout& layout)
+{
+    return parseWav(data, size, fileSize, layout) || parseWave64(data, size, fileSize, layout)
+        || parseAiff(data, size, fileSize, layout);
+}
+
+// Reads up to @p size bytes at @p offset, returning the number read or -1 on error
+int64_t readAt(int fd, std::byte* data, size_t size, uint64_t offset)
+{
+    size_t total{0};
+    while(total < size) {
+        const ssize_t count = ::pread(fd, data + total, size - total, static_cast<off_t>(offset + total));
+        if(count < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if(count == 0) {
+            break;
+        }
+        total += static_cast<size_t>(count);
+    }
+    return static_cast<int64_t>(total);
+}
+} // namespace
+
+namespace Fooyin {
+struct PcmDecoder::Private
+{
+    int fd{-1};
+    PcmLayout layout;
+    uint64_t framePos{0};
+    bool isDecoding{false};
+    Error error{NoError};
+    // Samples as stored in the file, for those which have to be unpacked
+    std::vector<std::byte> packed;
+
+    ~Private()
+    {
+        close();
+    }
+
+    void close()
+    {
+        if(fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        layout   = {};
+        framePos = 0;
+    }
+
+    bool open(const QString& source)
+    {
+        close();
+        error = NoError;
+
+        if(source.contains(QStringLiteral("://"))) {
+            error = NotSupportedError;
+            return false;
+        }
+
+        fd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+
+        struct stat info{};
+        if(fd < 0 || ::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+            close();
+            error = ResourceError;
+            return false;
+        }
+
+        if(!readHeader(static_cast<uint64_t>(info.st_size))) {
+            close();
+            error = FormatError;
+            return false;
+        }
+
+        ::posix_fadvise(fd, static_cast<off_t>(layout.dataOffset), 0, POSIX_FADV_SEQUENTIAL);
+
+        return true;
+    }
+
+    // Reads more of the file only if other chunks push the audio data further in
+    bool readHeader(uint64_t fileSize)
+    {
+        std::vector<std::byte> header;
+
+        for(uint64_t size{HeaderReadSize};; size *= 8) {
+            header.resize(static_cast<size_t>(std::min(size, fileSize)));
+
+            const int64_t count = readAt(fd, header.data(), header.size(), 0);
+            if(count <= 0) {
+                return false;
+            }
+
+            layout = {};
+            if(parseHeader(header.data(), static_cast<uint64_t>(count), fileSize, layout)) {
+                return true;
+            }
+            if(!layout.truncated || size >= MaxHeaderSize || std::cmp_less(count, header.size())) {
+                return false;
+            }
+        }
+    }
+
+    void seek(uint64_t pos)
+    {
+        const auto frame = pos * static_cast<uint64_t>(layout.format.sampleRate()) / 1000;
+        framePos         = std::min(frame, layout.frameCount);
+    }
+
+    AudioBuffer read(int frames)
+    {
+        if(fd < 0 || !isDecoding) {
+            return {};
+        }
+
+        frames = static_cast<int>(std::min<uint64_t>(frames, layout.frameCount - framePos));
+        if(frames <= 0) {
+            return {};
+        }
+
+        const AudioFormat& format = layout.format;
+        const uint64_t offset     = layout.dataOffset + (framePos * static_cast<uint64_t>(layout.frameSize));
+        const uint64_t startTime  = framePos * 1000 / static_cast<uint64_t>(format.sampleRate());
+        const auto size           = static_cast<size_t>(frames) * static_cast<size_t>(layout.frameSize);
+
+        AudioBuffer buffer{format, startTime};
+
+        // The file is read rather than mapped, so it can be rewritten by tagging while playing without faulting
+        std::byte* input{nullptr};
+        if(layout.unpack) {
+            packed.resize(size);
+            input = packed.data();
+        }
+        else {
+            buffer.resize(size);
+            input = buffer.data();
+        }
+
+        const int64_t count      = readAt(fd, input, size, offset);
+        const int64_t framesRead = count > 0 ? count / layout.frameSize : 0;
+        if(framesRead < frames) {
+            // The file has been cut short since it was opened
+            layout.frameCount = framePos + static_cast<uint64_t>(framesRead);
+            if(framesRead == 0) {
+                return {};
+            }
+            frames = static_cast<int>(framesRead);
+        }
+
+        framePos += static_cast<uint64_t>(frames);
+
+        buffer.resize(static_cast<size_t>(format.bytesForFrames(frames)));
+        if(layout.unpack) {
+            layout.unpack(input, buffer.data(), frames * format.channelCount());
+        }
+
+        return buffer;
+    }
+};
+
+PcmDecoder::PcmDecoder()
+    : p{std::make_unique<Private>()}
+{ }
+
+PcmDecoder::~PcmDecoder() = default;
+
+bool PcmDecoder::canDecode(const QString& source)
+{
+    Private probe;
+    return probe.open(source);
+}
+
+bool PcmDecoder::init(const QString& source)
+{
+    if(!p->open(source)) {
+        if(p->error == FormatError) {
+            qDebug() << "Unsupported PCM file" << source;
+        }
+        return false;
+    }
+    return true;
+}
+
+void PcmDecoder::start()
+{
+    p->isDecoding = true;
+}
+
+void PcmDecoder::stop()
+{
+    p->isDecoding = false;
+    p->framePos   = 0;
+}
+
+AudioFormat PcmDecoder::format() const
+{
+    return p->layout.format;
+}
+
+bool PcmDecoder::isSeekable() const
+{
+    return p->fd >= 0;
+}
+
+void PcmDecoder::seek(uint64_t pos)
+{
+    p->seek(pos);
+}
+
+AudioBuffer PcmDecoder::readBuffer()
+{
+    return p->read(BufferFrames);
+}
+
+AudioBuffer PcmDecoder::readBuffer(size_t bytes)
+{
+    const int frameSize = std::max(p->layout.format.bytesPerFrame(), 1);
+    return p->read(std::max(static_cast<int>(bytes) / frameSize, 1));
+}
+
+AudioDecoder::Error PcmDecoder::error() const
+{
+    return p->error;
+}
+} // namespace Fooyin
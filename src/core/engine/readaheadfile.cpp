@@ -0,0 +1,315 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "readaheadfile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Largest single read issued to the filesystem
+constexpr size_t ChunkSize = 256 * 1024;
+// Seeks landing this far past the buffered data wait for it rather than restarting the window
+constexpr uint64_t SkipAheadLimit = 1024 * 1024;
+
+namespace {
+void adviseAccess(int fd, uint64_t offset, uint64_t length, [[maybe_unused]] int advice)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), advice);
+#else
+    (void)fd;
+    (void)offset;
+    (void)length;
+#endif
+}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+constexpr int AdviseSequential = POSIX_FADV_SEQUENTIAL;
+constexpr int AdviseWillNeed   = POSIX_FADV_WILLNEED;
+#else
+constexpr int AdviseSequential = 0;
+constexpr int AdviseWillNeed   = 0;
+#endif
+} // namespace
+
+namespace Fooyin {
+ReadAheadFile::ReadAheadFile()
+    : m_fd{-1}
+    , m_size{0}
+    , m_cached{false}
+    , m_stop{false}
+    , m_history{0}
+    , m_windowStart{0}
+    , m_windowEnd{0}
+    , m_readPos{0}
+    , m_generation{0}
+    , m_error{0}
+{ }
+
+ReadAheadFile::~ReadAheadFile()
+{
+    close();
+}
+
+bool ReadAheadFile::open(const std::string& path, const ReadAheadOptions& options)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat info{};
+    if(::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd     = fd;
+    m_size   = static_cast<uint64_t>(info.st_size);
+    m_cached = options.cacheLimit > 0 && m_size <= options.cacheLimit;
+
+    const uint64_t capacity = m_cached ? m_size : std::min<uint64_t>(std::max(options.windowSize, ChunkSize), m_size);
+    m_buffer.resize(std::max<uint64_t>(capacity, 1));
+    // A cached file is never discarded; otherwise keep a little behind the read position for short seeks back
+    m_history = m_cached ? m_buffer.size() : m_buffer.size() / 4;
+
+    m_stop        = false;
+    m_windowStart = 0;
+    m_windowEnd   = 0;
+    m_readPos     = 0;
+    m_generation  = 0;
+    m_error       = 0;
+    m_stats       = {};
+
+    adviseAccess(m_fd, 0, 0, AdviseSequential);
+    adviseAccess(m_fd, 0, m_buffer.size(), AdviseWillNeed);
+
+    m_thread = std::thread{[this]() { fillLoop(); }};
+
+    return true;
+}
+
+void ReadAheadFile::close()
+{
+    if(m_fd < 0) {
+        return;
+    }
+
+    {
+        const std::scoped_lock lock{m_guard};
+        m_stop = true;
+    }
+    m_spaceReady.notify_all();
+    m_dataReady.notify_all();
+
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    ::close(m_fd);
+    m_fd     = -1;
+    m_size   = 0;
+    m_cached = false;
+    m_buffer = {};
+}
+
+bool ReadAheadFile::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+uint64_t ReadAheadFile::size() const
+{
+    return m_size;
+}
+
+uint64_t ReadAheadFile::pos() const
+{
+    const std::scoped_lock lock{m_guard};
+    return m_readPos;
+}
+
+bool ReadAheadFile::isCached() const
+{
+    return m_cached;
+}
+
+int64_t ReadAheadFile::read(std::byte* data, size_t size)
+{
+    std::unique_lock lock{m_guard};
+
+    if(m_fd < 0) {
+        return -1;
+    }
+    if(m_readPos >= m_size || size == 0) {
+        return 0;
+    }
+
+    if(m_readPos < m_windowStart || m_readPos > m_windowEnd + SkipAheadLimit) {
+        resetWindow(m_readPos);
+    }
+
+    const auto dataReady = [this]() { return m_stop || m_error != 0 || m_windowEnd > m_readPos; };
+
+    // Only count reads which actually had to wait for the fill thread
+    if(!dataReady()) {
+        const auto start = std::chrono::steady_clock::now();
+        m_dataReady.wait(lock, dataReady);
+        ++m_stats.stalls;
+        m_stats.stallTime += std::chrono::steady_clock::now() - start;
+    }
+
+    if(m_stop || m_readPos >= m_windowEnd) {
+        return -1;
+    }
+
+    const size_t count    = std::min<uint64_t>(size, m_windowEnd - m_readPos);
+    const size_t capacity = m_buffer.size();
+    const size_t offset   = m_readPos % capacity;
+    const size_t first    = std::min(count, capacity - offset);
+
+    std::memcpy(data, m_buffer.data() + offset, first);
+    std::memcpy(data + first, m_buffer.data(), count - first);
+
+    m_readPos += count;
+    m_stats.bytesRead += count;
+
+    lock.unlock();
+    m_spaceReady.notify_one();
+
+    return static_cast<int64_t>(count);
+}
+
+bool ReadAheadFile::seek(uint64_t pos)
+{
+    {
+        const std::scoped_lock lock{m_guard};
+
+        if(m_fd < 0 || pos > m_size) {
+            return false;
+        }
+
+        m_readPos = pos;
+        if(pos < m_windowStart || pos > m_windowEnd + SkipAheadLimit) {
+            resetWindow(pos);
+        }
+    }
+
+    // Moving forward may have freed space
+    m_spaceReady.notify_one();
+
+    return true;
+}
+
+ReadAheadStats ReadAheadFile::stats() const
+{
+    const std::scoped_lock lock{m_guard};
+    return m_stats;
+}
+
+void ReadAheadFile::fillLoop()
+{
+    std::vector<std::byte> chunk(ChunkSize);
+
+    std::unique_lock lock{m_guard};
+
+    while(true) {
+        m_spaceReady.wait(lock,
+                          [this]() { return m_stop || (m_error == 0 && m_windowEnd < m_size && freeSpace() > 0); });
+        if(m_stop) {
+            return;
+        }
+
+        const uint64_t offset     = m_windowEnd;
+        const uint64_t generation = m_generation;
+        const size_t count        = std::min<uint64_t>({freeSpace(), ChunkSize, m_size - offset});
+
+        lock.unlock();
+
+        // Read into a staging chunk, as the window may be moved by a seek while we're blocked
+        ssize_t bytesRead{0};
+        do {
+            bytesRead = ::pread(m_fd, chunk.data(), count, static_cast<off_t>(offset));
+        } while(bytesRead < 0 && errno == EINTR);
+        const int error = bytesRead < 0 ? errno : EIO;
+
+        lock.lock();
+
+        if(generation != m_generation) {
+            continue;
+        }
+
+        if(bytesRead <= 0) {
+            // A short file is treated as an error too, as the size no longer matches
+            m_error = error;
+            m_dataReady.notify_all();
+            continue;
+        }
+
+        // The reader may have seeked back within the window since, leaving less room than before
+        const size_t accepted = std::min(static_cast<size_t>(bytesRead), freeSpace());
+        if(accepted == 0) {
+            continue;
+        }
+
+        const size_t capacity = m_buffer.size();
+        const uint64_t used   = m_windowEnd - m_windowStart;
+        if(used + accepted > capacity) {
+            m_windowStart += used + accepted - capacity;
+        }
+
+        const size_t ringOffset = m_windowEnd % capacity;
+        const size_t first      = std::min(accepted, capacity - ringOffset);
+        std::memcpy(m_buffer.data() + ringOffset, chunk.data(), first);
+        std::memcpy(m_buffer.data(), chunk.data() + first, accepted - first);
+
+        m_windowEnd += accepted;
+        m_dataReady.notify_all();
+    }
+}
+
+void ReadAheadFile::resetWindow(uint64_t pos)
+{
+    m_windowStart = pos;
+    m_windowEnd   = pos;
+    m_error       = 0;
+    ++m_generation;
+    ++m_stats.refills;
+
+    adviseAccess(m_fd, pos, m_buffer.size(), AdviseWillNeed);
+    m_spaceReady.notify_one();
+}
+
+size_t ReadAheadFile::freeSpace() const
+{
+    const uint64_t used = m_windowEnd - m_windowStart;
+    // Data more than the history length behind the reader can be overwritten
+    const uint64_t reclaimable
+        = m_readPos > m_windowStart + m_history ? std::min(m_readPos - m_history - m_windowStart, used) : 0;
+
+    return m_buffer.size() - used + reclaimable;
+}
+} // namespace Fooyin
@@ -0,0 +1,109 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/readaheadoptions.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Fooyin {
+struct ReadAheadStats
+{
+    // Number of reads which had to wait for data
+    uint64_t stalls{0};
+    // Total time spent waiting
+    std::chrono::nanoseconds stallTime{0};
+    // Number of times the window was moved by a seek outside of it
+    uint64_t refills{0};
+    uint64_t bytesRead{0};
+};
+
+/*!
+ * A read-only file which is read ahead of the consumer on a background thread.
+ * Intended for slow or unreliable storage such as network shares and spinning disks, so
+ * the thread reading from it only blocks if the storage falls behind by a whole window.
+ * Reads and seeks must all come from the same thread.
+ */
+class FYCORE_EXPORT ReadAheadFile
+{
+public:
+    ReadAheadFile();
+    ~ReadAheadFile();
+
+    ReadAheadFile(const ReadAheadFile&)            = delete;
+    ReadAheadFile& operator=(const ReadAheadFile&) = delete;
+
+    /** Opens @p path, a native path, and starts reading ahead from the beginning. */
+    bool open(const std::string& path, const ReadAheadOptions& options = {});
+    void close();
+
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] uint64_t size() const;
+    [[nodiscard]] uint64_t pos() const;
+    /** Returns @c true if the whole file is being held in memory. */
+    [[nodiscard]] bool isCached() const;
+
+    /*!
+     * Reads up to @p size bytes into @p data, blocking until at least one byte is available.
+     * @returns the number of bytes read, 0 at the end of the file, or -1 if the file couldn't be read.
+     */
+    int64_t read(std::byte* data, size_t size);
+    /** Moves the read position to @p pos. Data already buffered around @p pos is kept. */
+    bool seek(uint64_t pos);
+
+    [[nodiscard]] ReadAheadStats stats() const;
+
+private:
+    void fillLoop();
+    void resetWindow(uint64_t pos);
+    [[nodiscard]] size_t freeSpace() const;
+
+    int m_fd;
+    uint64_t m_size;
+    bool m_cached;
+
+    std::thread m_thread;
+    mutable std::mutex m_guard;
+    std::condition_variable m_dataReady;
+    std::condition_variable m_spaceReady;
+    bool m_stop;
+
+    // Buffered data covers [m_windowStart, m_windowEnd) of the file, stored modulo the capacity
+    std::vector<std::byte> m_buffer;
+    size_t m_history;
+    uint64_t m_windowStart;
+    uint64_t m_windowEnd;
+    uint64_t m_readPos;
+    // Bumped whenever the window is moved, so reads started before the move are discarded
+    uint64_t m_generation;
+    int m_error;
+
+    ReadAheadStats m_stats;
+};
+} // namespace Fooyin
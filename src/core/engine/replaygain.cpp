@@ -0,0 +1,111 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "replaygain.h"
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+std::optional<double> readValue(const Fooyin::Track& track, const char* tag)
+{
+    const QStringList values = track.extraTag(QString::fromLatin1(tag));
+    if(values.empty()) {
+        return {};
+    }
+
+    // Gains are usually suffixed with "dB", but aren't always
+    static const QRegularExpression unitRegex{QStringLiteral("\\s*dB\\s*$"),
+                                              QRegularExpression::CaseInsensitiveOption};
+
+    QString value = values.constFirst().trimmed();
+    value.remove(unitRegex);
+
+    bool ok{false};
+    const double result = value.toDouble(&ok);
+    if(!ok || !std::isfinite(result)) {
+        return {};
+    }
+    return result;
+}
+
+void writeValue(Fooyin::Track& track, const char* tag, const std::optional<double>& value, const QString& text)
+{
+    if(value) {
+        track.replaceExtraTag(QString::fromLatin1(tag), text);
+    }
+    else {
+        track.removeExtraTag(QString::fromLatin1(tag));
+    }
+}
+
+QString gainText(const std::optional<double>& gain)
+{
+    return gain ? QStringLiteral("%1 dB").arg(*gain, 0, 'f', 2) : QString{};
+}
+
+QString peakText(const std::optional<double>& peak)
+{
+    return peak ? QString::number(*peak, 'f', 6) : QString{};
+}
+} // namespace
+
+namespace Fooyin::ReplayGain {
+Values values(const Track& track)
+{
+    return {.trackGain = readValue(track, TrackGainTag),
+            .trackPeak = readValue(track, TrackPeakTag),
+            .albumGain = readValue(track, AlbumGainTag),
+            .albumPeak = readValue(track, AlbumPeakTag)};
+}
+
+void setValues(Track& track, const Values& values)
+{
+    writeValue(track, TrackGainTag, values.trackGain, gainText(values.trackGain));
+    writeValue(track, TrackPeakTag, values.trackPeak, peakText(values.trackPeak));
+    writeValue(track, AlbumGainTag, values.albumGain, gainText(values.albumGain));
+    writeValue(track, AlbumPeakTag, values.albumPeak, peakText(values.albumPeak));
+}
+
+double linearGain(const Values& values, Mode mode, double preamp)
+{
+    if(mode == Mode::Off) {
+        return 1.0;
+    }
+
+    // Either falls back to the other when missing
+    const bool useAlbum = values.albumGain && (mode == Mode::Album || !values.trackGain);
+
+    const auto& gain = useAlbum ? values.albumGain : values.trackGain;
+    const auto& peak = useAlbum ? values.albumPeak : values.trackPeak;
+
+    if(!gain) {
+        return 1.0;
+    }
+
+    double linear = std::pow(10.0, (*gain + preamp) / 20.0);
+    if(peak && *peak > 0.0) {
+        linear = std::min(linear, 1.0 / *peak);
+    }
+
+    return linear;
+}
+} // namespace Fooyin::ReplayGain
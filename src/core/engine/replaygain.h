@@ -0,0 +1,60 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/track.h>
+
+#include <optional>
+
+namespace Fooyin::ReplayGain {
+constexpr auto TrackGainTag = "REPLAYGAIN_TRACK_GAIN";
+constexpr auto TrackPeakTag = "REPLAYGAIN_TRACK_PEAK";
+constexpr auto AlbumGainTag = "REPLAYGAIN_ALBUM_GAIN";
+constexpr auto AlbumPeakTag = "REPLAYGAIN_ALBUM_PEAK";
+
+// Loudness gains are calculated relative to, in LUFS (ReplayGain 2.0)
+constexpr double ReferenceLoudness = -18.0;
+
+enum class Mode : uint8_t
+{
+    Off = 0,
+    Track,
+    Album,
+};
+
+struct Values
+{
+    std::optional<double> trackGain;
+    std::optional<double> trackPeak;
+    std::optional<double> albumGain;
+    std::optional<double> albumPeak;
+};
+
+/** Reads the ReplayGain values from @p track's tags; any missing or unreadable values are left unset. */
+Values values(const Track& track);
+/** Writes @p values to @p track's tags, in the usual "-6.50 dB" and "0.988235" forms. Unset values are removed. */
+void setValues(Track& track, const Values& values);
+
+/*!
+ * Returns the linear gain to apply for @p values in @p mode, including @p preamp in dB.
+ * The gain is reduced if needed so the peak, if known, won't clip.
+ */
+double linearGain(const Values& values, Mode mode, double preamp = 0.0);
+} // namespace Fooyin::ReplayGain
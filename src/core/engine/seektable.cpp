@@ -0,0 +1,170 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "seektable.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Bumped whenever the serialised layout changes; older tables are discarded
+constexpr uint32_t SerialVersion = 1;
+
+namespace {
+template <typename T>
+void writeValue(std::vector<std::byte>& data, T value)
+{
+    const size_t pos = data.size();
+    data.resize(pos + sizeof(T));
+    std::memcpy(data.data() + pos, &value, sizeof(T));
+}
+
+template <typename T>
+T readValue(const std::byte* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+} // namespace
+
+namespace Fooyin {
+SeekTable::SeekTable(int64_t spacing)
+    : m_spacing{spacing}
+    , m_modified{false}
+{ }
+
+bool SeekTable::empty() const
+{
+    return m_points.empty();
+}
+
+size_t SeekTable::size() const
+{
+    return m_points.size();
+}
+
+const std::vector<SeekTable::Point>& SeekTable::points() const
+{
+    return m_points;
+}
+
+int64_t SeekTable::spacing() const
+{
+    return m_spacing;
+}
+
+void SeekTable::setSpacing(int64_t spacing)
+{
+    m_spacing = spacing;
+}
+
+bool SeekTable::insert(const Point& point)
+{
+    if(point.timestamp < 0 || point.offset < 0) {
+        return false;
+    }
+
+    const auto next = std::ranges::upper_bound(m_points, point.timestamp, {}, &Point::timestamp);
+
+    if(next != m_points.begin()) {
+        const auto& prev = *std::prev(next);
+        if(point.timestamp - prev.timestamp < m_spacing || point.offset <= prev.offset) {
+            return false;
+        }
+    }
+    if(next != m_points.end()) {
+        if(next->timestamp - point.timestamp < m_spacing || point.offset >= next->offset) {
+            return false;
+        }
+    }
+
+    m_points.insert(next, point);
+    m_modified = true;
+
+    return true;
+}
+
+std::optional<SeekTable::Point> SeekTable::find(int64_t timestamp) const
+{
+    const auto next = std::ranges::upper_bound(m_points, timestamp, {}, &Point::timestamp);
+    if(next == m_points.begin()) {
+        return {};
+    }
+    return *std::prev(next);
+}
+
+bool SeekTable::isModified() const
+{
+    return m_modified;
+}
+
+void SeekTable::setModified(bool modified)
+{
+    m_modified = modified;
+}
+
+std::vector<std::byte> SeekTable::serialise() const
+{
+    std::vector<std::byte> data;
+    data.reserve(sizeof(uint32_t) * 2 + m_points.size() * sizeof(int64_t) * 2);
+
+    writeValue(data, SerialVersion);
+    writeValue(data, static_cast<uint32_t>(m_points.size()));
+
+    for(const auto& point : m_points) {
+        writeValue(data, point.timestamp);
+        writeValue(data, point.offset);
+    }
+
+    return data;
+}
+
+SeekTable SeekTable::deserialise(const std::byte* data, size_t size)
+{
+    constexpr size_t HeaderSize = sizeof(uint32_t) * 2;
+    constexpr size_t PointSize  = sizeof(int64_t) * 2;
+
+    SeekTable table;
+
+    if(!data || size < HeaderSize || readValue<uint32_t>(data) != SerialVersion) {
+        return table;
+    }
+
+    const auto count = readValue<uint32_t>(data + sizeof(uint32_t));
+    if(size != HeaderSize + count * PointSize) {
+        return table;
+    }
+
+    table.m_points.reserve(count);
+
+    const std::byte* pointData = data + HeaderSize;
+    for(uint32_t i{0}; i < count; ++i, pointData += PointSize) {
+        const Point point{.timestamp = readValue<int64_t>(pointData),
+                          .offset    = readValue<int64_t>(pointData + sizeof(int64_t))};
+        // Guard against a corrupt table sending seeks to the wrong place
+        if(!table.insert(point)) {
+            return SeekTable{};
+        }
+    }
+
+    table.m_modified = false;
+
+    return table;
+}
+} // namespace Fooyin
@@ -0,0 +1,77 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Maps timestamps in a stream to the byte offsets of the packets starting there, so a seek can
+ * go straight to a known packet rather than relying on the demuxer's estimate.
+ * Timestamps are in the stream's own time base.
+ */
+class FYCORE_EXPORT SeekTable
+{
+public:
+    struct Point
+    {
+        int64_t timestamp{0};
+        int64_t offset{0};
+
+        bool operator==(const Point& other) const = default;
+    };
+
+    /** Points closer together than @p spacing are dropped, to bound the size of the table. */
+    explicit SeekTable(int64_t spacing = 0);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] const std::vector<Point>& points() const;
+
+    [[nodiscard]] int64_t spacing() const;
+    void setSpacing(int64_t spacing);
+
+    /*!
+     * Adds a point, keeping the table ordered.
+     * @returns @c false if it's too close to an existing point, or its offset is out of order with its neighbours.
+     */
+    bool insert(const Point& point);
+    /** Returns the last point at or before @p timestamp, if any. O(log n). */
+    [[nodiscard]] std::optional<Point> find(int64_t timestamp) const;
+
+    /** Returns @c true if points have been added since the table was loaded or last marked clean. */
+    [[nodiscard]] bool isModified() const;
+    void setModified(bool modified);
+
+    [[nodiscard]] std::vector<std::byte> serialise() const;
+    /** Returns an empty table if @p data isn't a valid serialised table. */
+    static SeekTable deserialise(const std::byte* data, size_t size);
+
+private:
+    std::vector<Point> m_points;
+    int64_t m_spacing;
+    bool m_modified;
+};
+} // namespace Fooyin
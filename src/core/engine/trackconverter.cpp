@@ -0,0 +1,267 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/engine/trackconverter.h>
+
+#include "engine/decoderfactory.h"
+#include "engine/ffmpeg/ffmpegencoder.h"
+#include "tagging/tagwriter.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/track.h>
+#include <utils/paralleltaskrunner.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+QString commonDirectory(const Fooyin::TrackList& tracks)
+{
+    QString common;
+
+    for(const Fooyin::Track& track : tracks) {
+        const QString dir = QFileInfo{track.filepath()}.absolutePath() + u'/';
+        if(common.isNull()) {
+            common = dir;
+            continue;
+        }
+
+        qsizetype length{0};
+        const qsizetype maxLength = std::min(common.size(), dir.size());
+        while(length < maxLength && common.at(length) == dir.at(length)) {
+            ++length;
+        }
+        // Only whole directory names are shared
+        common = common.left(common.lastIndexOf(u'/', length - 1) + 1);
+    }
+
+    return common;
+}
+} // namespace
+
+namespace Fooyin {
+QString ConversionOptions::extension(Codec codec)
+{
+    switch(codec) {
+        case(Opus):
+            return QStringLiteral("opus");
+        case(Mp3):
+            return QStringLiteral("mp3");
+        case(Aac):
+            return QStringLiteral("m4a");
+        case(Flac):
+        default:
+            return QStringLiteral("flac");
+    }
+}
+
+struct TrackConverter::Private
+{
+    struct TrackResult
+    {
+        Track track;
+        QString output;
+        QString error;
+    };
+
+    TrackConverter* self;
+
+    // Tracks to convert, with their output paths; errors are filled in as they finish
+    std::vector<TrackResult> jobs;
+    ConversionOptions options;
+    QString inputDirectory;
+
+    std::atomic<uint64_t> durationDone{0};
+    uint64_t totalDuration{0};
+
+    ParallelResults<TrackResult> results;
+
+    explicit Private(TrackConverter* self_)
+        : self{self_}
+    { }
+
+    [[nodiscard]] QString outputPath(const Track& track) const
+    {
+        const QFileInfo info{track.filepath()};
+        const QString relative = info.absolutePath().mid(inputDirectory.size());
+
+        return QDir::cleanPath(options.outputDirectory + u'/' + relative + u'/' + info.completeBaseName() + u'.'
+                               + ConversionOptions::extension(options.codec));
+    }
+
+    QString convertTrack(const Track& track, const QString& output)
+    {
+        if(QFileInfo{output}.absoluteFilePath() == QFileInfo{track.filepath()}.absoluteFilePath()) {
+            return tr("Output would overwrite the source file");
+        }
+        if(!options.overwrite && QFileInfo::exists(output)) {
+            return tr("Output file already exists");
+        }
+        if(!QDir{}.mkpath(QFileInfo{output}.absolutePath())) {
+            return tr("Unable to create output directory");
+        }
+
+        auto decoder = Audio::createDecoder(track.filepath(), ScanReadAhead);
+        if(!decoder->init(track.filepath())) {
+            return tr("Unable to decode file");
+        }
+
+        FFmpegEncoder encoder;
+        if(!encoder.open(output, decoder->format(), options)) {
+            QFile::remove(output);
+            return encoder.error();
+        }
+
+        decoder->start();
+
+        const uint64_t duration = track.duration();
+        uint64_t position{0};
+        bool written{true};
+
+        while(written && self->mayRun()) {
+            const AudioBuffer buffer = decoder->readBuffer();
+            if(!buffer.isValid()) {
+                break;
+            }
+
+            written = encoder.write(buffer);
+
+            // Progress is counted in ms of the source, capped in case the tagged duration is short
+            const uint64_t end  = buffer.startTime() + buffer.format().durationForFrames(buffer.frameCount());
+            const uint64_t next = std::min(end, duration);
+            if(next > position) {
+                durationDone.fetch_add(next - position, std::memory_order_relaxed);
+                position = next;
+            }
+        }
+
+        decoder->stop();
+        if(duration > position) {
+            durationDone.fetch_add(duration - position, std::memory_order_relaxed);
+        }
+
+        if(!written || !self->mayRun() || !encoder.finish()) {
+            const QString error = self->mayRun() ? encoder.error() : tr("Cancelled");
+            encoder.close();
+            QFile::remove(output);
+            return error;
+        }
+
+        Track converted{track};
+        converted.setFilePath(output);
+        if(!Tagging::writeMetaData(converted)) {
+            qDebug() << "Unable to write metadata to" << output;
+        }
+
+        return {};
+    }
+
+    void convertJob(size_t index)
+    {
+        TrackResult result = jobs.at(index);
+        result.error       = convertTrack(result.track, result.output);
+
+        if(self->mayRun()) {
+            results.add(std::move(result));
+        }
+    }
+
+    void reportProgress() const
+    {
+        const double done = totalDuration > 0 ? static_cast<double>(durationDone) / static_cast<double>(totalDuration)
+                                              : 0.0;
+        emit self->progressChanged(std::min(static_cast<int>(done * 100), 100));
+    }
+
+    void emitResults()
+    {
+        for(const auto& result : results.take()) {
+            if(result.error.isEmpty()) {
+                emit self->trackConverted(result.track, result.output);
+            }
+            else {
+                emit self->trackFailed(result.track, result.error);
+            }
+        }
+    }
+};
+
+TrackConverter::TrackConverter(QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+TrackConverter::~TrackConverter() = default;
+
+void TrackConverter::convertTracks(const TrackList& tracks, const ConversionOptions& options)
+{
+    if(tracks.empty() || options.outputDirectory.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    setState(Running);
+
+    p->options        = options;
+    p->inputDirectory = commonDirectory(tracks);
+    p->durationDone   = 0;
+    p->totalDuration  = 0;
+    p->jobs.clear();
+
+    // Tracks differing only by extension (a.flac and a.wav) would be written to the same file,
+    // so only the first is converted rather than having them race to create it
+    std::unordered_set<QString> outputs;
+    for(const Track& track : tracks) {
+        QString output = p->outputPath(track);
+        if(!outputs.emplace(output).second) {
+            emit trackFailed(track, tr("Another track would be converted to the same file"));
+            continue;
+        }
+        p->totalDuration += track.duration();
+        p->jobs.push_back({track, std::move(output), {}});
+    }
+
+    // Each track is decoded and encoded on a single thread, so convert one per core
+    const ParallelTaskRunner runner{this};
+    const ParallelTaskRunner::Tasks tasks{.process = [this](size_t index, int /*worker*/) { p->convertJob(index); }};
+
+    runner.run(p->jobs.size(), tasks, [this]() {
+        p->reportProgress();
+        p->emitResults();
+    });
+
+    // Also sent when cancelled, so progress is always seen to finish
+    emit progressChanged(100);
+    p->emitResults();
+
+    p->jobs.clear();
+
+    setState(Idle);
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "core/engine/moc_trackconverter.cpp"
@@ -47,6 +47,16 @@ CoreSettings::CoreSettings(SettingsManager* settingsManager)
     m_settings->createSetting<GaplessPlayback>(true, QStringLiteral("Engine/GaplessPlayback"));
     m_settings->createSetting<Language>(QStringLiteral(""), QStringLiteral("Language"));
     m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+    m_settings->createSetting<ReadAheadSize>(4, QStringLiteral("Engine/ReadAheadSize"));
+    m_settings->createSetting<MemoryCacheLimit>(64, QStringLiteral("Engine/MemoryCacheLimit"));
+    m_settings->createSetting<ReplayGainMode>(1, QStringLiteral("Engine/ReplayGainMode"));
+    m_settings->createSetting<ReplayGainPreamp>(0.0, QStringLiteral("Engine/ReplayGainPreamp"));
+    m_settings->createSetting<DspChain>(QStringList{}, QStringLiteral("Engine/DspChain"));
+    m_settings->createSetting<OutputSampleRate>(0, QStringLiteral("Engine/OutputSampleRate"));
+    m_settings->createSetting<CrossfadeLength>(0, QStringLiteral("Engine/CrossfadeLength"));
+    m_settings->createSetting<EngineStatistics>(false, QStringLiteral("Engine/CollectStatistics"));
+    m_settings->createSetting<OutputLatency>(0, QStringLiteral("Engine/OutputLatency"));
+    m_settings->createSetting<ExclusiveOutput>(false, QStringLiteral("Engine/ExclusiveOutput"));
 
     m_settings->createSetting<Internal::MonitorLibraries>(true, QStringLiteral("Library/MonitorLibraries"));
     m_settings->createTempSetting<Internal::MuteVolume>(m_settings->value<OutputVolume>());
@@ -21,6 +21,7 @@
 
 #include "library/libraryinfo.h"
 #include "libraryscanner.h"
+#include "replaygainscanner.h"
 #include "trackdatabasemanager.h"
 
 #include <core/library/musiclibrary.h>
@@ -63,6 +64,11 @@ struct LibraryThreadHandler::Private
     std::deque<LibraryScanRequest> scanRequests;
     int currentRequestId{-1};
 
+    // Kept on its own thread so it doesn't hold up library scans, which are much quicker
+    QThread replayGainThread;
+    ReplayGainScanner replayGainScanner;
+    std::deque<LibraryScanRequest> replayGainRequests;
+
     Private(LibraryThreadHandler* self_, DbConnectionPoolPtr dbPool_, MusicLibrary* library_,
             SettingsManager* settings_)
         : self{self_}
@@ -74,6 +80,7 @@ struct LibraryThreadHandler::Private
     {
         scanner.moveToThread(&thread);
         trackDatabaseManager.moveToThread(&thread);
+        replayGainScanner.moveToThread(&replayGainThread);
 
         QObject::connect(library, &MusicLibrary::tracksScanned, self, [this]() {
             if(!scanRequests.empty()) {
@@ -82,6 +89,7 @@ struct LibraryThreadHandler::Private
         });
 
         thread.start();
+        replayGainThread.start();
     }
 
     void scanLibrary(const LibraryScanRequest& request)
@@ -160,6 +168,53 @@ struct LibraryThreadHandler::Private
         return request;
     }
 
+    ScanRequest addReplayGainRequest(const TrackList& tracks)
+    {
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::ReplayGain, .id = id, .cancel = [this, id]() {
+                                cancelReplayGainRequest(id);
+                            }};
+
+        replayGainRequests.emplace_back(id, ScanRequest::ReplayGain, LibraryInfo{}, QStringLiteral(""), tracks);
+
+        if(replayGainRequests.size() == 1) {
+            execNextReplayGainRequest();
+        }
+
+        return request;
+    }
+
+    void execNextReplayGainRequest()
+    {
+        if(replayGainRequests.empty()) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(&replayGainScanner, [this, tracks = replayGainRequests.front().tracks]() {
+            replayGainScanner.scanTracks(tracks);
+        });
+    }
+
+    void finishReplayGainRequest()
+    {
+        if(!replayGainRequests.empty()) {
+            replayGainRequests.pop_front();
+        }
+        execNextReplayGainRequest();
+    }
+
+    void cancelReplayGainRequest(int id)
+    {
+        if(!replayGainRequests.empty() && replayGainRequests.front().id == id) {
+            // Will be removed in finishReplayGainRequest
+            replayGainScanner.stopThread();
+        }
+        else {
+            std::erase_if(replayGainRequests, [id](const auto& request) { return request.id == id; });
+        }
+    }
+
     std::optional<LibraryScanRequest> currentRequest() const
     {
         const auto requestIt = std::ranges::find_if(
@@ -240,17 +295,30 @@ LibraryThreadHandler::LibraryThreadHandler(DbConnectionPoolPtr dbPool, MusicLibr
         &p->scanner, &LibraryScanner::directoryChanged, this,
         [this](const LibraryInfo& libraryInfo, const QString& dir) { p->addDirectoryScanRequest(libraryInfo, dir); });
 
+    QObject::connect(&p->replayGainScanner, &Worker::finished, this, [this]() { p->finishReplayGainRequest(); });
+    QObject::connect(&p->replayGainScanner, &ReplayGainScanner::progressChanged, this, [this](int percent) {
+        if(!p->replayGainRequests.empty()) {
+            emit progressChanged(p->replayGainRequests.front().id, percent);
+        }
+    });
+    QObject::connect(&p->replayGainScanner, &ReplayGainScanner::scannedTracks, this,
+                     [this](const TrackList& tracks) { saveUpdatedTracks(tracks); });
+
     QMetaObject::invokeMethod(&p->scanner, &Worker::initialiseThread);
     QMetaObject::invokeMethod(&p->trackDatabaseManager, &Worker::initialiseThread);
+    QMetaObject::invokeMethod(&p->replayGainScanner, &Worker::initialiseThread);
 }
 
 LibraryThreadHandler::~LibraryThreadHandler()
 {
     p->scanner.stopThread();
     p->trackDatabaseManager.stopThread();
+    p->replayGainScanner.stopThread();
 
     p->thread.quit();
     p->thread.wait();
+    p->replayGainThread.quit();
+    p->replayGainThread.wait();
 }
 
 void LibraryThreadHandler::getAllTracks()
@@ -274,6 +342,11 @@ ScanRequest LibraryThreadHandler::scanTracks(const TrackList& tracks)
     return p->addTracksScanRequest(tracks);
 }
 
+ScanRequest LibraryThreadHandler::scanReplayGain(const TrackList& tracks)
+{
+    return p->addReplayGainRequest(tracks);
+}
+
 void LibraryThreadHandler::libraryRemoved(int id)
 {
     if(p->scanRequests.empty()) {
@@ -47,6 +47,7 @@ public:
 
     ScanRequest scanLibrary(const LibraryInfo& library);
     ScanRequest scanTracks(const TrackList& tracks);
+    ScanRequest scanReplayGain(const TrackList& tracks);
 
     void saveUpdatedTracks(const TrackList& tracks);
     void saveUpdatedTrackStats(const TrackList& track);
@@ -0,0 +1,258 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "replaygainscanner.h"
+
+#include "engine/audiokernels.h"
+#include "engine/decoderfactory.h"
+#include "engine/loudness.h"
+#include "engine/replaygain.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/track.h>
+#include <utils/paralleltaskrunner.h>
+
+#include <QDebug>
+#include <QFileInfo>
+
+#include <atomic>
+#include <cmath>
+#include <unordered_map>
+
+namespace Fooyin {
+struct ReplayGainScanner::Private
+{
+    struct TrackResult
+    {
+        std::vector<double> blocks;
+        double loudness{0.0};
+        double peak{0.0};
+        bool valid{false};
+    };
+
+    struct Album
+    {
+        std::vector<size_t> tracks;
+        std::atomic<size_t> remaining{0};
+    };
+
+    ReplayGainScanner* self;
+
+    TrackList tracks;
+    std::vector<TrackResult> results;
+    std::vector<Album> albums;
+    // Track and album indexes in album order, so albums are finished (and their results freed) as soon as possible
+    std::vector<std::pair<size_t, size_t>> queue;
+    std::atomic<size_t> tracksDone{0};
+
+    ParallelResults<Track> scanned;
+
+    explicit Private(ReplayGainScanner* self_)
+        : self{self_}
+    { }
+
+    void groupAlbums()
+    {
+        std::unordered_map<QString, size_t> albumIndexes;
+        std::vector<std::vector<size_t>> groups;
+
+        for(size_t i{0}; i < tracks.size(); ++i) {
+            const Track& track = tracks.at(i);
+
+            // Tracks without an album are treated as an album of their own
+            const QString album = track.album();
+            if(album.isEmpty()) {
+                groups.push_back({i});
+                continue;
+            }
+
+            const QString key    = QFileInfo{track.filepath()}.absolutePath() + u'|' + album;
+            auto [it, inserted] = albumIndexes.try_emplace(key, groups.size());
+            if(inserted) {
+                groups.emplace_back();
+            }
+            groups.at(it->second).push_back(i);
+        }
+
+        albums = std::vector<Album>(groups.size());
+        queue.clear();
+        queue.reserve(tracks.size());
+
+        for(size_t albumIndex{0}; albumIndex < groups.size(); ++albumIndex) {
+            auto& album = albums.at(albumIndex);
+            album.tracks.swap(groups.at(albumIndex));
+            album.remaining = album.tracks.size();
+
+            for(const size_t trackIndex : album.tracks) {
+                queue.emplace_back(trackIndex, albumIndex);
+            }
+        }
+    }
+
+    bool measureTrack(const Track& track, TrackResult& result) const
+    {
+        auto decoder = Audio::createDecoder(track.filepath(), ScanReadAhead);
+        if(!decoder->init(track.filepath())) {
+            qDebug() << "Unable to scan" << track.filepath();
+            return false;
+        }
+
+        const AudioFormat format = decoder->format();
+        const auto convert       = Audio::convertKernel(format.sampleFormat(), SampleFormat::Float);
+        if(!convert) {
+            return false;
+        }
+
+        LoudnessMeter meter{format.sampleRate(), format.channelCount()};
+        std::vector<float> samples;
+
+        decoder->start();
+
+        while(self->mayRun()) {
+            const AudioBuffer buffer = decoder->readBuffer();
+            if(!buffer.isValid()) {
+                break;
+            }
+
+            const int frames = buffer.frameCount();
+            const int count  = frames * format.channelCount();
+
+            samples.resize(static_cast<size_t>(count));
+            convert(buffer.constData().data(), reinterpret_cast<std::byte*>(samples.data()), count);
+            meter.process(samples.data(), frames);
+        }
+
+        result.loudness = meter.integratedLoudness();
+        result.peak     = meter.truePeak();
+        result.blocks   = meter.blocks();
+        // Silent tracks have nothing to adjust
+        result.valid = self->mayRun() && std::isfinite(result.loudness);
+
+        return result.valid;
+    }
+
+    void finishAlbum(const Album& album)
+    {
+        std::vector<double> blocks;
+        double albumPeak{0.0};
+
+        for(const size_t index : album.tracks) {
+            const auto& result = results.at(index);
+            if(result.valid) {
+                blocks.insert(blocks.end(), result.blocks.cbegin(), result.blocks.cend());
+                albumPeak = std::max(albumPeak, result.peak);
+            }
+        }
+
+        const double albumLoudness = LoudnessMeter::integratedLoudness(blocks);
+
+        TrackList albumTracks;
+
+        for(const size_t index : album.tracks) {
+            auto& result = results.at(index);
+            if(!result.valid) {
+                continue;
+            }
+
+            Track track{tracks.at(index)};
+            ReplayGain::setValues(track, {.trackGain = ReplayGain::ReferenceLoudness - result.loudness,
+                                          .trackPeak = result.peak,
+                                          .albumGain = ReplayGain::ReferenceLoudness - albumLoudness,
+                                          .albumPeak = albumPeak});
+            albumTracks.push_back(track);
+
+            result.blocks = {};
+        }
+
+        scanned.add(albumTracks);
+    }
+
+    void scanTrack(size_t index)
+    {
+        const auto [trackIndex, albumIndex] = queue.at(index);
+
+        measureTrack(tracks.at(trackIndex), results.at(trackIndex));
+        tracksDone.fetch_add(1);
+
+        auto& album = albums.at(albumIndex);
+        if(album.remaining.fetch_sub(1) == 1 && self->mayRun()) {
+            finishAlbum(album);
+        }
+    }
+
+    void reportProgress() const
+    {
+        const double done = static_cast<double>(tracksDone) / static_cast<double>(queue.size());
+        emit self->progressChanged(static_cast<int>(done * 100));
+    }
+
+    void emitScanned()
+    {
+        const TrackList finished = scanned.take();
+        if(!finished.empty()) {
+            emit self->scannedTracks(finished);
+        }
+    }
+};
+
+ReplayGainScanner::ReplayGainScanner(QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+ReplayGainScanner::~ReplayGainScanner() = default;
+
+void ReplayGainScanner::scanTracks(const TrackList& tracks)
+{
+    if(tracks.empty()) {
+        emit finished();
+        return;
+    }
+
+    setState(Running);
+
+    p->tracks = tracks;
+    p->results.assign(tracks.size(), {});
+    p->groupAlbums();
+    p->tracksDone = 0;
+
+    const ParallelTaskRunner runner{this};
+    const ParallelTaskRunner::Tasks tasks{.process = [this](size_t index, int /*worker*/) { p->scanTrack(index); }};
+
+    runner.run(p->queue.size(), tasks, [this]() {
+        p->reportProgress();
+        p->emitScanned();
+    });
+
+    // Also sent when cancelled, so progress is always seen to finish
+    emit progressChanged(100);
+    // Albums finished before a cancel are still kept
+    p->emitScanned();
+
+    p->tracks.clear();
+    p->results.clear();
+    p->albums.clear();
+    p->queue.clear();
+
+    setState(Idle);
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "moc_replaygainscanner.cpp"
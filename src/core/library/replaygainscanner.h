@@ -0,0 +1,50 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/trackfwd.h>
+#include <utils/worker.h>
+
+namespace Fooyin {
+/*!
+ * Measures the loudness of tracks, and calculates their ReplayGain values.
+ * Tracks are decoded in parallel, one per core, and grouped by album and directory to calculate album gain.
+ */
+class ReplayGainScanner : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayGainScanner(QObject* parent = nullptr);
+    ~ReplayGainScanner() override;
+
+signals:
+    void progressChanged(int percent);
+    /** Emitted in batches as albums are finished, with their ReplayGain tags set. */
+    void scannedTracks(const TrackList& tracks);
+
+public slots:
+    void scanTracks(const TrackList& tracks);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
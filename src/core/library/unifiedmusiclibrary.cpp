@@ -257,6 +257,11 @@ ScanRequest UnifiedMusicLibrary::scanTracks(const TrackList& tracks)
     return p->threadHandler.scanTracks(tracks);
 }
 
+ScanRequest UnifiedMusicLibrary::scanReplayGain(const TrackList& tracks)
+{
+    return p->threadHandler.scanReplayGain(tracks);
+}
+
 bool UnifiedMusicLibrary::hasLibrary() const
 {
     return p->libraryManager->hasLibrary();
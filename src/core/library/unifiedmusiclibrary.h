@@ -41,6 +41,7 @@ public:
     void rescanAll() override;
     ScanRequest rescan(const LibraryInfo& library) override;
     ScanRequest scanTracks(const TrackList& tracks) override;
+    ScanRequest scanReplayGain(const TrackList& tracks) override;
 
     [[nodiscard]] bool hasLibrary() const override;
     [[nodiscard]] bool isEmpty() const override;
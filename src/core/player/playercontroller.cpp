@@ -25,6 +25,14 @@
 #include <core/track.h>
 #include <utils/settings/settingsmanager.h>
 
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+using Clock = std::chrono::steady_clock;
+
 namespace Fooyin {
 struct PlayerController::Private
 {
@@ -37,16 +45,65 @@ struct PlayerController::Private
     PlayState playStatus{PlayState::Stopped};
     Playlist::PlayModes playMode;
     uint64_t position{0};
+    // When position was last set, so it can be extrapolated while playing
+    Clock::time_point positionTime;
     bool counted{false};
     bool isQueueTrack{false};
 
     PlaybackQueue queue;
+    QTimer playedTimer;
 
     Private(PlayerController* self_, SettingsManager* settings_)
         : self{self_}
         , settings{settings_}
         , playMode{static_cast<Playlist::PlayModes>(settings->value<Settings::Core::PlayMode>())}
-    { }
+    {
+        playedTimer.setSingleShot(true);
+        QObject::connect(&playedTimer, &QTimer::timeout, self, [this]() { checkPlayed(); });
+    }
+
+    [[nodiscard]] uint64_t currentPosition() const
+    {
+        if(playStatus != PlayState::Playing) {
+            return position;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - positionTime);
+        const uint64_t extrapolated = position + static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+        return totalDuration > 0 ? std::min(extrapolated, totalDuration) : extrapolated;
+    }
+
+    void setPosition(uint64_t ms)
+    {
+        position     = ms;
+        positionTime = Clock::now();
+    }
+
+    void checkPlayed()
+    {
+        // TODO: Only increment playCount based on total time listened excluding seeking.
+        if(!counted && currentPosition() >= totalDuration / 2) {
+            counted = true;
+            if(currentTrack.isValid()) {
+                emit self->trackPlayed(currentTrack.track);
+            }
+        }
+    }
+
+    void schedulePlayed()
+    {
+        // Position updates are sparse, so check again once playback should have reached half way
+        playedTimer.stop();
+        checkPlayed();
+
+        if(counted || playStatus != PlayState::Playing) {
+            return;
+        }
+
+        const uint64_t halfway = totalDuration / 2;
+        const uint64_t current = currentPosition();
+        playedTimer.start(static_cast<int>(std::min<uint64_t>(halfway - current, std::numeric_limits<int>::max())));
+    }
 };
 
 PlayerController::PlayerController(SettingsManager* settings, QObject* parent)
@@ -66,7 +123,8 @@ PlayerController::~PlayerController() = default;
 void PlayerController::reset()
 {
     p->playStatus = PlayState::Stopped;
-    p->position   = 0;
+    p->setPosition(0);
+    p->playedTimer.stop();
 }
 
 void PlayerController::play()
@@ -78,6 +136,8 @@ void PlayerController::play()
 
     if(p->currentTrack.isValid() && p->playStatus != PlayState::Playing) {
         p->playStatus = PlayState::Playing;
+        p->setPosition(p->position);
+        p->schedulePlayed();
         emit playStateChanged(p->playStatus);
     }
 }
@@ -99,6 +159,11 @@ void PlayerController::playPause()
 
 void PlayerController::pause()
 {
+    if(p->playStatus == PlayState::Playing) {
+        p->setPosition(p->currentPosition());
+        p->playedTimer.stop();
+    }
+
     if(std::exchange(p->playStatus, PlayState::Paused) != p->playStatus) {
         emit playStateChanged(p->playStatus);
     }
@@ -132,14 +197,8 @@ void PlayerController::stop()
 
 void PlayerController::setCurrentPosition(uint64_t ms)
 {
-    p->position = ms;
-    // TODO: Only increment playCount based on total time listened excluding seeking.
-    if(!p->counted && ms >= p->totalDuration / 2) {
-        p->counted = true;
-        if(p->currentTrack.isValid()) {
-            emit trackPlayed(p->currentTrack.track);
-        }
-    }
+    p->setPosition(ms);
+    p->schedulePlayed();
     emit positionChanged(ms);
 }
 
@@ -152,8 +211,9 @@ void PlayerController::changeCurrentTrack(const PlaylistTrack& track)
 {
     p->currentTrack  = track;
     p->totalDuration = p->currentTrack.track.duration();
-    p->position      = 0;
     p->counted       = false;
+    p->setPosition(0);
+    p->schedulePlayed();
 
     emit currentTrackChanged(p->currentTrack.track);
     emit playlistTrackChanged(p->currentTrack);
@@ -194,23 +254,26 @@ void PlayerController::seek(uint64_t ms)
         return;
     }
 
-    if(std::exchange(p->position, ms) != ms) {
+    if(p->currentPosition() != ms) {
+        p->setPosition(ms);
+        p->schedulePlayed();
         emit positionMoved(ms);
     }
 }
 
 void PlayerController::seekForward(uint64_t delta)
 {
-    seek(p->position + delta);
+    seek(p->currentPosition() + delta);
 }
 
 void PlayerController::seekBackward(uint64_t delta)
 {
-    if(delta > p->position) {
+    const uint64_t position = p->currentPosition();
+    if(delta > position) {
         seek(0);
     }
     else {
-        seek(p->position - delta);
+        seek(position - delta);
     }
 }
 
@@ -226,7 +289,7 @@ Playlist::PlayModes PlayerController::playMode() const
 
 uint64_t PlayerController::currentPosition() const
 {
-    return p->position;
+    return p->currentPosition();
 }
 
 Track PlayerController::currentTrack() const
@@ -155,6 +155,60 @@ struct Playlist::Private
 
         return nextIndex;
     }
+
+    // The same as getNextIndex, without consuming the scheduled track or moving the shuffle position
+    [[nodiscard]] int peekNextIndex(int delta, PlayModes mode) const
+    {
+        if(tracks.empty()) {
+            return -1;
+        }
+
+        if(nextTrackIndex >= 0) {
+            return nextTrackIndex;
+        }
+
+        const int count = static_cast<int>(tracks.size());
+        int nextIndex   = currentTrackIndex;
+
+        if(mode & ShuffleTracks) {
+            // The order is only created once playback moves on, so there's nothing to predict from yet
+            if(shuffleOrder.empty()) {
+                return -1;
+            }
+
+            const int shuffleCount = static_cast<int>(shuffleOrder.size());
+            int index              = (mode & RepeatTrack) ? shuffleIndex : shuffleIndex + delta;
+
+            if(mode & RepeatPlaylist) {
+                if(index > shuffleCount - 1) {
+                    index = 0;
+                }
+                else if(index < 0) {
+                    index = shuffleCount - 1;
+                }
+            }
+
+            return index >= 0 && index < shuffleCount ? shuffleOrder.at(index) : -1;
+        }
+
+        if(mode & RepeatPlaylist) {
+            nextIndex += delta;
+            if(nextIndex < 0) {
+                nextIndex = count - 1;
+            }
+            else if(nextIndex >= count) {
+                nextIndex = 0;
+            }
+        }
+        else if(mode == Default) {
+            nextIndex += delta;
+            if(nextIndex < 0 || nextIndex >= count) {
+                nextIndex = -1;
+            }
+        }
+
+        return nextIndex;
+    }
 };
 
 Playlist::Playlist(PrivateKey /*key*/, QString name)
@@ -259,6 +313,17 @@ Track Playlist::nextTrack(int delta, PlayModes mode)
     return p->tracks.at(index);
 }
 
+Track Playlist::peekNextTrack(int delta, PlayModes mode) const
+{
+    const int index = p->peekNextIndex(delta, mode);
+
+    if(index < 0 || index >= trackCount()) {
+        return {};
+    }
+
+    return p->tracks.at(index);
+}
+
 Track Playlist::nextTrackChange(int delta, PlayModes mode)
 {
     const int index = p->getNextIndex(delta, mode);
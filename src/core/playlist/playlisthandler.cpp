@@ -714,7 +714,23 @@ void PlaylistHandler::tracksRemoved(const TrackList& tracks)
 
 void PlaylistHandler::trackAboutToFinish()
 {
-    p->nextTrack(1);
+    // Queued tracks are played before the playlist continues
+    const auto queue = p->playerController->playbackQueue();
+    if(!queue.empty()) {
+        emit upcomingTrack(queue.track(0).track);
+        return;
+    }
+
+    auto* playlist = p->scheduledPlaylist ? p->scheduledPlaylist : p->activePlaylist;
+    if(!playlist) {
+        return;
+    }
+
+    // Only a prediction; the playlist moves on once the track actually changes
+    const Track track = playlist->peekNextTrack(1, p->playerController->playMode());
+    if(track.isValid()) {
+        emit upcomingTrack(track);
+    }
 }
 } // namespace Fooyin
 
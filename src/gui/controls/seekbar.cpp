@@ -23,6 +23,7 @@
 
 #include <core/player/playercontroller.h>
 #include <core/track.h>
+#include <gui/widgets/positionticker.h>
 #include <utils/clickablelabel.h>
 #include <utils/settings/settingsmanager.h>
 #include <utils/utils.h>
@@ -35,7 +36,10 @@
 #include <QSlider>
 #include <QStyleOptionSlider>
 
-constexpr auto SeekDelta = 5000;
+#include <algorithm>
+
+constexpr auto SeekDelta      = 5000;
+constexpr auto TickResolution = 250;
 
 namespace Fooyin {
 class TrackSlider : public QSlider
@@ -280,6 +284,8 @@ struct SeekBar::Private
     ClickableLabel* elapsed;
     ClickableLabel* total;
 
+    PositionTicker* ticker;
+
     uint64_t max{0};
     bool elapsedTotal;
 
@@ -290,6 +296,7 @@ struct SeekBar::Private
         , slider{new TrackSlider(self)}
         , elapsed{new ClickableLabel(self)}
         , total{new ClickableLabel(self)}
+        , ticker{new PositionTicker(playerController, self)}
     {
         toggleElapsedTotal(settings->value<Settings::Gui::Internal::SeekBarElapsedTotal>());
         toggleLabels(settings->value<Settings::Gui::Internal::SeekBarLabels>());
@@ -314,9 +321,17 @@ struct SeekBar::Private
             max = track.duration();
             slider->updateMaximum(max);
             updateLabels(max);
+            updateResolution();
         }
     }
 
+    void updateResolution() const
+    {
+        // No need to update more often than the slider moves a pixel, but the labels still need to tick each second
+        const uint64_t perPixel = max / static_cast<uint64_t>(std::max(slider->width(), 1));
+        ticker->setResolution(std::min<uint64_t>(perPixel, TickResolution));
+    }
+
     void setCurrentPosition(uint64_t pos) const
     {
         slider->updateCurrentValue(pos);
@@ -398,9 +413,7 @@ SeekBar::SeekBar(PlayerController* playerController, SettingsManager* settings,
                      [this](PlayState state) { p->stateChanged(state); });
     QObject::connect(p->playerController, &PlayerController::currentTrackChanged, this,
                      [this](const Track& track) { p->trackChanged(track); });
-    QObject::connect(p->playerController, &PlayerController::positionChanged, this,
-                     [this](uint64_t pos) { p->setCurrentPosition(pos); });
-    QObject::connect(p->playerController, &PlayerController::positionMoved, this,
+    QObject::connect(p->ticker, &PositionTicker::positionChanged, this,
                      [this](uint64_t pos) { p->setCurrentPosition(pos); });
 
     p->trackChanged(p->playerController->currentTrack());
@@ -0,0 +1,186 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "convertdialog.h"
+
+#include <core/track.h>
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDebug>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStandardPaths>
+
+namespace Fooyin {
+ConvertDialog::ConvertDialog(TrackList tracks, QWidget* parent)
+    : QDialog{parent}
+    , m_tracks{std::move(tracks)}
+    , m_codec{new QComboBox(this)}
+    , m_bitrate{new QSpinBox(this)}
+    , m_compression{new QSpinBox(this)}
+    , m_sampleRate{new QComboBox(this)}
+    , m_directory{new QLineEdit(this)}
+    , m_overwrite{new QCheckBox(tr("Overwrite existing files"), this)}
+    , m_converter{nullptr}
+{
+    setWindowTitle(tr("Convert %Ln Track(s)", nullptr, static_cast<int>(m_tracks.size())));
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    m_codec->addItem(QStringLiteral("FLAC"), ConversionOptions::Flac);
+    m_codec->addItem(QStringLiteral("Opus"), ConversionOptions::Opus);
+    m_codec->addItem(QStringLiteral("MP3"), ConversionOptions::Mp3);
+    m_codec->addItem(QStringLiteral("AAC"), ConversionOptions::Aac);
+
+    m_bitrate->setRange(32, 512);
+    m_bitrate->setSingleStep(32);
+    m_bitrate->setSuffix(QStringLiteral(" kbps"));
+    m_bitrate->setValue(192);
+
+    m_compression->setRange(0, 12);
+    m_compression->setValue(5);
+
+    m_sampleRate->addItem(tr("Keep original"), 0);
+    for(const int rate : {44100, 48000, 88200, 96000}) {
+        m_sampleRate->addItem(QStringLiteral("%1 Hz").arg(rate), rate);
+    }
+
+    m_directory->setText(QStandardPaths::writableLocation(QStandardPaths::MusicLocation));
+
+    auto* browse = new QPushButton(tr("Browse…"), this);
+    QObject::connect(browse, &QPushButton::clicked, this, &ConvertDialog::browseDirectory);
+
+    auto* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    buttonBox->button(QDialogButtonBox::Ok)->setText(tr("Convert"));
+    QObject::connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    QObject::connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto* layout = new QGridLayout(this);
+
+    int row{0};
+    layout->addWidget(new QLabel(tr("Format") + u":", this), row, 0);
+    layout->addWidget(m_codec, row++, 1, 1, 2);
+    layout->addWidget(new QLabel(tr("Bitrate") + u":", this), row, 0);
+    layout->addWidget(m_bitrate, row++, 1, 1, 2);
+    layout->addWidget(new QLabel(tr("Compression level") + u":", this), row, 0);
+    layout->addWidget(m_compression, row++, 1, 1, 2);
+    layout->addWidget(new QLabel(tr("Sample rate") + u":", this), row, 0);
+    layout->addWidget(m_sampleRate, row++, 1, 1, 2);
+    layout->addWidget(new QLabel(tr("Output directory") + u":", this), row, 0);
+    layout->addWidget(m_directory, row, 1);
+    layout->addWidget(browse, row++, 2);
+    layout->addWidget(m_overwrite, row++, 0, 1, 3);
+    layout->addWidget(buttonBox, row, 0, 1, 3);
+    layout->setColumnStretch(1, 1);
+
+    QObject::connect(m_codec, &QComboBox::currentIndexChanged, this, &ConvertDialog::updateCodecOptions);
+    updateCodecOptions();
+}
+
+ConvertDialog::~ConvertDialog()
+{
+    if(m_converter) {
+        m_converter->stopThread();
+    }
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ConvertDialog::accept()
+{
+    const QString directory = m_directory->text();
+    if(directory.isEmpty()) {
+        return;
+    }
+
+    ConversionOptions options;
+    options.codec            = static_cast<ConversionOptions::Codec>(m_codec->currentData().toInt());
+    options.bitrate          = m_bitrate->value();
+    options.compressionLevel = m_compression->value();
+    options.sampleRate       = m_sampleRate->currentData().toInt();
+    options.outputDirectory  = QDir::cleanPath(directory);
+    options.overwrite        = m_overwrite->isChecked();
+
+    hide();
+
+    m_progress = new QProgressDialog(tr("Converting tracks…"), tr("Abort"), 0, 100, parentWidget());
+    m_progress->setAttribute(Qt::WA_DeleteOnClose);
+    m_progress->setWindowModality(Qt::WindowModal);
+    m_progress->setMinimumDuration(0);
+
+    m_converter = new TrackConverter();
+    m_converter->moveToThread(&m_thread);
+    QObject::connect(&m_thread, &QThread::finished, m_converter, &QObject::deleteLater);
+
+    QObject::connect(m_converter, &TrackConverter::progressChanged, m_progress, &QProgressDialog::setValue);
+    QObject::connect(m_progress, &QProgressDialog::canceled, this, [this]() { m_converter->stopThread(); });
+    QObject::connect(m_converter, &TrackConverter::trackFailed, this,
+                     [this](const Track& track, const QString& error) {
+                         qWarning() << "Unable to convert" << track.filepath() << ":" << error;
+                         m_failed.push_back(track);
+                     });
+    QObject::connect(m_converter, &Worker::finished, this, &ConvertDialog::finishConversion);
+
+    m_thread.start();
+
+    QMetaObject::invokeMethod(m_converter, [converter = m_converter, tracks = m_tracks, options]() {
+        converter->convertTracks(tracks, options);
+    });
+}
+
+void ConvertDialog::updateCodecOptions()
+{
+    const bool lossless = m_codec->currentData().toInt() == ConversionOptions::Flac;
+    m_bitrate->setEnabled(!lossless);
+    m_compression->setEnabled(lossless);
+}
+
+void ConvertDialog::browseDirectory()
+{
+    const QString dir = QFileDialog::getExistingDirectory(this, tr("Output Directory"), m_directory->text(),
+                                                          QFileDialog::ShowDirsOnly);
+    if(!dir.isEmpty()) {
+        m_directory->setText(dir);
+    }
+}
+
+void ConvertDialog::finishConversion()
+{
+    if(m_progress) {
+        m_progress->close();
+    }
+
+    if(!m_failed.empty()) {
+        QMessageBox::warning(parentWidget(), tr("Convert"),
+                             tr("%Ln track(s) could not be converted.", nullptr, static_cast<int>(m_failed.size())));
+    }
+
+    deleteLater();
+}
+} // namespace Fooyin
+
+#include "moc_convertdialog.cpp"
@@ -0,0 +1,69 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/trackconverter.h>
+#include <core/trackfwd.h>
+
+#include <QDialog>
+#include <QPointer>
+#include <QThread>
+
+class QCheckBox;
+class QComboBox;
+class QLineEdit;
+class QProgressDialog;
+class QSpinBox;
+
+namespace Fooyin {
+/*!
+ * Asks for conversion options, then converts the tracks in the background while showing progress.
+ * Deletes itself once the conversion has finished or been cancelled.
+ */
+class ConvertDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ConvertDialog(TrackList tracks, QWidget* parent = nullptr);
+    ~ConvertDialog() override;
+
+    void accept() override;
+
+private:
+    void updateCodecOptions();
+    void browseDirectory();
+    void finishConversion();
+
+    TrackList m_tracks;
+    TrackList m_failed;
+
+    QComboBox* m_codec;
+    QSpinBox* m_bitrate;
+    QSpinBox* m_compression;
+    QComboBox* m_sampleRate;
+    QLineEdit* m_directory;
+    QCheckBox* m_overwrite;
+
+    QThread m_thread;
+    TrackConverter* m_converter;
+    QPointer<QProgressDialog> m_progress;
+};
+} // namespace Fooyin
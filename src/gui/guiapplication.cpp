@@ -26,6 +26,7 @@
 #include "core/application.h"
 #include "core/corepaths.h"
 #include "core/internalcoresettings.h"
+#include "dialog/convertdialog.h"
 #include "dirbrowser/dirbrowser.h"
 #include "info/infowidget.h"
 #include "internalguisettings.h"
@@ -61,10 +62,14 @@
 #include "settings/widgets/statuswidgetpage.h"
 #include "widgets/coverwidget.h"
 #include "widgets/dummy.h"
+#include "widgets/enginestatswidget.h"
 #include "widgets/spacer.h"
+#include "widgets/spectrogramwidget.h"
+#include "widgets/spectrumwidget.h"
 #include "widgets/splitterwidget.h"
 #include "widgets/statuswidget.h"
 #include "widgets/tabstackwidget.h"
+#include "widgets/vumeterwidget.h"
 
 #include <core/coresettings.h>
 #include <core/engine/enginehandler.h>
@@ -300,6 +305,13 @@ struct GuiApplication::Private
                          &PlaylistController::handleTrackSelectionAction);
         QObject::connect(&selectionController, &TrackSelectionController::requestPropertiesDialog, propertiesDialog,
                          &PropertiesDialog::show);
+        QObject::connect(&selectionController, &TrackSelectionController::requestReplayGainScan, library,
+                         [this](const TrackList& tracks) { library->scanReplayGain(tracks); });
+        QObject::connect(&selectionController, &TrackSelectionController::requestConversion, mainWindow.get(),
+                         [this](const TrackList& tracks) {
+                             auto* convertDialog = new ConvertDialog(tracks, mainWindow.get());
+                             convertDialog->show();
+                         });
         QObject::connect(fileMenu, &FileMenu::requestNewPlaylist, self, [this]() {
             if(auto* playlist = playlistHandler->createEmptyPlaylist()) {
                 playlistController->changeCurrentPlaylist(playlist);
@@ -515,6 +527,24 @@ struct GuiApplication::Private
             },
             tr("Directory Browser"));
         widgetProvider.setLimit(QStringLiteral("DirectoryBrowser"), 1);
+
+        widgetProvider.registerWidget(
+            QStringLiteral("EngineStatistics"),
+            [this]() { return new EngineStatsWidget(engine, settingsManager, mainWindow.get()); },
+            tr("Engine Statistics"));
+
+        widgetProvider.registerWidget(
+            QStringLiteral("Spectrum"), [this]() { return new SpectrumWidget(engine->analyser(), mainWindow.get()); },
+            tr("Spectrum"));
+
+        widgetProvider.registerWidget(
+            QStringLiteral("Spectrogram"),
+            [this]() { return new SpectrogramWidget(engine, playerController, mainWindow.get()); },
+            tr("Spectrogram"));
+
+        widgetProvider.registerWidget(
+            QStringLiteral("VuMeter"), [this]() { return new VuMeterWidget(engine->analyser(), mainWindow.get()); },
+            tr("VU Meter"));
     }
 
     void createPropertiesTabs()
@@ -27,12 +27,15 @@
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDoubleSpinBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QLabel>
 #include <QListView>
 #include <QSpinBox>
 
+#include <algorithm>
+
 namespace Fooyin {
 class EnginePageWidget : public SettingsPageWidget
 {
@@ -57,6 +60,16 @@ private:
 
     QCheckBox* m_gaplessPlayback;
     QSpinBox* m_bufferSize;
+    QSpinBox* m_readAheadSize;
+    QSpinBox* m_memoryCacheLimit;
+    QComboBox* m_outputSampleRate;
+    QSpinBox* m_crossfadeLength;
+    QSpinBox* m_outputLatency;
+    QCheckBox* m_exclusiveOutput;
+    QCheckBox* m_engineStats;
+
+    QComboBox* m_replayGainMode;
+    QDoubleSpinBox* m_replayGainPreamp;
 };
 
 EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController* engine)
@@ -66,6 +79,15 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     , m_deviceBox{new ExpandingComboBox(this)}
     , m_gaplessPlayback{new QCheckBox(tr("Gapless Playback"), this)}
     , m_bufferSize{new QSpinBox(this)}
+    , m_readAheadSize{new QSpinBox(this)}
+    , m_memoryCacheLimit{new QSpinBox(this)}
+    , m_outputSampleRate{new QComboBox(this)}
+    , m_crossfadeLength{new QSpinBox(this)}
+    , m_outputLatency{new QSpinBox(this)}
+    , m_exclusiveOutput{new QCheckBox(tr("Exclusive mode"), this)}
+    , m_engineStats{new QCheckBox(tr("Collect playback statistics"), this)}
+    , m_replayGainMode{new QComboBox(this)}
+    , m_replayGainPreamp{new QDoubleSpinBox(this)}
 {
     auto* outputLabel = new QLabel(tr("Output") + QStringLiteral(":"), this);
     auto* deviceLabel = new QLabel(tr("Device") + QStringLiteral(":"), this);
@@ -88,17 +110,107 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     generalLayout->addWidget(bufferLabel, 1, 0);
     generalLayout->addWidget(m_bufferSize, 1, 1);
 
+    auto* readAheadLabel = new QLabel(tr("Read-ahead buffer") + QStringLiteral(":"), this);
+    readAheadLabel->setToolTip(
+        tr("Amount of each file to read ahead of playback, to ride out slow or network storage"));
+
+    m_readAheadSize->setSuffix(QStringLiteral(" MB"));
+    m_readAheadSize->setMinimum(1);
+    m_readAheadSize->setMaximum(256);
+
+    generalLayout->addWidget(readAheadLabel, 2, 0);
+    generalLayout->addWidget(m_readAheadSize, 2, 1);
+
+    auto* cacheLabel = new QLabel(tr("Read into memory up to") + QStringLiteral(":"), this);
+    cacheLabel->setToolTip(tr("Files up to this size are read into memory in full; 0 disables this"));
+
+    m_memoryCacheLimit->setSuffix(QStringLiteral(" MB"));
+    m_memoryCacheLimit->setMinimum(0);
+    m_memoryCacheLimit->setMaximum(1024);
+
+    generalLayout->addWidget(cacheLabel, 3, 0);
+    generalLayout->addWidget(m_memoryCacheLimit, 3, 1);
+
+    auto* sampleRateLabel = new QLabel(tr("Output sample rate") + QStringLiteral(":"), this);
+    sampleRateLabel->setToolTip(tr("Resample every track to a fixed rate, so the output device is only opened once"));
+
+    m_outputSampleRate->addItem(tr("Match track"), 0);
+    for(const int sampleRate : {44100, 48000, 88200, 96000, 176400, 192000}) {
+        m_outputSampleRate->addItem(QStringLiteral("%1 Hz").arg(sampleRate), sampleRate);
+    }
+
+    generalLayout->addWidget(sampleRateLabel, 4, 0);
+    generalLayout->addWidget(m_outputSampleRate, 4, 1);
+
+    auto* crossfadeLabel = new QLabel(tr("Crossfade") + QStringLiteral(":"), this);
+    crossfadeLabel->setToolTip(tr("Fade each track into the next when playing through a playlist"));
+
+    m_crossfadeLength->setSuffix(QStringLiteral(" ms"));
+    m_crossfadeLength->setSpecialValueText(tr("Off"));
+    m_crossfadeLength->setSingleStep(500);
+    m_crossfadeLength->setMinimum(0);
+    m_crossfadeLength->setMaximum(15000);
+
+    generalLayout->addWidget(crossfadeLabel, 5, 0);
+    generalLayout->addWidget(m_crossfadeLength, 5, 1);
+
+    auto* latencyLabel = new QLabel(tr("Output latency") + QStringLiteral(":"), this);
+    latencyLabel->setToolTip(tr("Size of the output device's buffer; lower values respond faster but risk dropouts"));
+
+    m_outputLatency->setSuffix(QStringLiteral(" ms"));
+    m_outputLatency->setSpecialValueText(tr("Default"));
+    m_outputLatency->setSingleStep(10);
+    m_outputLatency->setMinimum(0);
+    m_outputLatency->setMaximum(2000);
+
+    generalLayout->addWidget(latencyLabel, 6, 0);
+    generalLayout->addWidget(m_outputLatency, 6, 1);
+
+    m_exclusiveOutput->setToolTip(tr("Open hardware devices directly in a format they play natively, bypassing any "
+                                     "mixing or conversion by the sound server, for bit-perfect playback"));
+
+    generalLayout->addWidget(m_exclusiveOutput, 7, 0, 1, 3);
+
+    m_engineStats->setToolTip(tr("Track underruns and decode times, for the Engine Statistics widget"));
+
+    generalLayout->addWidget(m_engineStats, 8, 0, 1, 3);
+
     generalLayout->setColumnStretch(2, 1);
 
+    auto* replayGainBox    = new QGroupBox(tr("ReplayGain"), this);
+    auto* replayGainLayout = new QGridLayout(replayGainBox);
+
+    auto* modeLabel = new QLabel(tr("Mode") + QStringLiteral(":"), this);
+
+    m_replayGainMode->addItem(tr("None"));
+    m_replayGainMode->addItem(tr("Track gain"));
+    m_replayGainMode->addItem(tr("Album gain"));
+
+    auto* preampLabel = new QLabel(tr("Preamp") + QStringLiteral(":"), this);
+    preampLabel->setToolTip(tr("Added to the gain of tracks with ReplayGain information"));
+
+    m_replayGainPreamp->setSuffix(QStringLiteral(" dB"));
+    m_replayGainPreamp->setSingleStep(0.5);
+    m_replayGainPreamp->setDecimals(1);
+    m_replayGainPreamp->setMinimum(-20.0);
+    m_replayGainPreamp->setMaximum(20.0);
+
+    replayGainLayout->addWidget(modeLabel, 0, 0);
+    replayGainLayout->addWidget(m_replayGainMode, 0, 1);
+    replayGainLayout->addWidget(preampLabel, 1, 0);
+    replayGainLayout->addWidget(m_replayGainPreamp, 1, 1);
+    replayGainLayout->setColumnStretch(2, 1);
+
     auto* mainLayout = new QGridLayout(this);
     mainLayout->addWidget(outputLabel, 0, 0);
     mainLayout->addWidget(m_outputBox, 0, 1);
     mainLayout->addWidget(deviceLabel, 1, 0);
     mainLayout->addWidget(m_deviceBox, 1, 1);
     mainLayout->addWidget(generalBox, 2, 0, 1, 2);
+    mainLayout->addWidget(replayGainBox, 3, 0, 1, 2);
 
     mainLayout->setColumnStretch(1, 1);
-    mainLayout->setRowStretch(3, 1);
+    mainLayout->setRowStretch(4, 1);
 
     QObject::connect(m_outputBox, &QComboBox::currentTextChanged, this, &EnginePageWidget::setupDevices);
 }
@@ -109,6 +221,16 @@ void EnginePageWidget::load()
     setupDevices(m_outputBox->currentText());
     m_gaplessPlayback->setChecked(m_settings->value<Settings::Core::GaplessPlayback>());
     m_bufferSize->setValue(m_settings->value<Settings::Core::BufferLength>());
+    m_readAheadSize->setValue(m_settings->value<Settings::Core::ReadAheadSize>());
+    m_memoryCacheLimit->setValue(m_settings->value<Settings::Core::MemoryCacheLimit>());
+    m_outputSampleRate->setCurrentIndex(
+        std::max(0, m_outputSampleRate->findData(m_settings->value<Settings::Core::OutputSampleRate>())));
+    m_crossfadeLength->setValue(m_settings->value<Settings::Core::CrossfadeLength>());
+    m_outputLatency->setValue(m_settings->value<Settings::Core::OutputLatency>());
+    m_exclusiveOutput->setChecked(m_settings->value<Settings::Core::ExclusiveOutput>());
+    m_engineStats->setChecked(m_settings->value<Settings::Core::EngineStatistics>());
+    m_replayGainMode->setCurrentIndex(m_settings->value<Settings::Core::ReplayGainMode>());
+    m_replayGainPreamp->setValue(m_settings->value<Settings::Core::ReplayGainPreamp>());
 }
 
 void EnginePageWidget::apply()
@@ -117,6 +239,15 @@ void EnginePageWidget::apply()
     m_settings->set<Settings::Core::AudioOutput>(output);
     m_settings->set<Settings::Core::GaplessPlayback>(m_gaplessPlayback->isChecked());
     m_settings->set<Settings::Core::BufferLength>(m_bufferSize->value());
+    m_settings->set<Settings::Core::ReadAheadSize>(m_readAheadSize->value());
+    m_settings->set<Settings::Core::MemoryCacheLimit>(m_memoryCacheLimit->value());
+    m_settings->set<Settings::Core::OutputSampleRate>(m_outputSampleRate->currentData().toInt());
+    m_settings->set<Settings::Core::CrossfadeLength>(m_crossfadeLength->value());
+    m_settings->set<Settings::Core::OutputLatency>(m_outputLatency->value());
+    m_settings->set<Settings::Core::ExclusiveOutput>(m_exclusiveOutput->isChecked());
+    m_settings->set<Settings::Core::EngineStatistics>(m_engineStats->isChecked());
+    m_settings->set<Settings::Core::ReplayGainMode>(m_replayGainMode->currentIndex());
+    m_settings->set<Settings::Core::ReplayGainPreamp>(m_replayGainPreamp->value());
 }
 
 void EnginePageWidget::reset()
@@ -124,6 +255,15 @@ void EnginePageWidget::reset()
     m_settings->reset<Settings::Core::AudioOutput>();
     m_settings->reset<Settings::Core::GaplessPlayback>();
     m_settings->reset<Settings::Core::BufferLength>();
+    m_settings->reset<Settings::Core::ReadAheadSize>();
+    m_settings->reset<Settings::Core::MemoryCacheLimit>();
+    m_settings->reset<Settings::Core::OutputSampleRate>();
+    m_settings->reset<Settings::Core::CrossfadeLength>();
+    m_settings->reset<Settings::Core::OutputLatency>();
+    m_settings->reset<Settings::Core::ExclusiveOutput>();
+    m_settings->reset<Settings::Core::EngineStatistics>();
+    m_settings->reset<Settings::Core::ReplayGainMode>();
+    m_settings->reset<Settings::Core::ReplayGainPreamp>();
 }
 
 void EnginePageWidget::setupOutputs()
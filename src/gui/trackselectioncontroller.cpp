@@ -72,6 +72,8 @@ struct TrackSelectionController::Private
     QAction* addToQueue;
     QAction* removeFromQueue;
     QAction* openFolder;
+    QAction* scanReplayGain;
+    QAction* convertTracks;
     QAction* openProperties;
 
     Private(TrackSelectionController* self_, ActionManager* actionManager_, SettingsManager* settings_,
@@ -91,6 +93,8 @@ struct TrackSelectionController::Private
         , addToQueue{new QAction(tr("Add to Playback Queue"), tracksMenu)}
         , removeFromQueue{new QAction(tr("Remove from Playback Queue"), tracksMenu)}
         , openFolder{new QAction(tr("Open Containing Folder"), tracksMenu)}
+        , scanReplayGain{new QAction(tr("Calculate ReplayGain"), tracksMenu)}
+        , convertTracks{new QAction(tr("Convert…"), tracksMenu)}
         , openProperties{new QAction(tr("Properties"), tracksMenu)}
     {
         // Playlist menu
@@ -152,6 +156,20 @@ struct TrackSelectionController::Private
         });
         tracksMenu->addAction(actionManager->registerAction(openFolder, "TrackSelection.OpenFolder"));
 
+        QObject::connect(scanReplayGain, &QAction::triggered, self, [this]() {
+            if(self->hasTracks()) {
+                emit self->requestReplayGainScan(contextSelection.at(activeContext).tracks);
+            }
+        });
+        tracksMenu->addAction(actionManager->registerAction(scanReplayGain, "TrackSelection.ScanReplayGain"));
+
+        QObject::connect(convertTracks, &QAction::triggered, self, [this]() {
+            if(self->hasTracks()) {
+                emit self->requestConversion(contextSelection.at(activeContext).tracks);
+            }
+        });
+        tracksMenu->addAction(actionManager->registerAction(convertTracks, "TrackSelection.Convert"));
+
         tracksMenu->addSeparator(Actions::Groups::Three);
 
         QObject::connect(openProperties, &QAction::triggered, self, [this]() {
@@ -332,6 +350,8 @@ struct TrackSelectionController::Private
         sendCurrent->setEnabled(haveTracks);
         sendNew->setEnabled(haveTracks);
         openFolder->setEnabled(haveTracks && allTracksInSameFolder());
+        scanReplayGain->setEnabled(haveTracks);
+        convertTracks->setEnabled(haveTracks);
         openProperties->setEnabled(haveTracks);
         addToQueue->setEnabled(haveTracks);
     }
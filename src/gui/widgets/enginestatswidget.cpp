@@ -0,0 +1,172 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "enginestatswidget.h"
+
+#include <core/coresettings.h>
+#include <core/engine/enginecontroller.h>
+#include <core/engine/enginestats.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QStackedWidget>
+#include <QVBoxLayout>
+
+#include <chrono>
+
+namespace {
+QString formatUs(std::chrono::microseconds time)
+{
+    return QStringLiteral("%1 µs").arg(time.count());
+}
+
+QString formatMs(std::chrono::nanoseconds time)
+{
+    return QStringLiteral("%1 ms").arg(std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
+}
+
+QString histogramText(const Fooyin::EngineStats& stats)
+{
+    QStringList buckets;
+
+    for(size_t i{0}; i < Fooyin::EngineStats::DecodeTimeBuckets; ++i) {
+        const uint64_t count = stats.decodeTimeHistogram.at(i);
+        if(count == 0) {
+            continue;
+        }
+        const bool last    = i == Fooyin::EngineStats::DecodeTimeBuckets - 1;
+        const auto limit   = uint64_t{1} << (last ? i - 1 : i);
+        const QString name = last ? QStringLiteral("≥%1 µs").arg(limit) : QStringLiteral("<%1 µs").arg(limit);
+        buckets.append(QStringLiteral("%1: %2").arg(name).arg(count));
+    }
+
+    return buckets.join(QStringLiteral("\n"));
+}
+} // namespace
+
+namespace Fooyin {
+EngineStatsWidget::EngineStatsWidget(EngineController* engine, SettingsManager* settings, QWidget* parent)
+    : FyWidget{parent}
+    , m_outputPath{new QLabel(this)}
+    , m_stack{new QStackedWidget(this)}
+    , m_disabledLabel{new QLabel(tr("Enable collecting playback statistics in the engine settings"), this)}
+    , m_underruns{new QLabel(this)}
+    , m_bufferLevel{new QLabel(this)}
+    , m_outputDelay{new QLabel(this)}
+    , m_decodeTime{new QLabel(this)}
+    , m_decodeHistogram{new QLabel(this)}
+    , m_conversions{new QLabel(this)}
+    , m_readAhead{new QLabel(this)}
+    , m_bufferPool{new QLabel(this)}
+    , m_dsp{new QLabel(this)}
+{
+    setObjectName(EngineStatsWidget::name());
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_outputPath);
+    layout->addWidget(m_stack, 1);
+
+    m_disabledLabel->setWordWrap(true);
+    m_disabledLabel->setAlignment(Qt::AlignCenter);
+
+    auto* statsWidget = new QWidget(this);
+    auto* statsLayout = new QFormLayout(statsWidget);
+
+    statsLayout->addRow(tr("Underruns") + QStringLiteral(":"), m_underruns);
+    statsLayout->addRow(tr("Buffer") + QStringLiteral(":"), m_bufferLevel);
+    statsLayout->addRow(tr("Output delay") + QStringLiteral(":"), m_outputDelay);
+    statsLayout->addRow(tr("Decode time") + QStringLiteral(":"), m_decodeTime);
+    statsLayout->addRow(tr("Decode time histogram") + QStringLiteral(":"), m_decodeHistogram);
+    statsLayout->addRow(tr("Conversions") + QStringLiteral(":"), m_conversions);
+    statsLayout->addRow(tr("Read-ahead stalls") + QStringLiteral(":"), m_readAhead);
+    statsLayout->addRow(tr("Buffer pool") + QStringLiteral(":"), m_bufferPool);
+    statsLayout->addRow(tr("DSP") + QStringLiteral(":"), m_dsp);
+
+    m_stack->addWidget(m_disabledLabel);
+    m_stack->addWidget(statsWidget);
+
+    settings->subscribe<Settings::Core::EngineStatistics>(this, &EngineStatsWidget::updateEnabled);
+    QObject::connect(engine, &EngineController::engineStatsChanged, this, &EngineStatsWidget::updateStats);
+    QObject::connect(engine, &EngineController::bitPerfectChanged, this, &EngineStatsWidget::updateBitPerfect);
+
+    updateEnabled(settings->value<Settings::Core::EngineStatistics>());
+    updateStats(engine->engineStats());
+    updateBitPerfect(engine->isBitPerfect());
+}
+
+QString EngineStatsWidget::name() const
+{
+    return tr("Engine Statistics");
+}
+
+QString EngineStatsWidget::layoutName() const
+{
+    return QStringLiteral("EngineStatistics");
+}
+
+void EngineStatsWidget::updateEnabled(bool enabled)
+{
+    m_stack->setCurrentIndex(enabled ? 1 : 0);
+}
+
+void EngineStatsWidget::updateBitPerfect(bool bitPerfect)
+{
+    // Always shown, as it doesn't depend on statistics being collected
+    m_outputPath->setText(tr("Output path") + QStringLiteral(": ")
+                          + (bitPerfect ? tr("Bit-perfect") : tr("Converted or not playing")));
+}
+
+void EngineStatsWidget::updateStats(const EngineStats& stats)
+{
+    m_underruns->setText(tr("%1 (%2 frames)").arg(stats.underruns).arg(stats.underrunFrames));
+
+    const int percent = stats.bufferCapacity > 0 ? stats.bufferedFrames * 100 / stats.bufferCapacity : 0;
+    m_bufferLevel->setText(tr("%1 / %2 frames (%3%), lowest %4")
+                               .arg(stats.bufferedFrames)
+                               .arg(stats.bufferCapacity)
+                               .arg(percent)
+                               .arg(stats.minBufferedFrames));
+    m_outputDelay->setText(QStringLiteral("%1 ms").arg(stats.outputDelay * 1000, 0, 'f', 1));
+
+    const auto average = stats.decodedBuffers > 0
+                           ? std::chrono::microseconds{stats.decodeTime.count() / stats.decodedBuffers}
+                           : std::chrono::microseconds{0};
+    m_decodeTime->setText(tr("%1 buffers, average %2, longest %3")
+                              .arg(stats.decodedBuffers)
+                              .arg(formatUs(average), formatUs(stats.maxDecodeTime)));
+    m_decodeHistogram->setText(histogramText(stats));
+
+    m_conversions->setText(QString::number(stats.conversions));
+    m_readAhead->setText(tr("%1 (%2)").arg(stats.readAheadStalls).arg(formatMs(stats.readAheadStallTime)));
+    m_bufferPool->setText(tr("%1 hits, %2 misses, %3 KiB cached")
+                              .arg(stats.bufferPool.hits)
+                              .arg(stats.bufferPool.misses)
+                              .arg(stats.bufferPool.cachedBytes / 1024));
+
+    QStringList stages;
+    for(const auto& stage : stats.dspStages) {
+        stages.append(QStringLiteral("%1: %2").arg(stage.name, formatMs(stage.processTime)));
+    }
+    m_dsp->setText(stages.isEmpty() ? tr("None") : stages.join(QStringLiteral("\n")));
+}
+} // namespace Fooyin
+
+#include "moc_enginestatswidget.cpp"
@@ -0,0 +1,61 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "gui/fywidget.h"
+
+class QLabel;
+class QStackedWidget;
+
+namespace Fooyin {
+class EngineController;
+class SettingsManager;
+struct EngineStats;
+
+class EngineStatsWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    EngineStatsWidget(EngineController* engine, SettingsManager* settings, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+private:
+    void updateEnabled(bool enabled);
+    void updateStats(const EngineStats& stats);
+    void updateBitPerfect(bool bitPerfect);
+
+    QLabel* m_outputPath;
+    QStackedWidget* m_stack;
+    QLabel* m_disabledLabel;
+
+    QLabel* m_underruns;
+    QLabel* m_bufferLevel;
+    QLabel* m_outputDelay;
+    QLabel* m_decodeTime;
+    QLabel* m_decodeHistogram;
+    QLabel* m_conversions;
+    QLabel* m_readAhead;
+    QLabel* m_bufferPool;
+    QLabel* m_dsp;
+};
+} // namespace Fooyin
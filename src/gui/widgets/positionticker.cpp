@@ -0,0 +1,111 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gui/widgets/positionticker.h>
+
+#include <core/player/playercontroller.h>
+
+#include <QEvent>
+#include <QScreen>
+#include <QWidget>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Interval used while the widget can't be seen
+constexpr auto HiddenInterval = 1000;
+
+namespace Fooyin {
+PositionTicker::PositionTicker(PlayerController* playerController, QWidget* widget)
+    : QObject{widget}
+    , m_playerController{playerController}
+    , m_widget{widget}
+    , m_resolution{0}
+    , m_exposed{widget->isVisible()}
+{
+    QObject::connect(&m_timer, &QTimer::timeout, this, &PositionTicker::sendPosition);
+
+    // Both jump the position, so restart the timer from there
+    const auto positionJumped = [this]() {
+        sendPosition();
+        updateInterval();
+    };
+    QObject::connect(m_playerController, &PlayerController::positionChanged, this, positionJumped);
+    QObject::connect(m_playerController, &PlayerController::positionMoved, this, positionJumped);
+    QObject::connect(m_playerController, &PlayerController::playStateChanged, this, positionJumped);
+
+    m_widget->installEventFilter(this);
+
+    updateInterval();
+}
+
+void PositionTicker::setResolution(uint64_t ms)
+{
+    if(std::exchange(m_resolution, ms) != ms) {
+        updateInterval();
+    }
+}
+
+bool PositionTicker::eventFilter(QObject* watched, QEvent* event)
+{
+    if(watched == m_widget) {
+        // Spontaneous show and hide events are also sent when the window is restored or minimised
+        if(event->type() == QEvent::Show) {
+            m_exposed = true;
+            sendPosition();
+            updateInterval();
+        }
+        else if(event->type() == QEvent::Hide) {
+            m_exposed = false;
+            updateInterval();
+        }
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+void PositionTicker::sendPosition()
+{
+    emit positionChanged(m_playerController->currentPosition());
+}
+
+void PositionTicker::updateInterval()
+{
+    if(m_playerController->playState() != PlayState::Playing) {
+        m_timer.stop();
+        return;
+    }
+
+    int interval{HiddenInterval};
+
+    if(m_exposed) {
+        const QScreen* screen  = m_widget->screen();
+        const double refresh   = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+        const auto frameLength = static_cast<int>(std::ceil(1000.0 / refresh));
+        const auto resolution  = static_cast<int>(std::min<uint64_t>(m_resolution, HiddenInterval));
+        interval               = std::max(frameLength, resolution);
+    }
+
+    m_timer.setTimerType(m_exposed ? Qt::PreciseTimer : Qt::CoarseTimer);
+    m_timer.start(interval);
+}
+} // namespace Fooyin
+
+#include "gui/widgets/moc_positionticker.cpp"
@@ -0,0 +1,249 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrogramgenerator.h"
+
+#include <core/engine/audioconverter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+constexpr double MinFrequency = 20.0;
+// Level shown as silence
+constexpr double MinDb = -90.0;
+// Frames read from the decoder at a time
+constexpr int ReadFrames = 4096;
+// Number of columns to generate between each update
+constexpr int UpdateInterval = 64;
+
+namespace Fooyin {
+namespace Spectrogram {
+std::vector<Band> logBands(int rows, int binCount, int sampleRate)
+{
+    std::vector<Band> bands(static_cast<size_t>(std::max(rows, 0)));
+    if(binCount < 2 || sampleRate <= 0) {
+        return bands;
+    }
+
+    const double nyquist  = sampleRate / 2.0;
+    const double binWidth = nyquist / (binCount - 1);
+    const double ratio    = std::pow(std::max(nyquist / MinFrequency, 1.0), 1.0 / rows);
+
+    double low = MinFrequency;
+    for(Band& band : bands) {
+        const double high = low * ratio;
+        band.first        = std::clamp(static_cast<int>(std::ceil(low / binWidth)), 1, binCount - 1);
+        band.last         = std::clamp(static_cast<int>(std::floor(high / binWidth)), band.first, binCount - 1);
+        low               = high;
+    }
+
+    return bands;
+}
+
+uint8_t bandLevel(const float* magnitudes, const Band& band)
+{
+    const float magnitude = *std::max_element(magnitudes + band.first, magnitudes + band.last + 1);
+    if(magnitude <= 0.0F) {
+        return 0;
+    }
+
+    const double db = 20.0 * std::log10(magnitude);
+    return static_cast<uint8_t>(std::lround(std::clamp((db - MinDb) / -MinDb, 0.0, 1.0) * 255.0));
+}
+} // namespace Spectrogram
+
+SpectrogramGenerator::SpectrogramGenerator(DecoderCreator createDecoder, QObject* parent)
+    : Worker{parent}
+    , m_createDecoder{std::move(createDecoder)}
+    , m_fft{FftSize}
+    , m_window(FftSize)
+    , m_history(FftSize)
+    , m_windowed(FftSize)
+    , m_magnitudes(static_cast<size_t>(m_fft.binCount()))
+    , m_historyPos{0}
+    , m_hop{FftSize}
+    , m_framesPerColumn{1}
+    , m_hopFrames{0}
+    , m_columnFrames{0}
+    , m_column(SpectrogramData::Rows)
+{
+    m_requiredFormat.setSampleFormat(SampleFormat::Float);
+
+    // Hann window, scaled so a full scale sine wave peaks at 1.0
+    double sum{0.0};
+    for(int i{0}; i < FftSize; ++i) {
+        m_window.at(i) = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * std::numbers::pi * i / (FftSize - 1))));
+        sum += m_window.at(i);
+    }
+    for(float& value : m_window) {
+        value = static_cast<float>(value * 2.0 / sum);
+    }
+}
+
+void SpectrogramGenerator::generate(const Track& track)
+{
+    if(closing()) {
+        return;
+    }
+
+    if(!setup(track)) {
+        return;
+    }
+
+    setState(Running);
+
+    const auto bufferSize = static_cast<size_t>(ReadFrames * m_decoder->format().bytesPerFrame());
+
+    m_decoder->start();
+
+    while(true) {
+        if(!mayRun()) {
+            m_decoder.reset();
+            return;
+        }
+
+        auto buffer = m_decoder->readBuffer(bufferSize);
+        if(!buffer.isValid()) {
+            break;
+        }
+
+        buffer = Audio::convert(buffer, m_requiredFormat);
+        processBuffer(buffer);
+    }
+
+    m_decoder.reset();
+
+    if(m_columnFrames > 0) {
+        finishColumn();
+    }
+    m_data.complete = true;
+
+    if(!closing()) {
+        setState(Idle);
+    }
+
+    emit generated(m_data);
+}
+
+bool SpectrogramGenerator::setup(const Track& track)
+{
+    m_decoder.reset();
+    m_data = {};
+
+    if(!track.isValid() || track.duration() == 0) {
+        return false;
+    }
+
+    // The best decoder depends on the file, so each track gets its own
+    m_decoder = m_createDecoder(track.filepath());
+    if(!m_decoder->init(track.filepath())) {
+        m_decoder.reset();
+        return false;
+    }
+
+    const AudioFormat format = m_decoder->format();
+    m_requiredFormat.setChannelCount(format.channelCount());
+    m_requiredFormat.setSampleRate(format.sampleRate());
+
+    m_data.filepath   = track.filepath();
+    m_data.sampleRate = format.sampleRate();
+    m_data.levels.assign(static_cast<size_t>(SpectrogramData::Columns * SpectrogramData::Rows), 0);
+
+    const uint64_t totalFrames = track.duration() * static_cast<uint64_t>(format.sampleRate()) / 1000;
+
+    m_framesPerColumn = std::max<uint64_t>((totalFrames + SpectrogramData::Columns - 1) / SpectrogramData::Columns, 1);
+    m_hop             = std::min<uint64_t>(FftSize, m_framesPerColumn);
+    m_hopFrames       = 0;
+    m_columnFrames    = 0;
+    m_historyPos      = 0;
+    m_bands           = Spectrogram::logBands(SpectrogramData::Rows, m_fft.binCount(), format.sampleRate());
+
+    std::ranges::fill(m_history, 0.0F);
+    std::ranges::fill(m_column, 0);
+
+    return true;
+}
+
+void SpectrogramGenerator::processBuffer(const AudioBuffer& buffer)
+{
+    const int channels  = buffer.format().channelCount();
+    const int frames    = buffer.frameCount();
+    const auto* samples = reinterpret_cast<const float*>(buffer.data());
+
+    if(channels <= 0) {
+        return;
+    }
+
+    for(int frame{0}; frame < frames; ++frame) {
+        const float* frameSamples = samples + static_cast<ptrdiff_t>(frame * channels);
+
+        float sum{0.0F};
+        for(int ch{0}; ch < channels; ++ch) {
+            sum += frameSamples[ch];
+        }
+
+        m_history[m_historyPos] = sum / static_cast<float>(channels);
+        m_historyPos            = (m_historyPos + 1) % FftSize;
+
+        if(++m_hopFrames >= m_hop) {
+            m_hopFrames = 0;
+            analyseWindow();
+        }
+        if(++m_columnFrames >= m_framesPerColumn) {
+            finishColumn();
+        }
+    }
+}
+
+void SpectrogramGenerator::analyseWindow()
+{
+    // The oldest sample is at the write position
+    for(int i{0}; i < FftSize; ++i) {
+        m_windowed[i] = m_history[(m_historyPos + i) % FftSize] * m_window[i];
+    }
+
+    m_fft.magnitudes(m_windowed.data(), m_magnitudes.data());
+
+    for(int row{0}; row < SpectrogramData::Rows; ++row) {
+        m_column[row] = std::max(m_column[row], Spectrogram::bandLevel(m_magnitudes.data(), m_bands[row]));
+    }
+}
+
+void SpectrogramGenerator::finishColumn()
+{
+    m_columnFrames = 0;
+
+    // The decoded length can run slightly over the track's duration
+    if(m_data.completeColumns >= SpectrogramData::Columns) {
+        return;
+    }
+
+    const auto offset = static_cast<ptrdiff_t>(m_data.completeColumns * SpectrogramData::Rows);
+    std::ranges::copy(m_column, m_data.levels.begin() + offset);
+    std::ranges::fill(m_column, 0);
+
+    if(++m_data.completeColumns % UpdateInterval == 0) {
+        emit generated(m_data);
+    }
+}
+} // namespace Fooyin
+
+#include "moc_spectrogramgenerator.cpp"
@@ -0,0 +1,121 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiodecoder.h>
+#include <core/engine/fft.h>
+#include <core/track.h>
+#include <utils/worker.h>
+
+#include <functional>
+#include <vector>
+
+namespace Fooyin {
+namespace Spectrogram {
+/** The range of FFT bins shown by one row of a spectrogram. */
+struct Band
+{
+    int first{0};
+    int last{0};
+};
+
+/*!
+ * Splits @p binCount bins of audio at @p sampleRate into @p rows bands spaced logarithmically
+ * from 20 Hz up to the Nyquist frequency, lowest first.
+ */
+std::vector<Band> logBands(int rows, int binCount, int sampleRate);
+/** Returns the loudest of the @p magnitudes in @p band, scaled from silence at 0 to full scale at 255. */
+uint8_t bandLevel(const float* magnitudes, const Band& band);
+} // namespace Spectrogram
+
+/*!
+ * A spectrogram of a whole track, at a fixed resolution so its size doesn't depend on the length of the track.
+ * Levels are stored a column at a time, lowest frequency first.
+ */
+struct SpectrogramData
+{
+    static constexpr int Columns = 2048;
+    static constexpr int Rows    = 256;
+
+    QString filepath;
+    int sampleRate{0};
+    // Number of columns generated so far
+    int completeColumns{0};
+    bool complete{false};
+    std::vector<uint8_t> levels;
+
+    [[nodiscard]] const uint8_t* column(int index) const
+    {
+        return levels.data() + static_cast<ptrdiff_t>(index * Rows);
+    }
+};
+
+/*!
+ * Decodes a whole track and generates its spectrogram, reporting columns as they are finished.
+ * Tracks are read in windows of one FFT, so however long the track, only one window and the
+ * fixed size spectrogram are held at a time.
+ */
+class SpectrogramGenerator : public Worker
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FftSize = 4096;
+
+    using DecoderCreator = std::function<std::unique_ptr<AudioDecoder>(const QString& source)>;
+
+    /** @p createDecoder is called from the generator's thread for each track, and the decoder freed once done. */
+    explicit SpectrogramGenerator(DecoderCreator createDecoder, QObject* parent = nullptr);
+
+signals:
+    void generated(const Fooyin::SpectrogramData& data);
+
+public slots:
+    void generate(const Fooyin::Track& track);
+
+private:
+    bool setup(const Track& track);
+    void processBuffer(const AudioBuffer& buffer);
+    void analyseWindow();
+    void finishColumn();
+
+    DecoderCreator m_createDecoder;
+    std::unique_ptr<AudioDecoder> m_decoder;
+    AudioFormat m_requiredFormat;
+    SpectrogramData m_data;
+    Audio::Fft m_fft;
+
+    std::vector<Spectrogram::Band> m_bands;
+    std::vector<float> m_window;
+    std::vector<float> m_history;
+    std::vector<float> m_windowed;
+    std::vector<float> m_magnitudes;
+    // Write position in m_history, which holds the last FftSize samples mixed down to mono
+    int m_historyPos;
+    // Frames to advance between each FFT, and between each column
+    uint64_t m_hop;
+    uint64_t m_framesPerColumn;
+    // Frames read since the last FFT, and since the start of the current column
+    uint64_t m_hopFrames;
+    uint64_t m_columnFrames;
+    // Loudest level of each row seen so far in the current column
+    std::vector<uint8_t> m_column;
+};
+} // namespace Fooyin
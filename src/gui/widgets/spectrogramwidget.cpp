@@ -0,0 +1,391 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrogramwidget.h"
+
+#include <core/engine/audioanalyser.h>
+#include <core/engine/enginecontroller.h>
+#include <core/player/playercontroller.h>
+#include <gui/widgets/positionticker.h>
+
+#include <QAction>
+#include <QContextMenuEvent>
+#include <QJsonObject>
+#include <QMenu>
+#include <QPainter>
+#include <QScreen>
+
+#include <algorithm>
+#include <utility>
+
+constexpr int TileWidth = 256;
+
+namespace {
+// Colours from silence to full scale
+std::array<QRgb, 256> heatMap()
+{
+    static constexpr std::array<std::array<double, 3>, 5> Stops{
+        {{0, 0, 0}, {20, 10, 120}, {190, 30, 100}, {250, 160, 20}, {255, 255, 220}}};
+    static constexpr int LastStop = static_cast<int>(Stops.size()) - 1;
+
+    std::array<QRgb, 256> colours{};
+    for(int i{0}; i < 256; ++i) {
+        const double pos = i / 255.0 * LastStop;
+        const int stop   = std::min(static_cast<int>(pos), LastStop - 1);
+        const double t   = pos - stop;
+
+        const auto& [r1, g1, b1] = Stops.at(stop);
+        const auto& [r2, g2, b2] = Stops.at(stop + 1);
+
+        colours.at(i) = qRgb(static_cast<int>(r1 + ((r2 - r1) * t)), static_cast<int>(g1 + ((g2 - g1) * t)),
+                             static_cast<int>(b1 + ((b2 - b1) * t)));
+    }
+    return colours;
+}
+} // namespace
+
+namespace Fooyin {
+SpectrogramWidget::SpectrogramWidget(EngineController* engine, PlayerController* playerController, QWidget* parent)
+    : FyWidget{parent}
+    , m_analyser{engine->analyser()}
+    , m_playerController{playerController}
+    , m_ticker{new PositionTicker(playerController, this)}
+    , m_generator{[engine](const QString& source) { return engine->createDecoder(source, ScanReadAhead); }}
+    , m_wholeTrack{false}
+    , m_colours{heatMap()}
+    , m_written{0}
+    , m_liveSampleRate{0}
+    , m_track{playerController->currentTrack()}
+    , m_renderedColumns{0}
+    , m_position{0}
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    m_generator.moveToThread(&m_generatorThread);
+
+    QObject::connect(m_analyser, &AudioAnalyser::updated, this, &SpectrogramWidget::addColumns);
+    QObject::connect(&m_generator, &SpectrogramGenerator::generated, this, &SpectrogramWidget::updateTrackImage);
+    QObject::connect(m_playerController, &PlayerController::currentTrackChanged, this,
+                     &SpectrogramWidget::changeTrack);
+    QObject::connect(m_ticker, &PositionTicker::positionChanged, this, [this](uint64_t ms) {
+        m_position = ms;
+        if(m_wholeTrack) {
+            update();
+        }
+    });
+
+    m_generatorThread.start();
+}
+
+SpectrogramWidget::~SpectrogramWidget()
+{
+    m_generator.closeThread();
+    m_generatorThread.quit();
+    m_generatorThread.wait();
+}
+
+QString SpectrogramWidget::name() const
+{
+    return tr("Spectrogram");
+}
+
+QString SpectrogramWidget::layoutName() const
+{
+    return QStringLiteral("Spectrogram");
+}
+
+void SpectrogramWidget::saveLayoutData(QJsonObject& layout)
+{
+    layout[QStringLiteral("WholeTrack")] = m_wholeTrack;
+}
+
+void SpectrogramWidget::loadLayoutData(const QJsonObject& layout)
+{
+    if(layout.contains(QStringLiteral("WholeTrack"))) {
+        setWholeTrack(layout.value(QStringLiteral("WholeTrack")).toBool());
+    }
+}
+
+QSize SpectrogramWidget::minimumSizeHint() const
+{
+    return {50, 20};
+}
+
+void SpectrogramWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    if(!m_wholeTrack) {
+        if(const auto* widgetScreen = screen()) {
+            m_analyser->setRefreshRate(widgetScreen->refreshRate());
+        }
+        m_analyser->subscribe(this);
+    }
+}
+
+void SpectrogramWidget::hideEvent(QHideEvent* event)
+{
+    m_analyser->unsubscribe(this);
+
+    FyWidget::hideEvent(event);
+}
+
+void SpectrogramWidget::resizeEvent(QResizeEvent* event)
+{
+    FyWidget::resizeEvent(event);
+
+    updateResolution();
+
+    if(!m_wholeTrack) {
+        const QSize area     = contentsRect().size();
+        const auto tileCount = static_cast<int>(m_tiles.size());
+        // Only start again if the tiles no longer fit, as drawn columns can't be rescaled
+        if(m_tiles.empty() || m_tiles.front().height() != area.height()
+           || (tileCount - 1) * TileWidth < area.width()) {
+            resetTiles();
+        }
+    }
+}
+
+void SpectrogramWidget::contextMenuEvent(QContextMenuEvent* event)
+{
+    auto* menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+
+    auto* wholeTrack = new QAction(tr("Whole Track"), menu);
+    wholeTrack->setCheckable(true);
+    wholeTrack->setChecked(m_wholeTrack);
+    QObject::connect(wholeTrack, &QAction::triggered, this, &SpectrogramWidget::setWholeTrack);
+
+    menu->addAction(wholeTrack);
+
+    menu->popup(event->globalPos());
+}
+
+void SpectrogramWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter{this};
+
+    const QRect area = contentsRect();
+    painter.fillRect(area, QColor{m_colours.front()});
+    painter.setClipRect(area);
+
+    if(m_wholeTrack) {
+        paintTrack(painter, area);
+    }
+    else {
+        paintTiles(painter, area);
+    }
+}
+
+void SpectrogramWidget::setWholeTrack(bool enabled)
+{
+    if(std::exchange(m_wholeTrack, enabled) == enabled) {
+        return;
+    }
+
+    if(m_wholeTrack) {
+        m_analyser->unsubscribe(this);
+        // Nothing of the live view needs to be kept
+        m_tiles.clear();
+        m_written = 0;
+        startGenerating();
+    }
+    else {
+        m_generator.stopThread();
+        m_trackImage = {};
+        resetTiles();
+        if(isVisible()) {
+            m_analyser->subscribe(this);
+        }
+    }
+
+    update();
+}
+
+void SpectrogramWidget::changeTrack(const Track& track)
+{
+    m_track    = track;
+    m_position = 0;
+
+    updateResolution();
+
+    if(m_wholeTrack) {
+        startGenerating();
+    }
+}
+
+void SpectrogramWidget::updateResolution()
+{
+    if(m_track.duration() > 0) {
+        m_ticker->setResolution(m_track.duration() / static_cast<uint64_t>(std::max(contentsRect().width(), 1)));
+    }
+}
+
+void SpectrogramWidget::resetTiles()
+{
+    const QSize area = contentsRect().size();
+
+    m_tiles.clear();
+    m_written = 0;
+    m_liveBands.clear();
+
+    if(area.isEmpty()) {
+        return;
+    }
+
+    // Enough to cover the width with a partially drawn tile at either end
+    const int tileCount = (area.width() / TileWidth) + 2;
+    for(int i{0}; i < tileCount; ++i) {
+        m_tiles.emplace_back(TileWidth, area.height(), QImage::Format_RGB32);
+        m_tiles.back().fill(m_colours.front());
+    }
+}
+
+void SpectrogramWidget::addColumns()
+{
+    if(m_wholeTrack || m_tiles.empty()) {
+        return;
+    }
+
+    const auto& results = m_analyser->released();
+    for(const AnalysisResult& result : results) {
+        drawColumn(result);
+    }
+
+    if(!results.empty()) {
+        update();
+    }
+}
+
+void SpectrogramWidget::drawColumn(const AnalysisResult& result)
+{
+    if(!result.isValid() || result.spectrum.size() < 2) {
+        return;
+    }
+
+    const int height = m_tiles.front().height();
+
+    if(result.sampleRate != m_liveSampleRate || std::cmp_not_equal(m_liveBands.size(), height)) {
+        m_liveSampleRate = result.sampleRate;
+        m_liveBands = Spectrogram::logBands(height, static_cast<int>(result.spectrum.size()), result.sampleRate);
+    }
+
+    const uint64_t capacity = m_tiles.size() * TileWidth;
+    const auto column       = static_cast<int>(m_written % capacity);
+    const int x             = column % TileWidth;
+    QImage& tile            = m_tiles.at(column / TileWidth);
+
+    if(x == 0) {
+        // Clear the oldest columns, which have long since scrolled out of view
+        tile.fill(m_colours.front());
+    }
+
+    for(int row{0}; row < height; ++row) {
+        const uint8_t level = Spectrogram::bandLevel(result.spectrum.data(), m_liveBands[row]);
+        auto* line          = reinterpret_cast<QRgb*>(tile.scanLine(height - 1 - row));
+        line[x]             = m_colours[level];
+    }
+
+    ++m_written;
+}
+
+void SpectrogramWidget::paintTiles(QPainter& painter, const QRect& area) const
+{
+    if(m_tiles.empty() || m_written == 0) {
+        return;
+    }
+
+    // The newest column is drawn at the right edge, with each older tile to its left
+    const uint64_t tileCount = m_tiles.size();
+    const int right          = area.right() + 1;
+
+    for(uint64_t tile = (m_written - 1) / TileWidth;; --tile) {
+        const auto x = static_cast<int>(right - static_cast<int64_t>(m_written - (tile * TileWidth)));
+        if(x + TileWidth <= area.left()) {
+            break;
+        }
+
+        painter.drawImage(x, area.top(), m_tiles.at(tile % tileCount));
+
+        if(tile == 0) {
+            break;
+        }
+    }
+}
+
+void SpectrogramWidget::startGenerating()
+{
+    m_generator.stopThread();
+    m_trackImage      = {};
+    m_renderedColumns = 0;
+
+    if(!m_track.isValid()) {
+        update();
+        return;
+    }
+
+    QMetaObject::invokeMethod(&m_generator, [this, track = m_track]() { m_generator.generate(track); });
+    update();
+}
+
+void SpectrogramWidget::updateTrackImage(const SpectrogramData& data)
+{
+    // Ignore anything still queued from a previous track or mode
+    if(!m_wholeTrack || data.filepath != m_track.filepath()) {
+        return;
+    }
+
+    if(m_trackImage.isNull()) {
+        m_trackImage = QImage{SpectrogramData::Columns, SpectrogramData::Rows, QImage::Format_RGB32};
+        m_trackImage.fill(m_colours.front());
+    }
+
+    // Only the columns generated since the last update need drawing
+    for(int column{m_renderedColumns}; column < data.completeColumns; ++column) {
+        const uint8_t* levels = data.column(column);
+        for(int row{0}; row < SpectrogramData::Rows; ++row) {
+            auto* line   = reinterpret_cast<QRgb*>(m_trackImage.scanLine(SpectrogramData::Rows - 1 - row));
+            line[column] = m_colours[levels[row]];
+        }
+    }
+    m_renderedColumns = std::max(m_renderedColumns, data.completeColumns);
+
+    update();
+}
+
+void SpectrogramWidget::paintTrack(QPainter& painter, const QRect& area) const
+{
+    if(!m_trackImage.isNull()) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(area, m_trackImage);
+    }
+
+    if(m_track.duration() > 0) {
+        const double duration = static_cast<double>(m_track.duration());
+        const double progress = std::min(static_cast<double>(m_position) / duration, 1.0);
+        const int x           = area.left() + static_cast<int>(progress * area.width());
+
+        painter.setPen(palette().highlight().color());
+        painter.drawLine(x, area.top(), x, area.bottom());
+    }
+}
+} // namespace Fooyin
+
+#include "moc_spectrogramwidget.cpp"
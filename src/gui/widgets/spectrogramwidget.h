@@ -0,0 +1,106 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "spectrogramgenerator.h"
+
+#include <core/track.h>
+#include <gui/fywidget.h>
+
+#include <QImage>
+#include <QThread>
+
+#include <array>
+#include <vector>
+
+namespace Fooyin {
+class AudioAnalyser;
+struct AnalysisResult;
+class EngineController;
+class PlayerController;
+class PositionTicker;
+
+/*!
+ * Shows a spectrogram, either scrolling live with the audio being heard, or of the whole of the current track.
+ * Live columns are drawn once into a ring of fixed width tiles, so each update only draws the new columns, and
+ * the ring is only as wide as the widget. The whole track view is generated on a separate thread at a fixed
+ * resolution, so memory use doesn't depend on the length of the track.
+ */
+class SpectrogramWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    SpectrogramWidget(EngineController* engine, PlayerController* playerController, QWidget* parent = nullptr);
+    ~SpectrogramWidget() override;
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+    void saveLayoutData(QJsonObject& layout) override;
+    void loadLayoutData(const QJsonObject& layout) override;
+
+    [[nodiscard]] QSize minimumSizeHint() const override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void setWholeTrack(bool enabled);
+    void changeTrack(const Track& track);
+    void updateResolution();
+
+    void resetTiles();
+    void addColumns();
+    void drawColumn(const AnalysisResult& result);
+    void paintTiles(QPainter& painter, const QRect& area) const;
+
+    void startGenerating();
+    void updateTrackImage(const SpectrogramData& data);
+    void paintTrack(QPainter& painter, const QRect& area) const;
+
+    AudioAnalyser* m_analyser;
+    PlayerController* m_playerController;
+    PositionTicker* m_ticker;
+
+    QThread m_generatorThread;
+    SpectrogramGenerator m_generator;
+
+    bool m_wholeTrack;
+    std::array<QRgb, 256> m_colours;
+
+    // Live view
+    std::vector<QImage> m_tiles;
+    // Total number of columns drawn into the tiles
+    uint64_t m_written;
+    int m_liveSampleRate;
+    std::vector<Spectrogram::Band> m_liveBands;
+
+    // Whole track view
+    Track m_track;
+    QImage m_trackImage;
+    int m_renderedColumns;
+    uint64_t m_position;
+};
+} // namespace Fooyin
@@ -0,0 +1,152 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrumwidget.h"
+
+#include <core/engine/audioanalyser.h>
+
+#include <QPainter>
+#include <QScreen>
+
+#include <algorithm>
+#include <cmath>
+
+constexpr int BarCount        = 32;
+constexpr int BarGap          = 1;
+constexpr double MinFrequency = 20.0;
+constexpr double MaxFrequency = 20000.0;
+// Level shown at the bottom of the widget
+constexpr double MinDb = -70.0;
+// How quickly bars fall back once the audio gets quieter, in dB per second
+constexpr double FalloffRate = 60.0;
+
+namespace {
+double levelFromMagnitude(float magnitude)
+{
+    if(magnitude <= 0.0F) {
+        return 0.0;
+    }
+    const double db = 20.0 * std::log10(magnitude);
+    return std::clamp((db - MinDb) / -MinDb, 0.0, 1.0);
+}
+
+// Loudest bin between @p low and @p high Hz, falling back to the nearest bin for bands narrower than one
+float bandMagnitude(const Fooyin::AnalysisResult& result, double low, double high)
+{
+    const auto binCount   = static_cast<int>(result.spectrum.size());
+    const double binWidth = result.binFrequency(1);
+
+    const int first = std::clamp(static_cast<int>(std::ceil(low / binWidth)), 1, binCount - 1);
+    const int last  = std::clamp(static_cast<int>(std::floor(high / binWidth)), first, binCount - 1);
+
+    return *std::max_element(result.spectrum.cbegin() + first, result.spectrum.cbegin() + last + 1);
+}
+} // namespace
+
+namespace Fooyin {
+SpectrumWidget::SpectrumWidget(AudioAnalyser* analyser, QWidget* parent)
+    : FyWidget{parent}
+    , m_analyser{analyser}
+    , m_levels(BarCount, 0.0)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    QObject::connect(m_analyser, &AudioAnalyser::updated, this, &SpectrumWidget::updateBars);
+}
+
+QString SpectrumWidget::name() const
+{
+    return tr("Spectrum");
+}
+
+QString SpectrumWidget::layoutName() const
+{
+    return QStringLiteral("Spectrum");
+}
+
+QSize SpectrumWidget::minimumSizeHint() const
+{
+    return {BarCount * 2, 20};
+}
+
+void SpectrumWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    if(const auto* widgetScreen = screen()) {
+        m_analyser->setRefreshRate(widgetScreen->refreshRate());
+    }
+    m_analyser->subscribe(this);
+    m_elapsed.start();
+}
+
+void SpectrumWidget::hideEvent(QHideEvent* event)
+{
+    m_analyser->unsubscribe(this);
+    std::ranges::fill(m_levels, 0.0);
+
+    FyWidget::hideEvent(event);
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter{this};
+
+    const QRect area = contentsRect();
+    painter.fillRect(area, palette().base());
+
+    const double barWidth = static_cast<double>(area.width()) / BarCount;
+    const QColor colour   = palette().highlight().color();
+
+    for(int bar{0}; bar < BarCount; ++bar) {
+        const double height = m_levels.at(bar) * area.height();
+        const QRectF rect{area.left() + (bar * barWidth), area.bottom() + 1 - height,
+                          std::max(barWidth - BarGap, 1.0), height};
+        painter.fillRect(rect, colour);
+    }
+}
+
+void SpectrumWidget::updateBars()
+{
+    const AnalysisResult& result = m_analyser->current();
+    const double elapsed         = static_cast<double>(m_elapsed.restart()) / 1000.0;
+
+    if(!result.isValid() || result.spectrum.size() < 2) {
+        std::ranges::fill(m_levels, 0.0);
+        update();
+        return;
+    }
+
+    const double maxFrequency = std::min(MaxFrequency, result.sampleRate / 2.0);
+    const double ratio        = std::pow(maxFrequency / MinFrequency, 1.0 / BarCount);
+    const double falloff      = FalloffRate / -MinDb * elapsed;
+
+    double low = MinFrequency;
+    for(double& level : m_levels) {
+        const double high   = low * ratio;
+        const double target = levelFromMagnitude(bandMagnitude(result, low, high));
+        level               = std::max(target, level - falloff);
+        low                 = high;
+    }
+
+    update();
+}
+} // namespace Fooyin
+
+#include "moc_spectrumwidget.cpp"
@@ -0,0 +1,60 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "gui/fywidget.h"
+
+#include <QElapsedTimer>
+
+#include <vector>
+
+namespace Fooyin {
+class AudioAnalyser;
+
+/*!
+ * Shows the spectrum of the audio being heard as bars spaced logarithmically across the audible range.
+ * Only repaints when the shared analysis moves on, and only subscribes to it while visible.
+ */
+class SpectrumWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumWidget(AudioAnalyser* analyser, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+    [[nodiscard]] QSize minimumSizeHint() const override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void updateBars();
+
+    AudioAnalyser* m_analyser;
+    // Height of each bar from 0 to 1
+    std::vector<double> m_levels;
+    QElapsedTimer m_elapsed;
+};
+} // namespace Fooyin
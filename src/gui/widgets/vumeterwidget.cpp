@@ -0,0 +1,158 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "vumeterwidget.h"
+
+#include <core/engine/audioanalyser.h>
+
+#include <QPainter>
+#include <QScreen>
+
+#include <algorithm>
+#include <cmath>
+
+constexpr int ChannelGap = 2;
+// Level shown at the left of the meter
+constexpr double MinDb = -60.0;
+// How quickly the meter falls back once the audio gets quieter, in dB per second
+constexpr double FalloffRate = 30.0;
+constexpr double PeakHoldTime = 1.5;
+
+namespace {
+double levelFromGain(float gain)
+{
+    if(gain <= 0.0F) {
+        return 0.0;
+    }
+    const double db = 20.0 * std::log10(gain);
+    return std::clamp((db - MinDb) / -MinDb, 0.0, 1.0);
+}
+} // namespace
+
+namespace Fooyin {
+VuMeterWidget::VuMeterWidget(AudioAnalyser* analyser, QWidget* parent)
+    : FyWidget{parent}
+    , m_analyser{analyser}
+    , m_channels(2)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+
+    QObject::connect(m_analyser, &AudioAnalyser::updated, this, &VuMeterWidget::updateLevels);
+}
+
+QString VuMeterWidget::name() const
+{
+    return tr("VU Meter");
+}
+
+QString VuMeterWidget::layoutName() const
+{
+    return QStringLiteral("VuMeter");
+}
+
+QSize VuMeterWidget::minimumSizeHint() const
+{
+    return {60, 12};
+}
+
+void VuMeterWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    if(const auto* widgetScreen = screen()) {
+        m_analyser->setRefreshRate(widgetScreen->refreshRate());
+    }
+    m_analyser->subscribe(this);
+    m_elapsed.start();
+}
+
+void VuMeterWidget::hideEvent(QHideEvent* event)
+{
+    m_analyser->unsubscribe(this);
+    std::ranges::fill(m_channels, Channel{});
+
+    FyWidget::hideEvent(event);
+}
+
+void VuMeterWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter{this};
+
+    const QRect area = contentsRect();
+    painter.fillRect(area, palette().base());
+
+    const auto count           = static_cast<int>(m_channels.size());
+    const double channelHeight = static_cast<double>(area.height() - (ChannelGap * (count - 1))) / count;
+    const QColor levelColour   = palette().highlight().color();
+    const QColor peakColour    = palette().text().color();
+
+    double y = area.top();
+    for(const Channel& channel : m_channels) {
+        painter.fillRect(QRectF{static_cast<double>(area.left()), y, channel.level * area.width(), channelHeight},
+                         levelColour);
+
+        if(channel.peak > 0.0) {
+            const double peakX = area.left() + (channel.peak * (area.width() - 2));
+            painter.fillRect(QRectF{peakX, y, 2.0, channelHeight}, peakColour);
+        }
+
+        y += channelHeight + ChannelGap;
+    }
+}
+
+void VuMeterWidget::updateLevels()
+{
+    const AnalysisResult& result = m_analyser->current();
+    const double elapsed         = static_cast<double>(m_elapsed.restart()) / 1000.0;
+
+    if(!result.isValid()) {
+        std::ranges::fill(m_channels, Channel{});
+        update();
+        return;
+    }
+
+    if(m_channels.size() != result.rms.size()) {
+        m_channels.assign(result.rms.size(), {});
+    }
+
+    const double falloff = FalloffRate / -MinDb * elapsed;
+
+    for(size_t ch{0}; ch < m_channels.size(); ++ch) {
+        Channel& channel = m_channels.at(ch);
+
+        channel.level = std::max(levelFromGain(result.rms.at(ch)), channel.level - falloff);
+
+        const double peak = levelFromGain(result.peak.at(ch));
+        if(peak >= channel.peak) {
+            channel.peak     = peak;
+            channel.peakHold = PeakHoldTime;
+        }
+        else if(channel.peakHold > 0.0) {
+            channel.peakHold -= elapsed;
+        }
+        else {
+            channel.peak = std::max(peak, channel.peak - falloff);
+        }
+    }
+
+    update();
+}
+} // namespace Fooyin
+
+#include "moc_vumeterwidget.cpp"
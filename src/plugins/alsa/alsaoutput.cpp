@@ -20,9 +20,29 @@
 #include "alsaoutput.h"
 
 #include <alsa/asoundlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include <QDebug>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <utility>
+
+// Used unless a latency has been requested
+constexpr snd_pcm_uframes_t DefaultBufferSize = 8192;
+constexpr snd_pcm_uframes_t DefaultPeriodSize = 1024;
+// Periods the buffer is split into when sized by latency
+constexpr unsigned int PeriodsPerBuffer = 4;
+// Rates probed for when negotiating a format in exclusive mode
+constexpr std::array StandardRates = {8000U,   11025U,  16000U,  22050U,  32000U,  44100U,  48000U, 88200U,
+                                      96000U,  176400U, 192000U, 352800U, 384000U, 705600U, 768000U};
+// Highest channel count probed for in exclusive mode
+constexpr unsigned int MaxProbedChannels = 32;
+
 namespace {
 bool checkError(int error, const QString& message)
 {
@@ -82,6 +102,53 @@ snd_pcm_format_t findAlsaFormat(Fooyin::SampleFormat format)
     }
 }
 
+// Formats to try in order, with the sample format itself first, then formats which hold it losslessly
+std::vector<Fooyin::SampleFormat> formatPreference(Fooyin::SampleFormat format)
+{
+    using Fooyin::SampleFormat;
+
+    switch(format) {
+        case(SampleFormat::U8):
+            return {SampleFormat::U8, SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+        case(SampleFormat::S16):
+            return {SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+        case(SampleFormat::S24):
+            return {SampleFormat::S24, SampleFormat::S32, SampleFormat::Float};
+        case(SampleFormat::S32):
+            return {SampleFormat::S32, SampleFormat::Float};
+        case(SampleFormat::Float):
+            return {SampleFormat::Float, SampleFormat::S32, SampleFormat::S16};
+        case(SampleFormat::Unknown):
+        default:
+            return {};
+    }
+}
+
+// Prefers the exact rate, then the nearest multiple of the same base rate (44.1kHz or 48kHz) above it
+unsigned int chooseRate(unsigned int rate, const std::vector<unsigned int>& rates)
+{
+    if(rates.empty() || std::ranges::find(rates, rate) != rates.cend()) {
+        return rate;
+    }
+
+    const auto sameFamily = [rate](unsigned int supported) {
+        return (rate % 11025 == 0) == (supported % 11025 == 0);
+    };
+
+    for(const unsigned int supported : rates) {
+        if(supported > rate && sameFamily(supported)) {
+            return supported;
+        }
+    }
+    for(const unsigned int supported : rates) {
+        if(supported > rate) {
+            return supported;
+        }
+    }
+
+    return rates.back();
+}
+
 struct DeviceHint
 {
     void** hints{nullptr};
@@ -126,6 +193,54 @@ struct PcmHandleDeleter
 };
 
 using PcmHandleUPtr = std::unique_ptr<snd_pcm_t, PcmHandleDeleter>;
+
+/*!
+ * Finds the hw device at the bottom of @p device.
+ * @returns an empty name if it doesn't lead to one, or @c std::nullopt if the device couldn't be opened to check.
+ */
+std::optional<QByteArray> findHardwareDevice(const QString& device)
+{
+    const qsizetype argsStart = device.indexOf(u':');
+
+    if(argsStart >= 0) {
+        if(device.startsWith(u"hw:") || device.startsWith(u"plughw:")) {
+            return QStringLiteral("hw%1").arg(device.sliced(argsStart)).toLocal8Bit();
+        }
+
+        // Per-card devices, such as front:CARD=PCH,DEV=0, name the card they play through
+        QString card;
+        QString dev{QStringLiteral("0")};
+        for(const QString& arg : device.sliced(argsStart + 1).split(u',')) {
+            if(arg.startsWith(u"CARD=")) {
+                card = arg.sliced(5);
+            }
+            else if(arg.startsWith(u"DEV=")) {
+                dev = arg.sliced(4);
+            }
+        }
+        if(!card.isEmpty()) {
+            return QStringLiteral("hw:CARD=%1,DEV=%2").arg(card, dev).toLocal8Bit();
+        }
+    }
+
+    // Otherwise ask the device itself; plugins such as plug report the card below them, but dmix and sound servers
+    // don't, as they share it
+    snd_pcm_t* rawHandle;
+    const int err = snd_pcm_open(&rawHandle, device.toLocal8Bit().constData(), SND_PCM_STREAM_PLAYBACK,
+                                 SND_PCM_NONBLOCK);
+    if(checkError(err, QStringLiteral("Failed to open device"))) {
+        return std::nullopt;
+    }
+    const PcmHandleUPtr handle{rawHandle};
+
+    snd_pcm_info_t* info;
+    snd_pcm_info_alloca(&info);
+    if(snd_pcm_info(handle.get(), info) < 0 || snd_pcm_info_get_card(info) < 0) {
+        return QByteArray{};
+    }
+
+    return QStringLiteral("hw:%1,%2").arg(snd_pcm_info_get_card(info)).arg(snd_pcm_info_get_device(info)).toLocal8Bit();
+}
 } // namespace
 
 namespace Fooyin::Alsa {
@@ -136,46 +251,373 @@ struct AlsaOutput::Private
     bool initialised{false};
 
     PcmHandleUPtr pcmHandle{nullptr};
-    snd_pcm_uframes_t bufferSize{8192};
-    snd_pcm_uframes_t periodSize{1024};
+    int latency{0};
+    snd_pcm_uframes_t bufferSize{DefaultBufferSize};
+    snd_pcm_uframes_t periodSize{DefaultPeriodSize};
+    // Set when the pull thread writes straight into the device's buffer
+    bool mmap{false};
     bool pausable{true};
     QString device{QStringLiteral("default")};
+    bool exclusive{false};
+    // The hw device opened in exclusive mode, empty if the device doesn't lead to one; found on first use
+    std::optional<QByteArray> hwDevice;
+    bool bitPerfect{false};
+
+    // What the device can play natively, probed in exclusive mode
+    struct Capabilities
+    {
+        bool valid{false};
+        std::vector<snd_pcm_format_t> formats;
+        std::vector<unsigned int> rates;
+        std::vector<unsigned int> channels;
+    };
+    Capabilities capabilities;
     bool deviceLost;
     bool started{false};
 
+    AudioPullCallback pullCallback;
+    std::thread pullThread;
+    std::atomic<bool> pullRunning{false};
+    int wakeupFd{-1};
+    std::vector<pollfd> pollFds;
+    std::vector<std::byte> pullBuffer;
+
     void reset()
     {
+        stopPullThread();
+        bitPerfect = false;
+
         if(pcmHandle) {
             snd_pcm_drop(pcmHandle.get());
             pcmHandle.reset();
         }
         started = false;
+
+        if(wakeupFd >= 0) {
+            ::close(wakeupFd);
+            wakeupFd = -1;
+        }
     }
 
-    bool initAlsa()
+    void startPullThread()
     {
-        int err{-1};
-        {
-            snd_pcm_t* rawHandle;
-            err = snd_pcm_open(&rawHandle, device.toLocal8Bit().constData(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
-            if(checkError(err, QStringLiteral("Failed to open device"))) {
+        if(!pullCallback || !pcmHandle || pullThread.joinable()) {
+            return;
+        }
+
+        if(wakeupFd < 0) {
+            wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if(wakeupFd < 0) {
+                printError(QStringLiteral("Failed to create wakeup descriptor"));
+                return;
+            }
+        }
+
+        // The last descriptor is used to wake the thread when stopping
+        const int count = snd_pcm_poll_descriptors_count(pcmHandle.get());
+        pollFds.resize(static_cast<size_t>(count) + 1);
+        snd_pcm_poll_descriptors(pcmHandle.get(), pollFds.data(), static_cast<unsigned int>(count));
+        pollFds.back() = {.fd = wakeupFd, .events = POLLIN, .revents = 0};
+
+        if(!mmap) {
+            pullBuffer.resize(static_cast<size_t>(format.bytesForFrames(static_cast<int>(bufferSize))));
+        }
+
+        pullRunning.store(true);
+        pullThread = std::thread{[this]() { pullLoop(); }};
+    }
+
+    void stopPullThread()
+    {
+        if(!pullThread.joinable()) {
+            return;
+        }
+
+        pullRunning.store(false);
+
+        const uint64_t wake{1};
+        if(::write(wakeupFd, &wake, sizeof(wake)) < 0) {
+            printError(QStringLiteral("Failed to wake pull thread"));
+        }
+
+        pullThread.join();
+    }
+
+    void waitForDevice()
+    {
+        if(poll(pollFds.data(), pollFds.size(), -1) < 0) {
+            return;
+        }
+
+        if(pollFds.back().revents & POLLIN) {
+            uint64_t wake;
+            while(::read(wakeupFd, &wake, sizeof(wake)) > 0) { }
+            return;
+        }
+
+        unsigned short revents{0};
+        snd_pcm_poll_descriptors_revents(pcmHandle.get(), pollFds.data(), static_cast<unsigned int>(pollFds.size() - 1),
+                                         &revents);
+        if(revents & POLLERR) {
+            recoverState();
+        }
+    }
+
+    void pullLoop()
+    {
+        snd_pcm_t* handle                 = pcmHandle.get();
+        const snd_pcm_format_t alsaFormat = findAlsaFormat(format.sampleFormat());
+        const auto maxFrames              = static_cast<snd_pcm_sframes_t>(bufferSize);
+
+        while(pullRunning.load()) {
+            const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+            if(avail < 0) {
+                if(checkError(snd_pcm_recover(handle, static_cast<int>(avail), 1), QStringLiteral("Recover error"))) {
+                    break;
+                }
+                continue;
+            }
+
+            if(avail < static_cast<snd_pcm_sframes_t>(periodSize)) {
+                // Buffer is full; make sure the device has started before waiting for it to drain a period
+                recoverState();
+                waitForDevice();
+                continue;
+            }
+
+            const auto frames
+                = static_cast<int>(std::min(avail, maxFrames) / static_cast<snd_pcm_sframes_t>(periodSize) * periodSize);
+            // Everything still queued in the device plays before what's written now
+            snd_pcm_sframes_t delay{0};
+            if(snd_pcm_delay(handle, &delay) < 0) {
+                delay = 0;
+            }
+
+            delay = std::max<snd_pcm_sframes_t>(delay, 0);
+
+            if(mmap) {
+                writeMapped(frames, delay);
+                continue;
+            }
+
+            const int framesRead = pullCallback(pullBuffer.data(), frames,
+                                                static_cast<double>(delay) / static_cast<double>(format.sampleRate()));
+
+            if(framesRead < frames) {
+                snd_pcm_format_set_silence(alsaFormat, pullBuffer.data() + format.bytesForFrames(framesRead),
+                                           (frames - framesRead) * format.channelCount());
+            }
+
+            const snd_pcm_sframes_t written = snd_pcm_writei(handle, pullBuffer.data(), frames);
+            if(written < 0 && written != -EAGAIN) {
+                checkError(snd_pcm_recover(handle, static_cast<int>(written), 1), QStringLiteral("Write error"));
+            }
+        }
+    }
+
+    // Renders @p frames frames directly into the device's buffer, in as many pieces as it wraps around in
+    void writeMapped(int frames, snd_pcm_sframes_t delay)
+    {
+        snd_pcm_t* handle                 = pcmHandle.get();
+        const snd_pcm_format_t alsaFormat = findAlsaFormat(format.sampleFormat());
+
+        while(frames > 0) {
+            const snd_pcm_channel_area_t* areas{nullptr};
+            snd_pcm_uframes_t offset{0};
+            auto count = static_cast<snd_pcm_uframes_t>(frames);
+
+            int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+            if(err < 0) {
+                checkError(snd_pcm_recover(handle, err, 1), QStringLiteral("Map error"));
+                return;
+            }
+
+            // Interleaved, so every channel shares the first area
+            auto* data = static_cast<std::byte*>(areas[0].addr) + (areas[0].first / 8) + (offset * (areas[0].step / 8));
+
+            const int mapped     = static_cast<int>(count);
+            const int framesRead = pullCallback(
+                data, mapped, static_cast<double>(delay) / static_cast<double>(format.sampleRate()));
+
+            if(framesRead < mapped) {
+                snd_pcm_format_set_silence(alsaFormat, data + format.bytesForFrames(framesRead),
+                                           (mapped - framesRead) * format.channelCount());
+            }
+
+            const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, count);
+            if(committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != count) {
+                err = committed < 0 ? static_cast<int>(committed) : -EPIPE;
+                checkError(snd_pcm_recover(handle, err, 1), QStringLiteral("Commit error"));
+                return;
+            }
+
+            frames -= mapped;
+            delay += mapped;
+        }
+    }
+
+    // Direct access needs the hw device itself; anything above it, such as plug, dmix or a sound server, converts
+    bool findDirectDevice()
+    {
+        if(!hwDevice) {
+            // Checked again next time if the device was busy
+            hwDevice = findHardwareDevice(device);
+            if(!hwDevice) {
                 return false;
             }
-            pcmHandle = {rawHandle, PcmHandleDeleter()};
+            if(hwDevice->isEmpty()) {
+                printError(
+                    QStringLiteral("%1 doesn't lead to a single hardware device, so it will be shared").arg(device));
+            }
+        }
+        return !hwDevice->isEmpty();
+    }
+
+    [[nodiscard]] QByteArray deviceName(bool direct) const
+    {
+        return direct && hwDevice ? *hwDevice : device.toLocal8Bit();
+    }
+
+    PcmHandleUPtr openDevice(bool direct) const
+    {
+        int mode{SND_PCM_NONBLOCK};
+        if(direct) {
+            mode |= SND_PCM_NO_AUTO_RESAMPLE | SND_PCM_NO_AUTO_CHANNELS | SND_PCM_NO_AUTO_FORMAT;
+        }
+
+        snd_pcm_t* rawHandle;
+        const int err = snd_pcm_open(&rawHandle, deviceName(direct).constData(), SND_PCM_STREAM_PLAYBACK, mode);
+        if(checkError(err, QStringLiteral("Failed to open device"))) {
+            return nullptr;
+        }
+        return {rawHandle, PcmHandleDeleter()};
+    }
+
+    void probeCapabilities(snd_pcm_t* handle, snd_pcm_hw_params_t* hwParams)
+    {
+        capabilities = {};
+
+        for(const auto sampleFormat : {SampleFormat::U8, SampleFormat::S16, SampleFormat::S32, SampleFormat::Float}) {
+            const snd_pcm_format_t alsaFormat = findAlsaFormat(sampleFormat);
+            if(snd_pcm_hw_params_test_format(handle, hwParams, alsaFormat) == 0) {
+                capabilities.formats.push_back(alsaFormat);
+            }
+        }
+        for(const unsigned int rate : StandardRates) {
+            if(snd_pcm_hw_params_test_rate(handle, hwParams, rate, 0) == 0) {
+                capabilities.rates.push_back(rate);
+            }
+        }
+        // Tested one by one, as some devices only take a few counts within their range
+        for(unsigned int count{1}; count <= MaxProbedChannels; ++count) {
+            if(snd_pcm_hw_params_test_channels(handle, hwParams, count) == 0) {
+                capabilities.channels.push_back(count);
+            }
+        }
+
+        capabilities.valid = true;
+    }
+
+    // Assumed until the device has been probed
+    [[nodiscard]] bool supportsChannels(int count) const
+    {
+        const auto& channels = capabilities.channels;
+        return !capabilities.valid || std::ranges::find(channels, static_cast<unsigned int>(count)) != channels.cend();
+    }
+
+    AudioFormat negotiate(const AudioFormat& requested)
+    {
+        if(!exclusive) {
+            return requested;
+        }
+
+        if(!capabilities.valid) {
+            // The device can't be opened twice, so rely on what was probed while it was last open
+            if(pcmHandle || !findDirectDevice()) {
+                return requested;
+            }
+
+            const PcmHandleUPtr handle = openDevice(true);
+            if(!handle) {
+                return requested;
+            }
+
+            snd_pcm_hw_params_t* hwParams;
+            snd_pcm_hw_params_alloca(&hwParams);
+            if(snd_pcm_hw_params_any(handle.get(), hwParams) < 0) {
+                return requested;
+            }
+            probeCapabilities(handle.get(), hwParams);
+        }
+
+        // Nothing along the way can remix, so the plug layer converts everything instead
+        if(!supportsChannels(requested.channelCount())) {
+            return requested;
+        }
+
+        AudioFormat negotiated{requested};
+
+        for(const auto sampleFormat : formatPreference(requested.sampleFormat())) {
+            if(std::ranges::find(capabilities.formats, findAlsaFormat(sampleFormat)) != capabilities.formats.cend()) {
+                negotiated.setSampleFormat(sampleFormat);
+                break;
+            }
+        }
+
+        const auto rate = static_cast<unsigned int>(requested.sampleRate());
+        negotiated.setSampleRate(static_cast<int>(chooseRate(rate, capabilities.rates)));
+
+        return negotiated;
+    }
+
+    bool initAlsa()
+    {
+        bitPerfect = false;
+
+        // A device with no hw device below it, or a channel count the hardware can't take, means falling back to
+        // shared access, which isn't bit-perfect
+        const bool hardware = exclusive && findDirectDevice();
+        const bool direct   = hardware && supportsChannels(format.channelCount());
+        if(hardware && !direct) {
+            qInfo() << "[ALSA] Device can't play" << format.channelCount() << "channels natively, using shared access";
+        }
+
+        pcmHandle = openDevice(direct);
+        if(!pcmHandle) {
+            return false;
         }
         snd_pcm_t* handle = pcmHandle.get();
 
         snd_pcm_hw_params_t* hwParams;
         snd_pcm_hw_params_alloca(&hwParams);
 
-        err = snd_pcm_hw_params_any(handle, hwParams);
+        int err = snd_pcm_hw_params_any(handle, hwParams);
         if(checkError(err, QStringLiteral("Failed to initialise hardware parameters"))) {
             return false;
         }
 
+        if(direct) {
+            probeCapabilities(handle, hwParams);
+
+            if(!supportsChannels(format.channelCount())) {
+                // Now the device has been probed, this opens it through the plug layer instead
+                pcmHandle.reset();
+                return initAlsa();
+            }
+
+            err = snd_pcm_hw_params_set_rate_resample(handle, hwParams, 0);
+            if(checkError(err, QStringLiteral("Failed to disable resampling"))) {
+                return false;
+            }
+        }
+
         pausable = snd_pcm_hw_params_can_pause(hwParams);
 
-        err = snd_pcm_hw_params_set_access(handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
+        // Pull mode renders straight into the device's buffer if it can be mapped, saving a copy per period
+        mmap = pullCallback && snd_pcm_hw_params_test_access(handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+
+        err = snd_pcm_hw_params_set_access(handle, hwParams,
+                                           mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED);
         if(checkError(err, QStringLiteral("Failed to set access mode"))) {
             return false;
         }
@@ -197,32 +639,22 @@ struct AlsaOutput::Private
 
         uint32_t sampleRate = format.sampleRate();
 
-        err = snd_pcm_hw_params_set_rate_near(handle, hwParams, &sampleRate, nullptr);
+        // A near match would mean the device plays at a different rate than what's written
+        err = direct ? snd_pcm_hw_params_set_rate(handle, hwParams, sampleRate, 0)
+                     : snd_pcm_hw_params_set_rate_near(handle, hwParams, &sampleRate, nullptr);
         if(checkError(err, QStringLiteral("Failed to set sample rate"))) {
             return false;
         }
 
         uint32_t channelCount = format.channelCount();
 
-        err = snd_pcm_hw_params_set_channels_near(handle, hwParams, &channelCount);
+        err = direct ? snd_pcm_hw_params_set_channels(handle, hwParams, channelCount)
+                     : snd_pcm_hw_params_set_channels_near(handle, hwParams, &channelCount);
         if(checkError(err, QStringLiteral("Failed to set channel count"))) {
             return false;
         }
 
-        snd_pcm_uframes_t maxBufferSize;
-        err = snd_pcm_hw_params_get_buffer_size_max(hwParams, &maxBufferSize);
-        if(checkError(err, QStringLiteral("Unable to get max buffer size"))) {
-            return false;
-        }
-
-        bufferSize = std::min(bufferSize, maxBufferSize);
-        err        = snd_pcm_hw_params_set_buffer_size_near(handle, hwParams, &bufferSize);
-        if(checkError(err, QStringLiteral("Unable to set buffer size"))) {
-            return false;
-        }
-
-        err = snd_pcm_hw_params_set_period_size_near(handle, hwParams, &periodSize, nullptr);
-        if(checkError(err, QStringLiteral("Failed to set period size"))) {
+        if(!setBufferSize(hwParams)) {
             return false;
         }
 
@@ -231,6 +663,13 @@ struct AlsaOutput::Private
             return false;
         }
 
+        // The device may not have given us exactly what was asked for
+        snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize);
+        snd_pcm_hw_params_get_period_size(hwParams, &periodSize, nullptr);
+
+        // Every parameter was set exactly, and nothing but the hardware sits between us and the device
+        bitPerfect = direct && snd_pcm_type(handle) == SND_PCM_TYPE_HW;
+
         snd_pcm_sw_params_t* swParams;
         snd_pcm_sw_params_alloca(&swParams);
 
@@ -274,6 +713,40 @@ struct AlsaOutput::Private
         return !checkError(snd_pcm_prepare(pcmHandle.get()), QStringLiteral("Prepare error"));
     }
 
+    bool setBufferSize(snd_pcm_hw_params_t* hwParams)
+    {
+        snd_pcm_t* handle = pcmHandle.get();
+        int err{-1};
+
+        if(latency > 0) {
+            auto bufferTime = static_cast<unsigned int>(latency) * 1000;
+            err             = snd_pcm_hw_params_set_buffer_time_near(handle, hwParams, &bufferTime, nullptr);
+            if(checkError(err, QStringLiteral("Unable to set buffer time"))) {
+                return false;
+            }
+
+            unsigned int periodTime = bufferTime / PeriodsPerBuffer;
+            err = snd_pcm_hw_params_set_period_time_near(handle, hwParams, &periodTime, nullptr);
+            return !checkError(err, QStringLiteral("Failed to set period time"));
+        }
+
+        snd_pcm_uframes_t maxBufferSize;
+        err = snd_pcm_hw_params_get_buffer_size_max(hwParams, &maxBufferSize);
+        if(checkError(err, QStringLiteral("Unable to get max buffer size"))) {
+            return false;
+        }
+
+        bufferSize = std::min(DefaultBufferSize, maxBufferSize);
+        err        = snd_pcm_hw_params_set_buffer_size_near(handle, hwParams, &bufferSize);
+        if(checkError(err, QStringLiteral("Unable to set buffer size"))) {
+            return false;
+        }
+
+        periodSize = DefaultPeriodSize;
+        err        = snd_pcm_hw_params_set_period_size_near(handle, hwParams, &periodSize, nullptr);
+        return !checkError(err, QStringLiteral("Failed to set period size"));
+    }
+
     bool attemptRecovery(snd_pcm_status_t* status)
     {
         if(!status) {
@@ -404,6 +877,8 @@ void AlsaOutput::uninit()
 
 void AlsaOutput::reset()
 {
+    p->stopPullThread();
+
     checkError(snd_pcm_drop(p->pcmHandle.get()), QStringLiteral("ALSA drop error"));
     checkError(snd_pcm_prepare(p->pcmHandle.get()), QStringLiteral("ALSA prepare error"));
 
@@ -413,6 +888,13 @@ void AlsaOutput::reset()
 void AlsaOutput::start()
 {
     p->started = true;
+
+    if(p->pullCallback) {
+        // The pull thread starts the device once it has filled the buffer
+        p->startPullThread();
+        return;
+    }
+
     snd_pcm_start(p->pcmHandle.get());
 }
 
@@ -497,25 +979,65 @@ int AlsaOutput::write(const AudioBuffer& buffer)
 
 void AlsaOutput::setPaused(bool pause)
 {
-    if(!p->pausable) {
-        return;
+    if(pause) {
+        p->stopPullThread();
     }
 
-    p->recoverState();
+    if(p->pausable) {
+        p->recoverState();
 
-    const auto state = snd_pcm_state(p->pcmHandle.get());
-    if(state == SND_PCM_STATE_RUNNING && pause) {
-        checkError(snd_pcm_pause(p->pcmHandle.get(), 1), QStringLiteral("Couldn't pause device"));
+        const auto state = snd_pcm_state(p->pcmHandle.get());
+        if(state == SND_PCM_STATE_RUNNING && pause) {
+            checkError(snd_pcm_pause(p->pcmHandle.get(), 1), QStringLiteral("Couldn't pause device"));
+        }
+        else if(state == SND_PCM_STATE_PAUSED && !pause) {
+            checkError(snd_pcm_pause(p->pcmHandle.get(), 0), QStringLiteral("Couldn't unpause device"));
+        }
     }
-    else if(state == SND_PCM_STATE_PAUSED && !pause) {
-        checkError(snd_pcm_pause(p->pcmHandle.get(), 0), QStringLiteral("Couldn't unpause device"));
+
+    if(!pause && p->started) {
+        p->startPullThread();
     }
 }
 
 void AlsaOutput::setDevice(const QString& device)
 {
-    if(!device.isEmpty()) {
-        p->device = device;
+    if(!device.isEmpty() && device != p->device) {
+        p->device       = device;
+        p->hwDevice     = {};
+        p->capabilities = {};
     }
 }
+
+void AlsaOutput::setLatency(int latency)
+{
+    p->latency = latency;
+}
+
+void AlsaOutput::setExclusive(bool exclusive)
+{
+    if(std::exchange(p->exclusive, exclusive) != exclusive) {
+        p->capabilities = {};
+    }
+}
+
+AudioFormat AlsaOutput::negotiateFormat(const AudioFormat& format)
+{
+    return p->negotiate(format);
+}
+
+bool AlsaOutput::isBitPerfect() const
+{
+    return p->initialised && p->bitPerfect;
+}
+
+bool AlsaOutput::supportsPullMode() const
+{
+    return true;
+}
+
+void AlsaOutput::setPullCallback(AudioPullCallback callback)
+{
+    p->pullCallback = std::move(callback);
+}
 } // namespace Fooyin::Alsa
@@ -45,6 +45,13 @@ public:
     int write(const AudioBuffer& buffer) override;
     void setPaused(bool pause) override;
     void setDevice(const QString& device) override;
+    void setLatency(int latency) override;
+    void setExclusive(bool exclusive) override;
+    AudioFormat negotiateFormat(const AudioFormat& format) override;
+    [[nodiscard]] bool isBitPerfect() const override;
+
+    [[nodiscard]] bool supportsPullMode() const override;
+    void setPullCallback(AudioPullCallback callback) override;
 
 private:
     struct Private;
@@ -0,0 +1,145 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nulloutput.h"
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+// Frames requested per callback
+constexpr auto BufferSize = 4096;
+// Time to wait when there's nothing to read, so an empty buffer or a pause doesn't spin
+constexpr auto IdleWait = 1ms;
+
+namespace Fooyin::Null {
+NullOutput::NullOutput()
+    : m_initialised{false}
+    , m_pullRunning{false}
+    , m_paused{false}
+{ }
+
+NullOutput::~NullOutput()
+{
+    stopPullThread();
+}
+
+bool NullOutput::init(const AudioFormat& format)
+{
+    m_format = format;
+    m_pullBuffer.resize(static_cast<size_t>(format.bytesForFrames(BufferSize)));
+    m_paused.store(false);
+    m_initialised = true;
+
+    return true;
+}
+
+void NullOutput::uninit()
+{
+    stopPullThread();
+    m_initialised = false;
+}
+
+void NullOutput::reset()
+{
+    stopPullThread();
+}
+
+void NullOutput::start()
+{
+    if(!m_pullCallback || m_pullThread.joinable()) {
+        return;
+    }
+
+    m_pullRunning.store(true);
+    m_pullThread = std::thread{[this]() { pullLoop(); }};
+}
+
+bool NullOutput::initialised() const
+{
+    return m_initialised;
+}
+
+QString NullOutput::device() const
+{
+    return QStringLiteral("null");
+}
+
+bool NullOutput::canHandleVolume() const
+{
+    // Nothing is heard, so there's no point applying it
+    return true;
+}
+
+int NullOutput::bufferSize() const
+{
+    return BufferSize;
+}
+
+OutputState NullOutput::currentState()
+{
+    return {.freeSamples = BufferSize};
+}
+
+OutputDevices NullOutput::getAllDevices() const
+{
+    return {{QStringLiteral("null"), tr("Discard")}};
+}
+
+int NullOutput::write(const AudioBuffer& buffer)
+{
+    return buffer.frameCount();
+}
+
+void NullOutput::setPaused(bool pause)
+{
+    m_paused.store(pause);
+}
+
+void NullOutput::setDevice(const QString& /*device*/) { }
+
+bool NullOutput::supportsPullMode() const
+{
+    return true;
+}
+
+void NullOutput::setPullCallback(AudioPullCallback callback)
+{
+    m_pullCallback = std::move(callback);
+}
+
+void NullOutput::stopPullThread()
+{
+    if(!m_pullThread.joinable()) {
+        return;
+    }
+
+    m_pullRunning.store(false);
+    m_pullThread.join();
+}
+
+void NullOutput::pullLoop()
+{
+    while(m_pullRunning.load()) {
+        if(m_paused.load() || m_pullCallback(m_pullBuffer.data(), BufferSize, 0.0) == 0) {
+            std::this_thread::sleep_for(IdleWait);
+        }
+    }
+}
+} // namespace Fooyin::Null
@@ -98,6 +98,7 @@ namespace Fooyin::Pipewire {
 struct PipeWireOutput::Private
 {
     QString device;
+    bool exclusive{false};
     float volume{1.0};
     bool pendingVolumeChange{false};
 
@@ -106,6 +107,8 @@ struct PipeWireOutput::Private
     AudioBuffer buffer;
     uint32_t bufferPos{0};
 
+    AudioPullCallback pullCallback;
+
     std::unique_ptr<PipewireThreadLoop> loop;
     std::unique_ptr<PipewireContext> context;
     std::unique_ptr<PipewireCore> core;
@@ -197,7 +200,7 @@ struct PipeWireOutput::Private
 
         const auto dev = device != u"default" ? device : QStringLiteral("");
 
-        stream = std::make_unique<PipewireStream>(core.get(), format, dev);
+        stream = std::make_unique<PipewireStream>(core.get(), format, dev, exclusive);
         stream->addListener(streamEvents, this);
 
         const spa_audio_format spaFormat = findSpaFormat(format.sampleFormat());
@@ -227,10 +230,48 @@ struct PipeWireOutput::Private
         return stream->connect(PW_ID_ANY, PW_DIRECTION_OUTPUT, params, flags);
     }
 
+    void processPull()
+    {
+        auto* pwBuffer = stream->dequeueBuffer();
+        if(!pwBuffer) {
+            return;
+        }
+
+        const spa_data& data    = pwBuffer->buffer->datas[0];
+        const int bytesPerFrame = format.bytesPerFrame();
+
+        auto frames = static_cast<int>(data.maxsize) / bytesPerFrame;
+#if PW_CHECK_VERSION(0, 3, 49)
+        if(pwBuffer->requested > 0) {
+            frames = std::min(frames, static_cast<int>(pwBuffer->requested));
+        }
+#endif
+
+        auto* dst            = static_cast<std::byte*>(data.data);
+        const int framesRead = pullCallback(dst, frames, stream->delay());
+
+        if(framesRead < frames) {
+            const auto fill = format.sampleFormat() == SampleFormat::U8 ? 0x80 : 0;
+            std::memset(dst + format.bytesForFrames(framesRead), fill,
+                        static_cast<size_t>(format.bytesForFrames(frames - framesRead)));
+        }
+
+        data.chunk->offset = 0;
+        data.chunk->stride = bytesPerFrame;
+        data.chunk->size   = static_cast<uint32_t>(format.bytesForFrames(frames));
+
+        stream->queueBuffer(pwBuffer);
+    }
+
     static void process(void* userData)
     {
         auto* self = static_cast<PipeWireOutput::Private*>(userData);
 
+        if(self->pullCallback) {
+            self->processPull();
+            return;
+        }
+
         if(!self->bufferPos) {
             self->loop->signal(false);
             return;
@@ -396,6 +437,16 @@ void PipeWireOutput::setPaused(bool pause)
     p->stream->setActive(!pause);
 }
 
+bool PipeWireOutput::supportsPullMode() const
+{
+    return true;
+}
+
+void PipeWireOutput::setPullCallback(AudioPullCallback callback)
+{
+    p->pullCallback = std::move(callback);
+}
+
 void PipeWireOutput::setVolume(double volume)
 {
     p->volume = static_cast<float>(volume);
@@ -415,4 +466,11 @@ void PipeWireOutput::setDevice(const QString& device)
         p->device = device;
     }
 }
+
+void PipeWireOutput::setExclusive(bool exclusive)
+{
+    // Keeps other streams off the device, but the sink's own volume and format, and any filters after it,
+    // aren't visible to the stream, so this output is never reported as bit-perfect
+    p->exclusive = exclusive;
+}
 } // namespace Fooyin::Pipewire
@@ -45,8 +45,12 @@ public:
     int write(const AudioBuffer& buffer) override;
     void setPaused(bool pause) override;
 
+    [[nodiscard]] bool supportsPullMode() const override;
+    void setPullCallback(AudioPullCallback callback) override;
+
     void setVolume(double volume) override;
     void setDevice(const QString& device) override;
+    void setExclusive(bool exclusive) override;
 
 private:
     struct Private;
@@ -22,16 +22,20 @@
 #include <core/engine/audiobuffer.h>
 
 #include <pipewire/keys.h>
+#include <pipewire/version.h>
 #include <spa/param/props.h>
 
 #include <QDebug>
 
+#include <ctime>
+
 #ifdef __clang__
 #pragma clang diagnostic ignored "-Wgnu-statement-expression-from-macro-expansion"
 #endif
 
 namespace Fooyin::Pipewire {
-PipewireStream::PipewireStream(PipewireCore* core, const AudioFormat& format, const QString& device)
+PipewireStream::PipewireStream(PipewireCore* core, const AudioFormat& format, const QString& device,
+                               bool exclusive)
 {
     struct pw_properties* props = pw_properties_new(PW_KEY_MEDIA_TYPE, "Audio", PW_KEY_MEDIA_CATEGORY, "Playback",
                                                     PW_KEY_MEDIA_ROLE, "Music", PW_KEY_APP_ID, "fooyin",
@@ -39,6 +43,7 @@ PipewireStream::PipewireStream(PipewireCore* core, const AudioFormat& format, co
 
     const auto frames = std::clamp<int>(64, std::ceil(static_cast<float>(2048 * format.sampleRate()) / 48000.0), 8192);
     m_bufferSize      = frames * format.bytesPerFrame();
+    m_sampleRate      = format.sampleRate();
 
     pw_properties_setf(props, PW_KEY_NODE_RATE, "1/%u", format.sampleRate());
     // pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u", frames, format.sampleRate());
@@ -47,6 +52,11 @@ PipewireStream::PipewireStream(PipewireCore* core, const AudioFormat& format, co
         pw_properties_setf(props, PW_KEY_TARGET_OBJECT, "%s", device.toUtf8().constData());
     }
 
+    if(exclusive) {
+        // Keep other streams off the device, so the graph can follow our rate without mixing
+        pw_properties_set(props, PW_KEY_NODE_EXCLUSIVE, "true");
+    }
+
     m_stream.reset(pw_stream_new(core->core(), "Playback", props));
 
     if(!m_stream) {
@@ -69,6 +79,39 @@ int PipewireStream::bufferSize() const
     return m_bufferSize;
 }
 
+double PipewireStream::delay() const
+{
+    pw_time time{};
+#if PW_CHECK_VERSION(0, 3, 50)
+    const int result = pw_stream_get_time_n(m_stream.get(), &time, sizeof(time));
+#else
+    const int result = pw_stream_get_time(m_stream.get(), &time);
+#endif
+    if(result < 0 || time.rate.denom == 0) {
+        return 0.0;
+    }
+
+    // The delay is in units of the graph's rate
+    double delay = static_cast<double>(std::max<int64_t>(time.delay, 0)) * time.rate.num / time.rate.denom;
+
+#if PW_CHECK_VERSION(0, 3, 50)
+    // Frames held by the stream's resampler, at our rate
+    if(m_sampleRate > 0) {
+        delay += static_cast<double>(time.buffered) / m_sampleRate;
+    }
+#endif
+
+    // The delay was measured at the start of the graph cycle, and playback has moved on since
+    if(time.now > 0) {
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        const int64_t now = (static_cast<int64_t>(ts.tv_sec) * 1000000000) + ts.tv_nsec;
+        delay -= static_cast<double>(std::max<int64_t>(now - time.now, 0)) / 1e9;
+    }
+
+    return std::max(delay, 0.0);
+}
+
 void PipewireStream::setActive(bool active)
 {
     pw_stream_set_active(m_stream.get(), active);
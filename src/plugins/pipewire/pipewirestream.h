@@ -35,11 +35,17 @@ namespace Pipewire {
 class PipewireStream
 {
 public:
-    PipewireStream(PipewireCore* core, const AudioFormat& format, const QString& device = {});
+    PipewireStream(PipewireCore* core, const AudioFormat& format, const QString& device = {},
+                   bool exclusive = false);
     ~PipewireStream();
 
     pw_stream_state state();
     [[nodiscard]] int bufferSize() const;
+    /*!
+     * Returns the time in seconds until the next buffer queued will be heard, or 0 if it isn't known.
+     * Includes audio held in the stream's resampler, and is adjusted for the time since the graph last reported it.
+     */
+    [[nodiscard]] double delay() const;
 
     void setActive(bool active);
     void setVolume(float volume);
@@ -68,6 +74,7 @@ private:
     spa_hook m_streamListener;
     PwStreamUPtr m_stream;
     int m_bufferSize;
+    int m_sampleRate;
 };
 } // namespace Pipewire
 } // namespace Fooyin
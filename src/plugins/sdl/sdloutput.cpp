@@ -23,6 +23,8 @@
 
 #include <QDebug>
 
+#include <cstring>
+
 namespace {
 SDL_AudioFormat findFormat(Fooyin::SampleFormat format)
 {
@@ -60,14 +62,18 @@ bool SdlOutput::init(const AudioFormat& format)
     m_desiredSpec.format   = findFormat(format.sampleFormat());
     m_desiredSpec.channels = format.channelCount();
     m_desiredSpec.samples  = m_bufferSize;
-    m_desiredSpec.callback = nullptr;
+    m_desiredSpec.callback = m_pullCallback ? audioCallback : nullptr;
+    m_desiredSpec.userdata = this;
+
+    // The callback writes directly into the device buffer, so let SDL convert to the device format
+    const int allowedChanges = m_pullCallback ? 0 : SDL_AUDIO_ALLOW_ANY_CHANGE;
 
     if(m_device == QStringLiteral("default")) {
-        m_audioDeviceId = SDL_OpenAudioDevice(nullptr, 0, &m_desiredSpec, &m_obtainedSpec, SDL_AUDIO_ALLOW_ANY_CHANGE);
+        m_audioDeviceId = SDL_OpenAudioDevice(nullptr, 0, &m_desiredSpec, &m_obtainedSpec, allowedChanges);
     }
     else {
         m_audioDeviceId = SDL_OpenAudioDevice(m_device.toLocal8Bit().constData(), 0, &m_desiredSpec, &m_obtainedSpec,
-                                              SDL_AUDIO_ALLOW_ANY_CHANGE);
+                                              allowedChanges);
     }
 
     if(m_audioDeviceId == 0) {
@@ -126,6 +132,7 @@ OutputState SdlOutput::currentState()
 
     state.queuedSamples = static_cast<int>(SDL_GetQueuedAudioSize(m_audioDeviceId) / m_format.bytesPerFrame());
     state.freeSamples   = m_bufferSize - state.queuedSamples;
+    state.delay         = static_cast<double>(state.queuedSamples) / m_format.sampleRate();
 
     return state;
 }
@@ -177,4 +184,30 @@ void SdlOutput::setDevice(const QString& device)
         m_device = device;
     }
 }
+
+bool SdlOutput::supportsPullMode() const
+{
+    return true;
+}
+
+void SdlOutput::setPullCallback(AudioPullCallback callback)
+{
+    m_pullCallback = std::move(callback);
+}
+
+void SdlOutput::audioCallback(void* userData, uint8_t* stream, int len)
+{
+    auto* self = static_cast<SdlOutput*>(userData);
+
+    const int bytesPerFrame = self->m_format.bytesPerFrame();
+    const int frames        = len / bytesPerFrame;
+    // SDL doesn't report its latency; assume the device is halfway through playing the previous buffer
+    const double delay      = static_cast<double>(self->m_obtainedSpec.samples) / 2.0 / self->m_obtainedSpec.freq;
+    const int framesRead    = self->m_pullCallback(reinterpret_cast<std::byte*>(stream), frames, delay);
+    const int bytesRead     = framesRead * bytesPerFrame;
+
+    if(bytesRead < len) {
+        std::memset(stream + bytesRead, self->m_obtainedSpec.silence, static_cast<size_t>(len - bytesRead));
+    }
+}
 } // namespace Fooyin::Sdl
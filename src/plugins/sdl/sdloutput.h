@@ -47,11 +47,17 @@ public:
     void setPaused(bool pause) override;
     void setDevice(const QString& device) override;
 
+    [[nodiscard]] bool supportsPullMode() const override;
+    void setPullCallback(AudioPullCallback callback) override;
+
 private:
+    static void audioCallback(void* userData, uint8_t* stream, int len);
+
     AudioFormat m_format;
     int m_bufferSize;
     bool m_initialised;
     QString m_device;
+    AudioPullCallback m_pullCallback;
 
     SDL_AudioSpec m_desiredSpec;
     SDL_AudioSpec m_obtainedSpec;
@@ -39,6 +39,8 @@
 #include <QMenu>
 #include <QProgressDialog>
 
+#include <algorithm>
+
 // TODO: Make setting
 constexpr auto SeekDelta = 5000;
 
@@ -78,17 +80,21 @@ struct WaveBarPlugin::Private
         , dbPool{DbConnectionPool::create(dbConnectionParams(), QStringLiteral("wavebar"))}
     { }
 
+    [[nodiscard]] DecoderCreator decoderCreator() const
+    {
+        return [engine = engine](const QString& source) { return engine->createDecoder(source, ScanReadAhead); };
+    }
+
     FyWidget* createWavebar()
     {
         if(!waveBuilder) {
-            waveBuilder = std::make_unique<WaveformBuilder>(engine->createDecoder(), dbPool, settings);
+            waveBuilder = std::make_unique<WaveformBuilder>(decoderCreator(), dbPool, settings);
         }
 
-        auto* wavebar = new WaveBarWidget(waveBuilder.get(), settings);
+        auto* wavebar = new WaveBarWidget(waveBuilder.get(), playerController, settings);
 
         QObject::connect(playerController, &PlayerController::currentTrackChanged, wavebar,
                          &WaveBarWidget::changeTrack);
-        QObject::connect(playerController, &PlayerController::positionChanged, wavebar, &WaveBarWidget::changePosition);
         QObject::connect(wavebar, &WaveBarWidget::seek, playerController, &PlayerController::seek);
         QObject::connect(wavebar, &WaveBarWidget::seekForward, playerController,
                          [this]() { playerController->seekForward(SeekDelta); });
@@ -128,7 +134,7 @@ struct WaveBarPlugin::Private
         dialog->setWindowModality(Qt::WindowModal);
         dialog->setValue(0);
 
-        auto* builder = new WaveformBuilder(engine->createDecoder(), dbPool, settings, dialog);
+        auto* builder = new WaveformBuilder(decoderCreator(), dbPool, settings, dialog);
 
         QObject::connect(builder, &WaveformBuilder::waveformGenerated, dialog, [dialog, builder]() {
             if(dialog->wasCanceled()) {
@@ -25,6 +25,7 @@
 
 #include <core/engine/enginecontroller.h>
 #include <core/player/playercontroller.h>
+#include <gui/widgets/positionticker.h>
 #include <utils/settings/settingsdialogcontroller.h>
 #include <utils/settings/settingsmanager.h>
 
@@ -33,12 +34,20 @@
 #include <QMenu>
 #include <QVBoxLayout>
 
+#include <algorithm>
+
+// Update the progress at least this often, however far it has to move to cover a pixel
+constexpr auto TickResolution = 50;
+
 namespace Fooyin::WaveBar {
-WaveBarWidget::WaveBarWidget(WaveformBuilder* builder, SettingsManager* settings, QWidget* parent)
+WaveBarWidget::WaveBarWidget(WaveformBuilder* builder, PlayerController* playerController, SettingsManager* settings,
+                             QWidget* parent)
     : FyWidget{parent}
     , m_settings{settings}
     , m_seekbar{new WaveSeekBar(settings, this)}
     , m_builder{builder}
+    , m_ticker{new PositionTicker(playerController, this)}
+    , m_duration{playerController->currentTrack().duration()}
 {
     setMinimumSize(100, 20);
 
@@ -52,6 +61,9 @@ WaveBarWidget::WaveBarWidget(WaveformBuilder* builder, SettingsManager* settings
 
     QObject::connect(m_builder, &WaveformBuilder::generatingWaveform, this, [this]() { m_seekbar->processData({}); });
     QObject::connect(m_builder, &WaveformBuilder::waveformRescaled, m_seekbar, &WaveSeekBar::processData);
+    QObject::connect(m_ticker, &PositionTicker::positionChanged, this, &WaveBarWidget::changePosition);
+
+    updateResolution();
 }
 
 QString WaveBarWidget::name() const
@@ -66,6 +78,9 @@ QString WaveBarWidget::layoutName() const
 
 void WaveBarWidget::changeTrack(const Track& track)
 {
+    m_duration = track.duration();
+    updateResolution();
+
     m_seekbar->setPosition(0);
     m_builder->generateAndScale(track);
 }
@@ -79,6 +94,7 @@ void WaveBarWidget::resizeEvent(QResizeEvent* event)
 {
     FyWidget::resizeEvent(event);
 
+    updateResolution();
     m_builder->rescale(m_seekbar->contentsRect().width());
 }
 
@@ -174,6 +190,13 @@ void WaveBarWidget::contextMenuEvent(QContextMenuEvent* event)
 
     menu->popup(event->globalPos());
 }
+
+void WaveBarWidget::updateResolution()
+{
+    // Progress only needs redrawing once it's moved a pixel
+    const uint64_t perPixel = m_duration / static_cast<uint64_t>(std::max(m_seekbar->contentsRect().width(), 1));
+    m_ticker->setResolution(std::min<uint64_t>(perPixel, TickResolution));
+}
 } // namespace Fooyin::WaveBar
 
 #include "moc_wavebarwidget.cpp"
@@ -22,6 +22,8 @@
 #include <gui/fywidget.h>
 
 namespace Fooyin {
+class PlayerController;
+class PositionTicker;
 class SettingsManager;
 class Track;
 
@@ -34,7 +36,8 @@ class WaveBarWidget : public FyWidget
     Q_OBJECT
 
 public:
-    WaveBarWidget(WaveformBuilder* builder, SettingsManager* settings, QWidget* parent = nullptr);
+    WaveBarWidget(WaveformBuilder* builder, PlayerController* playerController, SettingsManager* settings,
+                  QWidget* parent = nullptr);
 
     [[nodiscard]] QString name() const override;
     [[nodiscard]] QString layoutName() const override;
@@ -52,10 +55,14 @@ protected:
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
+    void updateResolution();
+
     SettingsManager* m_settings;
 
     WaveSeekBar* m_seekbar;
     WaveformBuilder* m_builder;
+    PositionTicker* m_ticker;
+    uint64_t m_duration;
 };
 } // namespace WaveBar
 } // namespace Fooyin
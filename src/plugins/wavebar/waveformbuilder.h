@@ -40,8 +40,8 @@ class WaveformBuilder : public QObject
     Q_OBJECT
 
 public:
-    explicit WaveformBuilder(std::unique_ptr<AudioDecoder> decoder, DbConnectionPoolPtr dbPool,
-                             SettingsManager* settings, QObject* parent = nullptr);
+    explicit WaveformBuilder(DecoderCreator createDecoder, DbConnectionPoolPtr dbPool, SettingsManager* settings,
+                             QObject* parent = nullptr);
     ~WaveformBuilder() override;
 
     void generate(const Track& track, bool update = false);
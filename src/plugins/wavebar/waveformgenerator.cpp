@@ -21,6 +21,7 @@
 
 #include <core/engine/audioconverter.h>
 #include <utils/math.h>
+#include <utils/paralleltaskrunner.h>
 #include <utils/paths.h>
 
 #include <QDebug>
@@ -29,6 +30,11 @@
 #include <utility>
 
 constexpr auto SampleCount = 2048;
+// Smallest number of samples worth seeking to decode separately
+constexpr auto MinSegmentSamples = 64;
+constexpr auto MaxSegments       = SampleCount / MinSegmentSamples;
+// Interval in ms to check for finished segments
+constexpr auto UpdateInterval = 100;
 
 namespace {
 float convertSampleToFloat(const int16_t inSample)
@@ -98,10 +104,13 @@ Fooyin::WaveBar::WaveformData<OutputType> convertCache(const Fooyin::WaveBar::Wa
 } // namespace
 
 namespace Fooyin::WaveBar {
-WaveformGenerator::WaveformGenerator(std::unique_ptr<AudioDecoder> decoder, DbConnectionPoolPtr dbPool, QObject* parent)
+WaveformGenerator::WaveformGenerator(DecoderCreator createDecoder, DbConnectionPoolPtr dbPool, QObject* parent)
     : Worker{parent}
-    , m_decoder{std::move(decoder)}
+    , m_createDecoder{std::move(createDecoder)}
     , m_dbPool{std::move(dbPool)}
+    , m_framesPerSample{1}
+    , m_sampleTotal{0}
+    , m_segmentsDone{0}
 {
     m_requiredFormat.setSampleFormat(SampleFormat::Float);
 }
@@ -136,31 +145,10 @@ void WaveformGenerator::generate(const Track& track, bool update)
 
     emit generatingWaveform();
 
-    const uint64_t durationSecs = m_data.duration / 1000;
-    const int samplesPerChannel = static_cast<int>(std::floor(durationSecs * m_format.sampleRate()));
-    const int samplesPerBuffer  = static_cast<int>(std::ceil(static_cast<double>(samplesPerChannel) / SampleCount));
-    const int bufferSize        = samplesPerBuffer * m_format.bytesPerFrame();
-
-    m_decoder->start();
-
-    while(true) {
-        if(!mayRun()) {
-            m_decoder->stop();
-            return;
-        }
-
-        auto buffer = m_decoder->readBuffer(static_cast<size_t>(bufferSize));
-        if(!buffer.isValid()) {
-            m_data.complete = true;
-            break;
-        }
-
-        buffer = Audio::convert(buffer, m_requiredFormat);
-        processBuffer(buffer);
+    if(!decode(false)) {
+        return;
     }
 
-    m_decoder->stop();
-
     if(!m_waveDb.storeInCache(trackKey, convertCache<int16_t>(m_data))) {
         qWarning() << "[WaveBar] Unable to store waveform for track:" << m_track.filepath();
     }
@@ -201,40 +189,10 @@ void WaveformGenerator::generateAndRender(const Track& track, bool update)
 
     emit generatingWaveform();
 
-    const uint64_t durationSecs = m_data.duration / 1000;
-    const int samplesPerChannel = static_cast<int>(std::floor(durationSecs * m_format.sampleRate()));
-    const int samplesPerBuffer  = static_cast<int>(std::ceil(static_cast<double>(samplesPerChannel) / SampleCount));
-    const int bufferSize        = samplesPerBuffer * m_format.bytesPerFrame();
-    const int numOfUpdates      = std::max<int>(1, std::floor(static_cast<double>(durationSecs) / 30));
-    const int updateThreshold   = SampleCount / numOfUpdates;
-
-    int processedCount{0};
-
-    m_decoder->start();
-
-    while(true) {
-        if(!mayRun()) {
-            m_decoder->stop();
-            return;
-        }
-
-        auto buffer = m_decoder->readBuffer(static_cast<size_t>(bufferSize));
-        if(!buffer.isValid()) {
-            m_data.complete = true;
-            break;
-        }
-
-        buffer = Audio::convert(buffer, m_requiredFormat);
-        processBuffer(buffer);
-
-        if(processedCount++ == updateThreshold) {
-            processedCount = 0;
-            emit waveformGenerated(m_data);
-        }
+    if(!decode(true)) {
+        return;
     }
 
-    m_decoder->stop();
-
     if(!m_waveDb.storeInCache(trackKey, convertCache<int16_t>(m_data))) {
         qWarning() << "[WaveBar] Unable to store waveform for track:" << m_track.filepath();
     }
@@ -248,14 +206,18 @@ void WaveformGenerator::generateAndRender(const Track& track, bool update)
 
 QString WaveformGenerator::setup(const Track& track)
 {
-    m_decoder->stop();
+    // The best decoder depends on the file, so each track gets its own
+    m_decoder.reset();
+    m_segmentDecoders.clear();
     m_data = {};
 
     if(!track.isValid()) {
         return {};
     }
 
+    m_decoder = m_createDecoder(track.filepath());
     if(!m_decoder->init(track.filepath())) {
+        m_decoder.reset();
         return {};
     }
 
@@ -272,13 +234,149 @@ QString WaveformGenerator::setup(const Track& track)
     return WaveBarDatabase::cacheKey(m_track, m_data.channels);
 }
 
-void WaveformGenerator::processBuffer(const AudioBuffer& buffer)
+bool WaveformGenerator::decode(bool sendUpdates)
+{
+    const auto sampleRate = static_cast<uint64_t>(m_format.sampleRate());
+    const uint64_t frames = m_data.duration * sampleRate / 1000;
+    // Without a duration, fall back to a sample a second and read until the end
+    m_framesPerSample = frames > 0 ? std::max<uint64_t>((frames + SampleCount - 1) / SampleCount, 1)
+                                   : std::max<uint64_t>(sampleRate, 1);
+    m_sampleTotal     = static_cast<int>((frames + m_framesPerSample - 1) / m_framesPerSample);
+
+    // Samples not yet decoded are silent, so partial waveforms keep their position
+    const auto sampleTotal = static_cast<size_t>(m_sampleTotal);
+    for(auto& [max, min, rms] : m_data.channelData) {
+        max.assign(sampleTotal, 0.0F);
+        min.assign(sampleTotal, 0.0F);
+        rms.assign(sampleTotal, 0.0F);
+    }
+
+    const int segmentCount
+        = m_decoder->isSeekable() ? std::clamp(m_sampleTotal / MinSegmentSamples, 1, MaxSegments) : 1;
+
+    m_segments.clear();
+    for(int i{0}; i < segmentCount; ++i) {
+        const int start = i * m_sampleTotal / segmentCount;
+        const int end   = (i + 1) * m_sampleTotal / segmentCount;
+        m_segments.push_back({start, end - start});
+    }
+    m_segmentsDone = 0;
+
+    // Each segment is decoded on a single thread, so decode one per core
+    const auto workers = static_cast<size_t>(ParallelTaskRunner::workerCount(m_segments.size()));
+    while(m_segmentDecoders.size() + 1 < workers) {
+        m_segmentDecoders.emplace_back(m_createDecoder(m_track.filepath()));
+    }
+
+    const ParallelTaskRunner::Tasks tasks{
+        .start   = [this](int worker) { return startDecoder(worker); },
+        .process = [this](size_t index, int worker) { decodeSegment(decoderFor(worker), m_segments.at(index)); },
+        .finish  = [this](int worker) { decoderFor(worker)->stop(); }};
+
+    int segmentsSent{0};
+    const ParallelTaskRunner runner{this, UpdateInterval};
+    runner.run(m_segments.size(), tasks, [this, sendUpdates, &segmentsSent]() {
+        if(sendUpdates) {
+            const std::scoped_lock lock{m_dataGuard};
+            if(std::exchange(segmentsSent, m_segmentsDone) != m_segmentsDone) {
+                emit waveformGenerated(m_data);
+            }
+        }
+    });
+
+    // Each keeps a file open and a read-ahead buffer, so they're only held while decoding
+    m_segmentDecoders.clear();
+    m_decoder.reset();
+
+    if(!mayRun() || m_segmentsDone < segmentCount) {
+        return false;
+    }
+
+    m_data.complete = true;
+    return true;
+}
+
+AudioDecoder* WaveformGenerator::decoderFor(int worker) const
+{
+    return worker == 0 ? m_decoder.get() : m_segmentDecoders.at(static_cast<size_t>(worker) - 1).get();
+}
+
+bool WaveformGenerator::startDecoder(int worker)
+{
+    AudioDecoder* decoder = decoderFor(worker);
+
+    // The first worker reuses the decoder opened by setup; any segments left by a decoder that fails to open
+    // are picked up by the others
+    if(worker > 0 && !decoder->init(m_track.filepath())) {
+        return false;
+    }
+
+    decoder->start();
+    return true;
+}
+
+void WaveformGenerator::decodeSegment(AudioDecoder* decoder, const Segment& segment)
+{
+    // The last segment carries on to the end, as the decoded length can differ from the track's duration
+    const bool last       = segment.start + segment.count == m_sampleTotal;
+    const auto bufferSize = static_cast<size_t>(m_framesPerSample * static_cast<uint64_t>(m_format.bytesPerFrame()));
+
+    if(segment.start > 0) {
+        const uint64_t frame = static_cast<uint64_t>(segment.start) * m_framesPerSample;
+        decoder->seek(frame * 1000 / static_cast<uint64_t>(m_format.sampleRate()));
+    }
+
+    WaveformData<float> data;
+    data.channels = m_data.channels;
+    data.channelData.resize(data.channels);
+
+    for(int i{0}; last || i < segment.count; ++i) {
+        if(!mayRun()) {
+            return;
+        }
+
+        auto buffer = decoder->readBuffer(bufferSize);
+        if(!buffer.isValid()) {
+            break;
+        }
+
+        buffer = Audio::convert(buffer, m_requiredFormat);
+        processBuffer(buffer, data);
+    }
+
+    mergeSegment(segment.start, data);
+}
+
+void WaveformGenerator::mergeSegment(int start, const WaveformData<float>& data)
+{
+    const std::scoped_lock lock{m_dataGuard};
+
+    for(int ch{0}; ch < m_data.channels; ++ch) {
+        auto& [max, min, rms]             = m_data.channelData.at(ch);
+        const auto& [inMax, inMin, inRms] = data.channelData.at(ch);
+
+        const size_t end = static_cast<size_t>(start) + inMax.size();
+        if(max.size() < end) {
+            max.resize(end, 0.0F);
+            min.resize(end, 0.0F);
+            rms.resize(end, 0.0F);
+        }
+
+        std::ranges::copy(inMax, max.begin() + start);
+        std::ranges::copy(inMin, min.begin() + start);
+        std::ranges::copy(inRms, rms.begin() + start);
+    }
+
+    ++m_segmentsDone;
+}
+
+void WaveformGenerator::processBuffer(const AudioBuffer& buffer, WaveformData<float>& data) const
 {
     const int bps         = buffer.format().bytesPerSample();
     const int sampleCount = buffer.frameCount();
     const auto* samples   = buffer.data();
 
-    for(int ch{0}; ch < m_data.channels; ++ch) {
+    for(int ch{0}; ch < data.channels; ++ch) {
         if(!mayRun()) {
             return;
         }
@@ -292,7 +390,7 @@ void WaveformGenerator::processBuffer(const AudioBuffer& buffer)
                 return;
             }
 
-            const int offset = (i * m_data.channels + ch) * bps;
+            const int offset = (i * data.channels + ch) * bps;
             float sample;
             std::memcpy(&sample, samples + offset, bps);
 
@@ -304,7 +402,7 @@ void WaveformGenerator::processBuffer(const AudioBuffer& buffer)
         rms /= static_cast<float>(sampleCount);
         rms = std::sqrt(rms);
 
-        auto& [cMax, cMin, cRms] = m_data.channelData.at(ch);
+        auto& [cMax, cMin, cRms] = data.channelData.at(ch);
         cMax.emplace_back(max);
         cMin.emplace_back(min);
         cRms.emplace_back(rms);
@@ -27,14 +27,23 @@
 #include <utils/database/dbconnectionpool.h>
 #include <utils/worker.h>
 
+#include <functional>
+#include <mutex>
+
 namespace Fooyin::WaveBar {
+using DecoderCreator = std::function<std::unique_ptr<AudioDecoder>(const QString& source)>;
+
+/*!
+ * Generates the waveform of a track, caching it in the database.
+ * Seekable tracks are split into segments which are decoded concurrently, each worker using its own decoder
+ * for the track from @p createDecoder, which is called from the generator's thread.
+ */
 class WaveformGenerator : public Worker
 {
     Q_OBJECT
 
 public:
-    explicit WaveformGenerator(std::unique_ptr<AudioDecoder> decoder, DbConnectionPoolPtr dbPool,
-                               QObject* parent = nullptr);
+    explicit WaveformGenerator(DecoderCreator createDecoder, DbConnectionPoolPtr dbPool, QObject* parent = nullptr);
 
 signals:
     void generatingWaveform();
@@ -46,10 +55,25 @@ public slots:
     void generateAndRender(const Fooyin::Track& track, bool update = false);
 
 private:
+    /** A run of waveform samples decoded by one worker. */
+    struct Segment
+    {
+        int start{0};
+        int count{0};
+    };
+
     QString setup(const Track& track);
-    void processBuffer(const AudioBuffer& buffer);
+    bool decode(bool sendUpdates);
+    [[nodiscard]] AudioDecoder* decoderFor(int worker) const;
+    bool startDecoder(int worker);
+    void decodeSegment(AudioDecoder* decoder, const Segment& segment);
+    void mergeSegment(int start, const WaveformData<float>& data);
+    void processBuffer(const AudioBuffer& buffer, WaveformData<float>& data) const;
 
+    DecoderCreator m_createDecoder;
     std::unique_ptr<AudioDecoder> m_decoder;
+    // Decoders for all but the first worker
+    std::vector<std::unique_ptr<AudioDecoder>> m_segmentDecoders;
     DbConnectionPoolPtr m_dbPool;
     std::unique_ptr<DbConnectionHandler> m_dbHandler;
     WaveBarDatabase m_waveDb;
@@ -58,5 +82,13 @@ private:
     AudioFormat m_format;
     AudioFormat m_requiredFormat;
     WaveformData<float> m_data;
+
+    std::vector<Segment> m_segments;
+    uint64_t m_framesPerSample;
+    int m_sampleTotal;
+
+    // Guards m_data while segments are being merged into it
+    std::mutex m_dataGuard;
+    int m_segmentsDone;
 };
 } // namespace Fooyin::WaveBar
@@ -0,0 +1,277 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "wavfileoutput.h"
+
+#include <utils/paths.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+
+using namespace std::chrono_literals;
+
+// Frames requested per callback
+constexpr auto BufferSize = 4096;
+// Time to wait when there's nothing to read, so an empty buffer or a pause doesn't spin
+constexpr auto IdleWait   = 1ms;
+constexpr auto HeaderSize = 44;
+
+namespace {
+template <size_t N>
+void putLE(std::array<char, HeaderSize>& header, size_t offset, uint32_t value)
+{
+    for(size_t i{0}; i < N; ++i) {
+        header.at(offset + i) = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+QString defaultDirectory()
+{
+    return Fooyin::Utils::cachePath(QStringLiteral("captures"));
+}
+} // namespace
+
+namespace Fooyin::WavFile {
+WavFileOutput::WavFileOutput()
+    : m_directory{defaultDirectory()}
+    , m_dataSize{0}
+    , m_writeFailed{false}
+    , m_droppedFrames{0}
+    , m_pullRunning{false}
+    , m_paused{false}
+{ }
+
+WavFileOutput::~WavFileOutput()
+{
+    if(m_file.isOpen()) {
+        uninit();
+    }
+}
+
+bool WavFileOutput::init(const AudioFormat& format)
+{
+    m_format = format;
+
+    if(!QDir{}.mkpath(m_directory)) {
+        qWarning() << "[WavFile] Unable to create" << m_directory;
+        return false;
+    }
+
+    const QString filename = QStringLiteral("capture-%1.wav")
+                                 .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-hhmmss-zzz")));
+    m_file.setFileName(QDir{m_directory}.filePath(filename));
+
+    // Unbuffered, so a failed write is seen by the write that caused it
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        qWarning() << "[WavFile] Unable to open" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    m_dataSize      = 0;
+    m_writeFailed   = false;
+    m_droppedFrames = 0;
+    if(!writeHeader()) {
+        m_file.close();
+        return false;
+    }
+
+    m_pullBuffer.resize(static_cast<size_t>(format.bytesForFrames(BufferSize)));
+    m_paused.store(false);
+
+    return true;
+}
+
+void WavFileOutput::uninit()
+{
+    stopPullThread();
+
+    if(m_writeFailed) {
+        qWarning() << "[WavFile]" << m_file.fileName() << "is incomplete," << m_droppedFrames
+                   << "frames couldn't be written";
+    }
+
+    // Now the final sizes are known
+    writeHeader();
+    m_file.close();
+}
+
+void WavFileOutput::reset()
+{
+    stopPullThread();
+}
+
+void WavFileOutput::start()
+{
+    if(!m_pullCallback || m_pullThread.joinable()) {
+        return;
+    }
+
+    m_pullRunning.store(true);
+    m_pullThread = std::thread{[this]() { pullLoop(); }};
+}
+
+bool WavFileOutput::initialised() const
+{
+    return m_file.isOpen();
+}
+
+QString WavFileOutput::device() const
+{
+    return m_directory;
+}
+
+bool WavFileOutput::canHandleVolume() const
+{
+    // Capture the audio as it leaves the engine, rather than at whatever volume it's being listened to
+    return true;
+}
+
+int WavFileOutput::bufferSize() const
+{
+    return BufferSize;
+}
+
+OutputState WavFileOutput::currentState()
+{
+    return {.freeSamples = BufferSize};
+}
+
+OutputDevices WavFileOutput::getAllDevices() const
+{
+    return {{defaultDirectory(), tr("Cache directory")}};
+}
+
+int WavFileOutput::write(const AudioBuffer& buffer)
+{
+    writeData(buffer.constData().data(), buffer.frameCount());
+    return buffer.frameCount();
+}
+
+void WavFileOutput::setPaused(bool pause)
+{
+    m_paused.store(pause);
+}
+
+void WavFileOutput::setDevice(const QString& device)
+{
+    // Applies from the next file
+    m_directory = device.isEmpty() ? defaultDirectory() : device;
+}
+
+bool WavFileOutput::supportsPullMode() const
+{
+    return true;
+}
+
+void WavFileOutput::setPullCallback(AudioPullCallback callback)
+{
+    m_pullCallback = std::move(callback);
+}
+
+bool WavFileOutput::writeHeader()
+{
+    // Sizes past 4 GiB can't be represented; the data is still there for anything which ignores them
+    constexpr uint64_t MaxDataSize = std::numeric_limits<uint32_t>::max() - HeaderSize;
+
+    const bool isFloat    = m_format.sampleFormat() == SampleFormat::Float;
+    const auto channels   = static_cast<uint32_t>(m_format.channelCount());
+    const auto sampleRate = static_cast<uint32_t>(m_format.sampleRate());
+    const auto frameSize  = static_cast<uint32_t>(m_format.bytesPerFrame());
+    const auto sampleBits = static_cast<uint32_t>(m_format.bytesPerSample() * 8);
+    const auto dataSize   = static_cast<uint32_t>(std::min(m_dataSize, MaxDataSize));
+
+    std::array<char, HeaderSize> header{'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' '};
+    putLE<4>(header, 4, dataSize + HeaderSize - 8);
+    putLE<4>(header, 16, 16);
+    putLE<2>(header, 20, isFloat ? 3 : 1);
+    putLE<2>(header, 22, channels);
+    putLE<4>(header, 24, sampleRate);
+    putLE<4>(header, 28, sampleRate * frameSize);
+    putLE<2>(header, 32, frameSize);
+    putLE<2>(header, 34, sampleBits);
+    std::copy_n("data", 4, header.begin() + 36);
+    putLE<4>(header, 40, dataSize);
+
+    if(!m_file.seek(0) || m_file.write(header.data(), HeaderSize) != HeaderSize) {
+        qWarning() << "[WavFile] Unable to write header" << m_file.errorString();
+        return false;
+    }
+
+    return m_file.seek(HeaderSize + static_cast<qint64>(m_dataSize));
+}
+
+void WavFileOutput::writeData(const std::byte* data, int frames)
+{
+    if(m_writeFailed) {
+        m_droppedFrames += static_cast<uint64_t>(frames);
+        return;
+    }
+
+    // Samples are written in native byte order, which for every platform we build on is little-endian
+    const auto size = static_cast<qint64>(m_format.bytesForFrames(frames));
+    if(m_file.write(reinterpret_cast<const char*>(data), size) == size) {
+        m_dataSize += static_cast<uint64_t>(size);
+        return;
+    }
+
+    // Playback carries on, but a capture with a gap in it isn't bit for bit, so nothing more is written.
+    // Anything partly written is cut off, leaving the file playable up to that point.
+    qWarning() << "[WavFile] Unable to write to" << m_file.fileName() << m_file.errorString();
+    m_file.resize(HeaderSize + static_cast<qint64>(m_dataSize));
+    m_file.seek(HeaderSize + static_cast<qint64>(m_dataSize));
+
+    m_writeFailed   = true;
+    m_droppedFrames = static_cast<uint64_t>(frames);
+}
+
+void WavFileOutput::stopPullThread()
+{
+    if(!m_pullThread.joinable()) {
+        return;
+    }
+
+    m_pullRunning.store(false);
+    m_pullThread.join();
+}
+
+void WavFileOutput::pullLoop()
+{
+    while(m_pullRunning.load()) {
+        if(m_paused.load()) {
+            std::this_thread::sleep_for(IdleWait);
+            continue;
+        }
+
+        // Only what the engine provides is written, so an underrun never shows up as silence in the capture
+        const int frames = m_pullCallback(m_pullBuffer.data(), BufferSize, 0.0);
+        if(frames == 0) {
+            std::this_thread::sleep_for(IdleWait);
+            continue;
+        }
+
+        writeData(m_pullBuffer.data(), frames);
+    }
+}
+} // namespace Fooyin::WavFile
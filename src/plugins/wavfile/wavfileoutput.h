@@ -0,0 +1,85 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiooutput.h>
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Fooyin::WavFile {
+/*!
+ * Captures audio to a WAV file as fast as the engine can decode it, bit for bit as it would
+ * have been sent to a device. A new file is started each time the output is initialised, so
+ * tracks played gaplessly end up in the same file.
+ * The device is the directory files are written to.
+ */
+class WavFileOutput : public AudioOutput
+{
+    Q_DECLARE_TR_FUNCTIONS(WavFileOutput)
+
+public:
+    WavFileOutput();
+    ~WavFileOutput() override;
+
+    bool init(const AudioFormat& format) override;
+    void uninit() override;
+    void reset() override;
+    void start() override;
+
+    [[nodiscard]] bool initialised() const override;
+    [[nodiscard]] QString device() const override;
+    [[nodiscard]] bool canHandleVolume() const override;
+    int bufferSize() const override;
+    OutputState currentState() override;
+    [[nodiscard]] OutputDevices getAllDevices() const override;
+
+    int write(const AudioBuffer& buffer) override;
+    void setPaused(bool pause) override;
+    void setDevice(const QString& device) override;
+
+    [[nodiscard]] bool supportsPullMode() const override;
+    void setPullCallback(AudioPullCallback callback) override;
+
+private:
+    bool writeHeader();
+    void writeData(const std::byte* data, int frames);
+    void stopPullThread();
+    void pullLoop();
+
+    AudioFormat m_format;
+    QString m_directory;
+    QFile m_file;
+    uint64_t m_dataSize;
+    // Set once a write fails, after which the rest of the capture is dropped
+    bool m_writeFailed;
+    uint64_t m_droppedFrames;
+    AudioPullCallback m_pullCallback;
+
+    std::vector<std::byte> m_pullBuffer;
+    std::thread m_pullThread;
+    std::atomic<bool> m_pullRunning;
+    std::atomic<bool> m_paused;
+};
+} // namespace Fooyin::WavFile
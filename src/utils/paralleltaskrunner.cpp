@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/paralleltaskrunner.h>
+
+#include <utils/worker.h>
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Fooyin {
+ParallelTaskRunner::ParallelTaskRunner(const Worker* owner, int updateInterval)
+    : m_owner{owner}
+    , m_updateInterval{updateInterval}
+{ }
+
+int ParallelTaskRunner::workerCount(size_t count)
+{
+    return static_cast<int>(std::min(static_cast<size_t>(std::max(QThread::idealThreadCount(), 1)), count));
+}
+
+void ParallelTaskRunner::run(size_t count, const Tasks& tasks, const std::function<void()>& update) const
+{
+    const int workers = workerCount(count);
+    if(workers == 0) {
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{0};
+
+    const auto processItems = [this, count, &tasks, &nextIndex](int worker) {
+        if(tasks.start && !tasks.start(worker)) {
+            return;
+        }
+
+        while(m_owner->mayRun()) {
+            const size_t index = nextIndex.fetch_add(1);
+            if(index >= count) {
+                break;
+            }
+            tasks.process(index, worker);
+        }
+
+        if(tasks.finish) {
+            tasks.finish(worker);
+        }
+    };
+
+    // The work is CPU bound, so one worker per core; a dedicated pool avoids starving the global one
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+
+    for(int worker{0}; worker < workers; ++worker) {
+        pool.start([&processItems, worker]() { processItems(worker); });
+    }
+
+    while(!pool.waitForDone(m_updateInterval)) {
+        if(update) {
+            update();
+        }
+    }
+}
+} // namespace Fooyin
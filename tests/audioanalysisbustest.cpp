@@ -0,0 +1,119 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audioanalysisbus.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<float> rampSamples(int frames, int channels)
+{
+    std::vector<float> samples(static_cast<size_t>(frames * channels));
+    for(size_t i{0}; i < samples.size(); ++i) {
+        samples.at(i) = static_cast<float>(i % 1000) / 1000.0F;
+    }
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AudioAnalysisBusTest, SplitsIntoBlocks)
+{
+    constexpr int Frames = (AudioAnalysisBus::BlockFrames * 2) + 100;
+
+    const AudioFormat format{SampleFormat::Float, 48000, 2};
+    const auto samples = rampSamples(Frames, 2);
+    const auto start   = AudioAnalysisBus::Clock::now();
+
+    AudioAnalysisBus bus;
+    uint64_t cursor = bus.nextSequence();
+    bus.publish(format, reinterpret_cast<const std::byte*>(samples.data()), Frames, start);
+
+    AudioAnalysisBus::Block block;
+    int offset{0};
+    for(const int expectedFrames : {AudioAnalysisBus::BlockFrames, AudioAnalysisBus::BlockFrames, 100}) {
+        ASSERT_TRUE(bus.read(cursor, block));
+        EXPECT_EQ(expectedFrames, block.frames);
+        EXPECT_EQ(2, block.channels);
+        EXPECT_EQ(48000, block.sampleRate);
+
+        const auto offsetTime = std::chrono::duration<double>{static_cast<double>(offset) / 48000};
+        EXPECT_NEAR(0, (block.playTime - start - offsetTime).count(), 1000);
+
+        for(int i{0}; i < expectedFrames * 2; ++i) {
+            ASSERT_EQ(samples.at((offset * 2) + i), block.samples.at(i));
+        }
+        offset += expectedFrames;
+    }
+
+    EXPECT_FALSE(bus.read(cursor, block));
+}
+
+TEST(AudioAnalysisBusTest, SkipsOverwrittenBlocks)
+{
+    constexpr int Extra = 5;
+
+    const AudioFormat format{SampleFormat::Float, 44100, 1};
+    const auto samples = rampSamples(AudioAnalysisBus::BlockFrames, 1);
+
+    AudioAnalysisBus bus;
+    uint64_t cursor = bus.nextSequence();
+    for(int i{0}; i < AudioAnalysisBus::BlockCount + Extra; ++i) {
+        bus.publish(format, reinterpret_cast<const std::byte*>(samples.data()), AudioAnalysisBus::BlockFrames,
+                    AudioAnalysisBus::Clock::now());
+    }
+
+    // The reader has been lapped, so picks up from the oldest block still held
+    AudioAnalysisBus::Block block;
+    ASSERT_TRUE(bus.read(cursor, block));
+    EXPECT_EQ(Extra + 1, block.sequence);
+
+    int count{1};
+    while(bus.read(cursor, block)) {
+        ++count;
+    }
+    EXPECT_EQ(AudioAnalysisBus::BlockCount, count);
+}
+
+TEST(AudioAnalysisBusTest, MarksDiscontinuity)
+{
+    const AudioFormat format{SampleFormat::S16, 44100, 2};
+    const std::vector<int16_t> samples(200, 16384);
+
+    AudioAnalysisBus bus;
+    uint64_t cursor = bus.nextSequence();
+
+    bus.markDiscontinuity();
+    bus.publish(format, reinterpret_cast<const std::byte*>(samples.data()), 100, AudioAnalysisBus::Clock::now());
+    bus.publish(format, reinterpret_cast<const std::byte*>(samples.data()), 100, AudioAnalysisBus::Clock::now());
+
+    AudioAnalysisBus::Block block;
+    ASSERT_TRUE(bus.read(cursor, block));
+    EXPECT_TRUE(block.discontinuity);
+    // Converted to float
+    EXPECT_FLOAT_EQ(0.5F, block.samples.front());
+
+    ASSERT_TRUE(bus.read(cursor, block));
+    EXPECT_FALSE(block.discontinuity);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,258 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "core/engine/audiobufferpool.h"
+
+#include <core/engine/audiobuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+std::vector<std::byte> makeBytes(size_t size)
+{
+    std::vector<std::byte> bytes(size);
+    for(size_t i{0}; i < size; ++i) {
+        bytes[i] = static_cast<std::byte>(i % 251);
+    }
+    return bytes;
+}
+
+void countRelease(void* opaque)
+{
+    ++*static_cast<int*>(opaque);
+}
+} // namespace
+
+namespace Fooyin::Testing {
+class AudioBufferTest : public ::testing::Test
+{
+protected:
+    AudioFormat m_format{SampleFormat::S16, 44100, 2};
+};
+
+TEST(AudioBufferPoolTest, RoundsUpToSizeClasses)
+{
+    EXPECT_EQ(64, AudioBufferPool::capacityFor(0));
+    EXPECT_EQ(64, AudioBufferPool::capacityFor(1));
+    EXPECT_EQ(64, AudioBufferPool::capacityFor(64));
+    EXPECT_EQ(128, AudioBufferPool::capacityFor(65));
+    EXPECT_EQ(4096, AudioBufferPool::capacityFor(4000));
+    EXPECT_EQ(8192, AudioBufferPool::capacityFor(4097));
+}
+
+TEST(AudioBufferPoolTest, ReusesReleasedBlocks)
+{
+    auto& pool = AudioBufferPool::instance();
+
+    std::byte* first = pool.acquire(3000);
+    pool.release(first, 3000);
+
+    const AudioBufferPoolStats before = pool.stats();
+
+    // Any size in the same class gets the block back
+    std::byte* second = pool.acquire(2500);
+    EXPECT_EQ(first, second);
+
+    AudioBufferPoolStats after = pool.stats();
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(before.cachedBytes - 4096, after.cachedBytes);
+
+    pool.release(second, 2500);
+
+    after = pool.stats();
+    EXPECT_EQ(before.cachedBytes, after.cachedBytes);
+}
+
+TEST(AudioBufferPoolTest, DoesNotKeepOversizedBlocks)
+{
+    auto& pool = AudioBufferPool::instance();
+
+    constexpr size_t Size = 64 * 1024 * 1024;
+
+    const AudioBufferPoolStats before = pool.stats();
+
+    std::byte* block = pool.acquire(Size);
+    ASSERT_NE(nullptr, block);
+    pool.release(block, Size);
+
+    const AudioBufferPoolStats after = pool.stats();
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.cachedBytes, after.cachedBytes);
+}
+
+TEST_F(AudioBufferTest, RecyclesStorage)
+{
+    const auto bytes = makeBytes(1000);
+
+    {
+        // Make sure the pool holds blocks of the sizes used
+        const AudioBuffer buffer{bytes, m_format, 0};
+    }
+
+    const AudioBufferPoolStats before = AudioBuffer::poolStats();
+    {
+        const AudioBuffer buffer{bytes, m_format, 0};
+        EXPECT_EQ(1000, buffer.byteCount());
+    }
+    const AudioBufferPoolStats after = AudioBuffer::poolStats();
+
+    // Both the buffer's storage and its shared state come from the pool
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(before.hits + 2, after.hits);
+    EXPECT_EQ(before.cachedBytes, after.cachedBytes);
+}
+
+TEST_F(AudioBufferTest, EraseMovesOffset)
+{
+    const auto bytes = makeBytes(100);
+
+    AudioBuffer buffer{bytes, m_format, 0};
+    const std::byte* start = buffer.constData().data();
+
+    buffer.erase(40);
+
+    ASSERT_EQ(60, buffer.byteCount());
+    EXPECT_EQ(start + 40, buffer.constData().data());
+    EXPECT_TRUE(std::equal(bytes.cbegin() + 40, bytes.cend(), buffer.constData().begin()));
+
+    // Erasing everything starts over from the front
+    buffer.erase(100);
+    EXPECT_EQ(0, buffer.byteCount());
+    EXPECT_EQ(start, buffer.constData().data());
+}
+
+TEST_F(AudioBufferTest, ReserveReclaimsErasedSpace)
+{
+    const auto bytes = makeBytes(100);
+
+    AudioBuffer buffer{bytes, m_format, 0};
+    const std::byte* start = buffer.constData().data();
+
+    buffer.erase(40);
+    // Doesn't fit after the offset, but does fit in the 128 byte block
+    buffer.reserve(120);
+
+    ASSERT_EQ(60, buffer.byteCount());
+    EXPECT_EQ(start, buffer.constData().data());
+    EXPECT_TRUE(std::equal(bytes.cbegin() + 40, bytes.cend(), buffer.constData().begin()));
+
+    // Appending now fills the reclaimed space without moving to a new block
+    buffer.append(bytes.data(), 60);
+    ASSERT_EQ(120, buffer.byteCount());
+    EXPECT_EQ(start, buffer.constData().data());
+    EXPECT_TRUE(std::equal(bytes.cbegin(), bytes.cbegin() + 60, buffer.constData().begin() + 60));
+}
+
+TEST_F(AudioBufferTest, ReserveGrowsIntoLargerBlock)
+{
+    const auto bytes = makeBytes(100);
+
+    AudioBuffer buffer{bytes, m_format, 0};
+    buffer.erase(10);
+    buffer.reserve(1000);
+
+    ASSERT_EQ(90, buffer.byteCount());
+    EXPECT_TRUE(std::equal(bytes.cbegin() + 10, bytes.cend(), buffer.constData().begin()));
+}
+
+TEST_F(AudioBufferTest, ReleasesExternalOnceDestroyed)
+{
+    const auto bytes = makeBytes(100);
+    int releases{0};
+
+    {
+        const AudioBuffer buffer{bytes.data(), bytes.size(), m_format, 0, countRelease, &releases};
+        const AudioBuffer copy{buffer};
+
+        EXPECT_EQ(bytes.data(), buffer.constData().data());
+        EXPECT_EQ(bytes.data(), copy.constData().data());
+    }
+
+    EXPECT_EQ(1, releases);
+}
+
+TEST_F(AudioBufferTest, ReleasesExternalOnceCopied)
+{
+    const auto bytes = makeBytes(100);
+    int releases{0};
+
+    {
+        AudioBuffer buffer{bytes.data(), bytes.size(), m_format, 0, countRelease, &releases};
+
+        // Non-const access copies the data into the buffer's own storage
+        std::byte* data = buffer.data();
+        EXPECT_NE(bytes.data(), data);
+        EXPECT_EQ(1, releases);
+        EXPECT_TRUE(std::equal(bytes.cbegin(), bytes.cend(), buffer.constData().begin()));
+
+        data[0] = std::byte{0xff};
+        EXPECT_EQ(std::byte{0}, bytes[0]);
+    }
+
+    EXPECT_EQ(1, releases);
+}
+
+TEST_F(AudioBufferTest, ExternalEraseKeepsOffset)
+{
+    const auto bytes = makeBytes(100);
+    int releases{0};
+
+    AudioBuffer buffer{bytes.data(), bytes.size(), m_format, 0, countRelease, &releases};
+    buffer.erase(24);
+
+    ASSERT_EQ(76, buffer.byteCount());
+    EXPECT_EQ(bytes.data() + 24, buffer.constData().data());
+    EXPECT_EQ(0, releases);
+
+    // The offset is carried over into the copy
+    buffer.append(bytes.data(), 4);
+    EXPECT_EQ(1, releases);
+    ASSERT_EQ(80, buffer.byteCount());
+    EXPECT_TRUE(std::equal(bytes.cbegin() + 24, bytes.cend(), buffer.constData().begin()));
+    EXPECT_TRUE(std::equal(bytes.cbegin(), bytes.cbegin() + 4, buffer.constData().begin() + 76));
+}
+
+TEST_F(AudioBufferTest, DetachedExternalCopyDoesNotAlias)
+{
+    const auto bytes = makeBytes(100);
+    int releases{0};
+
+    {
+        const AudioBuffer buffer{bytes.data(), bytes.size(), m_format, 0, countRelease, &releases};
+
+        AudioBuffer copy{buffer};
+        copy.detach();
+
+        EXPECT_NE(bytes.data(), copy.constData().data());
+        EXPECT_TRUE(std::equal(bytes.cbegin(), bytes.cend(), copy.constData().begin()));
+
+        copy.data()[0] = std::byte{0xff};
+        EXPECT_EQ(std::byte{0}, bytes[0]);
+        EXPECT_EQ(bytes.data(), buffer.constData().data());
+
+        // The original still holds the external data
+        EXPECT_EQ(0, releases);
+    }
+
+    EXPECT_EQ(1, releases);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,110 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiocrossfader.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace Fooyin::Testing {
+TEST(AudioCrossfaderTest, KeepsPowerConstant)
+{
+    constexpr int Frames = 3000;
+
+    const AudioFormat format{SampleFormat::Float, 48000, 2};
+
+    AudioCrossfader crossfader;
+    crossfader.prepare(format);
+    crossfader.start(Frames);
+    EXPECT_TRUE(crossfader.isActive());
+
+    std::vector<float> outgoing(Frames * 2, 1.0F);
+    const std::vector<float> incoming(Frames * 2, 1.0F);
+
+    // Mix in uneven chunks, as buffers from the two decoders won't line up
+    int frame{0};
+    for(const int chunk : {1, 999, 1500, 500}) {
+        crossfader.mix(reinterpret_cast<std::byte*>(outgoing.data() + (frame * 2)),
+                       reinterpret_cast<const std::byte*>(incoming.data() + (frame * 2)), chunk);
+        frame += chunk;
+    }
+    EXPECT_FALSE(crossfader.isActive());
+
+    EXPECT_FLOAT_EQ(outgoing.front(), 1.0F);
+    for(int i{0}; i < Frames; ++i) {
+        const double angle = (static_cast<double>(i) / Frames) * std::numbers::pi / 2.0;
+        // Two identical signals sum to cos + sin, which peaks at the midpoint
+        EXPECT_NEAR(outgoing.at(i * 2), std::cos(angle) + std::sin(angle), 1e-5);
+        EXPECT_EQ(outgoing.at(i * 2), outgoing.at((i * 2) + 1));
+    }
+    EXPECT_NEAR(outgoing.at(Frames), std::sqrt(2.0), 1e-3);
+}
+
+TEST(AudioCrossfaderTest, PassesIncomingOnceFinished)
+{
+    const AudioFormat format{SampleFormat::S16, 44100, 1};
+
+    AudioCrossfader crossfader;
+    crossfader.prepare(format);
+    crossfader.start(4);
+
+    std::vector<int16_t> outgoing(8, 10000);
+    const std::vector<int16_t> incoming(8, -2000);
+    crossfader.mix(reinterpret_cast<std::byte*>(outgoing.data()), reinterpret_cast<const std::byte*>(incoming.data()),
+                   8);
+
+    EXPECT_EQ(outgoing.front(), 10000);
+    for(int i{4}; i < 8; ++i) {
+        EXPECT_EQ(outgoing.at(i), -2000);
+    }
+}
+
+TEST(AudioCrossfaderTest, FadesAcrossEarlyEnds)
+{
+    const AudioFormat format{SampleFormat::Float, 48000, 1};
+
+    AudioCrossfader crossfader;
+    crossfader.prepare(format);
+    crossfader.start(100);
+
+    // The outgoing track ends halfway through, so the incoming carries on fading in alone
+    std::vector<float> outgoing(50, 0.0F);
+    const std::vector<float> incoming(50, 1.0F);
+    crossfader.mix(reinterpret_cast<std::byte*>(outgoing.data()), reinterpret_cast<const std::byte*>(incoming.data()),
+                   50);
+    EXPECT_EQ(crossfader.remainingFrames(), 50);
+
+    std::vector<float> rest(50, 1.0F);
+    crossfader.fadeIn(reinterpret_cast<std::byte*>(rest.data()), 50);
+    EXPECT_FALSE(crossfader.isActive());
+
+    EXPECT_NEAR(rest.front(), std::sin(std::numbers::pi / 4.0), 1e-5);
+    EXPECT_GT(rest.back(), outgoing.back());
+
+    // Without an incoming track, the outgoing one fades to silence
+    crossfader.start(10);
+    std::vector<float> tail(20, 1.0F);
+    crossfader.fadeOut(reinterpret_cast<std::byte*>(tail.data()), 20);
+    EXPECT_FLOAT_EQ(tail.front(), 1.0F);
+    EXPECT_FLOAT_EQ(tail.back(), 0.0F);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,276 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiokernels.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using Fooyin::SampleFormat;
+using Fooyin::Audio::KernelIsa;
+
+// Ten seconds of 44.1kHz stereo audio
+constexpr int SampleCount = 44100 * 2 * 10;
+constexpr int Iterations  = 50;
+
+const char* formatName(SampleFormat format)
+{
+    switch(format) {
+        case(SampleFormat::U8):
+            return "u8";
+        case(SampleFormat::S16):
+            return "s16";
+        case(SampleFormat::S32):
+            return "s32";
+        case(SampleFormat::Float):
+            return "f32";
+        default:
+            return "?";
+    }
+}
+
+double measure(Fooyin::Audio::ConvertKernel kernel, const std::byte* input, std::byte* output)
+{
+    // Warm up caches and page in the output
+    kernel(input, output, SampleCount);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(int i{0}; i < Iterations; ++i) {
+        kernel(input, output, SampleCount);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / Iterations;
+}
+
+// The per-sample copy FFmpegDecoder used before the interleave kernels
+void interleaveReference(const uint8_t* const* planes, int channels, std::byte* output, int frames, int size)
+{
+    for(int i{0}; i < frames; ++i) {
+        for(int ch{0}; ch < channels; ++ch) {
+            std::memmove(output, planes[ch] + static_cast<ptrdiff_t>(i * size), static_cast<size_t>(size));
+            output += size;
+        }
+    }
+}
+
+template <typename Func>
+double measureFunc(Func&& interleave)
+{
+    interleave();
+
+    const auto start = std::chrono::steady_clock::now();
+    for(int i{0}; i < Iterations; ++i) {
+        interleave();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / Iterations;
+}
+
+// The per-sample gain AudioBuffer used before the gain kernels
+template <typename T>
+void gainReference(std::byte* data, int count, double gain)
+{
+    for(int i{0}; i < count; ++i) {
+        T sample;
+        std::memcpy(&sample, data + (i * sizeof(T)), sizeof(T));
+        sample *= gain;
+        std::memcpy(data + (i * sizeof(T)), &sample, sizeof(T));
+    }
+}
+
+void benchmarkGain()
+{
+    // Gain is applied a device period at a time, so keep the samples in cache
+    constexpr int BlockSize  = 4096;
+    constexpr int BlockCount = SampleCount / BlockSize;
+
+    constexpr std::array formats{SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+
+    std::vector<std::byte> data(static_cast<size_t>(BlockSize) * 4);
+    const std::vector<float> gains(BlockSize, 0.5F);
+
+    std::printf("\n%-12s %10s %10s %10s %10s %8s\n", "gain", "memcpy", "scalar", "sse2", "avx2", "speedup");
+
+    for(const auto format : formats) {
+        // Alternate between gains which cancel out, so the samples stay in range
+        double gain{0.5};
+        auto applyBlocks = [&](auto&& apply) {
+            for(int i{0}; i < BlockCount; ++i) {
+                gain = 1.0 / gain;
+                apply(gain);
+            }
+        };
+
+        std::array<double, 4> times{};
+        times[0] = measureFunc([&]() {
+            applyBlocks([&](double blockGain) {
+                if(format == SampleFormat::S16) {
+                    gainReference<int16_t>(data.data(), BlockSize, blockGain);
+                }
+                else if(format == SampleFormat::S32) {
+                    gainReference<int32_t>(data.data(), BlockSize, blockGain);
+                }
+                else {
+                    gainReference<float>(data.data(), BlockSize, blockGain);
+                }
+            });
+        });
+        for(const auto isa : {KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::AVX2}) {
+            const auto kernel = Fooyin::Audio::gainKernel(format, isa);
+            times.at(static_cast<size_t>(isa) + 1) = measureFunc(
+                [&]() { applyBlocks([&](double blockGain) { kernel(data.data(), BlockSize, blockGain); }); });
+        }
+
+        std::printf("%-12s %8.3fms %8.3fms %8.3fms %8.3fms %7.1fx\n", formatName(format), times[0], times[1],
+                    times[2], times[3], times[0] / std::min(times[2], times[3]));
+
+        std::array<double, 3> rampTimes{};
+        for(const auto isa : {KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::AVX2}) {
+            const auto kernel                      = Fooyin::Audio::gainRampKernel(format, isa);
+            rampTimes.at(static_cast<size_t>(isa)) = measureFunc(
+                [&]() { applyBlocks([&](double /*blockGain*/) { kernel(data.data(), gains.data(), BlockSize); }); });
+        }
+
+        const std::string name = std::string{formatName(format)} + " ramp";
+        std::printf("%-12s %10s %8.3fms %8.3fms %8.3fms %7.1fx\n", name.c_str(), "", rampTimes[0], rampTimes[1],
+                    rampTimes[2], rampTimes[0] / std::min(rampTimes[1], rampTimes[2]));
+    }
+}
+
+void benchmarkInterleave()
+{
+    // Ten seconds of 44.1kHz audio per channel
+    constexpr int Frames = 44100 * 10;
+
+    std::printf("\n%-12s %10s %10s %10s %10s %8s\n", "interleave", "memmove", "scalar", "sse2", "avx2", "speedup");
+
+    for(const int size : {2, 4}) {
+        for(const int channels : {1, 2, 6, 8}) {
+            const std::vector<std::byte> input(static_cast<size_t>(Frames * channels * size));
+            std::vector<std::byte> output(input.size());
+
+            const auto* samples = reinterpret_cast<const uint8_t*>(input.data());
+
+            std::vector<const uint8_t*> planes;
+            for(int ch{0}; ch < channels; ++ch) {
+                planes.push_back(samples + static_cast<ptrdiff_t>(ch * Frames * size));
+            }
+
+            std::array<double, 4> times{};
+            times[0] = measureFunc(
+                [&]() { interleaveReference(planes.data(), channels, output.data(), Frames, size); });
+            for(const auto isa : {KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::AVX2}) {
+                const auto kernel = Fooyin::Audio::interleaveKernel(size, channels, isa);
+                times.at(static_cast<size_t>(isa) + 1)
+                    = measureFunc([&]() { kernel(planes.data(), channels, output.data(), Frames); });
+            }
+
+            const std::string name = std::to_string(size * 8) + "bit " + std::to_string(channels) + "ch";
+            std::printf("%-12s %8.3fms %8.3fms %8.3fms %8.3fms %7.1fx\n", name.c_str(), times[0], times[1], times[2],
+                        times[3], times[0] / std::min(times[2], times[3]));
+        }
+    }
+}
+
+// The per-sample copy AudioConverter used before the remap kernels
+void remapReference(const std::byte* input, int inChannels, std::byte* output, int outChannels, int frames, int size)
+{
+    for(int i{0}; i < frames; ++i) {
+        for(int ch{0}; ch < outChannels; ++ch) {
+            const int inChannel = inChannels == 1 ? 0 : ch;
+            std::memcpy(output + static_cast<ptrdiff_t>(((i * outChannels) + ch) * size),
+                        input + static_cast<ptrdiff_t>(((i * inChannels) + inChannel) * size),
+                        static_cast<size_t>(size));
+        }
+    }
+}
+
+void benchmarkRemap()
+{
+    // Ten seconds of 44.1kHz audio
+    constexpr int Frames = 44100 * 10;
+
+    constexpr std::array formats{SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+
+    std::printf("\n%-12s %10s %10s %10s %10s %8s\n", "remap", "memcpy", "scalar", "sse2", "avx2", "speedup");
+
+    for(const auto format : formats) {
+        const int size = format == SampleFormat::S16 ? 2 : 4;
+
+        for(const auto& [inChannels, outChannels] : {std::pair{1, 2}, std::pair{2, 1}}) {
+            const std::vector<std::byte> input(static_cast<size_t>(Frames * inChannels * size));
+            std::vector<std::byte> output(static_cast<size_t>(Frames * outChannels * size));
+
+            std::array<double, 4> times{};
+            times[0] = measureFunc(
+                [&]() { remapReference(input.data(), inChannels, output.data(), outChannels, Frames, size); });
+            for(const auto isa : {KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::AVX2}) {
+                const auto kernel = Fooyin::Audio::remapKernel(format, inChannels, outChannels, isa);
+                times.at(static_cast<size_t>(isa) + 1)
+                    = measureFunc([&]() { kernel(input.data(), output.data(), Frames); });
+            }
+
+            const std::string name = std::string{formatName(format)} + " " + std::to_string(inChannels) + "->"
+                                   + std::to_string(outChannels) + "ch";
+            std::printf("%-12s %8.3fms %8.3fms %8.3fms %8.3fms %7.1fx\n", name.c_str(), times[0], times[1], times[2],
+                        times[3], times[0] / std::min(times[2], times[3]));
+        }
+    }
+}
+} // namespace
+
+int main()
+{
+    constexpr std::array formats{SampleFormat::U8, SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+
+    const std::vector<std::byte> input(static_cast<size_t>(SampleCount) * 4);
+    std::vector<std::byte> output(static_cast<size_t>(SampleCount) * 4);
+
+    std::printf("Detected ISA: %d\n", static_cast<int>(Fooyin::Audio::detectedIsa()));
+    std::printf("%-12s %10s %10s %10s %8s\n", "conversion", "scalar", "sse2", "avx2", "speedup");
+
+    for(const auto inFormat : formats) {
+        for(const auto outFormat : formats) {
+            std::array<double, 3> times{};
+            for(const auto isa : {KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::AVX2}) {
+                const auto kernel                  = Fooyin::Audio::convertKernel(inFormat, outFormat, isa);
+                times.at(static_cast<size_t>(isa)) = measure(kernel, input.data(), output.data());
+            }
+
+            const std::string name = std::string{formatName(inFormat)} + "->" + formatName(outFormat);
+            std::printf("%-12s %8.3fms %8.3fms %8.3fms %7.1fx\n", name.c_str(), times[0], times[1], times[2],
+                        times[0] / std::min(times[1], times[2]));
+        }
+    }
+
+    benchmarkInterleave();
+    benchmarkRemap();
+    benchmarkGain();
+
+    return 0;
+}
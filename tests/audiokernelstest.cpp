@@ -0,0 +1,325 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiogain.h"
+#include "core/engine/audiokernels.h"
+
+#include <core/engine/audioconverter.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr std::array SampleFormats
+    = {Fooyin::SampleFormat::U8, Fooyin::SampleFormat::S16, Fooyin::SampleFormat::S32, Fooyin::SampleFormat::Float};
+
+int sampleSize(Fooyin::SampleFormat format)
+{
+    switch(format) {
+        case(Fooyin::SampleFormat::U8):
+            return 1;
+        case(Fooyin::SampleFormat::S16):
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+std::vector<std::byte> randomSamples(Fooyin::SampleFormat format, int count)
+{
+    std::mt19937 gen{42};
+    std::vector<std::byte> samples(static_cast<size_t>(count) * 4);
+
+    if(format == Fooyin::SampleFormat::Float) {
+        // Include values outside of [-1, 1] to test clipping
+        std::uniform_real_distribution<float> dist{-1.25F, 1.25F};
+        for(int i{0}; i < count; ++i) {
+            const float sample = i == 0 ? 1.0F : i == 1 ? -1.0F : dist(gen);
+            std::memcpy(samples.data() + static_cast<ptrdiff_t>(i * 4), &sample, sizeof(float));
+        }
+    }
+    else {
+        std::uniform_int_distribution<int> dist{0, 255};
+        for(auto& byte : samples) {
+            byte = static_cast<std::byte>(dist(gen));
+        }
+    }
+
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AudioKernelsTest, VectorKernelsMatchScalar)
+{
+    // Not a multiple of any vector width, so the scalar tail is also exercised
+    constexpr int Count = 1029;
+
+    for(const auto inFormat : SampleFormats) {
+        const auto input = randomSamples(inFormat, Count);
+
+        for(const auto outFormat : SampleFormats) {
+            const auto outSize = static_cast<size_t>(Count * sampleSize(outFormat));
+
+            std::vector<std::byte> expected(outSize);
+            Audio::convertKernel(inFormat, outFormat, Audio::KernelIsa::Scalar)(input.data(), expected.data(), Count);
+
+            for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+                std::vector<std::byte> output(outSize);
+                Audio::convertKernel(inFormat, outFormat, isa)(input.data(), output.data(), Count);
+                EXPECT_EQ(expected, output) << "Format " << static_cast<int>(inFormat) << " to "
+                                            << static_cast<int>(outFormat) << ", ISA " << static_cast<int>(isa);
+            }
+        }
+    }
+}
+
+TEST(AudioKernelsTest, InterleaveKernelsMatchScalar)
+{
+    constexpr int Frames = 1003;
+
+    for(const int size : {1, 2, 4, 8}) {
+        for(const int channels : {1, 2, 3, 6, 8, 10}) {
+            // Slice the planes from one buffer so each channel holds different samples
+            const auto input = randomSamples(SampleFormat::U8, Frames * channels * size);
+            const auto* samples = reinterpret_cast<const uint8_t*>(input.data());
+
+            std::vector<const uint8_t*> planes;
+            for(int ch{0}; ch < channels; ++ch) {
+                planes.push_back(samples + static_cast<ptrdiff_t>(ch * Frames * size));
+            }
+
+            const auto outSize = static_cast<size_t>(Frames * channels * size);
+
+            std::vector<std::byte> expected(outSize);
+            Audio::interleaveKernel(size, channels, Audio::KernelIsa::Scalar)(planes.data(), channels,
+                                                                              expected.data(), Frames);
+
+            // Last sample of the last channel
+            EXPECT_EQ(0, std::memcmp(expected.data() + outSize - static_cast<size_t>(size), planes.back() + ((Frames - 1) * size),
+                                     static_cast<size_t>(size)));
+
+            for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+                std::vector<std::byte> output(outSize);
+                Audio::interleaveKernel(size, channels, isa)(planes.data(), channels, output.data(), Frames);
+                EXPECT_EQ(expected, output)
+                    << "Size " << size << ", channels " << channels << ", ISA " << static_cast<int>(isa);
+            }
+        }
+    }
+}
+
+TEST(AudioKernelsTest, RemapKernelsMatchScalar)
+{
+    constexpr int Frames = 1003;
+
+    for(const auto format : SampleFormats) {
+        const int size = sampleSize(format);
+
+        for(const auto& [inChannels, outChannels] : {std::pair{1, 2}, std::pair{2, 1}}) {
+            const auto input   = randomSamples(format, Frames * inChannels);
+            const auto outSize = static_cast<size_t>(Frames * outChannels * size);
+
+            std::vector<std::byte> expected(outSize);
+            Audio::remapKernel(format, inChannels, outChannels, Audio::KernelIsa::Scalar)(input.data(),
+                                                                                         expected.data(), Frames);
+
+            for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+                std::vector<std::byte> output(outSize);
+                Audio::remapKernel(format, inChannels, outChannels, isa)(input.data(), output.data(), Frames);
+                EXPECT_EQ(expected, output) << "Format " << static_cast<int>(format) << ", " << inChannels << " to "
+                                            << outChannels << " channels, ISA " << static_cast<int>(isa);
+            }
+        }
+    }
+
+    EXPECT_EQ(nullptr, Audio::remapKernel(SampleFormat::S16, 2, 6));
+}
+
+TEST(AudioKernelsTest, GainKernelsMatchScalar)
+{
+    constexpr int Count = 1029;
+
+    std::vector<float> gains(Count);
+    for(int i{0}; i < Count; ++i) {
+        gains.at(i) = 1.5F - (static_cast<float>(i) / Count);
+    }
+
+    for(const auto format : SampleFormats) {
+        const auto input = randomSamples(format, Count);
+        const auto size  = static_cast<size_t>(Count * sampleSize(format));
+
+        for(const double gain : {0.3, 0.999, 1.7}) {
+            std::vector<std::byte> expected{input.begin(), input.begin() + static_cast<ptrdiff_t>(size)};
+            Audio::gainKernel(format, Audio::KernelIsa::Scalar)(expected.data(), Count, gain);
+
+            for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+                std::vector<std::byte> output{input.begin(), input.begin() + static_cast<ptrdiff_t>(size)};
+                Audio::gainKernel(format, isa)(output.data(), Count, gain);
+                EXPECT_EQ(expected, output) << "Format " << static_cast<int>(format) << ", gain " << gain
+                                            << ", ISA " << static_cast<int>(isa);
+            }
+        }
+
+        std::vector<std::byte> expected{input.begin(), input.begin() + static_cast<ptrdiff_t>(size)};
+        Audio::gainRampKernel(format, Audio::KernelIsa::Scalar)(expected.data(), gains.data(), Count);
+
+        for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+            std::vector<std::byte> output{input.begin(), input.begin() + static_cast<ptrdiff_t>(size)};
+            Audio::gainRampKernel(format, isa)(output.data(), gains.data(), Count);
+            EXPECT_EQ(expected, output) << "Ramp, format " << static_cast<int>(format) << ", ISA "
+                                        << static_cast<int>(isa);
+        }
+    }
+}
+
+TEST(AudioKernelsTest, MixKernelsMatchScalar)
+{
+    constexpr int Count = 1029;
+
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<float> dist{-1.0F, 1.0F};
+
+    std::vector<float> outgoing(Count);
+    std::vector<float> incoming(Count);
+    std::vector<float> outGains(Count);
+    std::vector<float> inGains(Count);
+    for(int i{0}; i < Count; ++i) {
+        outgoing.at(i) = dist(gen);
+        incoming.at(i) = dist(gen);
+        outGains.at(i) = 1.0F - (static_cast<float>(i) / Count);
+        inGains.at(i)  = static_cast<float>(i) / Count;
+    }
+
+    auto expected = outgoing;
+    Audio::mixKernel(Audio::KernelIsa::Scalar)(expected.data(), incoming.data(), outGains.data(), inGains.data(),
+                                               Count);
+
+    for(const auto isa : {Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+        auto output = outgoing;
+        Audio::mixKernel(isa)(output.data(), incoming.data(), outGains.data(), inGains.data(), Count);
+        for(int i{0}; i < Count; ++i) {
+            EXPECT_FLOAT_EQ(expected.at(i), output.at(i)) << "Sample " << i << ", ISA " << static_cast<int>(isa);
+        }
+    }
+}
+
+TEST(AudioKernelsTest, GainSaturates)
+{
+    std::array<int16_t, 4> samples{std::numeric_limits<int16_t>::min(), -20000, 20000,
+                                   std::numeric_limits<int16_t>::max()};
+
+    const AudioFormat format{SampleFormat::S16, 44100, 2};
+    Audio::applyGain(format, reinterpret_cast<std::byte*>(samples.data()), 4, 2.0);
+
+    const std::array<int16_t, 4> expected{std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::min(),
+                                          std::numeric_limits<int16_t>::max(), std::numeric_limits<int16_t>::max()};
+    EXPECT_EQ(expected, samples);
+}
+
+TEST(AudioKernelsTest, GainRampSpansBuffers)
+{
+    constexpr int Frames = 100;
+
+    const AudioFormat format{SampleFormat::Float, 44100, 2};
+
+    for(const auto shape : {Audio::RampShape::Linear, Audio::RampShape::Logarithmic}) {
+        Audio::GainRamp ramp{1.0};
+        ramp.rampTo(0.0, Frames, shape);
+
+        // Process the ramp in uneven chunks, with frames left over afterwards
+        std::vector<float> samples(static_cast<size_t>(Frames + 10) * 2, 1.0F);
+        auto* data = reinterpret_cast<std::byte*>(samples.data());
+        for(int offset{0}, chunk{1}; offset < Frames + 10; offset += chunk, chunk += 7) {
+            chunk = std::min(chunk, Frames + 10 - offset);
+            ramp.process(format, data + format.bytesForFrames(offset), chunk);
+        }
+
+        EXPECT_FALSE(ramp.isRamping());
+        EXPECT_EQ(0.0, ramp.gain());
+
+        for(int i{0}; i < Frames + 10; ++i) {
+            // Both channels of a frame share a gain, which only ever falls
+            EXPECT_EQ(samples.at(i * 2), samples.at((i * 2) + 1));
+            if(i > 0) {
+                EXPECT_LE(samples.at(i * 2), samples.at((i - 1) * 2));
+            }
+        }
+        EXPECT_LT(samples.front(), 1.0F);
+        EXPECT_EQ(0.0F, samples.at((Frames - 1) * 2));
+        EXPECT_EQ(0.0F, samples.back());
+    }
+}
+
+TEST(AudioKernelsTest, FullScaleRoundTrip)
+{
+    const std::array<int16_t, 4> input{std::numeric_limits<int16_t>::min(), -1, 0, std::numeric_limits<int16_t>::max()};
+    std::array<float, 4> floats{};
+    std::array<int16_t, 4> output{};
+
+    const AudioFormat s16Format{SampleFormat::S16, 44100, 2};
+    const AudioFormat floatFormat{SampleFormat::Float, 44100, 2};
+
+    ASSERT_TRUE(Audio::convert(s16Format, reinterpret_cast<const std::byte*>(input.data()), floatFormat,
+                               reinterpret_cast<std::byte*>(floats.data()), 2));
+    ASSERT_TRUE(Audio::convert(floatFormat, reinterpret_cast<const std::byte*>(floats.data()), s16Format,
+                               reinterpret_cast<std::byte*>(output.data()), 2));
+
+    EXPECT_FLOAT_EQ(-1.0F, floats.front());
+    EXPECT_EQ(input, output);
+}
+
+TEST(AudioKernelsTest, MonoToStereo)
+{
+    const std::array<int16_t, 2> input{100, -100};
+    std::array<int16_t, 4> output{};
+
+    const AudioFormat monoFormat{SampleFormat::S16, 44100, 1};
+    const AudioFormat stereoFormat{SampleFormat::S16, 44100, 2};
+
+    ASSERT_TRUE(Audio::convert(monoFormat, reinterpret_cast<const std::byte*>(input.data()), stereoFormat,
+                               reinterpret_cast<std::byte*>(output.data()), 2));
+
+    const std::array<int16_t, 4> expected{100, 100, -100, -100};
+    EXPECT_EQ(expected, output);
+}
+
+TEST(AudioKernelsTest, StereoToMono)
+{
+    const std::array<int16_t, 6> input{100, -100, 32767, 32767, -32768, -32767};
+    std::array<int16_t, 3> output{};
+
+    const AudioFormat stereoFormat{SampleFormat::S16, 44100, 2};
+    const AudioFormat monoFormat{SampleFormat::S16, 44100, 1};
+
+    ASSERT_TRUE(Audio::convert(stereoFormat, reinterpret_cast<const std::byte*>(input.data()), monoFormat,
+                               reinterpret_cast<std::byte*>(output.data()), 3));
+
+    // Both channels are averaged, rounding halves up
+    const std::array<int16_t, 3> expected{0, 32767, -32767};
+    EXPECT_EQ(expected, output);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,205 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audioringbuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+const Fooyin::AudioFormat Format{Fooyin::SampleFormat::S16, 1000, 2};
+
+// Fills each frame with its index, so frames read can be checked against markers
+std::vector<std::byte> framesFrom(int first, int count)
+{
+    std::vector<std::byte> frames(static_cast<size_t>(count * Format.bytesPerFrame()));
+    for(int i{0}; i < count; ++i) {
+        const std::array<int16_t, 2> frame{static_cast<int16_t>(first + i), static_cast<int16_t>(first + i)};
+        std::memcpy(frames.data() + static_cast<ptrdiff_t>(i * Format.bytesPerFrame()), frame.data(), sizeof(frame));
+    }
+    return frames;
+}
+
+int16_t frameAt(const std::vector<std::byte>& frames, int index)
+{
+    int16_t sample{0};
+    std::memcpy(&sample, frames.data() + static_cast<ptrdiff_t>(index * Format.bytesPerFrame()), sizeof(sample));
+    return sample;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AudioRingBufferTest, ReadsStopAtMarkers)
+{
+    AudioRingBuffer buffer;
+    buffer.init(Format, 1000);
+
+    ASSERT_TRUE(buffer.writeTrackStart(0));
+    ASSERT_EQ(10, buffer.writeFrames(framesFrom(0, 10).data(), 10));
+    ASSERT_TRUE(buffer.writeMarker(10));
+    ASSERT_EQ(5, buffer.writeFrames(framesFrom(10, 5).data(), 5));
+    ASSERT_TRUE(buffer.writeEndOfTrack());
+
+    std::vector<std::byte> output(static_cast<size_t>(100 * Format.bytesPerFrame()));
+
+    // Nothing can be read past a marker which hasn't been taken
+    EXPECT_EQ(0, buffer.readFrames(output.data(), 100));
+
+    AudioRingBuffer::Marker marker;
+    ASSERT_TRUE(buffer.takeMarker(marker));
+    EXPECT_TRUE(marker.trackStart);
+    EXPECT_EQ(0, marker.startTime);
+
+    // The next marker isn't due until its frames have been read
+    AudioRingBuffer::Marker early;
+    EXPECT_FALSE(buffer.takeMarker(early));
+
+    EXPECT_EQ(10, buffer.readFrames(output.data(), 100));
+    EXPECT_EQ(9, frameAt(output, 9));
+
+    ASSERT_TRUE(buffer.takeMarker(marker));
+    EXPECT_FALSE(marker.trackStart);
+    EXPECT_FALSE(marker.endOfTrack);
+    EXPECT_EQ(10, marker.startTime);
+
+    EXPECT_EQ(5, buffer.readFrames(output.data(), 100));
+    EXPECT_EQ(10, frameAt(output, 0));
+
+    ASSERT_TRUE(buffer.takeMarker(marker));
+    EXPECT_TRUE(marker.endOfTrack);
+
+    EXPECT_FALSE(buffer.takeMarker(marker));
+    EXPECT_EQ(0, buffer.framesAvailable());
+}
+
+TEST(AudioRingBufferTest, WritesWholeFrames)
+{
+    AudioRingBuffer buffer;
+    buffer.init(Format, 200);
+
+    const int capacity = buffer.capacity();
+    ASSERT_GT(capacity, 0);
+
+    const auto input = framesFrom(0, capacity + 10);
+    EXPECT_EQ(capacity, buffer.writeFrames(input.data(), capacity + 10));
+    EXPECT_EQ(capacity, buffer.framesAvailable());
+    EXPECT_EQ(200, buffer.bufferedDuration());
+}
+
+TEST(AudioRingBufferTest, ClearFromConsumer)
+{
+    AudioRingBuffer buffer;
+    buffer.init(Format, 1000);
+
+    buffer.writeMarker(0);
+    buffer.writeFrames(framesFrom(0, 20).data(), 20);
+    buffer.writeEndOfTrack();
+
+    buffer.clear();
+    EXPECT_EQ(0, buffer.framesAvailable());
+
+    AudioRingBuffer::Marker marker;
+    EXPECT_FALSE(buffer.takeMarker(marker));
+
+    // Anything written afterwards is read as normal
+    buffer.writeMarker(500);
+    buffer.writeFrames(framesFrom(500, 5).data(), 5);
+
+    ASSERT_TRUE(buffer.takeMarker(marker));
+    EXPECT_EQ(500, marker.startTime);
+
+    std::vector<std::byte> output(static_cast<size_t>(5 * Format.bytesPerFrame()));
+    EXPECT_EQ(5, buffer.readFrames(output.data(), 5));
+    EXPECT_EQ(500, frameAt(output, 0));
+}
+
+TEST(AudioRingBufferTest, MarkersStayInOrderAcrossThreads)
+{
+    static constexpr int Total     = 20000;
+    static constexpr int ChunkSize = 37;
+
+    AudioRingBuffer buffer;
+    buffer.init(Format, 200);
+
+    // Each chunk is preceded by a marker holding the index of its first frame
+    std::thread producer{[&buffer]() {
+        for(int frame{0}; frame < Total; frame += ChunkSize) {
+            const int count = std::min(ChunkSize, Total - frame);
+
+            while(!buffer.writeMarker(static_cast<uint64_t>(frame))) {
+                buffer.waitForSpace(0, true);
+            }
+
+            const auto chunk = framesFrom(frame, count);
+            int written{0};
+            while(written < count) {
+                buffer.waitForSpace(count - written);
+                written += buffer.writeFrames(chunk.data() + static_cast<ptrdiff_t>(written * Format.bytesPerFrame()),
+                                              count - written);
+            }
+        }
+        while(!buffer.writeEndOfTrack()) {
+            buffer.waitForSpace(0, true);
+        }
+    }};
+
+    std::vector<std::byte> output(static_cast<size_t>(100 * Format.bytesPerFrame()));
+    int read{0};
+    int markers{0};
+    int mismatches{0};
+    bool ended{false};
+
+    while(!ended) {
+        AudioRingBuffer::Marker marker;
+        if(buffer.takeMarker(marker)) {
+            if(marker.endOfTrack) {
+                ended = true;
+            }
+            else {
+                mismatches += std::cmp_equal(marker.startTime, read) ? 0 : 1;
+                ++markers;
+            }
+            continue;
+        }
+
+        const int count = buffer.readFrames(output.data(), 100);
+        for(int i{0}; i < count; ++i) {
+            mismatches += frameAt(output, i) == static_cast<int16_t>(read + i) ? 0 : 1;
+        }
+        read += count;
+
+        if(count == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    EXPECT_EQ(0, mismatches);
+    EXPECT_EQ(Total, read);
+    EXPECT_EQ((Total + ChunkSize - 1) / ChunkSize, markers);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,199 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/dspchain.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace {
+class GainNode : public Fooyin::DspNode
+{
+public:
+    explicit GainNode(float gain, int latency = 0)
+        : m_gain{gain}
+        , m_latency{latency}
+    { }
+
+    [[nodiscard]] QString name() const override
+    {
+        return QStringLiteral("Gain");
+    }
+
+    bool prepare(const Fooyin::AudioFormat& format, int maxFrames) override
+    {
+        m_channels  = format.channelCount();
+        m_maxFrames = maxFrames;
+        return format.sampleFormat() == Fooyin::SampleFormat::Float;
+    }
+
+    void process(float* data, int frames) override
+    {
+        EXPECT_LE(frames, m_maxFrames);
+        for(int i{0}; i < frames * m_channels; ++i) {
+            data[i] *= m_gain;
+        }
+        ++blocks;
+    }
+
+    [[nodiscard]] int latency() const override
+    {
+        return m_latency;
+    }
+
+    void reset() override
+    {
+        ++resets;
+    }
+
+    int blocks{0};
+    int resets{0};
+
+private:
+    float m_gain;
+    int m_latency;
+    int m_channels{0};
+    int m_maxFrames{0};
+};
+
+class RejectingNode : public GainNode
+{
+public:
+    RejectingNode()
+        : GainNode{0.0F}
+    { }
+
+    bool prepare(const Fooyin::AudioFormat& /*format*/, int /*maxFrames*/) override
+    {
+        return false;
+    }
+};
+
+template <typename T>
+Fooyin::AudioBuffer makeBuffer(const std::vector<T>& samples, const Fooyin::AudioFormat& format)
+{
+    return {reinterpret_cast<const uint8_t*>(samples.data()), samples.size() * sizeof(T), format, 0};
+}
+
+template <typename T>
+std::vector<T> samplesOf(const Fooyin::AudioBuffer& buffer)
+{
+    std::vector<T> samples(buffer.byteCount() / sizeof(T));
+    std::memcpy(samples.data(), buffer.constData().data(), buffer.byteCount());
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(DspChainTest, ProcessesFloatInBlocks)
+{
+    const AudioFormat format{SampleFormat::Float, 48000, 2};
+
+    DspChain chain{64};
+    auto node      = std::make_unique<GainNode>(0.5F);
+    auto* gainNode = node.get();
+    chain.prepare(format);
+
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    nodes.push_back(std::move(node));
+    chain.setNodes(std::move(nodes));
+    EXPECT_FALSE(chain.isEmpty());
+
+    // 150 frames is split into blocks of 64, 64 and 22
+    const std::vector<float> input(300, 0.8F);
+    auto buffer = makeBuffer(input, format);
+    chain.process(buffer);
+
+    EXPECT_EQ(gainNode->blocks, 3);
+    for(const float sample : samplesOf<float>(buffer)) {
+        EXPECT_FLOAT_EQ(sample, 0.4F);
+    }
+
+    const auto stats = chain.stats();
+    ASSERT_EQ(stats.size(), 1);
+    EXPECT_EQ(stats.front().name, QStringLiteral("Gain"));
+    EXPECT_EQ(stats.front().frames, 150);
+}
+
+TEST(DspChainTest, ConvertsIntegerFormats)
+{
+    const AudioFormat format{SampleFormat::S16, 44100, 1};
+
+    DspChain chain;
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    nodes.push_back(std::make_unique<GainNode>(0.5F));
+    chain.setNodes(std::move(nodes));
+    chain.prepare(format);
+
+    const std::vector<int16_t> input{16384, -16384, 0, 8192};
+    auto buffer = makeBuffer(input, format);
+    chain.process(buffer);
+
+    EXPECT_EQ(buffer.format(), format);
+    EXPECT_EQ(samplesOf<int16_t>(buffer), (std::vector<int16_t>{8192, -8192, 0, 4096}));
+
+    // Buffers in any other format are left alone
+    const AudioFormat otherFormat{SampleFormat::S16, 48000, 1};
+    auto other = makeBuffer(input, otherFormat);
+    chain.process(other);
+    EXPECT_EQ(samplesOf<int16_t>(other), input);
+}
+
+TEST(DspChainTest, BypassesUnpreparedStages)
+{
+    const AudioFormat format{SampleFormat::Float, 48000, 2};
+
+    DspChain chain;
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    nodes.push_back(std::make_unique<RejectingNode>());
+    nodes.push_back(std::make_unique<GainNode>(1.0F, 480));
+    nodes.push_back(std::make_unique<GainNode>(1.0F, 960));
+    auto* last = static_cast<GainNode*>(nodes.back().get());
+    chain.setNodes(std::move(nodes));
+    chain.prepare(format);
+
+    EXPECT_EQ(chain.latencyFrames(), 1440);
+    EXPECT_EQ(chain.latency(), 30);
+
+    // A silenced stage would zero the samples if it were run
+    const std::vector<float> input(20, 1.0F);
+    auto buffer = makeBuffer(input, format);
+    chain.process(buffer);
+    EXPECT_EQ(samplesOf<float>(buffer), input);
+
+    chain.reset();
+    EXPECT_EQ(last->resets, 1);
+
+    const auto stats = chain.stats();
+    ASSERT_EQ(stats.size(), 3);
+    EXPECT_EQ(stats.at(0).frames, 0);
+    EXPECT_EQ(stats.at(2).frames, 10);
+}
+
+TEST(DspChainTest, EmptyChainIsBypassed)
+{
+    DspChain chain;
+    chain.prepare({SampleFormat::S32, 48000, 2});
+
+    EXPECT_TRUE(chain.isEmpty());
+    EXPECT_EQ(chain.latency(), 0);
+}
+} // namespace Fooyin::Testing
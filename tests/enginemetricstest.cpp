@@ -0,0 +1,91 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/enginemetrics.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace Fooyin::Testing {
+TEST(EngineMetricsTest, IgnoredWhileDisabled)
+{
+    EngineMetrics metrics;
+
+    metrics.recordUnderrun(100);
+    metrics.recordDecode(50us);
+    metrics.recordConversion();
+    metrics.recordBufferLevel(10);
+
+    const EngineStats stats = metrics.snapshot();
+    EXPECT_EQ(0, stats.underruns);
+    EXPECT_EQ(0, stats.decodedBuffers);
+    EXPECT_EQ(0, stats.conversions);
+    EXPECT_EQ(0, stats.bufferedFrames);
+}
+
+TEST(EngineMetricsTest, CountsWhileEnabled)
+{
+    EngineMetrics metrics;
+    metrics.setEnabled(true);
+
+    metrics.recordUnderrun(100);
+    metrics.recordUnderrun(20);
+    metrics.recordConversion();
+    metrics.recordBufferLevel(500);
+    metrics.recordBufferLevel(200);
+    metrics.recordBufferLevel(300);
+    metrics.recordOutputDelay(0.05);
+
+    const EngineStats stats = metrics.snapshot();
+    EXPECT_EQ(2, stats.underruns);
+    EXPECT_EQ(120, stats.underrunFrames);
+    EXPECT_EQ(1, stats.conversions);
+    EXPECT_EQ(300, stats.bufferedFrames);
+    EXPECT_EQ(200, stats.minBufferedFrames);
+    EXPECT_DOUBLE_EQ(0.05, stats.outputDelay);
+
+    // Re-enabling starts over
+    metrics.setEnabled(false);
+    metrics.setEnabled(true);
+    EXPECT_EQ(0, metrics.snapshot().underruns);
+}
+
+TEST(EngineMetricsTest, DecodeTimeHistogram)
+{
+    EngineMetrics metrics;
+    metrics.setEnabled(true);
+
+    metrics.recordDecode(0us);
+    metrics.recordDecode(3us);
+    metrics.recordDecode(1000us);
+    metrics.recordDecode(10s);
+
+    const EngineStats stats = metrics.snapshot();
+    EXPECT_EQ(4, stats.decodedBuffers);
+    EXPECT_EQ(10s, stats.maxDecodeTime);
+    EXPECT_EQ(10s + 1003us, stats.decodeTime);
+
+    // Bucket i counts times under 2^i µs
+    EXPECT_EQ(1, stats.decodeTimeHistogram.at(0));
+    EXPECT_EQ(1, stats.decodeTimeHistogram.at(2));
+    EXPECT_EQ(1, stats.decodeTimeHistogram.at(10));
+    EXPECT_EQ(1, stats.decodeTimeHistogram.back());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,107 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/ffmpeg/ffmpegresampler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numbers>
+#include <vector>
+
+namespace {
+Fooyin::AudioBuffer sineBuffer(const Fooyin::AudioFormat& format, int startFrame, int frames, uint64_t startTime)
+{
+    std::vector<int16_t> samples(static_cast<size_t>(frames) * format.channelCount());
+    for(int frame{0}; frame < frames; ++frame) {
+        const double phase = 2.0 * std::numbers::pi * 1000.0 * (startFrame + frame) / format.sampleRate();
+        for(int ch{0}; ch < format.channelCount(); ++ch) {
+            samples[(static_cast<size_t>(frame) * format.channelCount()) + ch]
+                = static_cast<int16_t>(std::lrint(16384.0 * std::sin(phase)));
+        }
+    }
+    return {reinterpret_cast<const uint8_t*>(samples.data()), samples.size() * sizeof(int16_t), format, startTime};
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(FFmpegResamplerTest, ConvertsRateAndFormat)
+{
+    const AudioFormat input{SampleFormat::S16, 44100, 2};
+    const AudioFormat output{SampleFormat::S32, 48000, 2};
+
+    FFmpegResampler resampler;
+    ASSERT_TRUE(resampler.init(input, output));
+    EXPECT_TRUE(resampler.isInitialised());
+
+    // One second, in 100ms buffers
+    int frames{0};
+    uint64_t lastStart{0};
+    for(int i{0}; i < 10; ++i) {
+        const auto buffer = resampler.process(sineBuffer(input, i * 4410, 4410, i * 100));
+        if(!buffer.isValid()) {
+            continue;
+        }
+        EXPECT_EQ(buffer.format(), output);
+        EXPECT_GE(buffer.startTime(), lastStart);
+        lastStart = buffer.startTime();
+        frames += buffer.frameCount();
+    }
+
+    const auto tail = resampler.flush();
+    if(tail.isValid()) {
+        frames += tail.frameCount();
+    }
+    EXPECT_FALSE(resampler.isInitialised());
+
+    EXPECT_NEAR(frames, 48000, 2);
+}
+
+TEST(FFmpegResamplerTest, PreservesLevel)
+{
+    const AudioFormat input{SampleFormat::S16, 48000, 1};
+    const AudioFormat output{SampleFormat::S16, 96000, 1};
+
+    FFmpegResampler resampler;
+    ASSERT_TRUE(resampler.init(input, output));
+
+    const auto buffer = resampler.process(sineBuffer(input, 0, 48000, 0));
+    ASSERT_TRUE(buffer.isValid());
+
+    const auto* samples = reinterpret_cast<const int16_t*>(buffer.constData().data());
+    int peak{0};
+    // Skip the filter's start up
+    for(int i{1000}; i < buffer.sampleCount(); ++i) {
+        peak = std::max(peak, std::abs(static_cast<int>(samples[i])));
+    }
+    EXPECT_NEAR(peak, 16384, 200);
+}
+
+TEST(FFmpegResamplerTest, RejectsUnsupportedFormats)
+{
+    FFmpegResampler resampler;
+
+    EXPECT_FALSE(resampler.init({SampleFormat::S16, 44100, 2}, {SampleFormat::S16, 48000, 1}));
+    EXPECT_FALSE(resampler.init({SampleFormat::Unknown, 44100, 2}, {SampleFormat::S16, 48000, 2}));
+    EXPECT_FALSE(resampler.isInitialised());
+    EXPECT_FALSE(resampler.process(sineBuffer({SampleFormat::S16, 44100, 2}, 0, 100, 0)).isValid());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/fft.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+namespace Fooyin::Testing {
+TEST(FftTest, MatchesDft)
+{
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<float> dist{-1.0F, 1.0F};
+
+    for(const int size : {4, 8, 16, 64, 1024}) {
+        std::vector<float> input(size);
+        for(float& sample : input) {
+            sample = dist(gen);
+        }
+
+        for(const auto isa : {Audio::KernelIsa::Scalar, Audio::KernelIsa::SSE2, Audio::KernelIsa::AVX2}) {
+            Audio::Fft fft{size, isa};
+            ASSERT_EQ(size / 2 + 1, fft.binCount());
+
+            std::vector<float> real(fft.binCount());
+            std::vector<float> imag(fft.binCount());
+            fft.forward(input.data(), real.data(), imag.data());
+
+            for(int k{0}; k < fft.binCount(); ++k) {
+                double expectedRe{0.0};
+                double expectedIm{0.0};
+                for(int n{0}; n < size; ++n) {
+                    const double angle = 2.0 * std::numbers::pi * k * n / size;
+                    expectedRe += input.at(n) * std::cos(angle);
+                    expectedIm -= input.at(n) * std::sin(angle);
+                }
+                EXPECT_NEAR(expectedRe, real.at(k), 1e-3) << "Size " << size << ", bin " << k;
+                EXPECT_NEAR(expectedIm, imag.at(k), 1e-3) << "Size " << size << ", bin " << k;
+            }
+        }
+    }
+}
+
+TEST(FftTest, SineFallsInOneBin)
+{
+    constexpr int Size = 512;
+    constexpr int Bin  = 40;
+
+    std::vector<float> input(Size);
+    for(int n{0}; n < Size; ++n) {
+        input.at(n) = static_cast<float>(std::sin(2.0 * std::numbers::pi * Bin * n / Size));
+    }
+
+    Audio::Fft fft{Size};
+    std::vector<float> magnitudes(fft.binCount());
+    fft.magnitudes(input.data(), magnitudes.data());
+
+    for(int k{0}; k < fft.binCount(); ++k) {
+        EXPECT_NEAR(k == Bin ? Size / 2.0 : 0.0, magnitudes.at(k), 1e-2) << "Bin " << k;
+    }
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,232 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/lockfreeringbuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+// Prime, so the pattern never lines up with the capacity and a misplaced byte is always caught
+constexpr int PatternLength = 251;
+
+uint8_t patternAt(uint64_t pos)
+{
+    return static_cast<uint8_t>(pos % PatternLength);
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(LockFreeRingBufferTest, WrapsAround)
+{
+    LockFreeRingBuffer<int> buffer{8};
+
+    std::array<int, 6> input{};
+    std::iota(input.begin(), input.end(), 0);
+
+    // Leave the positions part way through, so the next write and read span the end
+    ASSERT_EQ(6, buffer.write(input.data(), 6));
+    std::array<int, 6> output{};
+    ASSERT_EQ(6, buffer.read(output.data(), 6));
+    EXPECT_EQ(input, output);
+
+    std::iota(input.begin(), input.end(), 10);
+    EXPECT_EQ(6, buffer.write(input.data(), 6));
+    EXPECT_EQ(6, buffer.readAvailable());
+    EXPECT_EQ(2, buffer.writeAvailable());
+
+    output = {};
+    EXPECT_EQ(6, buffer.read(output.data(), 6));
+    EXPECT_EQ(input, output);
+    EXPECT_EQ(12, buffer.readPosition());
+    EXPECT_EQ(12, buffer.writePosition());
+}
+
+TEST(LockFreeRingBufferTest, WritesOnlyWhatFits)
+{
+    LockFreeRingBuffer<int> buffer{4};
+
+    const std::array<int, 6> input{1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(4, buffer.write(input.data(), input.size()));
+    EXPECT_EQ(0, buffer.write(input.data(), input.size()));
+    EXPECT_EQ(0, buffer.writeAvailable());
+
+    std::array<int, 6> output{};
+    EXPECT_EQ(4, buffer.read(output.data(), output.size()));
+    EXPECT_EQ((std::array<int, 6>{1, 2, 3, 4, 0, 0}), output);
+    EXPECT_EQ(0, buffer.read(output.data(), output.size()));
+}
+
+TEST(LockFreeRingBufferTest, PeekAndSkip)
+{
+    LockFreeRingBuffer<int> buffer{4};
+
+    // Start two items in, so peeking spans the end of the buffer
+    const std::array<int, 2> padding{};
+    buffer.write(padding.data(), padding.size());
+    buffer.skip(padding.size());
+
+    const std::array<int, 4> input{1, 2, 3, 4};
+    buffer.write(input.data(), input.size());
+
+    std::array<int, 3> peeked{};
+    EXPECT_EQ(3, buffer.peek(peeked.data(), peeked.size()));
+    EXPECT_EQ((std::array<int, 3>{1, 2, 3}), peeked);
+    // Peeking doesn't consume anything
+    EXPECT_EQ(4, buffer.readAvailable());
+
+    EXPECT_EQ(3, buffer.skip(3));
+    EXPECT_EQ(1, buffer.readAvailable());
+    EXPECT_EQ(1, buffer.skip(10));
+
+    int last{0};
+    EXPECT_EQ(0, buffer.peek(&last, 1));
+}
+
+TEST(LockFreeRingBufferTest, ClearFromConsumer)
+{
+    LockFreeRingBuffer<int> buffer{4};
+
+    const std::array<int, 3> input{1, 2, 3};
+    buffer.write(input.data(), input.size());
+
+    buffer.clear();
+    EXPECT_EQ(0, buffer.readAvailable());
+    EXPECT_EQ(4, buffer.writeAvailable());
+    // Positions carry on from where they were, so earlier offsets stay comparable
+    EXPECT_EQ(3, buffer.readPosition());
+    EXPECT_EQ(3, buffer.writePosition());
+
+    const std::array<int, 4> next{5, 6, 7, 8};
+    EXPECT_EQ(4, buffer.write(next.data(), next.size()));
+
+    std::array<int, 4> output{};
+    EXPECT_EQ(4, buffer.read(output.data(), output.size()));
+    EXPECT_EQ(next, output);
+}
+
+TEST(LockFreeRingBufferTest, WaitForSpaceWakesOnRead)
+{
+    LockFreeRingBuffer<int> buffer{4};
+
+    const std::array<int, 4> input{1, 2, 3, 4};
+    buffer.write(input.data(), input.size());
+
+    auto waiting = std::async(std::launch::async, [&buffer]() { return buffer.waitForSpace(2); });
+    EXPECT_EQ(std::future_status::timeout, waiting.wait_for(20ms));
+
+    std::array<int, 2> output{};
+    buffer.read(output.data(), output.size());
+
+    ASSERT_EQ(std::future_status::ready, waiting.wait_for(5s));
+    EXPECT_TRUE(waiting.get());
+}
+
+TEST(LockFreeRingBufferTest, WaitForSpaceWakesOnInterrupt)
+{
+    LockFreeRingBuffer<int> buffer{4};
+
+    const std::array<int, 4> input{1, 2, 3, 4};
+    buffer.write(input.data(), input.size());
+
+    auto waiting = std::async(std::launch::async, [&buffer]() { return buffer.waitForSpace(1); });
+
+    // An interrupt before the producer starts waiting is missed, so keep going until it returns
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while(waiting.wait_for(1ms) != std::future_status::ready && std::chrono::steady_clock::now() < deadline) {
+        buffer.interrupt();
+    }
+
+    ASSERT_EQ(std::future_status::ready, waiting.wait_for(0ms));
+    // Nothing was read, so there's still no space
+    EXPECT_FALSE(waiting.get());
+}
+
+TEST(LockFreeRingBufferTest, TwoThreadStress)
+{
+    constexpr uint64_t Total = 4 * 1024 * 1024;
+
+    // Not a power of two, so wrapping never lines up with the chunk sizes
+    LockFreeRingBuffer<uint8_t> buffer{1000};
+
+    std::thread producer{[&buffer]() {
+        std::array<uint8_t, 384> chunk{};
+        uint64_t written{0};
+        size_t size{1};
+
+        while(written < Total) {
+            size = (size * 7 % chunk.size()) + 1;
+            const auto count = static_cast<size_t>(std::min<uint64_t>(size, Total - written));
+            for(size_t i{0}; i < count; ++i) {
+                chunk.at(i) = patternAt(written + i);
+            }
+
+            size_t sent{0};
+            while(sent < count) {
+                buffer.waitForSpace(count - sent);
+                sent += buffer.write(chunk.data() + sent, count - sent);
+            }
+            written += count;
+        }
+    }};
+
+    std::array<uint8_t, 512> chunk{};
+    uint64_t read{0};
+    size_t size{1};
+    uint64_t mismatches{0};
+
+    while(read < Total) {
+        size = (size * 13 % chunk.size()) + 1;
+
+        // Alternate between reading and peeking then skipping, which should see the same bytes
+        size_t count{0};
+        if(size % 2 == 0) {
+            count = buffer.read(chunk.data(), size);
+        }
+        else {
+            count = buffer.peek(chunk.data(), size);
+            EXPECT_EQ(count, buffer.skip(count));
+        }
+
+        for(size_t i{0}; i < count; ++i) {
+            mismatches += chunk.at(i) != patternAt(read + i) ? 1 : 0;
+        }
+        read += count;
+
+        if(count == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    EXPECT_EQ(0, mismatches);
+    EXPECT_EQ(Total, buffer.readPosition());
+    EXPECT_EQ(Total, buffer.writePosition());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,122 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/loudness.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+std::vector<float> sine(int sampleRate, int channels, double seconds, double freq, double dbfs, double phase = 0.0)
+{
+    const double amplitude = std::pow(10.0, dbfs / 20.0);
+    const auto frames      = static_cast<int>(sampleRate * seconds);
+
+    std::vector<float> samples(static_cast<size_t>(frames) * channels);
+    for(int frame{0}; frame < frames; ++frame) {
+        const auto sample = static_cast<float>(
+            amplitude * std::sin((2.0 * std::numbers::pi * freq * frame / sampleRate) + phase));
+        for(int ch{0}; ch < channels; ++ch) {
+            samples[(static_cast<size_t>(frame) * channels) + ch] = sample;
+        }
+    }
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(LoudnessTest, MeasuresReferenceTone)
+{
+    // EBU Tech 3341 test signal 1: a stereo 1kHz sine at -23dBFS reads -23 LUFS
+    for(const int sampleRate : {44100, 48000}) {
+        const auto samples = sine(sampleRate, 2, 20.0, 1000.0, -23.0);
+
+        LoudnessMeter meter{sampleRate, 2};
+        meter.process(samples.data(), static_cast<int>(samples.size() / 2));
+
+        EXPECT_NEAR(meter.integratedLoudness(), -23.0, 0.1);
+        EXPECT_NEAR(20.0 * std::log10(meter.truePeak()), -23.0, 0.1);
+    }
+}
+
+TEST(LoudnessTest, GatesQuietPassages)
+{
+    LoudnessMeter meter{48000, 2};
+
+    // The quiet section is more than 10 LU down, so shouldn't pull the result down
+    const auto loud  = sine(48000, 2, 10.0, 1000.0, -20.0);
+    const auto quiet = sine(48000, 2, 10.0, 1000.0, -40.0);
+    meter.process(loud.data(), static_cast<int>(loud.size() / 2));
+    meter.process(quiet.data(), static_cast<int>(quiet.size() / 2));
+
+    EXPECT_NEAR(meter.integratedLoudness(), -20.0, 0.1);
+
+    LoudnessMeter silent{48000, 2};
+    const std::vector<float> silence(48000 * 2 * 5, 0.0F);
+    silent.process(silence.data(), 48000 * 5);
+
+    EXPECT_TRUE(std::isinf(silent.integratedLoudness()));
+    EXPECT_EQ(silent.truePeak(), 0.0);
+
+    // Blocks from several meters combine into a single measurement
+    std::vector<double> album = meter.blocks();
+    album.insert(album.end(), silent.blocks().cbegin(), silent.blocks().cend());
+    EXPECT_DOUBLE_EQ(LoudnessMeter::integratedLoudness(album), meter.integratedLoudness());
+}
+
+TEST(LoudnessTest, FindsInterSamplePeaks)
+{
+    // A quarter sample rate sine offset by 45 degrees never has a sample at its peak
+    const auto samples = sine(48000, 1, 1.0, 12000.0, -6.0, std::numbers::pi / 4);
+
+    LoudnessMeter meter{48000, 1};
+    meter.process(samples.data(), static_cast<int>(samples.size()));
+
+    EXPECT_NEAR(20.0 * std::log10(meter.truePeak()), -6.0, 0.2);
+}
+
+TEST(LoudnessTest, VectorMatchesScalar)
+{
+    // An odd channel count covers both the paired and leftover channel paths
+    constexpr int Channels = 5;
+
+    std::vector<float> samples(static_cast<size_t>(44100) * 3 * Channels);
+    for(size_t i{0}; i < samples.size(); ++i) {
+        samples[i] = static_cast<float>(std::sin(static_cast<double>(i) * 0.013) * ((i % 7) / 7.0));
+    }
+
+    LoudnessMeter scalar{44100, Channels, Audio::KernelIsa::Scalar};
+    LoudnessMeter vector{44100, Channels};
+
+    // Uneven chunks, so sub-blocks straddle calls
+    for(size_t pos{0}; pos < samples.size();) {
+        const auto frames = static_cast<int>(std::min<size_t>(1237, (samples.size() - pos) / Channels));
+        scalar.process(samples.data() + pos, frames);
+        vector.process(samples.data() + pos, frames);
+        pos += static_cast<size_t>(frames) * Channels;
+    }
+
+    ASSERT_EQ(scalar.blocks().size(), vector.blocks().size());
+    EXPECT_NEAR(scalar.integratedLoudness(), vector.integratedLoudness(), 1e-9);
+    EXPECT_NEAR(scalar.truePeak(), vector.truePeak(), 1e-6);
+}
+} // namespace Fooyin::Testing
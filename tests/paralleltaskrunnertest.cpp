@@ -0,0 +1,102 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/paralleltaskrunner.h>
+#include <utils/worker.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace Fooyin::Testing {
+TEST(ParallelTaskRunnerTest, ProcessesEveryItemOnce)
+{
+    Worker owner;
+    owner.setState(Worker::Running);
+
+    constexpr size_t Count = 1000;
+    std::vector<std::atomic<int>> processed(Count);
+    std::atomic<int> started{0};
+    std::atomic<int> finished{0};
+
+    const ParallelTaskRunner runner{&owner, 10};
+    runner.run(Count, {.start =
+                           [&started](int /*worker*/) {
+                               ++started;
+                               return true;
+                           },
+                       .process = [&processed](size_t index, int /*worker*/) { ++processed.at(index); },
+                       .finish  = [&finished](int /*worker*/) { ++finished; }});
+
+    for(const auto& count : processed) {
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_EQ(started, ParallelTaskRunner::workerCount(Count));
+    EXPECT_EQ(finished, started);
+}
+
+TEST(ParallelTaskRunnerTest, LeavesItemsToWorkersWhichStart)
+{
+    Worker owner;
+    owner.setState(Worker::Running);
+
+    constexpr size_t Count = 100;
+    std::atomic<size_t> processed{0};
+
+    // Only the first worker starts, so it takes every item
+    const ParallelTaskRunner runner{&owner, 10};
+    runner.run(Count, {.start   = [](int worker) { return worker == 0; },
+                       .process = [&processed](size_t /*index*/, int worker) {
+                           EXPECT_EQ(worker, 0);
+                           ++processed;
+                       }});
+
+    EXPECT_EQ(processed, Count);
+}
+
+TEST(ParallelTaskRunnerTest, StopsWhenOwnerStops)
+{
+    Worker owner;
+    owner.setState(Worker::Running);
+
+    constexpr size_t Count = 100000;
+    std::atomic<size_t> processed{0};
+
+    const ParallelTaskRunner runner{&owner, 10};
+    runner.run(Count, {.process = [&owner, &processed](size_t /*index*/, int /*worker*/) {
+                   if(++processed == 10) {
+                       owner.stopThread();
+                   }
+               }});
+
+    // Items already taken by other workers are still processed
+    EXPECT_LT(processed, Count);
+}
+
+TEST(ParallelTaskRunnerTest, CollectsResultsInBatches)
+{
+    ParallelResults<int> results;
+    results.add(1);
+    results.add(std::vector<int>{2, 3});
+
+    EXPECT_EQ(results.take(), (std::vector<int>{1, 2, 3}));
+    EXPECT_TRUE(results.take().empty());
+}
+} // namespace Fooyin::Testing
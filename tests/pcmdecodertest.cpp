@@ -0,0 +1,280 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/pcmdecoder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+class PcmDecoderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Unique to the process and test, so parallel runs don't share a file
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        m_path                 = std::filesystem::temp_directory_path()
+               / ("fooyin_pcmdecoder_test_" + std::to_string(::getpid()) + "_" + name + ".bin");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(m_path);
+    }
+
+    [[nodiscard]] QString source() const
+    {
+        return QString::fromStdString(m_path.string());
+    }
+
+    void writeFile(const std::vector<uint8_t>& data) const
+    {
+        std::ofstream file{m_path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    static void append(std::vector<uint8_t>& data, const char* id)
+    {
+        data.insert(data.end(), id, id + 4);
+    }
+
+    static void appendLE(std::vector<uint8_t>& data, uint32_t value, int bytes)
+    {
+        for(int i{0}; i < bytes; ++i) {
+            data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    static void appendBE(std::vector<uint8_t>& data, uint32_t value, int bytes)
+    {
+        for(int i{bytes - 1}; i >= 0; --i) {
+            data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    // 16bit stereo, with each sample holding its index
+    void writeWav(int frames, uint16_t formatTag = 1, uint32_t junkSize = 1) const
+    {
+        const uint32_t dataSize = frames * 4;
+        const uint32_t junkPad  = junkSize & 1;
+
+        std::vector<uint8_t> data;
+        append(data, "RIFF");
+        appendLE(data, 4 + 8 + 16 + 8 + dataSize + 8 + junkSize + junkPad, 4);
+        append(data, "WAVE");
+        // An unknown chunk, which is padded if it has an odd size
+        append(data, "junk");
+        appendLE(data, junkSize, 4);
+        data.insert(data.end(), junkSize + junkPad, 0);
+        append(data, "fmt ");
+        appendLE(data, 16, 4);
+        appendLE(data, formatTag, 2);
+        appendLE(data, 2, 2);
+        appendLE(data, 44100, 4);
+        appendLE(data, 44100 * 4, 4);
+        appendLE(data, 4, 2);
+        appendLE(data, 16, 2);
+        append(data, "data");
+        appendLE(data, dataSize, 4);
+        for(int i{0}; i < frames * 2; ++i) {
+            appendLE(data, i, 2);
+        }
+
+        writeFile(data);
+    }
+
+    std::filesystem::path m_path;
+};
+} // namespace
+
+namespace Fooyin::Testing {
+TEST_F(PcmDecoderTest, ReadsWav)
+{
+    constexpr int Frames = 10000;
+    writeWav(Frames);
+
+    ASSERT_TRUE(PcmDecoder::canDecode(source()));
+
+    PcmDecoder decoder;
+    ASSERT_TRUE(decoder.init(source()));
+    EXPECT_EQ(decoder.format(), AudioFormat(SampleFormat::S16, 44100, 2));
+    EXPECT_TRUE(decoder.isSeekable());
+
+    decoder.start();
+
+    std::vector<int16_t> samples;
+    uint64_t expectedStart{0};
+
+    while(true) {
+        const AudioBuffer buffer = decoder.readBuffer();
+        if(!buffer.isValid()) {
+            break;
+        }
+
+        EXPECT_EQ(buffer.startTime(), expectedStart);
+        expectedStart = (static_cast<uint64_t>(samples.size() / 2) + buffer.frameCount()) * 1000 / 44100;
+
+        const auto* data = reinterpret_cast<const int16_t*>(buffer.constData().data());
+        samples.insert(samples.end(), data, data + buffer.sampleCount());
+    }
+
+    ASSERT_EQ(samples.size(), static_cast<size_t>(Frames * 2));
+    for(int i{0}; i < Frames * 2; ++i) {
+        EXPECT_EQ(samples.at(i), static_cast<int16_t>(i));
+    }
+}
+
+TEST_F(PcmDecoderTest, UnpacksBigEndianAiff)
+{
+    constexpr int Frames = 100;
+
+    std::vector<uint8_t> data;
+    append(data, "FORM");
+    appendBE(data, 4 + 26 + 16 + (Frames * 3), 4);
+    append(data, "AIFF");
+    append(data, "COMM");
+    appendBE(data, 18, 4);
+    appendBE(data, 1, 2);
+    appendBE(data, Frames, 4);
+    appendBE(data, 24, 2);
+    // 48000 as an 80bit extended float
+    appendBE(data, 0x400E, 2);
+    appendBE(data, 0xBB800000, 4);
+    appendBE(data, 0, 4);
+    append(data, "SSND");
+    appendBE(data, 8 + (Frames * 3), 4);
+    appendBE(data, 0, 4);
+    appendBE(data, 0, 4);
+    for(int i{0}; i < Frames; ++i) {
+        // Alternate signs to check they're extended correctly
+        appendBE(data, static_cast<uint32_t>(i % 2 == 0 ? i * 1000 : -i * 1000), 3);
+    }
+    writeFile(data);
+
+    PcmDecoder decoder;
+    ASSERT_TRUE(decoder.init(source()));
+    EXPECT_EQ(decoder.format(), AudioFormat(SampleFormat::S24, 48000, 1));
+
+    decoder.start();
+    const AudioBuffer buffer = decoder.readBuffer();
+    ASSERT_EQ(buffer.frameCount(), Frames);
+
+    std::vector<int32_t> samples(Frames);
+    std::memcpy(samples.data(), buffer.constData().data(), samples.size() * sizeof(int32_t));
+
+    for(int i{0}; i < Frames; ++i) {
+        const int32_t expected = (i % 2 == 0 ? i * 1000 : -i * 1000) * 256;
+        EXPECT_EQ(samples.at(i), expected);
+    }
+
+    EXPECT_FALSE(decoder.readBuffer().isValid());
+}
+
+TEST_F(PcmDecoderTest, SeeksToSample)
+{
+    writeWav(44100);
+
+    PcmDecoder decoder;
+    ASSERT_TRUE(decoder.init(source()));
+    decoder.start();
+    decoder.seek(500);
+
+    const AudioBuffer buffer = decoder.readBuffer(400);
+    ASSERT_TRUE(buffer.isValid());
+    EXPECT_EQ(buffer.startTime(), 500);
+    EXPECT_EQ(buffer.frameCount(), 100);
+
+    const auto* samples = reinterpret_cast<const int16_t*>(buffer.constData().data());
+    EXPECT_EQ(samples[0], static_cast<int16_t>(22050 * 2));
+}
+
+TEST_F(PcmDecoderTest, BuffersOutliveDecoder)
+{
+    writeWav(100);
+
+    AudioBuffer buffer;
+    {
+        PcmDecoder decoder;
+        ASSERT_TRUE(decoder.init(source()));
+        decoder.start();
+        buffer = decoder.readBuffer();
+    }
+
+    ASSERT_EQ(buffer.frameCount(), 100);
+    const auto* samples = reinterpret_cast<const int16_t*>(buffer.constData().data());
+    EXPECT_EQ(samples[199], 199);
+}
+
+TEST_F(PcmDecoderTest, ReadsPastLargeLeadingChunks)
+{
+    // Pushes the format beyond the first read of the header
+    writeWav(100, 1, 200001);
+
+    PcmDecoder decoder;
+    ASSERT_TRUE(decoder.init(source()));
+    decoder.start();
+
+    const AudioBuffer buffer = decoder.readBuffer();
+    ASSERT_EQ(buffer.frameCount(), 100);
+    const auto* samples = reinterpret_cast<const int16_t*>(buffer.constData().data());
+    EXPECT_EQ(samples[199], 199);
+}
+
+TEST_F(PcmDecoderTest, StopsAtTruncation)
+{
+    constexpr int Frames = 10000;
+    writeWav(Frames);
+
+    PcmDecoder decoder;
+    ASSERT_TRUE(decoder.init(source()));
+    decoder.start();
+
+    ASSERT_EQ(decoder.readBuffer(4000).frameCount(), 1000);
+
+    // As if rewritten by a tag editor while playing; the header is 54 bytes
+    const uint64_t dataOffset = 54;
+    std::filesystem::resize_file(m_path, dataOffset + (1500 * 4) + 2);
+
+    const AudioBuffer buffer = decoder.readBuffer(4000);
+    ASSERT_EQ(buffer.frameCount(), 500);
+    const auto* samples = reinterpret_cast<const int16_t*>(buffer.constData().data());
+    EXPECT_EQ(samples[0], 2000);
+
+    EXPECT_FALSE(decoder.readBuffer().isValid());
+}
+
+TEST_F(PcmDecoderTest, RejectsCompressedFiles)
+{
+    // IMA ADPCM
+    writeWav(100, 0x11);
+    EXPECT_FALSE(PcmDecoder::canDecode(source()));
+
+    PcmDecoder decoder;
+    EXPECT_FALSE(decoder.init(source()));
+    EXPECT_EQ(decoder.error(), AudioDecoder::FormatError);
+}
+} // namespace Fooyin::Testing
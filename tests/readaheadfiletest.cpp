@@ -0,0 +1,141 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/readaheadfile.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace {
+class ReadAheadFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_path = std::filesystem::temp_directory_path() / "fooyin_readahead_test.bin";
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> dist{0, 255};
+
+        m_data.resize(3 * 1024 * 1024 + 123);
+        for(auto& byte : m_data) {
+            byte = static_cast<std::byte>(dist(gen));
+        }
+
+        std::ofstream file{m_path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(m_path);
+    }
+
+    std::vector<std::byte> readAll(Fooyin::ReadAheadFile& file, size_t readSize)
+    {
+        std::vector<std::byte> result;
+        std::vector<std::byte> chunk(readSize);
+
+        int64_t count{0};
+        while((count = file.read(chunk.data(), chunk.size())) > 0) {
+            result.insert(result.end(), chunk.begin(), chunk.begin() + count);
+        }
+
+        EXPECT_EQ(count, 0);
+        return result;
+    }
+
+    std::filesystem::path m_path;
+    std::vector<std::byte> m_data;
+};
+} // namespace
+
+namespace Fooyin::Testing {
+TEST_F(ReadAheadFileTest, ReadsWholeFileThroughWindow)
+{
+    ReadAheadFile file;
+    // Smaller than the file, so the window has to wrap
+    ASSERT_TRUE(file.open(m_path.string(), {.windowSize = 256 * 1024, .cacheLimit = 0}));
+    EXPECT_FALSE(file.isCached());
+    EXPECT_EQ(file.size(), m_data.size());
+
+    EXPECT_EQ(readAll(file, 32768), m_data);
+    EXPECT_EQ(file.stats().bytesRead, m_data.size());
+}
+
+TEST_F(ReadAheadFileTest, CachesSmallFiles)
+{
+    ReadAheadFile file;
+    ASSERT_TRUE(file.open(m_path.string(), {.windowSize = 256 * 1024, .cacheLimit = m_data.size()}));
+    EXPECT_TRUE(file.isCached());
+
+    EXPECT_EQ(readAll(file, 4096), m_data);
+
+    // Everything is still buffered, so seeking back doesn't restart the window
+    const auto refills = file.stats().refills;
+    const auto stalls  = file.stats().stalls;
+    ASSERT_TRUE(file.seek(0));
+    EXPECT_EQ(readAll(file, 65536), m_data);
+    EXPECT_EQ(file.stats().refills, refills);
+    // Nor does reading from the buffer count as a stall
+    EXPECT_EQ(file.stats().stalls, stalls);
+}
+
+TEST_F(ReadAheadFileTest, SeeksAnywhere)
+{
+    ReadAheadFile file;
+    ASSERT_TRUE(file.open(m_path.string(), {.windowSize = 256 * 1024, .cacheLimit = 0}));
+
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<size_t> posDist{0, m_data.size()};
+    std::vector<std::byte> chunk(10000);
+
+    for(int i{0}; i < 200; ++i) {
+        const size_t pos = posDist(gen);
+        ASSERT_TRUE(file.seek(pos));
+        EXPECT_EQ(file.pos(), pos);
+
+        // Reads may be short if the window hasn't caught up yet
+        size_t count{0};
+        int64_t read{0};
+        while(count < chunk.size() && (read = file.read(chunk.data() + count, chunk.size() - count)) > 0) {
+            count += static_cast<size_t>(read);
+        }
+        ASSERT_EQ(count, std::min(chunk.size(), m_data.size() - pos));
+        EXPECT_TRUE(std::equal(chunk.begin(), chunk.begin() + static_cast<ptrdiff_t>(count),
+                               m_data.begin() + static_cast<ptrdiff_t>(pos)));
+    }
+
+    EXPECT_FALSE(file.seek(m_data.size() + 1));
+}
+
+TEST_F(ReadAheadFileTest, FailsOnMissingFile)
+{
+    ReadAheadFile file;
+    EXPECT_FALSE(file.open((m_path.parent_path() / "fooyin_missing_file.bin").string()));
+    EXPECT_FALSE(file.isOpen());
+
+    std::byte byte;
+    EXPECT_EQ(file.read(&byte, 1), -1);
+}
+} // namespace Fooyin::Testing
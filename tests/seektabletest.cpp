@@ -0,0 +1,81 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/seektable.h"
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(SeekTableTest, FindsPointAtOrBefore)
+{
+    SeekTable table{100};
+
+    EXPECT_TRUE(table.insert({.timestamp = 0, .offset = 10}));
+    EXPECT_TRUE(table.insert({.timestamp = 200, .offset = 500}));
+    // Out of order insertion is kept sorted
+    EXPECT_TRUE(table.insert({.timestamp = 100, .offset = 250}));
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_TRUE(table.isModified());
+
+    EXPECT_EQ(table.find(0), (SeekTable::Point{0, 10}));
+    EXPECT_EQ(table.find(99), (SeekTable::Point{0, 10}));
+    EXPECT_EQ(table.find(150), (SeekTable::Point{100, 250}));
+    EXPECT_EQ(table.find(5000), (SeekTable::Point{200, 500}));
+    EXPECT_FALSE(table.find(-1));
+}
+
+TEST(SeekTableTest, RejectsInvalidPoints)
+{
+    SeekTable table{100};
+
+    EXPECT_TRUE(table.insert({.timestamp = 1000, .offset = 5000}));
+
+    // Too close to an existing point
+    EXPECT_FALSE(table.insert({.timestamp = 1050, .offset = 5100}));
+    EXPECT_FALSE(table.insert({.timestamp = 950, .offset = 4900}));
+    // Offsets must increase with timestamps
+    EXPECT_FALSE(table.insert({.timestamp = 2000, .offset = 4000}));
+    EXPECT_FALSE(table.insert({.timestamp = 0, .offset = 6000}));
+    EXPECT_FALSE(table.insert({.timestamp = -1, .offset = 0}));
+
+    EXPECT_EQ(table.size(), 1);
+}
+
+TEST(SeekTableTest, RoundTrips)
+{
+    SeekTable table{10};
+    for(int64_t i{0}; i < 1000; ++i) {
+        table.insert({.timestamp = i * 1152, .offset = 4096 + i * 417});
+    }
+
+    const auto data     = table.serialise();
+    const auto restored = SeekTable::deserialise(data.data(), data.size());
+
+    EXPECT_EQ(restored.points(), table.points());
+    EXPECT_FALSE(restored.isModified());
+
+    // Truncated or corrupt data is discarded
+    EXPECT_TRUE(SeekTable::deserialise(data.data(), data.size() - 1).empty());
+    EXPECT_TRUE(SeekTable::deserialise(nullptr, 0).empty());
+
+    auto corrupt = data;
+    corrupt[0]   = std::byte{0xff};
+    EXPECT_TRUE(SeekTable::deserialise(corrupt.data(), corrupt.size()).empty());
+}
+} // namespace Fooyin::Testing
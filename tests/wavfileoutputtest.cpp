@@ -0,0 +1,156 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "plugins/wavfile/wavfileoutput.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr auto HeaderSize = 44;
+
+// Two tracks of 16bit stereo; each sample holds its index, offset per track so a gap or overlap shows up
+std::vector<int16_t> makeTracks(int firstFrames, int secondFrames)
+{
+    std::vector<int16_t> samples;
+    for(int i{0}; i < firstFrames * 2; ++i) {
+        samples.push_back(static_cast<int16_t>(i % 10000));
+    }
+    for(int i{0}; i < secondFrames * 2; ++i) {
+        samples.push_back(static_cast<int16_t>(-(i % 10000)));
+    }
+    return samples;
+}
+
+uint32_t readLE32(const std::vector<char>& data, size_t offset)
+{
+    uint32_t value{0};
+    for(size_t i{0}; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data.at(offset + i))) << (i * 8);
+    }
+    return value;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+class WavFileOutputTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        m_dir                  = std::filesystem::temp_directory_path()
+              / ("fooyin_wavfile_test_" + std::to_string(::getpid()) + "_" + name);
+        std::filesystem::create_directories(m_dir);
+
+        m_output.setDevice(QString::fromStdString(m_dir.string()));
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    [[nodiscard]] std::vector<char> readCapture() const
+    {
+        std::vector<std::filesystem::path> files;
+        for(const auto& entry : std::filesystem::directory_iterator{m_dir}) {
+            files.push_back(entry.path());
+        }
+        if(files.size() != 1) {
+            ADD_FAILURE() << "Expected a single capture, found " << files.size();
+            return {};
+        }
+
+        std::ifstream file{files.front(), std::ios::binary};
+        return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+    void expectCapture(const std::vector<int16_t>& samples) const
+    {
+        const std::vector<char> capture = readCapture();
+        const size_t dataSize           = samples.size() * sizeof(int16_t);
+
+        ASSERT_EQ(capture.size(), HeaderSize + dataSize);
+        EXPECT_EQ(readLE32(capture, 4), HeaderSize - 8 + dataSize);
+        EXPECT_EQ(readLE32(capture, 40), dataSize);
+        EXPECT_EQ(std::memcmp(capture.data() + HeaderSize, samples.data(), dataSize), 0);
+    }
+
+    AudioFormat m_format{SampleFormat::S16, 44100, 2};
+    WavFile::WavFileOutput m_output;
+    std::filesystem::path m_dir;
+};
+
+TEST_F(WavFileOutputTest, CapturesPulledTracksGaplessly)
+{
+    // Neither track is a whole number of pulls, so the second starts part way through one
+    const std::vector<int16_t> samples = makeTracks(5000, 3333);
+    const size_t totalFrames           = samples.size() / 2;
+    std::atomic<size_t> pos{0};
+
+    m_output.setPullCallback([&samples, &pos, totalFrames](std::byte* data, int frames, double /*delay*/) {
+        const size_t start = pos.load();
+        const size_t count = std::min(static_cast<size_t>(frames), totalFrames - start);
+        std::memcpy(data, samples.data() + (start * 2), count * 4);
+        pos.store(start + count);
+        return static_cast<int>(count);
+    });
+
+    ASSERT_TRUE(m_output.init(m_format));
+    m_output.start();
+
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while(pos.load() < totalFrames && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    m_output.uninit();
+
+    ASSERT_EQ(pos.load(), totalFrames);
+    expectCapture(samples);
+}
+
+TEST_F(WavFileOutputTest, CapturesWrittenTracksGaplessly)
+{
+    const std::vector<int16_t> samples = makeTracks(1000, 777);
+    const auto* bytes                  = reinterpret_cast<const std::byte*>(samples.data());
+    const size_t firstSize             = 1000 * 4;
+
+    ASSERT_TRUE(m_output.init(m_format));
+    EXPECT_EQ(m_output.write({std::span{bytes, firstSize}, m_format, 0}), 1000);
+    EXPECT_EQ(m_output.write({std::span{bytes + firstSize, (samples.size() * 2) - firstSize}, m_format, 0}), 777);
+    m_output.uninit();
+
+    expectCapture(samples);
+}
+} // namespace Fooyin::Testing